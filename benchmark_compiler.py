@@ -0,0 +1,84 @@
+import argparse
+import os
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Measure compilation time of a large generated source file'
+)
+parser.add_argument(
+    '--lines', type=int, default=100000, help='Approximate number of lines to generate'
+)
+parser.add_argument(
+    '--runs', type=int, default=5, help='Number of times to compile the file'
+)
+
+
+FUNCTION_TEMPLATE = '''func function_{i}(first: Int, second: Float) :: Float:
+  var total = first * 2 + second;
+  final items = [1, 2, 3, first, second];
+  var text = "function {i}";
+  for item in items:
+    if item > total and total != 0:
+      total += item / 2;
+    else:
+      total -= function_{prev}(item, 1.5);
+    end
+  end
+  var counter = 0;
+  while counter < first:
+    counter += 1;
+    total = total ** 2 % 1000;
+  end
+  try:
+    total = total / counter;
+  catch e:
+    total = 0;
+  end
+  return total + counter + items.length();
+end
+
+'''
+
+LINES_PER_FUNCTION = FUNCTION_TEMPLATE.count('\n')
+
+
+def generate(path, lines):
+    functions = max(1, lines // LINES_PER_FUNCTION)
+    with open(path, 'w') as f:
+        f.write('import std::list;\n\n')
+        for i in range(0, functions):
+            f.write(FUNCTION_TEMPLATE.format(i=i, prev=max(0, i - 1)))
+        f.write('func main():\nend\n')
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    with tempfile.TemporaryDirectory() as directory:
+        path = os.path.join(directory, 'compiler_benchmark.gr')
+        generate(path, args.lines)
+        print(f'Generated {path} ({os.path.getsize(path)} bytes)')
+
+        times = []
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, '-v', path], capture_output=True, text=True).stdout
+            match = re.search(r'Compilation succeeded in ([0-9]+) (ms|µs|\xE6s)', output)
+            if match is None:
+                raise RuntimeError(f'Unexpected output from grace: {output}')
+            ms = int(match.group(1)) if match.group(2) == 'ms' else int(match.group(1)) / 1000
+            times.append(ms)
+            print(f'Compiled in {ms} ms')
+
+    print(f'Best: {min(times)} ms, Average: {sum(times) / len(times)} ms')
+
+
+if __name__ == '__main__':
+    main()
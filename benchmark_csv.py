@@ -0,0 +1,112 @@
+import argparse
+import os
+import random
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Compare summing a CSV column with read_all_lines and split against std::csv rows and columns'
+)
+parser.add_argument(
+    '--rows', type=int, default=200000, help='Number of rows to generate'
+)
+parser.add_argument(
+    '--runs', type=int, default=3, help='Number of times to run each method'
+)
+
+
+METHODS = {
+    'split': '''import std::file;
+import std::string;
+import std::time;
+
+func main():
+  final start = std::time::time_ns();
+  final lines = std::file::read_all_lines("{path}");
+  var total = 0.0;
+  var header = true;
+  for line in lines:
+    if header:
+      header = false;
+    else:
+      total += Float(line.split(",")[2]);
+    end
+  end
+  println("elapsed: " + (std::time::time_ns() - start) / 1000000 + " ms, total: " + total);
+end
+''',
+    'rows': '''import std::csv;
+import std::time;
+
+func main():
+  final start = std::time::time_ns();
+  var total = 0.0;
+  var header = true;
+  for row in std::csv::rows("{path}"):
+    if header:
+      header = false;
+    else:
+      total += Float(row[2]);
+    end
+  end
+  println("elapsed: " + (std::time::time_ns() - start) / 1000000 + " ms, total: " + total);
+end
+''',
+    'columns': '''import std::csv;
+import std::time;
+
+func main():
+  final start = std::time::time_ns();
+  var total = 0.0;
+  for value in std::csv::columns("{path}")["price"]:
+    total += value;
+  end
+  println("elapsed: " + (std::time::time_ns() - start) / 1000000 + " ms, total: " + total);
+end
+''',
+}
+
+
+def generate(path, rows):
+    random.seed(0)
+    with open(path, 'w') as f:
+        f.write('id,name,price,quantity,category\n')
+        for i in range(0, rows):
+            # quoted, but without a comma inside so splitting on commas still finds the right column
+            name = f'"item number {i}"' if i % 10 == 0 else f'item{i}'
+            f.write(f'{i},{name},{random.random() * 100:.2f},{random.randint(1, 50)},category{i % 7}\n')
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    with tempfile.TemporaryDirectory() as directory:
+        data_path = os.path.join(directory, 'csv_benchmark.csv')
+        generate(data_path, args.rows)
+        print(f'Generated {data_path} ({os.path.getsize(data_path)} bytes)')
+
+        for method, template in METHODS.items():
+            script_path = os.path.join(directory, f'csv_benchmark_{method}.gr')
+            with open(script_path, 'w') as f:
+                f.write(template.replace('{path}', data_path.replace('\\', '/')))
+
+            times = []
+            for i in range(0, args.runs):
+                output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+                match = re.search(r'elapsed: ([0-9]+) ms', output)
+                if match is None:
+                    raise RuntimeError(f'Unexpected output from grace: {output}')
+                times.append(int(match.group(1)))
+
+            print(f'{method}: best {min(times)} ms, average {sum(times) / len(times):.0f} ms')
+
+
+if __name__ == '__main__':
+    main()
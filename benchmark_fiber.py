@@ -0,0 +1,160 @@
+import argparse
+import os
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Compare waiting on child processes one after another with waiting on them from fibers, '
+                'and time thousands of sleeping fibers and a ring of fibers passing lines through pipes'
+)
+parser.add_argument(
+    '--commands', type=int, default=50, help='Number of child processes to run'
+)
+parser.add_argument(
+    '--command-ms', type=int, default=100, help='How long each child process sleeps for, in milliseconds'
+)
+parser.add_argument(
+    '--sleepers', type=int, default=10000, help='Number of fibers sleeping at the same time'
+)
+parser.add_argument(
+    '--fibers', type=int, default=400,
+    help='Number of fibers passing lines through pipes, each needs two more open files than the limit allows otherwise'
+)
+parser.add_argument(
+    '--runs', type=int, default=3, help='Number of times to run the benchmark'
+)
+
+
+BENCHMARK_TEMPLATE = '''import std::fiber;
+import std::list;
+import std::system;
+import std::time;
+
+func export run_command() :: Int:
+  return std::fiber::run("sleep {command_seconds}");
+end
+
+func export nap(milliseconds: Int) :: Int:
+  std::fiber::sleep(milliseconds);
+  return 1;
+end
+
+func export echo(reader: Stream, writer: Stream) :: Int:
+  var count = 0;
+  while true:
+    final line = reader.read_line();
+    if line == null:
+      break;
+    end
+    writer.write(line + "\\n");
+    count += 1;
+  end
+  writer.close();
+  return count;
+end
+
+func main():
+  final command = "sleep {command_seconds}";
+
+  var start = std::time::time_ns();
+  var failed = 0;
+  var i = 0;
+  while i < {commands}:
+    failed += std::system::run(command);
+    i += 1;
+  end
+  println("sequential: " + (std::time::time_ns() - start) / 1000000 + " ms, " + failed + " failed");
+
+  start = std::time::time_ns();
+  final runners = [];
+  i = 0;
+  while i < {commands}:
+    runners.append(std::fiber::spawn("run_command", []));
+    i += 1;
+  end
+  failed = 0;
+  for runner in runners:
+    failed += runner.join();
+  end
+  println("fibers: " + (std::time::time_ns() - start) / 1000000 + " ms, " + failed + " failed");
+
+  start = std::time::time_ns();
+  final sleepers = [];
+  i = 0;
+  while i < {sleepers}:
+    sleepers.append(std::fiber::spawn("nap", [{command_ms}]));
+    i += 1;
+  end
+  var woken = 0;
+  for sleeper in sleepers:
+    woken += sleeper.join();
+  end
+  println("sleepers: " + (std::time::time_ns() - start) / 1000000 + " ms, " + woken + " woken");
+
+  // each echo fiber reads from the pipe before it and writes to the one after it
+  start = std::time::time_ns();
+  final first = std::fiber::pipe();
+  var reader = first[0];
+  final echoes = [];
+  i = 0;
+  while i < {fibers}:
+    final next = std::fiber::pipe();
+    echoes.append(std::fiber::spawn("echo", [reader, next[1]]));
+    reader = next[0];
+    i += 1;
+  end
+  first[1].write("ping\\npong\\n");
+  first[1].close();
+  final received = reader.read_all();
+  var passed = 0;
+  for echo in echoes:
+    passed += echo.join();
+  end
+  println("pipes: " + (std::time::time_ns() - start) / 1000000 + " ms, " + passed + " lines passed on");
+  println(received == "ping\\npong\\n");
+end
+'''
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        raise RuntimeError('std::fiber needs epoll, which is only available on Linux')
+    grace = './build/grace/Release/grace'
+
+    timings = {'sequential': [], 'fibers': [], 'sleepers': [], 'pipes': []}
+
+    with tempfile.TemporaryDirectory() as directory:
+        script_path = os.path.join(directory, 'fiber_benchmark.gr')
+        with open(script_path, 'w') as f:
+            f.write(BENCHMARK_TEMPLATE
+                    .replace('{command_seconds}', f'{args.command_ms / 1000:.3f}')
+                    .replace('{command_ms}', str(args.command_ms))
+                    .replace('{commands}', str(args.commands))
+                    .replace('{sleepers}', str(args.sleepers))
+                    .replace('{fibers}', str(args.fibers)))
+
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+            results = re.findall(r'^(sequential|fibers|sleepers|pipes): ([0-9]+) ms, ([0-9]+) (failed|woken|lines passed on)$',
+                                 output, re.MULTILINE)
+            expected = {'sequential': 0, 'fibers': 0, 'sleepers': args.sleepers, 'pipes': args.fibers * 2}
+            if len(results) != 4 or any(int(count) != expected[name] for name, _, count, _ in results) \
+                    or not output.strip().endswith('true'):
+                raise RuntimeError(f'Unexpected output from grace: {output}')
+            for name, ms, _, _ in results:
+                timings[name].append(int(ms))
+
+    for name, results in timings.items():
+        print(f'{name}: Best: {min(results)} ms, Average: {sum(results) / len(results):.0f} ms')
+
+    ideal = args.commands * args.command_ms
+    print(f'{args.commands} commands of {args.command_ms} ms take {ideal} ms one after another, '
+          f'fibers ran them {min(timings["sequential"]) / max(min(timings["fibers"]), 1):.1f}x faster')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,125 @@
+import argparse
+import os
+import re
+import resource
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Compare the time and peak memory of summing a filtered sequence built as a List and produced by a generator'
+)
+parser.add_argument(
+    '--count', type=int, default=2000000, help='The length of the sequence'
+)
+parser.add_argument(
+    '--runs', type=int, default=3, help='Number of times to run the benchmark'
+)
+
+
+LIST_TEMPLATE = '''import std::list;
+
+func numbers(last: Int) :: List:
+  final result = [];
+  var i = 0;
+  while i < last:
+    result.append(i);
+    i += 1;
+  end
+  return result;
+end
+
+func evens(items: List) :: List:
+  final result = [];
+  for n in items:
+    if n % 2 == 0:
+      result.append(n);
+    end
+  end
+  return result;
+end
+
+func main():
+  var total = 0;
+  for n in evens(numbers({count})):
+    total += n;
+  end
+  println("total " + total);
+end
+'''
+
+GENERATOR_TEMPLATE = '''func numbers(last: Int):
+  var i = 0;
+  while i < last:
+    yield i;
+    i += 1;
+  end
+end
+
+func evens(items: Generator):
+  for n in items:
+    if n % 2 == 0:
+      yield n;
+    end
+  end
+end
+
+func main():
+  var total = 0;
+  for n in evens(numbers({count})):
+    total += n;
+  end
+  println("total " + total);
+end
+'''
+
+
+def run(grace, script_path):
+    # each script runs in its own child, so the peak of the children so far only grows when this one beats it
+    before = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+    start = os.times().elapsed
+    output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+    elapsed = os.times().elapsed - start
+    peak = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+    total = re.findall(r'^total ([0-9]+)$', output, re.MULTILINE)
+    if len(total) != 1:
+        raise RuntimeError(f'Unexpected output from grace: {output}')
+    return total[0], elapsed, peak if peak > before else None
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        raise RuntimeError('Peak memory is measured with the resource module, which is not available on Windows')
+    grace = './build/grace/Release/grace'
+
+    timings = {'generator': [], 'list': []}
+    peaks = {}
+    totals = set()
+
+    with tempfile.TemporaryDirectory() as directory:
+        # the generator runs first, since the list's peak will be higher and hide it otherwise
+        for name, template in [('generator', GENERATOR_TEMPLATE), ('list', LIST_TEMPLATE)]:
+            script_path = os.path.join(directory, f'{name}_benchmark.gr')
+            with open(script_path, 'w') as f:
+                f.write(template.replace('{count}', str(args.count)))
+
+            for i in range(0, args.runs):
+                total, elapsed, peak = run(grace, script_path)
+                totals.add(total)
+                timings[name].append(elapsed)
+                if peak is not None:
+                    peaks[name] = max(peaks.get(name, 0), peak)
+
+    if len(totals) != 1:
+        raise RuntimeError(f'The List and generator versions disagree: {totals}')
+
+    for name, results in timings.items():
+        peak = f'{peaks[name] / 1024:.1f} MB' if name in peaks else 'unknown'
+        print(f'{name}: Best: {min(results) * 1000:.0f} ms, Average: {sum(results) / len(results) * 1000:.0f} ms, '
+              f'Peak memory: {peak}')
+
+
+if __name__ == '__main__':
+    main()
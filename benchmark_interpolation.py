@@ -0,0 +1,103 @@
+import argparse
+import os
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Compare building Strings with +, f-strings and std::string_builder'
+)
+parser.add_argument(
+    '--iterations', type=int, default=1000000, help='Number of Strings to build'
+)
+parser.add_argument(
+    '--runs', type=int, default=5, help='Number of times to run the benchmark'
+)
+
+
+BENCHMARK_TEMPLATE = '''import std::string;
+import std::string_builder;
+import std::time;
+
+func main():
+  final iterations = {iterations};
+  final sieve_size = 1000000;
+  final passes = 42;
+
+  var start = std::time::time_ns();
+  var i = 0;
+  var total = 0;
+  while i < iterations:
+    final s = "Found " + i + " primes under " + sieve_size + " in " + passes + " passes!";
+    total += s.length();
+    i += 1;
+  end
+  println("concatenation: " + (std::time::time_ns() - start) / 1000000 + " ms");
+
+  start = std::time::time_ns();
+  i = 0;
+  var interpolated_total = 0;
+  while i < iterations:
+    final s = f"Found {{i}} primes under {{sieve_size}} in {{passes}} passes!";
+    interpolated_total += s.length();
+    i += 1;
+  end
+  println("interpolation: " + (std::time::time_ns() - start) / 1000000 + " ms");
+
+  // accumulating one large String, with += and with a builder
+  start = std::time::time_ns();
+  i = 0;
+  var text = "";
+  while i < iterations:
+    text += f"Found {{i}} primes under {{sieve_size}} in {{passes}} passes!\\n";
+    i += 1;
+  end
+  println("accumulate +=: " + (std::time::time_ns() - start) / 1000000 + " ms");
+
+  start = std::time::time_ns();
+  i = 0;
+  final builder = std::string_builder::create();
+  while i < iterations:
+    builder.append_line(f"Found {{i}} primes under {{sieve_size}} in {{passes}} passes!");
+    i += 1;
+  end
+  final built = builder.build();
+  println("accumulate string_builder: " + (std::time::time_ns() - start) / 1000000 + " ms");
+
+  println("checks: " + (total == interpolated_total) + " " + (built == text) + " " + (built.length() == total + iterations));
+end
+'''
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    timings = {'concatenation': [], 'interpolation': [], 'accumulate +=': [], 'accumulate string_builder': []}
+
+    with tempfile.TemporaryDirectory() as directory:
+        script_path = os.path.join(directory, 'interpolation_benchmark.gr')
+        with open(script_path, 'w') as f:
+            f.write(BENCHMARK_TEMPLATE.format(iterations=args.iterations))
+
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+            if 'checks: true true true' not in output:
+                raise RuntimeError(f'Unexpected output from grace: {output}')
+            for name, results in timings.items():
+                match = re.search(re.escape(name) + r': ([0-9]+) ms', output)
+                if match is None:
+                    raise RuntimeError(f'Unexpected output from grace: {output}')
+                results.append(int(match.group(1)))
+
+    for name, results in timings.items():
+        print(f'{name} best: {min(results)} ms, Average: {sum(results) / len(results):.0f} ms')
+
+
+if __name__ == '__main__':
+    main()
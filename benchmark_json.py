@@ -0,0 +1,99 @@
+import argparse
+import json
+import os
+import random
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Measure std::json parse and stringify throughput in MB/s on a large generated document'
+)
+parser.add_argument(
+    '--records', type=int, default=100000, help='Number of records to generate (~200 bytes each)'
+)
+parser.add_argument(
+    '--runs', type=int, default=5, help='Number of times to parse and stringify the document'
+)
+
+
+BENCHMARK_TEMPLATE = '''import std::file;
+import std::json;
+import std::list;
+import std::string;
+import std::time;
+
+func main():
+  // mapped rather than read, so only the parser touches the text
+  final text = std::file::map("{path}");
+  final size = text.length();
+
+  final start_parse = std::time::time_ns();
+  final document = std::json::parse(text);
+  final parse_ns = std::time::time_ns() - start_parse;
+
+  final start_stringify = std::time::time_ns();
+  final output = std::json::stringify(document);
+  final stringify_ns = std::time::time_ns() - start_stringify;
+
+  println("parse: " + size * 1000 / parse_ns + " MB/s");
+  println("stringify: " + output.length() * 1000 / stringify_ns + " MB/s");
+  // still in use here, so freeing it isn't counted in the stringify time
+  println("records: " + document.length());
+end
+'''
+
+
+def generate(path, records):
+    random.seed(0)
+    document = []
+    for i in range(0, records):
+        document.append({
+            'id': i,
+            'name': f'record number {i}',
+            'score': random.random() * 1000,
+            'active': i % 3 == 0,
+            'tags': ['alpha', 'beta', 'gamma'][0:i % 4],
+            'note': None if i % 5 else 'escaped "quotes" and\ttabs\n',
+            'position': {'x': random.randint(-1000, 1000), 'y': random.randint(-1000, 1000)},
+        })
+    with open(path, 'w') as f:
+        json.dump(document, f, indent=1)
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    with tempfile.TemporaryDirectory() as directory:
+        data_path = os.path.join(directory, 'json_benchmark.json')
+        generate(data_path, args.records)
+        print(f'Generated {data_path} ({os.path.getsize(data_path)} bytes)')
+
+        script_path = os.path.join(directory, 'json_benchmark.gr')
+        with open(script_path, 'w') as f:
+            f.write(BENCHMARK_TEMPLATE.format(path=data_path.replace('\\', '/')))
+
+        parse_rates = []
+        stringify_rates = []
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+            parse = re.search(r'parse: ([0-9]+) MB/s', output)
+            stringify = re.search(r'stringify: ([0-9]+) MB/s', output)
+            if parse is None or stringify is None:
+                raise RuntimeError(f'Unexpected output from grace: {output}')
+            parse_rates.append(int(parse.group(1)))
+            stringify_rates.append(int(stringify.group(1)))
+            print(output.strip())
+
+    print(f'Parse best: {max(parse_rates)} MB/s, Average: {sum(parse_rates) / len(parse_rates):.0f} MB/s')
+    print(f'Stringify best: {max(stringify_rates)} MB/s, Average: {sum(stringify_rates) / len(stringify_rates):.0f} MB/s')
+
+
+if __name__ == '__main__':
+    main()
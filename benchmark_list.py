@@ -0,0 +1,209 @@
+import argparse
+import os
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Compare the native std::list, std::dict and std::math functions against the same thing written in Grace'
+)
+parser.add_argument(
+    '--size', type=int, default=1000000, help='Number of elements in the generated List'
+)
+parser.add_argument(
+    '--runs', type=int, default=5, help='Number of times to run the benchmark'
+)
+
+
+BENCHMARK_TEMPLATE = '''import std::dict;
+import std::list;
+import std::math;
+import std::time;
+
+// how these were written before they were native
+func is_number(final value) :: Bool:
+  final is_int = instanceof(value, Int);
+  final is_float = instanceof(value, Float);
+  return is_int or is_float;
+end
+
+func grace_min(final first, final second):
+  if !is_number(first):
+    throw("Expected number");
+  end
+  if !is_number(second):
+    throw("Expected number");
+  end
+  if first <= second:
+    return first;
+  end
+  return second;
+end
+
+func grace_contains(final list: List, value) :: Bool:
+  for element in list:
+    if element == value:
+      return true;
+    end
+  end
+  return false;
+end
+
+func grace_to_list(final dict: Dict) :: List:
+  final res = [];
+  for pair in dict:
+    res.append(pair);
+  end
+  return res;
+end
+
+func grace_zip(final list: List, final other: List) :: List:
+  final length = std::math::min(list.length(), other.length());
+  final res = [];
+  var i = 0;
+  while i < length:
+    res.append(KeyValuePair(list[i], other[i]));
+    i += 1;
+  end
+  return res;
+end
+
+func grace_sum(final list: List):
+  var total = 0;
+  for value in list:
+    total += value;
+  end
+  return total;
+end
+
+func grace_max(final list: List):
+  var best = list[0];
+  for value in list:
+    if value > best:
+      best = value;
+    end
+  end
+  return best;
+end
+
+func grace_reverse(final list: List) :: List:
+  final res = [];
+  var i = list.length() - 1;
+  while i >= 0:
+    res.append(list[i]);
+    i -= 1;
+  end
+  return res;
+end
+
+func report(final name: String, final grace_start: Int, final native_start: Int, final end_ns: Int):
+  println(name + ": grace " + (native_start - grace_start) / 1000 + " us, native " + (end_ns - native_start) / 1000 + " us");
+end
+
+func main():
+  final size = {size};
+  final list = [0] * size;
+  var i = 0;
+  while i < size:
+    list[i] = (i * 7919) % size;
+    i += 1;
+  end
+  final dict = {{}};
+  i = 0;
+  while i < size / 10:
+    dict[i] = i;
+    i += 1;
+  end
+
+  var grace_start = std::time::time_ns();
+  final grace_found = grace_contains(list, -1);
+  var native_start = std::time::time_ns();
+  final native_found = list.contains(-1);
+  report("contains", grace_start, native_start, std::time::time_ns());
+
+  grace_start = std::time::time_ns();
+  final grace_pairs = grace_to_list(dict);
+  native_start = std::time::time_ns();
+  final native_pairs = dict.to_list();
+  report("to_list", grace_start, native_start, std::time::time_ns());
+
+  grace_start = std::time::time_ns();
+  i = 0;
+  var grace_smallest = size;
+  while i < size:
+    grace_smallest = grace_min(grace_smallest, i);
+    i += 1;
+  end
+  native_start = std::time::time_ns();
+  i = 0;
+  var native_smallest = size;
+  while i < size:
+    native_smallest = std::math::min(native_smallest, i);
+    i += 1;
+  end
+  report("math::min", grace_start, native_start, std::time::time_ns());
+
+  grace_start = std::time::time_ns();
+  final grace_zipped = grace_zip(list, list);
+  native_start = std::time::time_ns();
+  final native_zipped = list.zip(list);
+  report("zip", grace_start, native_start, std::time::time_ns());
+
+  grace_start = std::time::time_ns();
+  final grace_total = grace_sum(list);
+  native_start = std::time::time_ns();
+  final native_total = list.sum();
+  report("sum", grace_start, native_start, std::time::time_ns());
+
+  grace_start = std::time::time_ns();
+  final grace_largest = grace_max(list);
+  native_start = std::time::time_ns();
+  final native_largest = list.max();
+  report("max", grace_start, native_start, std::time::time_ns());
+
+  grace_start = std::time::time_ns();
+  final grace_reversed = grace_reverse(list);
+  native_start = std::time::time_ns();
+  final native_reversed = list.slice(0, size);
+  native_reversed.reverse();
+  report("slice + reverse", grace_start, native_start, std::time::time_ns());
+
+  println("checks: " + (grace_found == native_found) + " " + (grace_pairs.length() == native_pairs.length()) + " "
+    + (grace_smallest == native_smallest) + " " + (grace_zipped.length() == native_zipped.length()) + " "
+    + (grace_total == native_total) + " " + (grace_largest == native_largest) + " " + (grace_reversed[0] == native_reversed[0]));
+end
+'''
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    timings = {}
+
+    with tempfile.TemporaryDirectory() as directory:
+        script_path = os.path.join(directory, 'list_benchmark.gr')
+        with open(script_path, 'w') as f:
+            f.write(BENCHMARK_TEMPLATE.format(size=args.size))
+
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+            results = re.findall(r'^(.+): grace ([0-9]+) us, native ([0-9]+) us$', output, re.MULTILINE)
+            if len(results) == 0 or 'checks: true true true true true true true' not in output:
+                raise RuntimeError(f'Unexpected output from grace: {output}')
+            for name, grace_us, native_us in results:
+                timings.setdefault(name, []).append((int(grace_us), int(native_us)))
+
+    for name, results in timings.items():
+        grace_best = min(result[0] for result in results)
+        native_best = min(result[1] for result in results)
+        print(f'{name}: grace best {grace_best} us, native best {native_best} us, {grace_best / max(native_best, 1):.1f}x faster')
+
+
+if __name__ == '__main__':
+    main()
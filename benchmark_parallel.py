@@ -0,0 +1,113 @@
+import argparse
+import os
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Compare the serial List functions with their par_ versions from std::list on one large List'
+)
+parser.add_argument(
+    '--length', type=int, default=2000000, help='Number of elements in the List'
+)
+parser.add_argument(
+    '--pool-size', type=int, default=0, help='Threads in the pool, 0 for one per core'
+)
+parser.add_argument(
+    '--runs', type=int, default=3, help='Number of times to run the benchmark'
+)
+
+
+BENCHMARK_TEMPLATE = '''import std::list;
+import std::thread;
+import std::time;
+
+func make_list(length: Int) :: List:
+  final list = [];
+  var state = 42;
+  var i = 0;
+  while i < length:
+    state = (state * 1103515245 + 12345) % 2147483648;
+    list.append(state % 1000000);
+    i += 1;
+  end
+  return list;
+end
+
+func main():
+  std::thread::set_pool_size({pool_size});
+  final list = make_list({length});
+
+  var start = std::time::time_ns();
+  final serial_sum = list.sum();
+  println("serial sum: " + (std::time::time_ns() - start) / 1000 + " us");
+  start = std::time::time_ns();
+  final parallel_sum = list.par_sum();
+  println("parallel sum: " + (std::time::time_ns() - start) / 1000 + " us");
+
+  start = std::time::time_ns();
+  final serial_max = list.max();
+  println("serial max: " + (std::time::time_ns() - start) / 1000 + " us");
+  start = std::time::time_ns();
+  final parallel_max = list.par_max();
+  println("parallel max: " + (std::time::time_ns() - start) / 1000 + " us");
+
+  start = std::time::time_ns();
+  final parallel_count = list.par_count(list[0]);
+  println("parallel count: " + (std::time::time_ns() - start) / 1000 + " us");
+
+  start = std::time::time_ns();
+  final parallel_added = list.par_add(list);
+  println("parallel add: " + (std::time::time_ns() - start) / 1000 + " us");
+  final first_doubled = parallel_added[0] == list[0] * 2;
+
+  start = std::time::time_ns();
+  final serial_sorted = list.sorted();
+  println("serial sort: " + (std::time::time_ns() - start) / 1000 + " us");
+  start = std::time::time_ns();
+  list.par_sort();
+  println("parallel sort: " + (std::time::time_ns() - start) / 1000 + " us");
+
+  if serial_sum != parallel_sum or serial_max != parallel_max or parallel_count < 1 or !first_doubled or list[0] != serial_sorted[0]:
+    println("mismatch");
+  end
+end
+'''
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    timings = {}
+
+    with tempfile.TemporaryDirectory() as directory:
+        script_path = os.path.join(directory, 'parallel_benchmark.gr')
+        with open(script_path, 'w') as f:
+            f.write(BENCHMARK_TEMPLATE.format(length=args.length, pool_size=args.pool_size))
+
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+            results = re.findall(r'^([a-z]+ [a-z]+): ([0-9]+) us$', output, re.MULTILINE)
+            if len(results) == 0 or 'mismatch' in output:
+                raise RuntimeError(f'Unexpected output from grace: {output}')
+            for name, us in results:
+                timings.setdefault(name, []).append(int(us))
+            print(output.strip())
+
+    for name, results in timings.items():
+        print(f'{name} best: {min(results)} us, Average: {sum(results) / len(results):.0f} us')
+
+    for operation in ['sum', 'max', 'sort']:
+        serial = min(timings[f'serial {operation}'])
+        parallel = min(timings[f'parallel {operation}'])
+        print(f'{operation} speedup: {serial / max(parallel, 1):.2f}x')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,69 @@
+import argparse
+import os
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Measure scanner throughput in tokens/s on a large generated source file'
+)
+parser.add_argument(
+    '--functions', type=int, default=20000, help='Number of functions to generate (~12 lines each)'
+)
+parser.add_argument(
+    '--runs', type=int, default=10, help='Number of times to scan the file'
+)
+
+
+FUNCTION_TEMPLATE = '''// function number {i}, comments are skipped by the scanner
+func export function_{i}(this List list, some_argument_{i}: Int, other_argument: Float) :: Float:
+  /*
+   * block comment spanning lines
+   */
+  var total_value_{i} = 0x{i:x} + 0b101 + {i} * 3.14159;
+  for item in list by 2:
+    total_value_{i} += item ** 2 - some_argument_{i} / (other_argument + 1.5);
+  end
+  if total_value_{i} >= 1000000 and some_argument_{i} != {i}:
+    println("A string literal with some text in it {i}");
+  end
+  return total_value_{i};
+end
+
+'''
+
+
+def generate(path, functions):
+    with open(path, 'w') as f:
+        for i in range(0, functions):
+            f.write(FUNCTION_TEMPLATE.format(i=i))
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    with tempfile.TemporaryDirectory() as directory:
+        path = os.path.join(directory, 'scanner_benchmark.gr')
+        generate(path, args.functions)
+        print(f'Generated {path} ({os.path.getsize(path)} bytes)')
+
+        rates = []
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, '--scan-only', path], capture_output=True, text=True).stdout
+            match = re.search(r'([0-9]+) tokens/s', output)
+            if match is None:
+                raise RuntimeError(f'Unexpected output from grace: {output}')
+            rates.append(int(match.group(1)))
+            print(output.strip())
+
+    print(f'Best: {max(rates)} tokens/s, Average: {sum(rates) / len(rates):.0f} tokens/s')
+
+
+if __name__ == '__main__':
+    main()
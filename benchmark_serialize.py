@@ -0,0 +1,108 @@
+import argparse
+import json
+import os
+import random
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Compare std::serialize against std::json for round tripping a large generated document'
+)
+parser.add_argument(
+    '--records', type=int, default=100000, help='Number of records to generate'
+)
+parser.add_argument(
+    '--runs', type=int, default=5, help='Number of times to run the comparison'
+)
+
+
+BENCHMARK_TEMPLATE = '''import std::file;
+import std::gc;
+import std::json;
+import std::list;
+import std::serialize;
+import std::string;
+import std::time;
+
+func main():
+  final document = std::json::parse(std::file::map("{path}"));
+  // nothing here makes cycles, and a sweep landing in one of the timings would swamp it
+  std::gc::set_enabled(false);
+
+  final start_json_write = std::time::time_ns();
+  final text = std::json::stringify(document);
+  final json_write_ns = std::time::time_ns() - start_json_write;
+
+  final start_json_read = std::time::time_ns();
+  final from_text = std::json::parse(text);
+  final json_read_ns = std::time::time_ns() - start_json_read;
+
+  final start_encode = std::time::time_ns();
+  final bytes = std::serialize::to_bytes(document);
+  final encode_ns = std::time::time_ns() - start_encode;
+
+  final start_decode = std::time::time_ns();
+  final from_bytes = std::serialize::from_bytes(bytes);
+  final decode_ns = std::time::time_ns() - start_decode;
+
+  println("json write: " + json_write_ns / 1000000 + " ms, " + text.length() + " bytes");
+  println("json read: " + json_read_ns / 1000000 + " ms");
+  println("serialize write: " + encode_ns / 1000000 + " ms, " + bytes.length() + " bytes");
+  println("serialize read: " + decode_ns / 1000000 + " ms");
+  // still in use here, so freeing them isn't counted in the timings
+  println("records: " + document.length() + " " + from_text.length() + " " + from_bytes.length());
+end
+'''
+
+
+def generate(path, records):
+    random.seed(0)
+    document = []
+    for i in range(0, records):
+        document.append({
+            'id': i,
+            'name': f'record number {i}',
+            'score': random.random() * 1000,
+            'active': i % 3 == 0,
+            'tags': ['alpha', 'beta', 'gamma'][0:i % 4],
+            'position': {'x': random.randint(-1000, 1000), 'y': random.randint(-1000, 1000)},
+        })
+    with open(path, 'w') as f:
+        json.dump(document, f)
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    timings = {'json write': [], 'json read': [], 'serialize write': [], 'serialize read': []}
+
+    with tempfile.TemporaryDirectory() as directory:
+        data_path = os.path.join(directory, 'serialize_benchmark.json')
+        generate(data_path, args.records)
+
+        script_path = os.path.join(directory, 'serialize_benchmark.gr')
+        with open(script_path, 'w') as f:
+            f.write(BENCHMARK_TEMPLATE.format(path=data_path.replace('\\', '/')))
+
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+            for name, results in timings.items():
+                match = re.search(name + r': ([0-9]+) ms', output)
+                if match is None:
+                    raise RuntimeError(f'Unexpected output from grace: {output}')
+                results.append(int(match.group(1)))
+            print(output.strip())
+
+    for name, results in timings.items():
+        print(f'{name} best: {min(results)} ms, Average: {sum(results) / len(results):.0f} ms')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,151 @@
+import argparse
+import os
+import random
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Measure the throughput of the native std::string functions in MB/s on a large generated text'
+)
+parser.add_argument(
+    '--size', type=int, default=8, help='Size of the generated text in MB'
+)
+parser.add_argument(
+    '--runs', type=int, default=5, help='Number of times to run the benchmark'
+)
+
+
+BENCHMARK_TEMPLATE = '''import std::file;
+import std::list;
+import std::string;
+import std::time;
+
+func report(final name: String, final bytes: Int, final start: Int):
+  final elapsed = std::time::time_ns() - start;
+  if elapsed == 0:
+    println(name + ": " + bytes * 1000 + " MB/s");
+  else:
+    println(name + ": " + bytes * 1000 / elapsed + " MB/s");
+  end
+end
+
+func main():
+  final text = std::file::read_all_text("{path}");
+  final size = text.length();
+
+  var start = std::time::time_ns();
+  final missing = text.find("zzz");
+  report("find", size, start);
+
+  start = std::time::time_ns();
+  final last = text.rfind("\\nzebra");
+  report("rfind", size, start);
+
+  start = std::time::time_ns();
+  final has = text.contains("xylophone");
+  report("contains", size, start);
+
+  start = std::time::time_ns();
+  final starts = text.starts_with(text);
+  report("starts_with", size, start);
+
+  start = std::time::time_ns();
+  final ends = text.ends_with(text);
+  report("ends_with", size, start);
+
+  start = std::time::time_ns();
+  final spaces = text.count(' ');
+  report("count", size, start);
+
+  start = std::time::time_ns();
+  final replaced = text.replace_all("the", "THE");
+  report("replace_all", size, start);
+
+  start = std::time::time_ns();
+  final trimmed = text.trim();
+  report("trim", size, start);
+
+  start = std::time::time_ns();
+  final upper = text.to_upper();
+  report("to_upper", size, start);
+
+  start = std::time::time_ns();
+  final lower = upper.to_lower();
+  report("to_lower", size, start);
+
+  final lines = text.split("\\n");
+  start = std::time::time_ns();
+  final joined = lines.join("\\n");
+  report("join", size, start);
+
+  start = std::time::time_ns();
+  final repeated = "grace ".repeat(size / 6);
+  report("repeat", repeated.length(), start);
+
+  // the same count as a loop over the chars, for comparison
+  start = std::time::time_ns();
+  var loop_spaces = 0;
+  for c in text.chars():
+    if c == ' ':
+      loop_spaces += 1;
+    end
+  end
+  report("count (chars loop)", size, start);
+
+  // still in use here, so freeing them isn't counted in the timings
+  println("checks: " + missing + " " + last + " " + has + " " + starts + " " + ends + " " + (spaces == loop_spaces) + " "
+    + replaced.length() + " " + trimmed.length() + " " + lower.length() + " " + (joined == text) + " " + lines.length());
+end
+'''
+
+WORDS = [
+    'the', 'grace', 'language', 'compiles', 'to', 'bytecode', 'and', 'runs', 'it', 'on', 'a', 'stack', 'based',
+    'virtual', 'machine', 'with', 'reference', 'counted', 'objects', 'The', 'Quick', 'Brown', 'Fox',
+]
+
+
+def generate(path, size):
+    random.seed(0)
+    target = size * 1000 * 1000
+    written = 0
+    with open(path, 'w') as f:
+        while written < target:
+            line = ' '.join(random.choice(WORDS) for _ in range(0, random.randint(4, 16))) + '\n'
+            f.write(line)
+            written += len(line)
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    rates = {}
+
+    with tempfile.TemporaryDirectory() as directory:
+        data_path = os.path.join(directory, 'string_benchmark.txt')
+        generate(data_path, args.size)
+
+        script_path = os.path.join(directory, 'string_benchmark.gr')
+        with open(script_path, 'w') as f:
+            f.write(BENCHMARK_TEMPLATE.format(path=data_path.replace('\\', '/')))
+
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+            results = re.findall(r'^(.+): ([0-9]+) MB/s$', output, re.MULTILINE)
+            if len(results) == 0 or 'checks: ' not in output:
+                raise RuntimeError(f'Unexpected output from grace: {output}')
+            for name, rate in results:
+                rates.setdefault(name, []).append(int(rate))
+
+    for name, results in rates.items():
+        print(f'{name}: best {max(results)} MB/s, Average: {sum(results) / len(results):.0f} MB/s')
+
+
+if __name__ == '__main__':
+    main()
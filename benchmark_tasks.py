@@ -0,0 +1,167 @@
+import argparse
+import ctypes
+import os
+import tempfile
+import threading
+import time
+
+
+parser = argparse.ArgumentParser(
+    description='Compare how long short scripts wait behind long ones when a fixed pool of threads runs each to completion, '
+                'and when it gives each one a time slice at a time. Needs Grace built as a library, e.g. build.py dll Release'
+)
+parser.add_argument(
+    '--library', type=str, default=None, help='Path to the Grace library'
+)
+parser.add_argument(
+    '--short-tasks', type=int, default=2000, help='Number of short scripts'
+)
+parser.add_argument(
+    '--long-tasks', type=int, default=8, help='Number of long scripts, which are started before the short ones'
+)
+parser.add_argument(
+    '--short-size', type=int, default=2000, help='How many numbers a short script checks for primes'
+)
+parser.add_argument(
+    '--long-size', type=int, default=400000, help='How many numbers a long script checks for primes'
+)
+parser.add_argument(
+    '--slice-us', type=int, default=500, help='How long a script runs before the next one gets a turn, in microseconds'
+)
+parser.add_argument(
+    '--threads', type=int, default=os.cpu_count(), help='Number of threads to share the scripts between'
+)
+parser.add_argument(
+    '--runs', type=int, default=3, help='Number of times to run the benchmark'
+)
+
+
+BENCHMARK_SCRIPT = '''func is_prime(n: Int) :: Bool:
+  if n < 2:
+    return false;
+  end
+  var i = 2;
+  while i * i <= n:
+    if n % i == 0:
+      return false;
+    end
+    i += 1;
+  end
+  return true;
+end
+
+func export count_primes(last: String) :: Int:
+  final limit = Int(last);
+  var count = 0;
+  var n = 0;
+  while n < limit:
+    if is_prime(n):
+      count += 1;
+    end
+    n += 1;
+  end
+  return count;
+end
+
+// never called, but the file needs one to compile
+func main():
+end
+'''
+
+RUNTIME_OK = 0
+SUSPENDED = 2
+
+
+def load_library(path):
+    library = ctypes.CDLL(path)
+    library.LoadFile.restype = ctypes.c_bool
+    library.LoadFile.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.POINTER(ctypes.c_char_p)]
+    library.StartTask.restype = ctypes.c_void_p
+    library.StartTask.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.POINTER(ctypes.c_char_p)]
+    library.ResumeTask.restype = ctypes.c_int
+    library.ResumeTask.argtypes = [ctypes.c_void_p, ctypes.c_uint64, ctypes.c_uint64]
+    library.FreeTask.restype = None
+    library.FreeTask.argtypes = [ctypes.c_void_p]
+    return library
+
+
+def run_thread(library, sizes, slice_us, start, finished_at):
+    # a Task belongs to the thread that started it, so each thread starts the ones it was given
+    tasks = []
+    for index, size in sizes:
+        args = (ctypes.c_char_p * 1)(str(size).encode())
+        tasks.append((index, library.StartTask(b'count_primes', 1, args)))
+
+    # ctypes lets go of the GIL while Grace runs, so the threads run at the same time
+    while len(tasks) > 0:
+        waiting = []
+        for index, task in tasks:
+            result = library.ResumeTask(task, 0, slice_us)
+            if result == SUSPENDED:
+                waiting.append((index, task))
+                continue
+            if result != RUNTIME_OK:
+                raise RuntimeError(f'Task {index} failed')
+            finished_at[index] = time.perf_counter() - start
+            library.FreeTask(task)
+        tasks = waiting
+
+
+def run(library, sizes, thread_count, slice_us):
+    # the scripts are dealt out in turn, so every thread gets some of the long ones first
+    shares = [[] for _ in range(thread_count)]
+    for index, size in enumerate(sizes):
+        shares[index % thread_count].append((index, size))
+
+    finished_at = [0.0] * len(sizes)
+    start = time.perf_counter()
+    threads = [threading.Thread(target=run_thread, args=(library, share, slice_us, start, finished_at)) for share in shares]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return time.perf_counter() - start, finished_at
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * fraction))]
+
+
+def main():
+    args = parser.parse_args()
+
+    if args.library is not None:
+        path = args.library
+    elif os.name == 'nt':
+        path = './build/grace/Release/Release/grace.dll'
+    else:
+        path = './build/grace/libgrace.so'
+    library = load_library(os.path.abspath(path))
+
+    sizes = [args.long_size] * args.long_tasks + [args.short_size] * args.short_tasks
+    short = range(args.long_tasks, len(sizes))
+
+    with tempfile.TemporaryDirectory() as directory:
+        script_path = os.path.join(directory, 'tasks_benchmark.gr')
+        with open(script_path, 'w') as f:
+            f.write(BENCHMARK_SCRIPT)
+        options = (ctypes.c_char_p * 1)(b'-O2')
+        if not library.LoadFile(script_path.encode(), 1, options):
+            raise RuntimeError('Failed to compile the benchmark script')
+
+        # a slice of 0 has no limit, so each script runs to completion before the next starts
+        for name, slice_us in [('run to completion', 0), (f'{args.slice_us} us slices', args.slice_us)]:
+            totals, medians, tails = [], [], []
+            for i in range(0, args.runs):
+                total, finished_at = run(library, sizes, args.threads, slice_us)
+                latencies = [finished_at[index] for index in short]
+                totals.append(total)
+                medians.append(percentile(latencies, 0.5))
+                tails.append(percentile(latencies, 0.99))
+            print(f'{name}: Total: {min(totals) * 1000:.0f} ms, Short scripts p50: {min(medians) * 1000:.0f} ms, '
+                  f'p99: {min(tails) * 1000:.0f} ms')
+
+
+if __name__ == '__main__':
+    main()
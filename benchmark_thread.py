@@ -0,0 +1,106 @@
+import argparse
+import os
+import re
+import subprocess
+import tempfile
+
+
+parser = argparse.ArgumentParser(
+    description='Measure how std::thread scales by splitting a fixed amount of CPU bound work between more and more threads'
+)
+parser.add_argument(
+    '--limit', type=int, default=2000000, help='Count the primes below this number'
+)
+parser.add_argument(
+    '--max-threads', type=int, default=os.cpu_count(), help='The most threads to split the work between'
+)
+parser.add_argument(
+    '--runs', type=int, default=3, help='Number of times to run the benchmark'
+)
+
+
+BENCHMARK_TEMPLATE = '''import std::list;
+import std::thread;
+import std::time;
+
+func is_prime(n: Int) :: Bool:
+  if n < 2:
+    return false;
+  end
+  var i = 2;
+  while i * i <= n:
+    if n % i == 0:
+      return false;
+    end
+    i += 1;
+  end
+  return true;
+end
+
+func export count_primes(first: Int, last: Int) :: Int:
+  var count = 0;
+  var n = first;
+  while n < last:
+    if is_prime(n):
+      count += 1;
+    end
+    n += 1;
+  end
+  return count;
+end
+
+func main():
+  final limit = {limit};
+  var thread_count = 1;
+  while thread_count <= {max_threads}:
+    final start = std::time::time_ns();
+    final threads = [];
+    var i = 0;
+    while i < thread_count:
+      threads.append(std::thread::spawn("count_primes", [limit * i / thread_count, limit * (i + 1) / thread_count]));
+      i += 1;
+    end
+    var total = 0;
+    for thread in threads:
+      total += thread.join();
+    end
+    println("threads " + thread_count + ": " + (std::time::time_ns() - start) / 1000000 + " ms, " + total + " primes");
+    thread_count *= 2;
+  end
+end
+'''
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    timings = {}
+
+    with tempfile.TemporaryDirectory() as directory:
+        script_path = os.path.join(directory, 'thread_benchmark.gr')
+        with open(script_path, 'w') as f:
+            f.write(BENCHMARK_TEMPLATE.format(limit=args.limit, max_threads=args.max_threads))
+
+        for i in range(0, args.runs):
+            output = subprocess.run([grace, script_path], capture_output=True, text=True).stdout
+            results = re.findall(r'^threads ([0-9]+): ([0-9]+) ms, ([0-9]+) primes$', output, re.MULTILINE)
+            if len(results) == 0 or len(set(primes for _, _, primes in results)) != 1:
+                raise RuntimeError(f'Unexpected output from grace: {output}')
+            for threads, ms, _ in results:
+                timings.setdefault(int(threads), []).append(int(ms))
+            print(output.strip())
+
+    single = min(timings[1])
+    for threads, results in timings.items():
+        best = min(results)
+        print(f'{threads} threads best: {best} ms, Average: {sum(results) / len(results):.0f} ms, '
+              f'Speedup: {single / max(best, 1):.2f}x')
+
+
+if __name__ == '__main__':
+    main()
@@ -2,7 +2,7 @@ if exists('b:current_syntax')
   finish
 endif
 
-syn keyword graceKeywords import export class constructor if else for in by while break continue return end this print println eprint eprintln and or func instanceof isobject assert try catch throw typename skipwhite
+syn keyword graceKeywords import export class constructor if else for in by while break continue return end this print println eprint eprintln and or func instanceof isobject assert try catch throw typename yield skipwhite
 syn keyword graceBooleans true false skipwhite
 syn keyword graceVariable var final const Int Float Bool String Char null List Dict KeyValuePair Exception Set skipwhite
 
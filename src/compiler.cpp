@@ -9,13 +9,18 @@
  *  For licensing information, see grace.hpp
  */
 
+#include <algorithm>
 #include <charconv>
 #include <chrono>
+#include <cstddef>
 #include <cstdlib>
+#include <deque>
 #include <filesystem>
-#include <fstream>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <stack>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 
@@ -28,6 +33,7 @@
 
 #include "compiler.hpp"
 #include "scanner.hpp"
+#include "source_file.hpp"
 
 using namespace Grace;
 
@@ -44,11 +50,29 @@ enum class CodeContext
   WhileLoop,
 };
 
+// What the compiler knows about the type of a value, from literals, type annotations and `final` locals.
+// The values up to Dict are the same as the type indices used by `instanceof`, so they can be given to AssertType.
+enum class StaticType : std::int64_t
+{
+  Bool = 0,
+  Char = 1,
+  Float = 2,
+  Int = 3,
+  Null = 4,
+  String = 5,
+  List = 6,
+  Dict = 7,
+  // a Range with Int bounds and increment, so iterating over it gives Ints
+  IntRange,
+  Unknown,
+};
+
 struct Local
 {
   std::string name;
   bool isFinal, isIterator;
   std::int64_t index;
+  StaticType type = StaticType::Unknown;
 
   Local(std::string&& name, bool final, bool iterator, std::int64_t index)
     : name(std::move(name)), isFinal(final), isIterator(iterator), index(index)
@@ -57,14 +81,73 @@ struct Local
   }
 };
 
+// The stack of locals in the current function, indexed by name so lookups don't have to scan the whole stack.
+// Locals live in a deque so the names the index views into don't move as locals are pushed and popped.
+class LocalList
+{
+  public:
+
+    using Iterator = std::deque<Local>::iterator;
+    using ConstIterator = std::deque<Local>::const_iterator;
+
+    template<typename... Args>
+    Local& emplace_back(Args&&... args)
+    {
+      auto& local = m_Locals.emplace_back(std::forward<Args>(args)...);
+      // if the name is already in use, keep pointing at the earlier local, the same one a linear search would find
+      m_Index.try_emplace(local.name, m_Locals.size() - 1);
+      return local;
+    }
+
+    void pop_back()
+    {
+      auto it = m_Index.find(m_Locals.back().name);
+      if (it != m_Index.end() && it->second == m_Locals.size() - 1) {
+        m_Index.erase(it);
+      }
+      m_Locals.pop_back();
+    }
+
+    void clear()
+    {
+      m_Index.clear();
+      m_Locals.clear();
+    }
+
+    GRACE_NODISCARD Iterator Find(std::string_view name)
+    {
+      auto it = m_Index.find(name);
+      return it == m_Index.end() ? m_Locals.end() : m_Locals.begin() + static_cast<std::ptrdiff_t>(it->second);
+    }
+
+    GRACE_NODISCARD ConstIterator Find(std::string_view name) const
+    {
+      auto it = m_Index.find(name);
+      return it == m_Index.end() ? m_Locals.end() : m_Locals.begin() + static_cast<std::ptrdiff_t>(it->second);
+    }
+
+    GRACE_NODISCARD std::size_t size() const { return m_Locals.size(); }
+    GRACE_NODISCARD bool empty() const { return m_Locals.empty(); }
+
+    GRACE_NODISCARD Iterator begin() { return m_Locals.begin(); }
+    GRACE_NODISCARD Iterator end() { return m_Locals.end(); }
+    GRACE_NODISCARD ConstIterator begin() const { return m_Locals.begin(); }
+    GRACE_NODISCARD ConstIterator end() const { return m_Locals.end(); }
+
+  private:
+
+    std::deque<Local> m_Locals;
+    std::unordered_map<std::string_view, std::size_t> m_Index;
+};
+
 struct CompilerContext
 {
-  CompilerContext(const std::string& fileName_, const std::filesystem::path& parentPath_, std::string&& code)
+  CompilerContext(const std::string& fileName_, const std::filesystem::path& parentPath_, std::unique_ptr<Scanner::SourceFile>&& file)
     : fileName(fileName_)
   {
     parentPath = std::filesystem::absolute(parentPath_);
     fullPath = std::filesystem::absolute(parentPath / std::filesystem::path(fileName).filename());
-    Scanner::InitScanner(fullPath.string(), std::move(code));
+    Scanner::InitScanner(fullPath.string(), std::move(file));
     codeContextStack.push_back(CodeContext::TopLevel);
   }
 
@@ -78,7 +161,7 @@ struct CompilerContext
   std::filesystem::path fullPath, parentPath;
 
   std::optional<Scanner::Token> current, previous;
-  std::vector<Local> locals;
+  LocalList locals;
 
   bool panicMode = false, hadError = false, hadWarning = false;
 
@@ -86,9 +169,20 @@ struct CompilerContext
 
   bool namespaceQualifierUsed = true;
   std::string currentNamespaceLookup;
+  // the full path of each file this one imports, by the namespace it's imported as, e.g. "std/console"
+  std::unordered_map<std::string, std::string> importedFilePaths;
 
   bool usingExpressionResult = false;
 
+  // the first `return` in the current function that gives back a value, which a generator can't do
+  std::optional<Scanner::Token> valueReturnToken;
+
+  // tokens put back by Rewind(), which Advance() gives out again before scanning any more, last first
+  std::vector<Scanner::Token> rewoundTokens;
+
+  // the type of the value left on the stack by the most recently compiled expression
+  StaticType expressionType = StaticType::Unknown;
+
   bool continueJumpNeedsIndexes = false;
   bool breakJumpNeedsIndexes = false;
 
@@ -128,6 +222,7 @@ static void EmitConstant(const VM::Value& value)
 
 // Advance to the next token
 static void Advance(CompilerContext& compiler);
+static void Rewind(std::vector<Scanner::Token>&& consumed, CompilerContext& compiler);
 
 // All of the following functions parse the grammar of the language in a recursive descent pattern
 static void Declaration(CompilerContext& compiler);
@@ -152,6 +247,7 @@ static void ReturnStatement(CompilerContext& compiler);
 static void TryStatement(CompilerContext& compiler);
 static void ThrowStatement(CompilerContext& compiler);
 static void WhileStatement(CompilerContext& compiler);
+static void YieldStatement(CompilerContext& compiler);
 
 static void Expression(bool canAssign, CompilerContext& compiler);
 
@@ -177,6 +273,7 @@ static void Subscript(bool canAssign, CompilerContext& compiler);
 static void Identifier(bool canAssign, CompilerContext& compiler);
 static void Char(CompilerContext& compiler);
 static void String(CompilerContext& compiler);
+static void InterpolatedString(CompilerContext& compiler);
 static void InstanceOf(CompilerContext& compiler);
 static void IsObject(CompilerContext& compiler);
 static void Cast(CompilerContext& compiler);
@@ -194,9 +291,10 @@ static void MessageAtCurrent(const std::string& message, LogLevel level, Compile
 static void MessageAtPrevious(const std::string& message, LogLevel level, CompilerContext& compiler);
 static void Message(const Scanner::Token& token, const std::string& message, LogLevel level, CompilerContext& compiler);
 
-GRACE_NODISCARD static VM::InterpretResult Finalise(const std::string& mainFileName, bool verbose, const std::vector<std::string>& args);
+GRACE_NODISCARD static bool CompileProgram(const std::string& fileName, bool verbose, bool warningsError, bool checkTypes);
+GRACE_NODISCARD static bool Prepare(const std::string& mainFileName, bool verbose, VM::OptimisationLevel optimisation);
 
-static bool s_Verbose, s_WarningsError;
+static bool s_Verbose, s_WarningsError, s_CheckTypes;
 static std::stack<CompilerContext> s_CompilerContextStack;
 
 struct Constant
@@ -207,29 +305,38 @@ struct Constant
 
 static std::unordered_map<std::string, std::unordered_map<std::string, Constant>> s_FileConstantsLookup;
 
-VM::InterpretResult Grace::Compiler::Compile(const std::string& fileName, bool verbose, bool warningsError, const std::vector<std::string>& args)
+VM::InterpretResult Grace::Compiler::Compile(const std::string& fileName, bool verbose, bool warningsError, bool checkTypes, VM::OptimisationLevel optimisation, const std::vector<std::string>& args)
+{
+  if (CompileProgram(fileName, verbose, warningsError, checkTypes) && Prepare(fileName, verbose, optimisation)) {
+    return VM::VM::Start(fileName, verbose, args);
+  }
+  return VM::InterpretResult::RuntimeError;
+}
+
+bool Grace::Compiler::Load(const std::string& fileName, bool verbose, bool warningsError, bool checkTypes, VM::OptimisationLevel optimisation)
+{
+  return CompileProgram(fileName, verbose, warningsError, checkTypes) && Prepare(fileName, verbose, optimisation);
+}
+
+static bool CompileProgram(const std::string& fileName, bool verbose, bool warningsError, bool checkTypes)
 {
   using namespace std::chrono;
 
   auto start = steady_clock::now();
 
-  std::stringstream inFileStream;
-  std::ifstream inFile;
-  inFile.open(fileName);
-
-  if (inFile.fail()) {    
+  auto sourceFile = Scanner::SourceFile::Open(fileName);
+  if (sourceFile == nullptr) {
     fmt::print(stderr, "Error reading file `{}`\n", fileName);
-    return VM::InterpretResult::RuntimeError;
+    return false;
   }
 
-  inFileStream << inFile.rdbuf();
-
   s_Verbose = verbose;
   s_WarningsError = warningsError;
+  s_CheckTypes = checkTypes;
  
   VM::VM::RegisterNatives();
 
-  s_CompilerContextStack.emplace(fileName, std::filesystem::absolute(std::filesystem::path(fileName)).parent_path(), inFileStream.str());
+  s_CompilerContextStack.emplace(fileName, std::filesystem::absolute(std::filesystem::path(fileName)).parent_path(), std::move(sourceFile));
   
   auto fullPath = s_CompilerContextStack.top().fullPath.string();
   s_FileConstantsLookup[fullPath]["__FILE"] = { VM::Value(fullPath), false };
@@ -272,29 +379,69 @@ VM::InterpretResult Grace::Compiler::Compile(const std::string& fileName, bool v
 #endif
       }
     }
-    return Finalise(fileName, verbose, args);
+    return true;
   }
 
-  return VM::InterpretResult::RuntimeError;
+  return false;
 }
 
-static VM::InterpretResult Finalise(const std::string& mainFileName, bool verbose, const std::vector<std::string>& args)
+VM::InterpretResult Grace::Compiler::Scan(const std::string& fileName)
 {
+  using namespace std::chrono;
+
+  auto sourceFile = Scanner::SourceFile::Open(fileName);
+  if (sourceFile == nullptr) {
+    fmt::print(stderr, "Error reading file `{}`\n", fileName);
+    return VM::InterpretResult::RuntimeError;
+  }
+
+  auto bytes = sourceFile->GetSize();
+  auto start = steady_clock::now();
+
+  Scanner::InitScanner(std::filesystem::absolute(fileName).string(), std::move(sourceFile));
+
+  std::size_t tokenCount = 0, errorCount = 0;
+  while (true) {
+    auto token = Scanner::ScanToken();
+    if (token.GetType() == Scanner::TokenType::EndOfFile) {
+      break;
+    }
+    if (token.GetType() == Scanner::TokenType::Error) {
+      errorCount++;
+    }
+    tokenCount++;
+  }
+
+  Scanner::PopScanner();
+
+  auto seconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+  fmt::print("Scanned {} tokens ({} bytes, {} errors) in {:.3f} ms, {:.0f} tokens/s.\n",
+    tokenCount, bytes, errorCount, seconds * 1000.0, seconds > 0.0 ? static_cast<double>(tokenCount) / seconds : 0.0);
+
+  return errorCount == 0 ? VM::InterpretResult::RuntimeOk : VM::InterpretResult::RuntimeError;
+}
+
+static bool Prepare(const std::string& mainFileName, bool verbose, VM::OptimisationLevel optimisation)
+{
+  VM::VM::Optimise(optimisation, verbose);
+
  #ifdef GRACE_DEBUG
    if (verbose) {
      VM::VM::PrintOps();
    }
  #endif
-   if (VM::VM::CombineFunctions(mainFileName, verbose)) {
-     return VM::VM::Start(mainFileName, verbose, args);
-   }
-  return VM::InterpretResult::RuntimeError;
+  return VM::VM::CombineFunctions(mainFileName, verbose);
 }
 
 static void Advance(CompilerContext& compiler)
 {
-  compiler.previous = compiler.current;
-  compiler.current = Scanner::ScanToken();
+  compiler.previous = std::move(compiler.current);
+  if (compiler.rewoundTokens.empty()) {
+    compiler.current = Scanner::ScanToken();
+  } else {
+    compiler.current = std::move(compiler.rewoundTokens.back());
+    compiler.rewoundTokens.pop_back();
+  }
 
 #ifdef GRACE_DEBUG
   if (s_Verbose) {
@@ -307,6 +454,20 @@ static void Advance(CompilerContext& compiler)
   }
 }
 
+// Puts tokens that were consumed, in the order they were consumed, back in front of the current token
+static void Rewind(std::vector<Scanner::Token>&& consumed, CompilerContext& compiler)
+{
+  if (consumed.empty()) {
+    return;
+  }
+
+  compiler.rewoundTokens.push_back(std::move(*compiler.current));
+  for (auto i = consumed.size() - 1; i > 0; i--) {
+    compiler.rewoundTokens.push_back(std::move(consumed[i]));
+  }
+  compiler.current = std::move(consumed[0]);
+}
+
 static bool Match(Scanner::TokenType expected, CompilerContext& compiler)
 {
   if (!Check(expected, compiler)) {
@@ -397,36 +558,35 @@ static bool IsKeyword(Scanner::TokenType type, std::string& outKeyword)
   }
 }
 
-static bool IsOperator(Scanner::TokenType type)
-{
-  static const std::vector<Scanner::TokenType> symbols {
-    Scanner::TokenType::Colon,
-    Scanner::TokenType::Semicolon,
-    Scanner::TokenType::RightParen,
-    Scanner::TokenType::Comma,
-    Scanner::TokenType::Dot,
-    Scanner::TokenType::DotDot,
-    Scanner::TokenType::Plus,
-    Scanner::TokenType::Slash,
-    Scanner::TokenType::Star,
-    Scanner::TokenType::StarStar,
-    Scanner::TokenType::BangEqual,
-    Scanner::TokenType::Equal,
-    Scanner::TokenType::EqualEqual,
-    Scanner::TokenType::LessThan,
-    Scanner::TokenType::GreaterThan,
-    Scanner::TokenType::LessEqual,
-    Scanner::TokenType::GreaterEqual,
-    Scanner::TokenType::Bar,
-    Scanner::TokenType::Ampersand,
-    Scanner::TokenType::Caret,
-    Scanner::TokenType::ShiftRight,
-    Scanner::TokenType::ShiftLeft,
-  };
-
-  return std::any_of(symbols.begin(), symbols.end(), [type](Scanner::TokenType t) {
-    return t == type;
-  });
+static constexpr bool IsOperator(Scanner::TokenType type)
+{
+  switch (type) {
+    case Scanner::TokenType::Colon:
+    case Scanner::TokenType::Semicolon:
+    case Scanner::TokenType::RightParen:
+    case Scanner::TokenType::Comma:
+    case Scanner::TokenType::Dot:
+    case Scanner::TokenType::DotDot:
+    case Scanner::TokenType::Plus:
+    case Scanner::TokenType::Slash:
+    case Scanner::TokenType::Star:
+    case Scanner::TokenType::StarStar:
+    case Scanner::TokenType::BangEqual:
+    case Scanner::TokenType::Equal:
+    case Scanner::TokenType::EqualEqual:
+    case Scanner::TokenType::LessThan:
+    case Scanner::TokenType::GreaterThan:
+    case Scanner::TokenType::LessEqual:
+    case Scanner::TokenType::GreaterEqual:
+    case Scanner::TokenType::Bar:
+    case Scanner::TokenType::Ampersand:
+    case Scanner::TokenType::Caret:
+    case Scanner::TokenType::ShiftRight:
+    case Scanner::TokenType::ShiftLeft:
+      return true;
+    default:
+      return false;
+  }
 }
 
 static void Declaration(CompilerContext& compiler)
@@ -486,6 +646,8 @@ static void Statement(CompilerContext& compiler)
     BreakStatement(compiler);
   } else if (Match(Scanner::TokenType::Continue, compiler)) {
     ContinueStatement(compiler);
+  } else if (Match(Scanner::TokenType::Yield, compiler)) {
+    YieldStatement(compiler);
   } else if (Check(Scanner::TokenType::Catch, compiler)) {
     if (compiler.codeContextStack.back() != CodeContext::Try) {
       MessageAtCurrent("`catch` block only allowed after `try` block", LogLevel::Error, compiler);
@@ -497,45 +659,181 @@ static void Statement(CompilerContext& compiler)
   }
 }
 
-static bool IsTypeIdent(Scanner::TokenType type)
+static constexpr bool IsTypeIdent(Scanner::TokenType type)
 {
-  static const std::vector<Scanner::TokenType> typeIdents = {
-    Scanner::TokenType::IntIdent,
-    Scanner::TokenType::FloatIdent,
-    Scanner::TokenType::BoolIdent,
-    Scanner::TokenType::StringIdent,
-    Scanner::TokenType::CharIdent,
-    Scanner::TokenType::ListIdent,
-    Scanner::TokenType::DictIdent,
-    Scanner::TokenType::KeyValuePairIdent,
-    Scanner::TokenType::SetIdent,
-    Scanner::TokenType::ExceptionIdent,
-    // Scanner::TokenType::RangeIdent,
-  };
-  return std::any_of(typeIdents.begin(), typeIdents.end(), [type](Scanner::TokenType t) {
-    return t == type;
-  });
-}
-
-static bool IsValidTypeAnnotation(const Scanner::TokenType& token)
-{
-  static const std::vector<Scanner::TokenType> valid = {
-    Scanner::TokenType::Identifier,
-    Scanner::TokenType::IntIdent,
-    Scanner::TokenType::FloatIdent,
-    Scanner::TokenType::BoolIdent,
-    Scanner::TokenType::CharIdent,
-    Scanner::TokenType::Null,
-    Scanner::TokenType::StringIdent,
-    Scanner::TokenType::ListIdent,
-    Scanner::TokenType::DictIdent,
-    Scanner::TokenType::ExceptionIdent,
-    Scanner::TokenType::KeyValuePairIdent,
-    Scanner::TokenType::SetIdent,
-  };
-  return std::any_of(valid.begin(), valid.end(), [token] (Scanner::TokenType t) {
-    return t == token;
-  });
+  switch (type) {
+    case Scanner::TokenType::IntIdent:
+    case Scanner::TokenType::FloatIdent:
+    case Scanner::TokenType::BoolIdent:
+    case Scanner::TokenType::StringIdent:
+    case Scanner::TokenType::CharIdent:
+    case Scanner::TokenType::ListIdent:
+    case Scanner::TokenType::DictIdent:
+    case Scanner::TokenType::KeyValuePairIdent:
+    case Scanner::TokenType::SetIdent:
+    case Scanner::TokenType::ExceptionIdent:
+    // case Scanner::TokenType::RangeIdent:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static constexpr bool IsValidTypeAnnotation(Scanner::TokenType type)
+{
+  switch (type) {
+    case Scanner::TokenType::Identifier:
+    case Scanner::TokenType::IntIdent:
+    case Scanner::TokenType::FloatIdent:
+    case Scanner::TokenType::BoolIdent:
+    case Scanner::TokenType::CharIdent:
+    case Scanner::TokenType::Null:
+    case Scanner::TokenType::StringIdent:
+    case Scanner::TokenType::ListIdent:
+    case Scanner::TokenType::DictIdent:
+    case Scanner::TokenType::ExceptionIdent:
+    case Scanner::TokenType::KeyValuePairIdent:
+    case Scanner::TokenType::SetIdent:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static constexpr StaticType AnnotationType(Scanner::TokenType type)
+{
+  switch (type) {
+    case Scanner::TokenType::BoolIdent:
+      return StaticType::Bool;
+    case Scanner::TokenType::CharIdent:
+      return StaticType::Char;
+    case Scanner::TokenType::FloatIdent:
+      return StaticType::Float;
+    case Scanner::TokenType::IntIdent:
+      return StaticType::Int;
+    case Scanner::TokenType::StringIdent:
+      return StaticType::String;
+    case Scanner::TokenType::ListIdent:
+      return StaticType::List;
+    case Scanner::TokenType::DictIdent:
+      return StaticType::Dict;
+    default:
+      return StaticType::Unknown;
+  }
+}
+
+static constexpr StaticType ValueType(const VM::Value& value)
+{
+  switch (value.GetType()) {
+    case VM::Value::Type::Bool:
+      return StaticType::Bool;
+    case VM::Value::Type::Char:
+      return StaticType::Char;
+    case VM::Value::Type::Double:
+      return StaticType::Float;
+    case VM::Value::Type::Int:
+      return StaticType::Int;
+    case VM::Value::Type::Null:
+      return StaticType::Null;
+    case VM::Value::Type::String:
+      return StaticType::String;
+    default:
+      return StaticType::Unknown;
+  }
+}
+
+static constexpr std::string_view StaticTypeName(StaticType type)
+{
+  switch (type) {
+    case StaticType::Bool: return "Bool";
+    case StaticType::Char: return "Char";
+    case StaticType::Float: return "Float";
+    case StaticType::Int: return "Int";
+    case StaticType::Null: return "Null";
+    case StaticType::String: return "String";
+    case StaticType::List: return "List";
+    case StaticType::Dict: return "Dict";
+    case StaticType::IntRange: return "Range";
+    default: return "Unknown";
+  }
+}
+
+// The type of the result of a binary op, mirroring the overloads on Value
+static constexpr StaticType BinaryResultType(VM::Ops op, StaticType lhs, StaticType rhs)
+{
+  auto bothInt = lhs == StaticType::Int && rhs == StaticType::Int;
+  auto bothNumeric = (lhs == StaticType::Int || lhs == StaticType::Float) && (rhs == StaticType::Int || rhs == StaticType::Float);
+
+  switch (op) {
+    case VM::Ops::And:
+    case VM::Ops::Or:
+    case VM::Ops::Equal:
+    case VM::Ops::NotEqual:
+    case VM::Ops::Greater:
+    case VM::Ops::GreaterEqual:
+    case VM::Ops::Less:
+    case VM::Ops::LessEqual:
+      return StaticType::Bool;
+    case VM::Ops::Add:
+    case VM::Ops::Subtract:
+    case VM::Ops::Multiply:
+    case VM::Ops::Divide:
+    case VM::Ops::Mod:
+    case VM::Ops::Pow:
+      return bothInt ? StaticType::Int : bothNumeric ? StaticType::Float : StaticType::Unknown;
+    case VM::Ops::BitwiseAnd:
+    case VM::Ops::BitwiseOr:
+    case VM::Ops::BitwiseXOr:
+    case VM::Ops::ShiftLeft:
+    case VM::Ops::ShiftRight:
+      return bothInt ? StaticType::Int : StaticType::Unknown;
+    default:
+      return StaticType::Unknown;
+  }
+}
+
+// The version of a binary op that skips the type checks in Value when both operands are proven to be Ints
+static constexpr VM::Ops SpecialisedIntOp(VM::Ops op)
+{
+  switch (op) {
+    case VM::Ops::Add: return VM::Ops::AddInt;
+    case VM::Ops::Subtract: return VM::Ops::SubtractInt;
+    case VM::Ops::Multiply: return VM::Ops::MultiplyInt;
+    case VM::Ops::Equal: return VM::Ops::EqualInt;
+    case VM::Ops::NotEqual: return VM::Ops::NotEqualInt;
+    case VM::Ops::Greater: return VM::Ops::GreaterInt;
+    case VM::Ops::GreaterEqual: return VM::Ops::GreaterEqualInt;
+    case VM::Ops::Less: return VM::Ops::LessInt;
+    case VM::Ops::LessEqual: return VM::Ops::LessEqualInt;
+    default: return op;
+  }
+}
+
+// Emits a binary op whose rhs has just been compiled, lhsType is the type of the expression before it
+static void EmitBinaryOp(VM::Ops op, StaticType lhsType, std::size_t line, CompilerContext& compiler)
+{
+  auto rhsType = compiler.expressionType;
+  auto bothInt = lhsType == StaticType::Int && rhsType == StaticType::Int;
+  EmitOp(bothInt ? SpecialisedIntOp(op) : op, line);
+  compiler.expressionType = BinaryResultType(op, lhsType, rhsType);
+}
+
+// In --check-types mode, checks that the value on top of the stack matches the type annotation of a local
+static void EmitTypeCheck(StaticType type, const std::string& localName, std::size_t line)
+{
+  EmitConstant(static_cast<std::int64_t>(type));
+  EmitConstant(std::string(StaticTypeName(type)));
+  EmitConstant(localName);
+  EmitOp(VM::Ops::AssertType, line);
+}
+
+// Checks a local's value after it has been changed in place, e.g. by a compound assignment or an iterator
+static void EmitLocalTypeCheck(const Local& local, std::size_t line)
+{
+  EmitConstant(local.index);
+  EmitOp(VM::Ops::LoadLocal, line);
+  EmitTypeCheck(local.type, local.name, line);
+  EmitOp(VM::Ops::Pop, line);
 }
 
 static const char s_EscapeChars[] = { 't', 'b', 'n', 'r', '\'', '"', '\\' };
@@ -560,19 +858,19 @@ static bool IsEscapeChar(char c, char& result)
   return false;
 }
 
-static bool IsLiteral(Scanner::TokenType token)
+static constexpr bool IsLiteral(Scanner::TokenType type)
 {
-  static const std::vector<Scanner::TokenType> literalTypes{
-    Scanner::TokenType::True,
-    Scanner::TokenType::False,
-    Scanner::TokenType::Integer,
-    Scanner::TokenType::Double,
-    Scanner::TokenType::String,
-    Scanner::TokenType::Char
-  };
-  return std::any_of(literalTypes.begin(), literalTypes.end(), [token](Scanner::TokenType t) {
-    return t == token;
-  });
+  switch (type) {
+    case Scanner::TokenType::True:
+    case Scanner::TokenType::False:
+    case Scanner::TokenType::Integer:
+    case Scanner::TokenType::Double:
+    case Scanner::TokenType::String:
+    case Scanner::TokenType::Char:
+      return true;
+    default:
+      return false;
+  }
 }
 
 static bool IsNumber(Scanner::TokenType token)
@@ -665,8 +963,7 @@ static std::optional<std::exception> TryParseDouble(const Scanner::Token& token,
 // returns true if the name is a duplicate
 static bool CheckForDuplicateLocalName(const std::string& varName, const CompilerContext& compiler)
 {
-  auto localsIt = std::find_if(compiler.locals.begin(), compiler.locals.end(), [&varName](const Local& local) { return local.name == varName; });
-  return localsIt != compiler.locals.end();
+  return compiler.locals.Find(varName) != compiler.locals.end();
 }
 
 // returns true if the name is a duplicate
@@ -753,24 +1050,21 @@ static void ImportDeclaration(CompilerContext& compiler)
     return;
   }
 
+  compiler.importedFilePaths[importPath.substr(0, importPath.length() - 3)] = fs::absolute(inPath).string();
+
   if (Scanner::HasFile(inPath.string())) {
     // don't produce a warning, but silently ignore the duplicate import
     // TODO: maybe ignore this in the std, but warn the user if they have duplicate imports in one file?
     return;
   }
 
-  std::stringstream inFileStream;
-  std::ifstream inFile;
-  inFile.open(inPath);
-
-  if (inFile.fail()) {
+  auto sourceFile = Scanner::SourceFile::Open(inPath);
+  if (sourceFile == nullptr) {
     Message(*lastPathToken, fmt::format("Error reading imported file `{}`\n", inPath.string()), LogLevel::Error, compiler);
     return;
   }
-  
-  inFileStream << inFile.rdbuf();
 
-  s_CompilerContextStack.emplace(std::move(importPath), inPath.parent_path(), inFileStream.str());
+  s_CompilerContextStack.emplace(std::move(importPath), inPath.parent_path(), std::move(sourceFile));
 
   auto fullPath = s_CompilerContextStack.top().fullPath.string();
   s_FileConstantsLookup[fullPath]["__FILE"] = { VM::Value(fullPath), false };
@@ -1009,6 +1303,7 @@ static void FuncDeclaration(CompilerContext& compiler)
 
   auto exportFunction = false;
   compiler.codeContextStack.emplace_back(CodeContext::Function);
+  compiler.valueReturnToken.reset();
 
   if (Match(Scanner::TokenType::Export, compiler)) {
     exportFunction = true;
@@ -1058,13 +1353,14 @@ static void FuncDeclaration(CompilerContext& compiler)
       }
 
       parameters.push_back(p);
-      compiler.locals.emplace_back(std::move(p), isFinal, false, compiler.locals.size());
+      auto& local = compiler.locals.emplace_back(std::move(p), isFinal, false, compiler.locals.size());
 
       if (Match(Scanner::TokenType::Colon, compiler)) {
         if (!IsValidTypeAnnotation(compiler.current->GetType())) {
           MessageAtCurrent("Expected type name after type annotation", LogLevel::Error, compiler);
           return;
         }
+        local.type = AnnotationType(compiler.current->GetType());
         Advance(compiler);
       }
 
@@ -1156,6 +1452,15 @@ static void FuncDeclaration(CompilerContext& compiler)
     return;
   }
 
+  // callers aren't checked, so make sure the arguments match the annotations when the function is entered
+  if (s_CheckTypes) {
+    for (const auto& local : compiler.locals) {
+      if (local.type != StaticType::Unknown) {
+        EmitLocalTypeCheck(local, funcNameToken.GetLine());
+      }
+    }
+  }
+
   while (!Match(Scanner::TokenType::End, compiler)) {
     Declaration(compiler);
     if (compiler.current->GetType() == Scanner::TokenType::EndOfFile) {
@@ -1185,6 +1490,12 @@ static void FuncDeclaration(CompilerContext& compiler)
     EmitOp(VM::Ops::Exit, compiler.previous->GetLine());
   }
 
+  // only known once the whole body has been compiled, since the `yield` can come after the `return`
+  if (VM::VM::LastFunctionIsGenerator() && compiler.valueReturnToken) {
+    Message(*compiler.valueReturnToken, "A generator cannot return a value, use `return;` to finish it early", LogLevel::Error, compiler);
+    return;
+  }
+
   compiler.codeContextStack.pop_back();
 }
 
@@ -1203,12 +1514,14 @@ static void VarDeclaration(CompilerContext& compiler, bool isFinal)
   }
 
   auto nameToken = *compiler.previous;
+  auto annotation = StaticType::Unknown;
 
   if (Match(Scanner::TokenType::Colon, compiler)) {
     if (!IsValidTypeAnnotation(compiler.current->GetType())) {
       MessageAtCurrent("Expected typename after type annotation", LogLevel::Error, compiler);
       return;
     }
+    annotation = AnnotationType(compiler.current->GetType());
     Advance(compiler);
   }
 
@@ -1234,12 +1547,37 @@ static void VarDeclaration(CompilerContext& compiler, bool isFinal)
   auto localId = static_cast<std::int64_t>(compiler.locals.size());
   EmitOp(VM::Ops::DeclareLocal, line);
 
+  // an annotated local that starts out as null has no type we can rely on
+  auto localType = StaticType::Unknown;
+
   if (Match(Scanner::TokenType::Equal, compiler)) {
     auto prevUsing = compiler.usingExpressionResult;
     compiler.usingExpressionResult = true;
     Expression(false, compiler);
     compiler.usingExpressionResult = prevUsing;
     line = compiler.previous->GetLine();
+
+    auto rhsType = compiler.expressionType;
+    compiler.expressionType = StaticType::Unknown;
+
+    if (annotation != StaticType::Unknown) {
+      if (rhsType != annotation) {
+        if (rhsType != StaticType::Unknown && (s_Verbose || s_WarningsError)) {
+          MessageAtPrevious(fmt::format("'{}' is annotated as `{}` but is being given a value of type `{}`", localName, StaticTypeName(annotation), StaticTypeName(rhsType)), LogLevel::Warning, compiler);
+          if (s_WarningsError) {
+            return;
+          }
+        }
+        if (s_CheckTypes) {
+          EmitTypeCheck(annotation, localName, line);
+        }
+      }
+      localType = annotation;
+    } else if (isFinal) {
+      // finals can't be reassigned, so they keep whatever type their initialiser has
+      localType = rhsType;
+    }
+
     EmitConstant(localId);
     EmitOp(VM::Ops::AssignLocal, line);
   } else {
@@ -1249,7 +1587,7 @@ static void VarDeclaration(CompilerContext& compiler, bool isFinal)
     }
   }
 
-  compiler.locals.emplace_back(std::move(localName), isFinal, false, localId);
+  compiler.locals.emplace_back(std::move(localName), isFinal, false, localId).type = localType;
   Consume(Scanner::TokenType::Semicolon, fmt::format("Expected ';' after `{}` declaration", diagnosticName), compiler);
 }
 
@@ -1292,25 +1630,65 @@ static void ConstDeclaration(CompilerContext& compiler)
   
   bool isNegativeNumber = false;
   std::optional<Scanner::Token> valueToken{};
+  std::vector<Scanner::Token> consumed;
 
   if (IsLiteral(compiler.current->GetType())) {
     valueToken = *compiler.current;
     Advance(compiler);    
+    consumed.push_back(*compiler.previous);
   } else {
     if (Match(Scanner::TokenType::Minus, compiler)) {
+      consumed.push_back(*compiler.previous);
       if (IsNumber(compiler.current->GetType())) {
         valueToken = *compiler.current;
         isNegativeNumber = true;
         Advance(compiler);
-      } else {
-        MessageAtCurrent(fmt::format("Cannot negate `{}`", compiler.current->GetType()), LogLevel::Error, compiler);
-        return;
+        consumed.push_back(*compiler.previous);
       }
     }
   }
 
+  // a lone literal is used as it is, anything else gets evaluated below
+  if (!Check(Scanner::TokenType::Semicolon, compiler)) {
+    Rewind(std::move(consumed), compiler);
+    valueToken.reset();
+  }
+
   auto fullFilePath = compiler.fullPath.string();
 
+  if (!valueToken) {
+    // anything other than a literal is compiled into a hidden function, which is ran now to give the value
+    // so only functions declared above the `const` can be called from it
+    auto exprToken = *compiler.current;
+    GRACE_MAYBE_UNUSED auto added = VM::VM::AddFunction("__CONST_" + constantName, 0, compiler.fileName, false, false);
+    GRACE_ASSERT(added, "Hidden function for `const` already exists");
+
+    compiler.codeContextStack.push_back(CodeContext::Function);
+    auto prevUsing = compiler.usingExpressionResult;
+    compiler.usingExpressionResult = true;
+    Expression(false, compiler);
+    compiler.usingExpressionResult = prevUsing;
+    compiler.codeContextStack.pop_back();
+    EmitOp(VM::Ops::Exit, compiler.previous->GetLine());
+
+    if (compiler.hadError) {
+      VM::VM::RemoveLastFunction();
+      return;
+    }
+
+    auto value = VM::VM::EvaluateConstant();
+    if (!value) {
+      Message(exprToken, fmt::format("Could not evaluate `const` `{}` while compiling", constantName), LogLevel::Error, compiler);
+      return;
+    }
+    s_FileConstantsLookup[fullFilePath][constantName] = {std::move(*value), isExport};
+
+    if (!Match(Scanner::TokenType::Semicolon, compiler)) {
+      MessageAtCurrent("Expected ';'", LogLevel::Error, compiler);
+    }
+    return;
+  }
+
   switch (valueToken->GetType()) {
     case Scanner::TokenType::True:
       s_FileConstantsLookup[fullFilePath][constantName] = {VM::Value(true), isExport};
@@ -1409,7 +1787,7 @@ static std::size_t GetEditDistance(const std::string& first, const std::string&
 // TODO: figure out what kind of range this thing produces and emit suggestions below a certain value
 // since right now if you only have 1 variable called "zebra" and you try and call on the value of "pancakes"
 // the compiler will eagerly ask you if you meant "zebra"
-static std::optional<std::string> FindMostSimilarVarName(const std::string& varName, const std::vector<Local>& localList)
+static std::optional<std::string> FindMostSimilarVarName(const std::string& varName, const LocalList& localList)
 {
   std::optional<std::string> res = std::nullopt;
   std::size_t current = std::numeric_limits<std::size_t>::max();
@@ -1539,21 +1917,22 @@ static void ForStatement(CompilerContext& compiler)
   auto iteratorNeedsPop = false, secondIteratorNeedsPop = false, twoIterators = false;
   auto iteratorName = compiler.previous->GetString();
   std::int64_t iteratorId;
+  auto iteratorAnnotation = StaticType::Unknown;
 
   if (Match(Scanner::TokenType::Colon, compiler)) {
     if (!IsValidTypeAnnotation(compiler.current->GetType())) {
       MessageAtCurrent("Expected typename after type annotation", LogLevel::Error, compiler);
       return;
     }
+    iteratorAnnotation = AnnotationType(compiler.current->GetType());
     Advance(compiler);
   }
 
-  auto it = std::find_if(
-    compiler.locals.begin(),
-    compiler.locals.end(),
-    [&iteratorName](const Local& l) {
-      return l.name == iteratorName;
-    });
+  // only iterators declared by this loop can be given a type, existing locals keep theirs
+  Local* newIterator = nullptr;
+  Local* newSecondIterator = nullptr;
+
+  auto it = compiler.locals.Find(iteratorName);
   if (it == compiler.locals.end()) {    
     if (CheckForDuplicateConstantName(iteratorName, compiler)) {
       MessageAtPrevious("A constant with the same name already exists", LogLevel::Error, compiler);
@@ -1561,7 +1940,8 @@ static void ForStatement(CompilerContext& compiler)
     }
 
     iteratorId = static_cast<std::int64_t>(compiler.locals.size());
-    compiler.locals.emplace_back(std::move(iteratorName), firstItIsFinal, true, iteratorId);
+    newIterator = &compiler.locals.emplace_back(std::move(iteratorName), firstItIsFinal, true, iteratorId);
+    newIterator->type = iteratorAnnotation;
     EmitOp(VM::Ops::DeclareLocal, compiler.previous->GetLine());
     iteratorNeedsPop = true;
   } else {
@@ -1600,18 +1980,15 @@ static void ForStatement(CompilerContext& compiler)
       return;
     }
     auto secondIteratorName = compiler.previous->GetString();
-    auto secondIt = std::find_if(
-      compiler.locals.begin(),
-      compiler.locals.end(),
-      [&secondIteratorName](const Local& l) {
-        return l.name == secondIteratorName;
-      });
+    auto secondIt = compiler.locals.Find(secondIteratorName);
+    auto secondIteratorAnnotation = StaticType::Unknown;
 
     if (Match(Scanner::TokenType::Colon, compiler)) {
       if (!IsValidTypeAnnotation(compiler.current->GetType())) {
         MessageAtCurrent("Expected typename after type annotation", LogLevel::Error, compiler);
         return;
       }
+      secondIteratorAnnotation = AnnotationType(compiler.current->GetType());
       Advance(compiler);
     }
 
@@ -1622,7 +1999,8 @@ static void ForStatement(CompilerContext& compiler)
       }
 
       secondIteratorId = static_cast<std::int64_t>(compiler.locals.size());
-      compiler.locals.emplace_back(std::move(secondIteratorName), secondItIsFinal, true, secondIteratorId);
+      newSecondIterator = &compiler.locals.emplace_back(std::move(secondIteratorName), secondItIsFinal, true, secondIteratorId);
+      newSecondIterator->type = secondIteratorAnnotation;
       auto line = compiler.previous->GetLine();
       EmitOp(VM::Ops::DeclareLocal, line);
       secondIteratorNeedsPop = true;
@@ -1661,6 +2039,20 @@ static void ForStatement(CompilerContext& compiler)
   Expression(false, compiler);
   compiler.usingExpressionResult = prevUsing;
 
+  // a final iterator over a range of Ints can't be anything but an Int
+  if (newIterator != nullptr && !twoIterators && firstItIsFinal && compiler.expressionType == StaticType::IntRange) {
+    if (iteratorAnnotation == StaticType::Unknown || iteratorAnnotation == StaticType::Int) {
+      newIterator->type = StaticType::Int;
+      iteratorAnnotation = StaticType::Unknown;
+    } else if (s_Verbose || s_WarningsError) {
+      MessageAtPrevious(fmt::format("'{}' is annotated as `{}` but is iterating over a range of `Int`", newIterator->name, StaticTypeName(iteratorAnnotation)), LogLevel::Warning, compiler);
+      if (s_WarningsError) {
+        return;
+      }
+    }
+  }
+  compiler.expressionType = StaticType::Unknown;
+
   Consume(Scanner::TokenType::Colon, "Expected ':' after `for` statement", compiler);
 
   line = compiler.previous->GetLine();
@@ -1683,6 +2075,15 @@ static void ForStatement(CompilerContext& compiler)
   EmitConstant(std::int64_t{});
   EmitOp(VM::Ops::JumpIfFalse, line);
 
+  if (s_CheckTypes) {
+    if (newIterator != nullptr && iteratorAnnotation != StaticType::Unknown) {
+      EmitLocalTypeCheck(*newIterator, line);
+    }
+    if (newSecondIterator != nullptr && newSecondIterator->type != StaticType::Unknown) {
+      EmitLocalTypeCheck(*newSecondIterator, line);
+    }
+  }
+
   // parse loop body
   while (!Match(Scanner::TokenType::End, compiler)) {
     Declaration(compiler);
@@ -1945,6 +2346,8 @@ static void ReturnStatement(CompilerContext& compiler)
     return;
   } 
 
+  auto returnToken = *compiler.previous;
+
   if (Match(Scanner::TokenType::Semicolon, compiler)) {
     auto line = compiler.previous->GetLine();
     EmitConstant(nullptr);
@@ -1953,6 +2356,10 @@ static void ReturnStatement(CompilerContext& compiler)
     return;
   }
 
+  if (!compiler.valueReturnToken) {
+    compiler.valueReturnToken = returnToken;
+  }
+
   auto prevUsing = compiler.usingExpressionResult;
   compiler.usingExpressionResult = true;
   Expression(false, compiler);
@@ -2025,7 +2432,7 @@ static void TryStatement(CompilerContext& compiler)
 
   auto exceptionVarName = compiler.previous->GetString();
   std::int64_t exceptionVarId;
-  auto it = std::find_if(compiler.locals.begin(), compiler.locals.end(), [&exceptionVarName](const Local& l) { return l.name == exceptionVarName; });
+  auto it = compiler.locals.Find(exceptionVarName);
   if (it == compiler.locals.end()) {
     if (CheckForDuplicateConstantName(exceptionVarName, compiler)) {
       MessageAtPrevious("A constant with the same name already exists", LogLevel::Error, compiler);
@@ -2101,6 +2508,35 @@ static void ThrowStatement(CompilerContext& compiler)
   Consume(Scanner::TokenType::Semicolon, "Expected ';' after `throw` statement", compiler);
 }
 
+static void YieldStatement(CompilerContext& compiler)
+{
+  if (std::find(compiler.codeContextStack.begin(), compiler.codeContextStack.end(), CodeContext::Function) == compiler.codeContextStack.end()) {
+    MessageAtPrevious("`yield` only allowed inside functions", LogLevel::Error, compiler);
+    return;
+  }
+
+  if (VM::VM::GetLastFunctionName() == "main") {
+    MessageAtPrevious("Cannot yield from main function", LogLevel::Error, compiler);
+    return;
+  }
+
+  // the VM only knows how to unwind a try block from the depth it was entered at, and a generator can be resumed from anywhere
+  if (std::find(compiler.codeContextStack.begin(), compiler.codeContextStack.end(), CodeContext::Try) != compiler.codeContextStack.end()) {
+    MessageAtPrevious("`yield` is not allowed inside a `try` block", LogLevel::Error, compiler);
+    return;
+  }
+
+  // calling the function now gives back a Generator instead of running it
+  VM::VM::MarkLastFunctionAsGenerator();
+
+  auto prevUsing = compiler.usingExpressionResult;
+  compiler.usingExpressionResult = true;
+  Expression(false, compiler);
+  compiler.usingExpressionResult = prevUsing;
+  EmitOp(VM::Ops::Yield, compiler.previous->GetLine());
+  Consume(Scanner::TokenType::Semicolon, "Expected ';' after `yield` statement", compiler);
+}
+
 static void WhileStatement(CompilerContext& compiler)
 {
   compiler.codeContextStack.emplace_back(CodeContext::WhileLoop);
@@ -2191,25 +2627,24 @@ static void WhileStatement(CompilerContext& compiler)
   compiler.codeContextStack.pop_back();
 }
 
-static bool IsCompoundAssignment(Scanner::TokenType token)
-{
-  static const std::vector<Scanner::TokenType> compoundAssignOps = {
-    Scanner::TokenType::PlusEquals,
-    Scanner::TokenType::MinusEquals,
-    Scanner::TokenType::StarEquals,
-    Scanner::TokenType::SlashEquals,
-    Scanner::TokenType::AmpersandEquals,
-    Scanner::TokenType::CaretEquals,
-    Scanner::TokenType::BarEquals,
-    Scanner::TokenType::ModEquals,
-    Scanner::TokenType::ShiftLeftEquals,
-    Scanner::TokenType::ShiftRightEquals,
-    Scanner::TokenType::StarStarEquals,
-  };
-
-  return std::any_of(compoundAssignOps.begin(), compoundAssignOps.end(), [token] (Scanner::TokenType toCheck) {
-    return toCheck == token;
-  });
+static constexpr bool IsCompoundAssignment(Scanner::TokenType type)
+{
+  switch (type) {
+    case Scanner::TokenType::PlusEquals:
+    case Scanner::TokenType::MinusEquals:
+    case Scanner::TokenType::StarEquals:
+    case Scanner::TokenType::SlashEquals:
+    case Scanner::TokenType::AmpersandEquals:
+    case Scanner::TokenType::CaretEquals:
+    case Scanner::TokenType::BarEquals:
+    case Scanner::TokenType::ModEquals:
+    case Scanner::TokenType::ShiftLeftEquals:
+    case Scanner::TokenType::ShiftRightEquals:
+    case Scanner::TokenType::StarStarEquals:
+      return true;
+    default:
+      return false;
+  }
 }
 
 static void Expression(bool canAssign, CompilerContext& compiler)
@@ -2240,7 +2675,7 @@ static void Expression(bool canAssign, CompilerContext& compiler)
       }
 
       auto localName = compiler.previous->GetString();
-      auto it = std::find_if(compiler.locals.begin(), compiler.locals.end(), [&localName](const Local& l) { return l.name == localName; });
+      auto it = compiler.locals.Find(localName);
       if (it == compiler.locals.end()) {
         auto mostSimilarVar = FindMostSimilarVarName(localName, compiler.locals);
         if (mostSimilarVar) {
@@ -2277,6 +2712,21 @@ static void Expression(bool canAssign, CompilerContext& compiler)
       Expression(false, compiler); // disallow x = y = z...
       compiler.usingExpressionResult = prevUsing;
 
+      auto rhsType = compiler.expressionType;
+      compiler.expressionType = StaticType::Unknown;
+
+      if (opToken == Scanner::TokenType::Equal && it->type != StaticType::Unknown && rhsType != it->type) {
+        if (rhsType != StaticType::Unknown && (s_Verbose || s_WarningsError)) {
+          MessageAtPrevious(fmt::format("'{}' is annotated as `{}` but is being given a value of type `{}`", it->name, StaticTypeName(it->type), StaticTypeName(rhsType)), LogLevel::Warning, compiler);
+          if (s_WarningsError) {
+            return;
+          }
+        }
+        if (s_CheckTypes) {
+          EmitTypeCheck(it->type, it->name, compiler.previous->GetLine());
+        }
+      }
+
       EmitConstant(it->index);
 
       switch (opToken) {
@@ -2315,6 +2765,10 @@ static void Expression(bool canAssign, CompilerContext& compiler)
           break;
         case Scanner::TokenType::StarStarEquals:
           EmitOp(VM::Ops::PowAssign, compiler.previous->GetLine());
+          // the other compound assignments keep the type of the local, but Int ** Float gives a Float
+          if (s_CheckTypes && it->type != StaticType::Unknown && BinaryResultType(VM::Ops::Pow, it->type, rhsType) != it->type) {
+            EmitLocalTypeCheck(*it, compiler.previous->GetLine());
+          }
           break;
         default:
           GRACE_UNREACHABLE();
@@ -2402,8 +2856,9 @@ static void Or(bool canAssign, bool skipFirst, CompilerContext& compiler)
     And(canAssign, false, compiler);
   }
   while (Match(Scanner::TokenType::Or, compiler)) {
+    auto lhsType = compiler.expressionType;
     And(canAssign, false, compiler);
-    EmitOp(VM::Ops::Or, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::Or, lhsType, compiler.current->GetLine(), compiler);
   }
 }
 
@@ -2413,8 +2868,9 @@ static void And(bool canAssign, bool skipFirst, CompilerContext& compiler)
     BitwiseOr(canAssign, false, compiler);
   }
   while (Match(Scanner::TokenType::And, compiler)) {
+    auto lhsType = compiler.expressionType;
     BitwiseOr(canAssign, false, compiler);
-    EmitOp(VM::Ops::And, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::And, lhsType, compiler.current->GetLine(), compiler);
   }
 }
 
@@ -2424,8 +2880,9 @@ static void BitwiseOr(bool canAssign, bool skipFirst, CompilerContext& compiler)
     BitwiseXOr(canAssign, false, compiler);
   }
   while (Match(Scanner::TokenType::Bar, compiler)) {
+    auto lhsType = compiler.expressionType;
     BitwiseXOr(canAssign, false, compiler);
-    EmitOp(VM::Ops::BitwiseOr, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::BitwiseOr, lhsType, compiler.current->GetLine(), compiler);
   }
 }
 
@@ -2435,8 +2892,9 @@ static void BitwiseXOr(bool canAssign, bool skipFirst, CompilerContext& compiler
     BitwiseAnd(canAssign, false, compiler);
   }
   while (Match(Scanner::TokenType::Caret, compiler)) {
+    auto lhsType = compiler.expressionType;
     BitwiseAnd(canAssign, false, compiler);
-    EmitOp(VM::Ops::BitwiseXOr, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::BitwiseXOr, lhsType, compiler.current->GetLine(), compiler);
   }
 }
 
@@ -2446,8 +2904,9 @@ static void BitwiseAnd(bool canAssign, bool skipFirst, CompilerContext& compiler
     Equality(canAssign, false, compiler);
   }
   while (Match(Scanner::TokenType::Ampersand, compiler)) {
+    auto lhsType = compiler.expressionType;
     Equality(canAssign, false, compiler);
-    EmitOp(VM::Ops::BitwiseAnd, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::BitwiseAnd, lhsType, compiler.current->GetLine(), compiler);
   }
 }
 
@@ -2456,12 +2915,13 @@ static void Equality(bool canAssign, bool skipFirst, CompilerContext& compiler)
   if (!skipFirst) {
     Comparison(canAssign, false, compiler);
   }
+  auto lhsType = compiler.expressionType;
   if (Match(Scanner::TokenType::EqualEqual, compiler)) {
     Comparison(canAssign, false, compiler);
-    EmitOp(VM::Ops::Equal, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::Equal, lhsType, compiler.current->GetLine(), compiler);
   } else if (Match(Scanner::TokenType::BangEqual, compiler)) {
     Comparison(canAssign, false, compiler);
-    EmitOp(VM::Ops::NotEqual, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::NotEqual, lhsType, compiler.current->GetLine(), compiler);
   }
 }
 
@@ -2470,18 +2930,19 @@ static void Comparison(bool canAssign, bool skipFirst, CompilerContext& compiler
   if (!skipFirst) {
     Shift(canAssign, false, compiler);
   }
+  auto lhsType = compiler.expressionType;
   if (Match(Scanner::TokenType::GreaterThan, compiler)) {
     Shift(canAssign, false, compiler);
-    EmitOp(VM::Ops::Greater, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::Greater, lhsType, compiler.current->GetLine(), compiler);
   } else if (Match(Scanner::TokenType::GreaterEqual, compiler)) {
     Shift(canAssign, false, compiler);
-    EmitOp(VM::Ops::GreaterEqual, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::GreaterEqual, lhsType, compiler.current->GetLine(), compiler);
   } else if (Match(Scanner::TokenType::LessThan, compiler)) {
     Shift(canAssign, false, compiler);
-    EmitOp(VM::Ops::Less, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::Less, lhsType, compiler.current->GetLine(), compiler);
   } else if (Match(Scanner::TokenType::LessEqual, compiler)) {
     Shift(canAssign, false, compiler);
-    EmitOp(VM::Ops::LessEqual, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::LessEqual, lhsType, compiler.current->GetLine(), compiler);
   }
 }
 
@@ -2490,12 +2951,13 @@ static void Shift(bool canAssign, bool skipFirst, CompilerContext& compiler)
   if (!skipFirst) {
     Term(canAssign, false, compiler);
   }
+  auto lhsType = compiler.expressionType;
   if (Match(Scanner::TokenType::ShiftRight, compiler)) {
     Term(canAssign, false, compiler);
-    EmitOp(VM::Ops::ShiftRight, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::ShiftRight, lhsType, compiler.current->GetLine(), compiler);
   } else if (Match(Scanner::TokenType::ShiftLeft, compiler)) {
     Term(canAssign, false, compiler);
-    EmitOp(VM::Ops::ShiftLeft, compiler.current->GetLine());
+    EmitBinaryOp(VM::Ops::ShiftLeft, lhsType, compiler.current->GetLine(), compiler);
   }
 }
 
@@ -2505,12 +2967,13 @@ static void Term(bool canAssign, bool skipFirst, CompilerContext& compiler)
     Factor(canAssign, false, compiler);
   }
   while (true) {
+    auto lhsType = compiler.expressionType;
     if (Match(Scanner::TokenType::Minus, compiler)) {
       Factor(canAssign, false, compiler);
-      EmitOp(VM::Ops::Subtract, compiler.current->GetLine());
+      EmitBinaryOp(VM::Ops::Subtract, lhsType, compiler.current->GetLine(), compiler);
     } else if (Match(Scanner::TokenType::Plus, compiler)) {
       Factor(canAssign, false, compiler);
-      EmitOp(VM::Ops::Add, compiler.current->GetLine());
+      EmitBinaryOp(VM::Ops::Add, lhsType, compiler.current->GetLine(), compiler);
     } else {
       break;
     }
@@ -2523,18 +2986,19 @@ static void Factor(bool canAssign, bool skipFirst, CompilerContext& compiler)
     Unary(canAssign, compiler);
   }
   while (true) {
+    auto lhsType = compiler.expressionType;
     if (Match(Scanner::TokenType::StarStar, compiler)) {
       Unary(canAssign, compiler);
-      EmitOp(VM::Ops::Pow, compiler.current->GetLine());
+      EmitBinaryOp(VM::Ops::Pow, lhsType, compiler.current->GetLine(), compiler);
     } else if (Match(Scanner::TokenType::Star, compiler)) {
       Unary(canAssign, compiler);
-      EmitOp(VM::Ops::Multiply, compiler.current->GetLine());
+      EmitBinaryOp(VM::Ops::Multiply, lhsType, compiler.current->GetLine(), compiler);
     } else if (Match(Scanner::TokenType::Slash, compiler)) {
       Unary(canAssign, compiler);
-      EmitOp(VM::Ops::Divide, compiler.current->GetLine());
+      EmitBinaryOp(VM::Ops::Divide, lhsType, compiler.current->GetLine(), compiler);
     } else if (Match(Scanner::TokenType::Mod, compiler)) {
       Unary(canAssign, compiler);
-      EmitOp(VM::Ops::Mod, compiler.current->GetLine());
+      EmitBinaryOp(VM::Ops::Mod, lhsType, compiler.current->GetLine(), compiler);
     } else {
       break;
     }
@@ -2547,14 +3011,21 @@ static void Unary(bool canAssign, CompilerContext& compiler)
     auto line = compiler.previous->GetLine();
     Unary(canAssign, compiler);
     EmitOp(VM::Ops::Not, line);
+    compiler.expressionType = StaticType::Bool;
   } else if (Match(Scanner::TokenType::Minus, compiler)) {
     auto line = compiler.previous->GetLine();
     Unary(canAssign, compiler);
     EmitOp(VM::Ops::Negate, line);
+    if (compiler.expressionType != StaticType::Int && compiler.expressionType != StaticType::Float) {
+      compiler.expressionType = StaticType::Unknown;
+    }
   } else if (Match(Scanner::TokenType::Tilde, compiler)) {
     auto line = compiler.previous->GetLine();
     Unary(canAssign, compiler);
     EmitOp(VM::Ops::BitwiseNot, line);
+    if (compiler.expressionType != StaticType::Int) {
+      compiler.expressionType = StaticType::Unknown;
+    }
   } else {
     Call(canAssign, compiler);
   }
@@ -2567,12 +3038,17 @@ static void Call(bool canAssign, CompilerContext& compiler)
 
 static void Primary(bool canAssign, CompilerContext& compiler)
 {
+  // anything that doesn't say otherwise leaves a value we know nothing about
+  compiler.expressionType = StaticType::Unknown;
+
   if (Match(Scanner::TokenType::True, compiler)) {
     EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
     EmitConstant(true);
+    compiler.expressionType = StaticType::Bool;
   } else if (Match(Scanner::TokenType::False, compiler)) {
     EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
     EmitConstant(false);
+    compiler.expressionType = StaticType::Bool;
   } else if (Match(Scanner::TokenType::This, compiler)) {
     // TODO: this 
   } else if (Match(Scanner::TokenType::Integer, compiler)) {
@@ -2584,6 +3060,7 @@ static void Primary(bool canAssign, CompilerContext& compiler)
     }
     EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
     EmitConstant(value);
+    compiler.expressionType = StaticType::Int;
   } else if (Match(Scanner::TokenType::HexLiteral, compiler)) {
     std::int64_t value;
     auto result = TryParseInt(*compiler.previous, value, 16, 2);
@@ -2593,6 +3070,7 @@ static void Primary(bool canAssign, CompilerContext& compiler)
     }
     EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
     EmitConstant(value);
+    compiler.expressionType = StaticType::Int;
   } else if (Match(Scanner::TokenType::BinaryLiteral, compiler)) {
     std::int64_t value;
     auto result = TryParseInt(*compiler.previous, value, 2, 2);
@@ -2602,6 +3080,7 @@ static void Primary(bool canAssign, CompilerContext& compiler)
     }
     EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
     EmitConstant(value);
+    compiler.expressionType = StaticType::Int;
   } else if (Match(Scanner::TokenType::Double, compiler)) {
     double value;
     auto result = TryParseDouble(*compiler.previous, value);
@@ -2611,8 +3090,11 @@ static void Primary(bool canAssign, CompilerContext& compiler)
     }
     EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
     EmitConstant(value);
+    compiler.expressionType = StaticType::Float;
   } else if (Match(Scanner::TokenType::String, compiler)) {
     String(compiler);
+  } else if (Match(Scanner::TokenType::InterpolatedString, compiler)) {
+    InterpolatedString(compiler);
   } else if (Match(Scanner::TokenType::Char, compiler)) {
     Char(compiler);
   } else if (Match(Scanner::TokenType::Identifier, compiler)) {
@@ -2620,6 +3102,7 @@ static void Primary(bool canAssign, CompilerContext& compiler)
   } else if (Match(Scanner::TokenType::Null, compiler)) {
     EmitConstant(nullptr);
     EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
+    compiler.expressionType = StaticType::Null;
   } else if (Match(Scanner::TokenType::LeftParen, compiler)) {
     Expression(canAssign, compiler);
     Consume(Scanner::TokenType::RightParen, "Expected ')'", compiler);
@@ -2635,9 +3118,13 @@ static void Primary(bool canAssign, CompilerContext& compiler)
     Dictionary(compiler);
   } else if (Match(Scanner::TokenType::Typename, compiler)) {
     Typename(compiler);
-  } else {
-    // Unreachable?
+  } else if (std::string kw; IsOperator(compiler.current->GetType()) || IsKeyword(compiler.current->GetType(), kw)) {
+    // Expression() reports these and skips over them
     Expression(canAssign, compiler);
+  } else {
+    // nothing here can start an expression, so going back into Expression() would never move past it
+    MessageAtCurrent("Expected identifier or literal at start of expression", LogLevel::Error, compiler);
+    return;
   }
 
   if (Match(Scanner::TokenType::Dot, compiler)) {
@@ -2649,11 +3136,16 @@ static void Primary(bool canAssign, CompilerContext& compiler)
 
 static void Subscript(bool canAssign, CompilerContext& compiler)
 {
+  auto containerType = compiler.expressionType;
+
   auto prevUsing = compiler.usingExpressionResult;
   compiler.usingExpressionResult = true;
   Expression(false, compiler);
   compiler.usingExpressionResult = prevUsing;
 
+  auto subscriptType = compiler.expressionType;
+  compiler.expressionType = StaticType::Unknown;
+
   if (!Match(Scanner::TokenType::RightSquareParen, compiler)) {
     MessageAtCurrent("Expected ']' after subscript expression", LogLevel::Error, compiler);
     return;
@@ -2671,6 +3163,9 @@ static void Subscript(bool canAssign, CompilerContext& compiler)
     compiler.usingExpressionResult = prevUsing;
 
     EmitOp(VM::Ops::AssignSubscript, compiler.previous->GetLine());
+    compiler.expressionType = StaticType::Unknown;
+  } else if (containerType == StaticType::List && subscriptType == StaticType::Int) {
+    EmitOp(VM::Ops::GetSubscriptList, compiler.previous->GetLine());
   } else {
     EmitOp(VM::Ops::GetSubscript, compiler.previous->GetLine());
   }
@@ -2733,6 +3228,8 @@ static void Dot(bool canAssign, CompilerContext& compiler)
       break;
     }
   }
+
+  compiler.expressionType = StaticType::Unknown;
 }
 
 static bool ParseCallParameters(CompilerContext& compiler, int64_t& numArgs)
@@ -2771,6 +3268,7 @@ static void DotFunctionCall(const Scanner::Token& funcNameToken, CompilerContext
   EmitConstant(static_cast<std::int64_t>(hasher(funcName)));
   EmitConstant(numArgs);
   EmitOp(VM::Ops::MemberCall, funcNameToken.GetLine());
+  compiler.expressionType = StaticType::Unknown;
 
   if (Check(Scanner::TokenType::Semicolon, compiler) && !compiler.usingExpressionResult) {
     // pop unused return value
@@ -2825,6 +3323,7 @@ static void FreeFunctionCall(const Scanner::Token& funcNameToken, CompilerContex
     EmitConstant(funcNameText);
     EmitOp(VM::Ops::Call, compiler.previous->GetLine());
   }
+  compiler.expressionType = StaticType::Unknown;
 
   if (Check(Scanner::TokenType::Semicolon, compiler) && !compiler.usingExpressionResult) {
     // pop unused return value
@@ -2874,14 +3373,17 @@ static void Identifier(bool canAssign, CompilerContext& compiler)
     // if it's not a reassignment, we are trying to load its value
     // Primary() has already but the variable's id on the stack
     if (!Check(Scanner::TokenType::Equal, compiler) && !IsCompoundAssignment(compiler.current->GetType())) {
-      auto localIt = std::find_if(compiler.locals.begin(), compiler.locals.end(), [&prevText](const Local& l){ return l.name == prevText; });
+      auto localIt = compiler.locals.Find(prevText);
       if (localIt == compiler.locals.end()) {
         // now check for constants...
         auto constantIt = s_FileConstantsLookup[compiler.fullPath.string()].find(prevText);
 
         if (constantIt == s_FileConstantsLookup[compiler.fullPath.string()].end()) {
           // might be in a namespace...
-          auto importPath = (compiler.parentPath / (compiler.currentNamespaceLookup + ".gr")).string();
+          auto importPathIt = compiler.importedFilePaths.find(compiler.currentNamespaceLookup);
+          auto importPath = importPathIt == compiler.importedFilePaths.end()
+            ? (compiler.parentPath / (compiler.currentNamespaceLookup + ".gr")).string()
+            : importPathIt->second;
           auto importedConstantIt = s_FileConstantsLookup[importPath].find(prevText);
 
           if (importedConstantIt == s_FileConstantsLookup[importPath].end()) {
@@ -2900,14 +3402,17 @@ static void Identifier(bool canAssign, CompilerContext& compiler)
             compiler.namespaceQualifierUsed = true;
             EmitConstant(importedConstantIt->second.value);
             EmitOp(VM::Ops::LoadConstant, prev.GetLine());
+            compiler.expressionType = ValueType(importedConstantIt->second.value);
           }
         } else {
           EmitConstant(constantIt->second.value);
           EmitOp(VM::Ops::LoadConstant, prev.GetLine());
+          compiler.expressionType = ValueType(constantIt->second.value);
         }
       } else {
         EmitConstant(localIt->index);
         EmitOp(VM::Ops::LoadLocal, prev.GetLine());
+        compiler.expressionType = localIt->type;
       }
     }
   }
@@ -2923,6 +3428,7 @@ static void Char(CompilerContext& compiler)
   }
   EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
   EmitConstant(res);  
+  compiler.expressionType = StaticType::Char;
 }
 
 static void String(CompilerContext& compiler)
@@ -2935,6 +3441,145 @@ static void String(CompilerContext& compiler)
   }
   EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
   EmitConstant(res);
+  compiler.expressionType = StaticType::String;
+}
+
+// the index of the '}' that closes the expression starting at `start`, skipping over any Strings inside it
+static std::size_t FindInterpolationEnd(std::string_view text, std::size_t start)
+{
+  std::size_t depth = 0;
+  auto inNestedString = false;
+  for (auto i = start; i < text.length(); i++) {
+    if (text[i] == '"' && (i == 0 || text[i - 1] != '\\')) {
+      inNestedString = !inNestedString;
+    } else if (!inNestedString) {
+      if (text[i] == '{') {
+        depth++;
+      } else if (text[i] == '}') {
+        if (depth == 0) {
+          return i;
+        }
+        depth--;
+      }
+    }
+  }
+
+  return std::string_view::npos;
+}
+
+// compiles an expression from inside an interpolated string by giving the compiler a scanner over just that expression
+// `code` runs one character past the closing '}', since the scanner treats the last character as the end of the code,
+// so the '}' ends the expression the same way it would end a Dictionary
+static void InterpolatedExpression(std::string_view code, std::size_t line, std::size_t column, CompilerContext& compiler)
+{
+  auto current = std::move(compiler.current);
+  auto previous = std::move(compiler.previous);
+  auto rewoundTokens = std::move(compiler.rewoundTokens);
+  compiler.rewoundTokens.clear();
+
+  Scanner::InitScanner(code, line, column);
+  Advance(compiler);
+
+  auto prevUsing = compiler.usingExpressionResult;
+  compiler.usingExpressionResult = true;
+  Expression(false, compiler);
+  compiler.usingExpressionResult = prevUsing;
+
+  if (!Check(Scanner::TokenType::RightCurlyParen, compiler)) {
+    MessageAtCurrent("Expected '}' after expression in interpolated string", LogLevel::Error, compiler);
+  }
+
+  Scanner::PopScanner();
+  compiler.current = std::move(current);
+  compiler.previous = std::move(previous);
+  compiler.rewoundTokens = std::move(rewoundTokens);
+}
+
+// f"..." pushes each piece of text and each expression in turn, then a single Interpolate op joins them all
+static void InterpolatedString(CompilerContext& compiler)
+{
+  const auto token = *compiler.previous;
+  auto text = token.GetText();
+
+  // without the f" and the closing "
+  auto body = text.substr(2, text.length() - 3);
+  const auto startLine = token.GetLine() - static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+  const auto startColumn = token.GetColumn() - token.GetLength() + 2;
+  auto line = startLine;
+
+  std::string literal;
+  std::int64_t numParts = 0, numExpressions = 0;
+
+  auto emitLiteral = [&] {
+    if (!literal.empty()) {
+      EmitOp(VM::Ops::LoadConstant, token.GetLine());
+      EmitConstant(literal);
+      literal.clear();
+      numParts++;
+    }
+  };
+
+  std::size_t lineStart = 0;
+  for (std::size_t i = 0; i < body.length(); i++) {
+    auto c = body[i];
+    if ((c == '{' || c == '}') && i + 1 < body.length() && body[i + 1] == c) {
+      literal.push_back(c);
+      i++;
+    } else if (c == '}') {
+      Message(token, "Single '}' in interpolated string, use '}}' for a literal brace", LogLevel::Error, compiler);
+      return;
+    } else if (c == '\\') {
+      char escaped;
+      if (i + 1 == body.length() || !IsEscapeChar(body[i + 1], escaped)) {
+        Message(token, "Unrecognised escape character in interpolated string", LogLevel::Error, compiler);
+        return;
+      }
+      literal.push_back(escaped);
+      i++;
+    } else if (c == '{') {
+      auto end = FindInterpolationEnd(body, i + 1);
+      if (end == std::string_view::npos) {
+        Message(token, "Expected '}' after expression in interpolated string", LogLevel::Error, compiler);
+        return;
+      }
+
+      auto expression = body.substr(i + 1, end - i);
+      if (expression.find_first_not_of(" \t\r\n}") == std::string_view::npos) {
+        Message(token, "Expected expression inside '{}' in interpolated string", LogLevel::Error, compiler);
+        return;
+      }
+
+      emitLiteral();
+      // columns in the scanner count from 1
+      auto expressionColumn = (line == startLine ? startColumn : 0) + (i + 1 - lineStart) + 1;
+      // the body is always followed by the closing '"' of the token, so there is a character to spare
+      InterpolatedExpression(std::string_view(expression.data(), expression.length() + 1), line, expressionColumn, compiler);
+      if (compiler.hadError) {
+        return;
+      }
+      numParts++;
+      numExpressions++;
+      i = end;
+    } else {
+      if (c == '\n') {
+        line++;
+        lineStart = i + 1;
+      }
+      literal.push_back(c);
+    }
+  }
+
+  emitLiteral();
+
+  if (numParts == 0) {
+    EmitOp(VM::Ops::LoadConstant, token.GetLine());
+    EmitConstant(std::string());
+  } else if (numExpressions != 0) {
+    EmitOp(VM::Ops::Interpolate, token.GetLine());
+    EmitConstant(numParts);
+  }
+
+  compiler.expressionType = StaticType::String;
 }
 
 static void InstanceOf(CompilerContext& compiler)
@@ -2998,6 +3643,7 @@ static void InstanceOf(CompilerContext& compiler)
   }
 
   EmitOp(VM::Ops::CheckType, compiler.current->GetLine());
+  compiler.expressionType = StaticType::Bool;
 
   Advance(compiler);  // Consume the type ident
   Consume(Scanner::TokenType::RightParen, "Expected ')'", compiler);
@@ -3018,6 +3664,7 @@ static void IsObject(CompilerContext& compiler)
   compiler.usingExpressionResult = prevUsing;
 
   EmitOp(VM::Ops::IsObject, compiler.previous->GetLine());
+  compiler.expressionType = StaticType::Bool;
   Consume(Scanner::TokenType::RightParen, "Expected ')' after expression", compiler);
 
   if (Check(Scanner::TokenType::Semicolon, compiler) && !compiler.usingExpressionResult) {
@@ -3147,6 +3794,8 @@ static void Cast(CompilerContext& compiler)
     EmitOp(VM::Ops::CreateSet, compiler.previous.value().GetLine());
   }
 
+  compiler.expressionType = isList ? StaticType::List : AnnotationType(typeToken.GetType());
+
   if (Check(Scanner::TokenType::Semicolon, compiler) && !compiler.usingExpressionResult) {
     // pop unused return value
     EmitOp(VM::Ops::Pop, compiler.previous->GetLine());
@@ -3155,7 +3804,7 @@ static void Cast(CompilerContext& compiler)
 
 static void List(CompilerContext& compiler)
 {
-  bool singleItemParsed = false, parsedRangeExpression = false;
+  bool singleItemParsed = false, parsedRangeExpression = false, intRange = false;
   std::int64_t numItems = 0;
 
   while (true) {
@@ -3168,24 +3817,35 @@ static void List(CompilerContext& compiler)
     Expression(false, compiler);
     compiler.usingExpressionResult = prevUsing;
 
+    // the item may not have moved past anything, so carrying on could loop forever
+    if (compiler.hadError) {
+      return;
+    }
+
     if (Match(Scanner::TokenType::DotDot, compiler)){
       if (singleItemParsed) {
         MessageAtPrevious("Cannot mix single items and range expressions in list declaration", LogLevel::Error, compiler);
         return;
       }
 
+      intRange = compiler.expressionType == StaticType::Int;
+
       // max
       prevUsing = compiler.usingExpressionResult;
       compiler.usingExpressionResult = true;
       Expression(false, compiler);
       compiler.usingExpressionResult = prevUsing;
 
+      intRange = intRange && compiler.expressionType == StaticType::Int;
+
       // check for custom increment
       if (Match(Scanner::TokenType::By, compiler)) {
         prevUsing = compiler.usingExpressionResult;
         compiler.usingExpressionResult = true;
         Expression(false, compiler);
         compiler.usingExpressionResult = prevUsing;
+
+        intRange = intRange && compiler.expressionType == StaticType::Int;
       } else {
         EmitConstant(std::int64_t{1});
         EmitOp(VM::Ops::LoadConstant, compiler.previous->GetLine());
@@ -3224,6 +3884,13 @@ static void List(CompilerContext& compiler)
     EmitConstant(numItems);
     EmitOp(VM::Ops::CreateList, line);
   }
+
+  // a range is its own object type, but we know its items are Ints if min, max and increment are
+  if (parsedRangeExpression) {
+    compiler.expressionType = intRange ? StaticType::IntRange : StaticType::Unknown;
+  } else {
+    compiler.expressionType = StaticType::List;
+  }
 }
 
 static void Dictionary(CompilerContext& compiler)
@@ -3247,6 +3914,10 @@ static void Dictionary(CompilerContext& compiler)
 
     Expression(false, compiler);
 
+    if (compiler.hadError) {
+      return;
+    }
+
     numItems++;
 
     if (Match(Scanner::TokenType::RightCurlyParen, compiler)) {
@@ -3260,6 +3931,7 @@ static void Dictionary(CompilerContext& compiler)
 
   EmitConstant(numItems);
   EmitOp(VM::Ops::CreateDictionary, compiler.previous->GetLine());
+  compiler.expressionType = StaticType::Dict;
 }
 
 static void Typename(CompilerContext& compiler)
@@ -3270,6 +3942,7 @@ static void Typename(CompilerContext& compiler)
   Expression(false, compiler);
   compiler.usingExpressionResult = prevUsing;
   EmitOp(VM::Ops::Typename, compiler.previous->GetLine());
+  compiler.expressionType = StaticType::String;
   Consume(Scanner::TokenType::RightParen, "Expected ')'", compiler);
 }
 
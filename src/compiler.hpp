@@ -27,8 +27,29 @@ namespace Grace::Compiler
    *  @param code             The code to be compiled.
    *  @param verbose          Verbose mode (display compilation time and compiler warnings).
    *  @param warningsError    Display compiler warnings, warnings result in errors
+   *  @param checkTypes       Check type annotations at runtime wherever the compiler can't prove them
+   *  @param optimisation     Which bytecode optimisation passes to run before executing
    */
-  GRACE_NODISCARD VM::InterpretResult Compile(const std::string& fileName, bool verbose, bool warningsError, const std::vector<std::string>& args);
+  GRACE_NODISCARD VM::InterpretResult Compile(const std::string& fileName, bool verbose, bool warningsError, bool checkTypes, VM::OptimisationLevel optimisation, const std::vector<std::string>& args);
+
+  /*
+   *  Compiles a program without running it, so a host can run its exported functions with VM::StartTask().
+   *  The file still needs a `main` function, which is never called.
+   *
+   *  @param fileName         Name of the file to be read
+   *  @param verbose          Verbose mode (display compilation time and compiler warnings).
+   *  @param warningsError    Display compiler warnings, warnings result in errors
+   *  @param checkTypes       Check type annotations at runtime wherever the compiler can't prove them
+   *  @param optimisation     Which bytecode optimisation passes to run
+   */
+  GRACE_NODISCARD bool Load(const std::string& fileName, bool verbose, bool warningsError, bool checkTypes, VM::OptimisationLevel optimisation);
+
+  /*
+   *  Runs the Scanner over a file without compiling it and prints token throughput, used for benchmarking.
+   *
+   *  @param fileName         Name of the file to be scanned
+   */
+  GRACE_NODISCARD VM::InterpretResult Scan(const std::string& fileName);
 } // namespace Grace::Compiler
 
 #endif  // ifndef GRACE_COMPILER_HPP
@@ -0,0 +1,229 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the CsvReader class.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <charconv>
+
+#include <fmt/format.h>
+
+#include "csv_reader.hpp"
+#include "objects/grace_dictionary.hpp"
+#include "objects/grace_exception.hpp"
+#include "objects/grace_file.hpp"
+#include "objects/grace_list.hpp"
+
+using namespace Grace::VM;
+
+namespace Grace
+{
+  // starts out assuming every field is an Int, and falls back to Float then String as fields come in that aren't
+  class CsvReader::Column
+  {
+    public:
+
+      void Add(std::string_view field)
+      {
+        if (m_Kind == Kind::String) {
+          m_Values.emplace_back(std::string(field));
+          return;
+        }
+
+        m_Raw.append(field);
+        m_RawEnds.push_back(m_Raw.size());
+
+        if (field.empty()) {
+          m_Values.emplace_back();
+          return;
+        }
+
+        // from_chars would take "inf" and "nan", which are much more likely to be words than numbers in a CSV
+        auto first = field.front();
+        if (!(first >= '0' && first <= '9') && first != '-' && first != '.') {
+          BecomeStrings();
+          return;
+        }
+
+        auto begin = field.data();
+        auto end = field.data() + field.size();
+
+        if (m_Kind == Kind::Int) {
+          std::int64_t value{};
+          auto [intEnd, intError] = std::from_chars(begin, end, value);
+          if (intError == std::errc() && intEnd == end) {
+            m_Values.emplace_back(value);
+            return;
+          }
+
+          m_Kind = Kind::Float;
+          for (auto& previous : m_Values) {
+            if (previous.GetType() == Value::Type::Int) {
+              previous = Value(static_cast<double>(previous.Get<std::int64_t>()));
+            }
+          }
+        }
+
+        double value{};
+        auto [doubleEnd, doubleError] = std::from_chars(begin, end, value);
+        if (doubleError == std::errc() && doubleEnd == end) {
+          m_Values.emplace_back(value);
+        } else {
+          BecomeStrings();
+        }
+      }
+
+      GRACE_NODISCARD Value TakeList()
+      {
+        return Value::CreateObject<GraceList>(std::move(m_Values));
+      }
+
+    private:
+
+      // the raw text is still there for every field so far, including the one that turned out not to be a number
+      void BecomeStrings()
+      {
+        m_Kind = Kind::String;
+        m_Values.clear();
+
+        std::size_t start = 0;
+        for (auto end : m_RawEnds) {
+          m_Values.emplace_back(m_Raw.substr(start, end - start));
+          start = end;
+        }
+
+        m_Raw = std::string();
+        m_RawEnds = std::vector<std::size_t>();
+      }
+
+      enum class Kind
+      {
+        Int, Float, String,
+      };
+
+      Kind m_Kind = Kind::Int;
+      std::vector<Value> m_Values;
+
+      // kept while the column still looks numeric, in case a later field means it has to be Strings after all
+      std::string m_Raw;
+      std::vector<std::size_t> m_RawEnds;
+  };
+
+  CsvReader::CsvReader(const Value& file, char delimiter, char quote)
+    : m_File(file), m_Delimiter(delimiter), m_Quote(quote)
+  {
+
+  }
+
+  bool CsvReader::ReadRecord()
+  {
+    auto file = m_File.GetObject()->GetAsFile();
+
+    do {
+      if (!file->ReadLine(m_Line)) {
+        return false;
+      }
+      m_LineNumber++;
+    } while (m_Line.empty());
+
+    m_RecordLine = m_LineNumber;
+
+    while (!SplitRecord()) {
+      if (!file->ReadLine(m_NextLine)) {
+        throw GraceException(
+          GraceException::Type::ParseFailed,
+          fmt::format("The quoted field in the record on line {} is never closed", m_RecordLine)
+        );
+      }
+      m_LineNumber++;
+
+      m_Line.push_back('\n');
+      m_Line.append(m_NextLine);
+    }
+
+    return true;
+  }
+
+  Value CsvReader::ReadColumns()
+  {
+    auto result = Value::CreateObject<GraceDictionary>();
+    if (!ReadRecord()) {
+      return result;
+    }
+
+    std::vector<std::string> names;
+    names.reserve(FieldCount());
+    for (std::size_t i = 0; i < FieldCount(); i++) {
+      names.emplace_back(Field(i));
+    }
+
+    std::vector<Column> columns(names.size());
+    while (ReadRecord()) {
+      if (FieldCount() != columns.size()) {
+        throw GraceException(
+          GraceException::Type::ParseFailed,
+          fmt::format("The record on line {} has {} fields but the header has {}", m_RecordLine, FieldCount(), columns.size())
+        );
+      }
+
+      for (std::size_t i = 0; i < columns.size(); i++) {
+        columns[i].Add(Field(i));
+      }
+    }
+
+    auto dict = result.GetObject()->GetAsDictionary();
+    for (std::size_t i = 0; i < columns.size(); i++) {
+      dict->Insert(Value(names[i]), columns[i].TakeList());
+    }
+
+    return result;
+  }
+
+  bool CsvReader::SplitRecord()
+  {
+    m_Fields.clear();
+    m_FieldEnds.clear();
+
+    std::string_view text(m_Line);
+    std::size_t current = 0;
+
+    while (true) {
+      if (current < text.size() && text[current] == m_Quote) {
+        current++;
+        while (true) {
+          auto closingQuote = text.find(m_Quote, current);
+          if (closingQuote == std::string_view::npos) {
+            return false;
+          }
+
+          m_Fields.append(text.substr(current, closingQuote - current));
+          current = closingQuote + 1;
+
+          // a doubled quote inside quotes is a literal quote
+          if (current < text.size() && text[current] == m_Quote) {
+            m_Fields.push_back(m_Quote);
+            current++;
+            continue;
+          }
+          break;
+        }
+        // anything between the closing quote and the delimiter is kept as it is
+      }
+
+      auto delimiter = text.find(m_Delimiter, current);
+      auto fieldEnd = delimiter == std::string_view::npos ? text.size() : delimiter;
+      m_Fields.append(text.substr(current, fieldEnd - current));
+      m_FieldEnds.push_back(m_Fields.size());
+
+      if (delimiter == std::string_view::npos) {
+        return true;
+      }
+      current = delimiter + 1;
+    }
+  }
+} // namespace Grace
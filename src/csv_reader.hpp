@@ -0,0 +1,79 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the CsvReader class, which streams records out of a delimited text file
+ *  one at a time, reusing the same buffers for every record.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_CSV_READER_HPP
+#define GRACE_CSV_READER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "grace.hpp"
+#include "value.hpp"
+
+namespace Grace
+{
+  class CsvReader
+  {
+    public:
+
+      // `file` must hold a GraceFile, which is kept alive for as long as the reader is
+      CsvReader(const VM::Value& file, char delimiter, char quote);
+
+      // moves on to the next record, returning false at the end of the file
+      // blank lines are skipped, and a quoted field can run over several lines
+      bool ReadRecord();
+
+      GRACE_NODISCARD GRACE_INLINE std::size_t FieldCount() const
+      {
+        return m_FieldEnds.size();
+      }
+
+      // only valid until the next call to ReadRecord()
+      GRACE_NODISCARD GRACE_INLINE std::string_view Field(std::size_t index) const
+      {
+        auto start = index == 0 ? 0 : m_FieldEnds[index - 1];
+        return std::string_view(m_Fields).substr(start, m_FieldEnds[index] - start);
+      }
+
+      // the line the current record started on, counting from 1
+      GRACE_NODISCARD GRACE_INLINE std::size_t LineNumber() const
+      {
+        return m_RecordLine;
+      }
+
+      // reads every remaining record into a Dict of the header's names to Lists of that column
+      // columns where every field is a number are parsed straight into Ints or Floats, empty fields in them are null
+      GRACE_NODISCARD VM::Value ReadColumns();
+
+    private:
+
+      class Column;
+
+      // returns false if the record ends inside a quoted field, so needs the next line
+      bool SplitRecord();
+
+      VM::Value m_File;
+      char m_Delimiter, m_Quote;
+
+      std::string m_Line;
+      std::string m_NextLine;
+      std::size_t m_LineNumber = 0, m_RecordLine = 0;
+
+      // every field of the current record back to back, with quotes removed
+      std::string m_Fields;
+      std::vector<std::size_t> m_FieldEnds;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_CSV_READER_HPP
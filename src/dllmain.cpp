@@ -9,7 +9,14 @@
  *  For licensing information, see grace.hpp
  */
 
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
 #include "dllmain.hpp"
+#include "objects/grace_exception.hpp"
 
 #ifdef GRACE_MSC
 
@@ -28,30 +35,79 @@ BOOL APIENTRY DllMain(GRACE_MAYBE_UNUSED HMODULE hModule, DWORD ul_reason_for_ca
 
 #endif
 
+struct InterpreterOptions
+{
+  bool verbose = false, warningsError = false, checkTypes = false;
+  Grace::VM::OptimisationLevel optimisation = Grace::VM::OptimisationLevel::O1;
+};
+
+static InterpreterOptions ParseInterpreterArgs(int interpreterArgc, const char* interpreterArgv[])
+{
+  InterpreterOptions options;
+  for (auto i = 0; i < interpreterArgc; i++) {
+    std::string arg(interpreterArgv[i]);
+    if (arg == "--verbose" || arg == "-v") {
+      options.verbose = true;
+    }
+    if (arg == "--warnings-error" || arg == "-we") {
+      options.warningsError = true;
+    }
+    if (arg == "--check-types") {
+      options.checkTypes = true;
+    }
+    if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+      options.optimisation = static_cast<Grace::VM::OptimisationLevel>(arg[2] - '0');
+    }
+  }
+  return options;
+}
+
 extern "C"
 {
   EXPORT Grace::VM::InterpretResult RunFile(const char* filePath, int interpreterArgc, const char* interpreterArgv[], int graceArgc, const char* graceArgv[])
   {
-    std::vector<std::string> interpreterArgs, graceArgs;
-    
-    for (auto i = 0; i < interpreterArgc; i++) {
-      interpreterArgs.push_back(interpreterArgv[i]);
-    }
-
+    std::vector<std::string> graceArgs;
     for (auto i = 0; i < graceArgc; i++) {
       graceArgs.push_back(graceArgv[i]);
     }
 
-    bool verbose = false, warningsError = false;
-    for (const auto& arg : interpreterArgs) {
-      if (arg == "--verbose" || arg == "-v") {
-        verbose = true;
-      }
-      if (arg == "--warnings-error" || arg == "-we") {
-        warningsError = true;
-      }
+    auto [verbose, warningsError, checkTypes, optimisation] = ParseInterpreterArgs(interpreterArgc, interpreterArgv);
+    return Grace::Compiler::Compile(filePath, verbose, warningsError, checkTypes, optimisation, graceArgs);
+  }
+
+  EXPORT bool LoadFile(const char* filePath, int interpreterArgc, const char* interpreterArgv[])
+  {
+    auto [verbose, warningsError, checkTypes, optimisation] = ParseInterpreterArgs(interpreterArgc, interpreterArgv);
+    return Grace::Compiler::Load(filePath, verbose, warningsError, checkTypes, optimisation);
+  }
+
+  EXPORT Grace::VM::VM::Task* StartTask(const char* functionName, int argc, const char* argv[])
+  {
+    std::vector<Grace::VM::Value> args;
+    for (auto i = 0; i < argc; i++) {
+      args.emplace_back(std::string(argv[i]));
+    }
+
+    try {
+      return Grace::VM::VM::StartTask(functionName, std::move(args)).release();
+    } catch (const Grace::GraceException& e) {
+      fmt::print(stderr, "{}\n", e.ToString());
+      return nullptr;
     }
+  }
 
-    return Grace::Compiler::Compile(filePath, verbose, warningsError, graceArgs);
+  EXPORT Grace::VM::InterpretResult ResumeTask(Grace::VM::VM::Task* task, std::uint64_t ops, std::uint64_t microseconds)
+  {
+    try {
+      return Grace::VM::VM::Resume(*task, { ops, std::chrono::microseconds(microseconds) });
+    } catch (const Grace::GraceException& e) {
+      fmt::print(stderr, "{}\n", e.ToString());
+      return Grace::VM::InterpretResult::RuntimeError;
+    }
+  }
+
+  EXPORT void FreeTask(Grace::VM::VM::Task* task)
+  {
+    delete task;
   }
 }
\ No newline at end of file
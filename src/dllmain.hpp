@@ -12,6 +12,8 @@
 #ifndef GRACE_DLLMAIN_HPP
 #define GRACE_DLLMAIN_HPP
 
+#include <cstdint>
+
 #include "grace.hpp"
 #include "compiler.hpp"
 
@@ -26,6 +28,20 @@
 extern "C"
 {
   EXPORT Grace::VM::InterpretResult RunFile(const char* filePath, int interpreterArgc, const char* interpreterArgv[], int graceArgc, const char* graceArgv[]);
+
+  // Tasks are pinned to the thread that started them. Everything a script makes lives on that thread's heap,
+  // so a Task can't be handed to another thread once it has started, not even while it's suspended.
+  // A host sharing scripts between a pool of threads calls LoadFile once, then gives each thread its own Tasks.
+
+  // compiles the file without running its main function, so its exported functions can be started as Tasks
+  EXPORT bool LoadFile(const char* filePath, int interpreterArgc, const char* interpreterArgv[]);
+  // starts a Task that calls the exported function with the given Strings as its arguments, or gives back null if there isn't one
+  EXPORT Grace::VM::VM::Task* StartTask(const char* functionName, int argc, const char* argv[]);
+  // runs the Task for up to `ops` ops and `microseconds`, where 0 is no limit, giving back Suspended if it hasn't finished yet
+  // gives back RuntimeError without running anything if called on a thread other than the one that started the Task
+  EXPORT Grace::VM::InterpretResult ResumeTask(Grace::VM::VM::Task* task, std::uint64_t ops, std::uint64_t microseconds);
+  // must be called on the thread that started the Task, since it frees the Task's Values from that thread's heap
+  EXPORT void FreeTask(Grace::VM::VM::Task* task);
 }
 
 #endif	// ifndef GRACE_DLLMAIN_HPP
\ No newline at end of file
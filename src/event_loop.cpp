@@ -0,0 +1,645 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the EventLoop.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifdef __linux__
+# include <fcntl.h>
+# include <signal.h>
+# include <spawn.h>
+# include <sys/epoll.h>
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include <sys/wait.h>
+# include <ucontext.h>
+# include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "event_loop.hpp"
+#include "objects/grace_exception.hpp"
+
+#ifdef __linux__
+extern char** environ;
+#endif
+
+namespace Grace::EventLoop
+{
+#ifdef __linux__
+  struct Fiber
+  {
+    ucontext_t context{};
+    std::function<void()> body;
+    // nullptr for the thread's own stack
+    char* stack = nullptr;
+    std::exception_ptr error;
+    // the fibers waiting in Join() for this one
+    std::vector<Fiber*> joiners;
+    // the file descriptor this is waiting on in epoll, if any
+    int waitingOn = -1;
+    bool woken = false, finished = false;
+  };
+
+  struct Timer
+  {
+    std::chrono::steady_clock::time_point deadline;
+    // timers with the same deadline go off in the order they were made, so sleeping for 0 takes turns fairly
+    std::uint64_t order;
+    Fiber* fiber;
+
+    bool operator>(const Timer& other) const
+    {
+      return std::tie(deadline, order) > std::tie(other.deadline, other.order);
+    }
+  };
+
+  // the same as a thread's stack, so anything that recurses fine on the main thread does in a fiber too
+  // only the pages a fiber actually touches are committed, so most of this is just address space
+  static constexpr std::size_t s_StackSize = 8 * 1024 * 1024;
+  // a reused stack keeps this much of its top committed, past that a fiber that went deep gives the memory back
+  static constexpr std::size_t s_KeptStackSize = 256 * 1024;
+  // stacks of finished fibers kept around for new ones, since mapping one is a few syscalls
+  static constexpr std::size_t s_MaxFreeStacks = 64;
+  static constexpr int s_MaxEvents = 64;
+
+  struct Scheduler
+  {
+    Fiber root;
+    Fiber* current = &root;
+    std::deque<Fiber*> ready;
+    // keeps every fiber that hasn't finished alive, whether or not anything else still has a handle to it
+    std::unordered_map<Fiber*, FiberHandle> alive;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers;
+    std::uint64_t nextTimerOrder = 0;
+    int epollFd = -1;
+    std::size_t waitingOnFds = 0;
+    std::vector<char*> freeStacks;
+
+    ~Scheduler()
+    {
+      // a fiber still alive now is stuck waiting on another, so its stack goes without being unwound
+      for (auto& [fiber, handle] : alive) {
+        munmap(fiber->stack, s_StackSize);
+      }
+      for (auto stack : freeStacks) {
+        munmap(stack, s_StackSize);
+      }
+      if (epollFd != -1) {
+        close(epollFd);
+      }
+    }
+  };
+
+  static thread_local Scheduler s_Scheduler;
+
+  static int EpollFd()
+  {
+    auto& scheduler = s_Scheduler;
+    if (scheduler.epollFd == -1) {
+      scheduler.epollFd = epoll_create1(EPOLL_CLOEXEC);
+      if (scheduler.epollFd == -1) {
+        throw GraceException(GraceException::Type::FiberFailed, fmt::format("Failed to create the event loop: {}", std::strerror(errno)));
+      }
+    }
+    return scheduler.epollFd;
+  }
+
+  // writing to a pipe that nothing reads from any more should fail, rather than kill the whole program
+  static void IgnoreBrokenPipes()
+  {
+    static std::once_flag once;
+    std::call_once(once, [] { signal(SIGPIPE, SIG_IGN); });
+  }
+
+  static char* AllocateStack()
+  {
+    auto& scheduler = s_Scheduler;
+    if (!scheduler.freeStacks.empty()) {
+      auto stack = scheduler.freeStacks.back();
+      scheduler.freeStacks.pop_back();
+      return stack;
+    }
+
+    auto memory = mmap(nullptr, s_StackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (memory == MAP_FAILED) {
+      throw GraceException(GraceException::Type::FiberFailed, fmt::format("Failed to allocate a stack for a new Fiber: {}", std::strerror(errno)));
+    }
+
+    // the stack grows down, so running off the end of it hits this page and crashes instead of overwriting something else
+    mprotect(memory, static_cast<std::size_t>(sysconf(_SC_PAGESIZE)), PROT_NONE);
+    return static_cast<char*>(memory);
+  }
+
+  static void ReleaseStack(char* stack)
+  {
+    auto& scheduler = s_Scheduler;
+    if (scheduler.freeStacks.size() < s_MaxFreeStacks) {
+      // the guard page stays as it is, this only drops the pages below the part most fibers use
+      auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+      madvise(stack + pageSize, s_StackSize - s_KeptStackSize - pageSize, MADV_DONTNEED);
+      scheduler.freeStacks.push_back(stack);
+    } else {
+      munmap(stack, s_StackSize);
+    }
+  }
+
+  static void Wake(Fiber* fiber)
+  {
+    auto& scheduler = s_Scheduler;
+    fiber->woken = true;
+    if (fiber != &scheduler.root) {
+      scheduler.ready.push_back(fiber);
+    }
+  }
+
+  static void FiberEntry()
+  {
+    auto& scheduler = s_Scheduler;
+    auto fiber = scheduler.current;
+
+    try {
+      fiber->body();
+    } catch (...) {
+      fiber->error = std::current_exception();
+    }
+
+    // anything body was holding on to is let go while its stack is still around
+    fiber->body = nullptr;
+    fiber->finished = true;
+    for (auto joiner : fiber->joiners) {
+      Wake(joiner);
+    }
+    fiber->joiners.clear();
+
+    // the loop releases this stack once it's back on its own, so this never returns
+    setcontext(&scheduler.root.context);
+  }
+
+  // gives every ready fiber a turn, then waits for the next timer or file descriptor
+  // gives back false if nothing was ready and nothing is left that could wake anything
+  static bool RunOnce()
+  {
+    auto& scheduler = s_Scheduler;
+
+    // fibers woken during this pass wait for the next one, so one that keeps sleeping for 0 can't starve the thread
+    auto turns = scheduler.ready.size();
+    for (std::size_t i = 0; i < turns; i++) {
+      auto fiber = scheduler.ready.front();
+      scheduler.ready.pop_front();
+
+      scheduler.current = fiber;
+      swapcontext(&scheduler.root.context, &fiber->context);
+      scheduler.current = &scheduler.root;
+
+      if (fiber->finished) {
+        ReleaseStack(fiber->stack);
+        fiber->stack = nullptr;
+        scheduler.alive.erase(fiber);
+      }
+    }
+
+    if (scheduler.root.woken) {
+      return true;
+    }
+
+    int timeout;
+    if (!scheduler.ready.empty()) {
+      timeout = 0;
+    } else if (!scheduler.timers.empty()) {
+      auto remaining = scheduler.timers.top().deadline - std::chrono::steady_clock::now();
+      auto milliseconds = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+      timeout = static_cast<int>(std::clamp<std::int64_t>(milliseconds, 0, INT_MAX));
+    } else if (scheduler.waitingOnFds > 0) {
+      timeout = -1;
+    } else {
+      return turns > 0;
+    }
+
+    epoll_event events[s_MaxEvents];
+    auto count = epoll_wait(EpollFd(), events, s_MaxEvents, timeout);
+    if (count == -1 && errno != EINTR) {
+      throw GraceException(GraceException::Type::FiberFailed, fmt::format("Failed to wait for events: {}", std::strerror(errno)));
+    }
+
+    for (int i = 0; i < count; i++) {
+      auto fiber = static_cast<Fiber*>(events[i].data.ptr);
+      epoll_ctl(EpollFd(), EPOLL_CTL_DEL, fiber->waitingOn, nullptr);
+      fiber->waitingOn = -1;
+      scheduler.waitingOnFds--;
+      Wake(fiber);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    while (!scheduler.timers.empty() && scheduler.timers.top().deadline <= now) {
+      Wake(scheduler.timers.top().fiber);
+      scheduler.timers.pop();
+    }
+
+    return true;
+  }
+
+  // gives up the current fiber's turn until something wakes it
+  // on the thread's own stack, this is where the other fibers get to run
+  static void Block()
+  {
+    auto& scheduler = s_Scheduler;
+    auto fiber = scheduler.current;
+
+    if (fiber != &scheduler.root) {
+      swapcontext(&fiber->context, &scheduler.root.context);
+    } else {
+      while (!scheduler.root.woken) {
+        if (!RunOnce()) {
+          // only a Join() can be left, so nothing should wake the thread later on when it's waiting for something else
+          for (auto& [other, handle] : scheduler.alive) {
+            std::erase(other->joiners, &scheduler.root);
+          }
+          throw GraceException(GraceException::Type::FiberFailed, "Every Fiber is waiting on another one to finish, so none of them can");
+        }
+      }
+    }
+
+    fiber->woken = false;
+  }
+
+  static void WaitFor(int fd, std::uint32_t events)
+  {
+    auto& scheduler = s_Scheduler;
+
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = scheduler.current;
+    if (epoll_ctl(EpollFd(), EPOLL_CTL_ADD, fd, &event) == -1) {
+      // epoll doesn't take regular files, since reading from and writing to them never has to wait
+      if (errno == EPERM) {
+        return;
+      }
+      if (errno == EEXIST) {
+        throw GraceException(GraceException::Type::FiberFailed, "Another Fiber is already waiting on the same file");
+      }
+      throw GraceException(GraceException::Type::FiberFailed, fmt::format("Failed to wait on a file: {}", std::strerror(errno)));
+    }
+
+    scheduler.current->waitingOn = fd;
+    scheduler.waitingOnFds++;
+    Block();
+  }
+
+  bool InFiber()
+  {
+    return s_Scheduler.current != &s_Scheduler.root;
+  }
+
+  FiberHandle Spawn(std::function<void()>&& body)
+  {
+    auto& scheduler = s_Scheduler;
+
+    auto fiber = std::make_shared<Fiber>();
+    fiber->body = std::move(body);
+    fiber->stack = AllocateStack();
+
+    getcontext(&fiber->context);
+    fiber->context.uc_stack.ss_sp = fiber->stack;
+    fiber->context.uc_stack.ss_size = s_StackSize;
+    fiber->context.uc_link = nullptr;
+    makecontext(&fiber->context, FiberEntry, 0);
+
+    scheduler.alive.emplace(fiber.get(), fiber);
+    Wake(fiber.get());
+    return fiber;
+  }
+
+  bool IsFinished(const FiberHandle& fiber)
+  {
+    return fiber->finished;
+  }
+
+  void Join(const FiberHandle& fiber)
+  {
+    auto& scheduler = s_Scheduler;
+    if (fiber.get() == scheduler.current) {
+      throw GraceException(GraceException::Type::FiberFailed, "A Fiber can't join itself");
+    }
+
+    if (!fiber->finished) {
+      fiber->joiners.push_back(scheduler.current);
+      Block();
+    }
+
+    if (fiber->error) {
+      std::rethrow_exception(fiber->error);
+    }
+  }
+
+  void Sleep(std::chrono::nanoseconds duration)
+  {
+    auto& scheduler = s_Scheduler;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration);
+    scheduler.timers.push({ deadline, scheduler.nextTimerOrder++, scheduler.current });
+    Block();
+  }
+
+  void Drain()
+  {
+    auto& scheduler = s_Scheduler;
+    if (scheduler.current != &scheduler.root) {
+      return;
+    }
+
+    while (!scheduler.alive.empty() && RunOnce()) {
+
+    }
+  }
+
+  int Open(const std::string& path, std::string_view mode)
+  {
+    auto flags = O_NONBLOCK | O_CLOEXEC;
+    if (mode == "r") {
+      flags |= O_RDONLY;
+    } else if (mode == "w") {
+      flags |= O_WRONLY | O_CREAT | O_TRUNC;
+    } else if (mode == "a") {
+      flags |= O_WRONLY | O_CREAT | O_APPEND;
+    } else {
+      throw GraceException(
+        GraceException::Type::InvalidArgument,
+        fmt::format("Invalid mode '{}' for `std::fiber::open(path, mode)`, expected one of 'r', 'w' or 'a'", mode)
+      );
+    }
+
+    auto fd = open(path.c_str(), flags, 0666);
+    if (fd == -1) {
+      throw GraceException(
+        mode == "r" ? GraceException::Type::FileReadFailed : GraceException::Type::FileWriteFailed,
+        fmt::format("Failed to open file '{}': {}", path, std::strerror(errno))
+      );
+    }
+
+    IgnoreBrokenPipes();
+    return fd;
+  }
+
+  std::pair<int, int> Pipe()
+  {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) == -1) {
+      throw GraceException(GraceException::Type::FileWriteFailed, fmt::format("Failed to create a pipe: {}", std::strerror(errno)));
+    }
+
+    IgnoreBrokenPipes();
+    return { fds[0], fds[1] };
+  }
+
+  std::size_t Read(int fd, char* buffer, std::size_t count)
+  {
+    while (true) {
+      auto result = read(fd, buffer, count);
+      if (result >= 0) {
+        return static_cast<std::size_t>(result);
+      }
+
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        WaitFor(fd, EPOLLIN);
+      } else if (errno != EINTR) {
+        throw GraceException(GraceException::Type::FileReadFailed, fmt::format("Failed to read: {}", std::strerror(errno)));
+      }
+    }
+  }
+
+  void Write(int fd, std::string_view text)
+  {
+    while (!text.empty()) {
+      auto result = write(fd, text.data(), text.size());
+      if (result >= 0) {
+        text.remove_prefix(static_cast<std::size_t>(result));
+        continue;
+      }
+
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        WaitFor(fd, EPOLLOUT);
+      } else if (errno != EINTR) {
+        throw GraceException(GraceException::Type::FileWriteFailed, fmt::format("Failed to write: {}", std::strerror(errno)));
+      }
+    }
+  }
+
+  void Close(int fd)
+  {
+    close(fd);
+  }
+
+  ChildProcess StartProcess(const std::string& command, bool pipeInput, bool pipeOutput)
+  {
+    IgnoreBrokenPipes();
+
+    // the child's ends stay blocking, since it doesn't know it's talking to a fiber
+    int inputPipe[2] = { -1, -1 }, outputPipe[2] = { -1, -1 };
+    if (pipeInput && pipe2(inputPipe, O_CLOEXEC) == -1) {
+      throw GraceException(GraceException::Type::ProcessFailed, fmt::format("Failed to create a pipe for `{}`: {}", command, std::strerror(errno)));
+    }
+    if (pipeOutput && pipe2(outputPipe, O_CLOEXEC) == -1) {
+      auto error = errno;
+      if (pipeInput) {
+        close(inputPipe[0]);
+        close(inputPipe[1]);
+      }
+      throw GraceException(GraceException::Type::ProcessFailed, fmt::format("Failed to create a pipe for `{}`: {}", command, std::strerror(error)));
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (pipeInput) {
+      posix_spawn_file_actions_adddup2(&actions, inputPipe[0], STDIN_FILENO);
+    }
+    if (pipeOutput) {
+      posix_spawn_file_actions_adddup2(&actions, outputPipe[1], STDOUT_FILENO);
+    }
+
+    // SIGPIPE is ignored here, which the child would inherit
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &defaults);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF);
+
+    const char* argv[] = { "sh", "-c", command.c_str(), nullptr };
+    pid_t pid;
+    auto result = posix_spawn(&pid, "/bin/sh", &actions, &attributes, const_cast<char* const*>(argv), environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+
+    if (pipeInput) {
+      close(inputPipe[0]);
+    }
+    if (pipeOutput) {
+      close(outputPipe[1]);
+    }
+
+    if (result != 0) {
+      if (pipeInput) {
+        close(inputPipe[1]);
+      }
+      if (pipeOutput) {
+        close(outputPipe[0]);
+      }
+      throw GraceException(GraceException::Type::ProcessFailed, fmt::format("Failed to start `{}`: {}", command, std::strerror(result)));
+    }
+
+    ChildProcess child;
+    child.pid = pid;
+    if (pipeInput) {
+      child.input = inputPipe[1];
+      fcntl(child.input, F_SETFL, fcntl(child.input, F_GETFL) | O_NONBLOCK);
+    }
+    if (pipeOutput) {
+      child.output = outputPipe[0];
+      fcntl(child.output, F_SETFL, fcntl(child.output, F_GETFL) | O_NONBLOCK);
+    }
+    return child;
+  }
+
+  int WaitForProcess(int pid)
+  {
+    int status = 0;
+    pid_t result;
+
+#ifdef SYS_pidfd_open
+    // readable once the child has exited
+    auto pidFd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+    if (pidFd != -1) {
+      try {
+        WaitFor(pidFd, EPOLLIN);
+      } catch (...) {
+        close(pidFd);
+        throw;
+      }
+      close(pidFd);
+
+      do {
+        result = waitpid(pid, &status, 0);
+      } while (result == -1 && errno == EINTR);
+    } else
+#endif
+    {
+      // kernels before 5.3 can't give back a file descriptor for a process, so it's checked on every turn instead
+      while ((result = waitpid(pid, &status, WNOHANG)) == 0) {
+        Sleep(std::chrono::milliseconds(1));
+      }
+    }
+
+    if (result == -1) {
+      throw GraceException(GraceException::Type::ProcessFailed, fmt::format("Failed to wait for process {}: {}", pid, std::strerror(errno)));
+    }
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+  }
+
+  void ForgetProcess(int pid)
+  {
+    waitpid(pid, nullptr, WNOHANG);
+  }
+#else
+  struct Fiber
+  {
+
+  };
+
+  [[noreturn]] static void ThrowUnsupported()
+  {
+    throw GraceException(GraceException::Type::FiberFailed, "Fibers need epoll, which is only available on Linux");
+  }
+
+  bool InFiber()
+  {
+    return false;
+  }
+
+  FiberHandle Spawn(GRACE_MAYBE_UNUSED std::function<void()>&& body)
+  {
+    ThrowUnsupported();
+  }
+
+  bool IsFinished(GRACE_MAYBE_UNUSED const FiberHandle& fiber)
+  {
+    ThrowUnsupported();
+  }
+
+  void Join(GRACE_MAYBE_UNUSED const FiberHandle& fiber)
+  {
+    ThrowUnsupported();
+  }
+
+  void Sleep(GRACE_MAYBE_UNUSED std::chrono::nanoseconds duration)
+  {
+    ThrowUnsupported();
+  }
+
+  void Drain()
+  {
+
+  }
+
+  int Open(GRACE_MAYBE_UNUSED const std::string& path, GRACE_MAYBE_UNUSED std::string_view mode)
+  {
+    ThrowUnsupported();
+  }
+
+  std::pair<int, int> Pipe()
+  {
+    ThrowUnsupported();
+  }
+
+  std::size_t Read(GRACE_MAYBE_UNUSED int fd, GRACE_MAYBE_UNUSED char* buffer, GRACE_MAYBE_UNUSED std::size_t count)
+  {
+    ThrowUnsupported();
+  }
+
+  void Write(GRACE_MAYBE_UNUSED int fd, GRACE_MAYBE_UNUSED std::string_view text)
+  {
+    ThrowUnsupported();
+  }
+
+  void Close(GRACE_MAYBE_UNUSED int fd)
+  {
+    ThrowUnsupported();
+  }
+
+  ChildProcess StartProcess(GRACE_MAYBE_UNUSED const std::string& command, GRACE_MAYBE_UNUSED bool pipeInput, GRACE_MAYBE_UNUSED bool pipeOutput)
+  {
+    ThrowUnsupported();
+  }
+
+  int WaitForProcess(GRACE_MAYBE_UNUSED int pid)
+  {
+    ThrowUnsupported();
+  }
+
+  void ForgetProcess(GRACE_MAYBE_UNUSED int pid)
+  {
+    ThrowUnsupported();
+  }
+#endif
+} // namespace Grace::EventLoop
@@ -0,0 +1,78 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the EventLoop, which runs fibers on the thread that spawned them
+ *  and suspends them while they wait on timers, file descriptors and child processes.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_EVENT_LOOP_HPP
+#define GRACE_EVENT_LOOP_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "grace.hpp"
+
+namespace Grace
+{
+  // Every fiber has its own stack but shares its thread, and so its heap, with the thread's other fibers.
+  // Only one of them runs at a time, and it keeps running until it waits on something in here. The thread's own stack
+  // runs the loop whenever it waits, running every fiber that is ready and then waiting on epoll for the rest.
+  // Fibers need epoll, so everything besides InFiber() and Drain() throws on platforms other than Linux.
+  namespace EventLoop
+  {
+    struct Fiber;
+    using FiberHandle = std::shared_ptr<Fiber>;
+
+    // whether the calling code is running on a fiber, rather than the thread's own stack
+    GRACE_NODISCARD bool InFiber();
+
+    // body starts the next time whatever is running waits, anything it throws is rethrown by Join()
+    GRACE_NODISCARD FiberHandle Spawn(std::function<void()>&& body);
+    GRACE_NODISCARD bool IsFinished(const FiberHandle& fiber);
+    // lets other fibers run until this one has finished, throws if nothing is left that could finish it
+    void Join(const FiberHandle& fiber);
+    // lets other fibers run until at least `duration` has passed, 0 gives every other ready fiber one turn first
+    void Sleep(std::chrono::nanoseconds duration);
+    // runs the thread's fibers until they have all finished, or are all waiting on each other
+    // does nothing when called from a fiber, since only the thread's own stack can wait for the rest
+    void Drain();
+
+    // the file descriptors given back are non-blocking and closed in child processes
+    // mode is 'r', 'w' or 'a'
+    GRACE_NODISCARD int Open(const std::string& path, std::string_view mode);
+    // { read end, write end }
+    GRACE_NODISCARD std::pair<int, int> Pipe();
+    // up to `count` bytes, waiting for at least one if there isn't any yet, and 0 at the end of the file
+    GRACE_NODISCARD std::size_t Read(int fd, char* buffer, std::size_t count);
+    // waits for all of `text` to be written
+    void Write(int fd, std::string_view text);
+    void Close(int fd);
+
+    struct ChildProcess
+    {
+      int pid = -1;
+      // the write end of the child's stdin and the read end of its stdout, or -1 if it uses the parent's
+      int input = -1, output = -1;
+    };
+
+    // runs `command` through the shell
+    GRACE_NODISCARD ChildProcess StartProcess(const std::string& command, bool pipeInput, bool pipeOutput);
+    // lets other fibers run until the child has exited, giving back its exit code, or 128 + the signal that stopped it
+    GRACE_NODISCARD int WaitForProcess(int pid);
+    // for a child nothing will wait on, cleans it up if it has already exited
+    void ForgetProcess(int pid);
+  } // namespace EventLoop
+} // namespace Grace
+
+#endif  // ifndef GRACE_EVENT_LOOP_HPP
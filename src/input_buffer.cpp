@@ -0,0 +1,210 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the InputBuffer class.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifdef GRACE_MSC
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include "input_buffer.hpp"
+#include "output_buffer.hpp"
+#include "objects/grace_exception.hpp"
+
+static bool IsSpace(char c)
+{
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+namespace Grace
+{
+  InputBuffer::InputBuffer(std::FILE* stream, std::size_t capacity, bool partial)
+    : m_Stream(stream), m_Capacity(capacity), m_Partial(partial)
+  {
+
+  }
+
+  std::optional<std::string> InputBuffer::ReadLine()
+  {
+    std::string line;
+    if (!ReadLine(line)) {
+      return std::nullopt;
+    }
+    return line;
+  }
+
+  bool InputBuffer::ReadLine(std::string& line)
+  {
+    std::lock_guard lock(m_Mutex);
+    line.clear();
+    auto found = false;
+    while (m_Start != m_End || Fill()) {
+      auto start = m_Buffer.data() + m_Start;
+      auto available = m_End - m_Start;
+      auto newLine = static_cast<const char*>(std::memchr(start, '\n', available));
+      if (newLine == nullptr) {
+        line.append(start, available);
+        m_Start = m_End;
+        found = true;
+        continue;
+      }
+
+      line.append(start, static_cast<std::size_t>(newLine - start));
+      m_Start += static_cast<std::size_t>(newLine - start) + 1;
+      found = true;
+      break;
+    }
+
+    if (!found) {
+      return false;
+    }
+
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    return true;
+  }
+
+  std::string InputBuffer::Read(std::size_t count)
+  {
+    std::lock_guard lock(m_Mutex);
+    std::string result;
+    result.reserve(std::min(count, m_Capacity));
+    while (result.size() < count && (m_Start != m_End || Fill())) {
+      auto toCopy = std::min(count - result.size(), m_End - m_Start);
+      result.append(m_Buffer.data() + m_Start, toCopy);
+      m_Start += toCopy;
+    }
+    return result;
+  }
+
+  std::string InputBuffer::ReadAll()
+  {
+    std::lock_guard lock(m_Mutex);
+    std::string result;
+    while (m_Start != m_End || Fill()) {
+      result.append(m_Buffer.data() + m_Start, m_End - m_Start);
+      m_Start = m_End;
+    }
+    return result;
+  }
+
+  std::optional<std::int64_t> InputBuffer::ReadInt()
+  {
+    std::lock_guard lock(m_Mutex);
+    while (true) {
+      while (m_Start != m_End && IsSpace(m_Buffer[m_Start])) {
+        m_Start++;
+      }
+      if (m_Start != m_End) {
+        break;
+      }
+      if (!Fill()) {
+        return std::nullopt;
+      }
+    }
+
+    // the number might run off the end of what has been read so far
+    auto tokenEnd = m_Start;
+    while (true) {
+      while (tokenEnd != m_End && !IsSpace(m_Buffer[tokenEnd])) {
+        tokenEnd++;
+      }
+      if (tokenEnd != m_End) {
+        break;
+      }
+
+      // Fill() moves the unconsumed bytes to the front even when there is nothing more to read
+      auto consumed = m_Start;
+      auto filled = Fill();
+      tokenEnd -= consumed;
+      if (!filled) {
+        break;
+      }
+    }
+
+    auto first = m_Buffer.data() + m_Start;
+    auto last = m_Buffer.data() + tokenEnd;
+    // from_chars doesn't accept a leading '+'
+    auto digits = *first == '+' && last - first > 1 ? first + 1 : first;
+
+    std::int64_t value{};
+    auto [end, error] = std::from_chars(digits, last, value);
+    if (error != std::errc() || end != last) {
+      throw GraceException(
+        GraceException::Type::InvalidArgument,
+        fmt::format("Expected an `Int` but found '{}'", std::string_view(first, static_cast<std::size_t>(last - first)))
+      );
+    }
+
+    m_Start = tokenEnd;
+    return value;
+  }
+
+  std::size_t InputBuffer::Discard()
+  {
+    std::lock_guard lock(m_Mutex);
+    auto unread = m_End - m_Start;
+    m_Start = m_End = 0;
+    return unread;
+  }
+
+  bool InputBuffer::Fill()
+  {
+    if (m_Buffer.empty()) {
+      m_Buffer.resize(m_Capacity);
+    }
+
+    if (m_Start != 0) {
+      std::memmove(m_Buffer.data(), m_Buffer.data() + m_Start, m_End - m_Start);
+      m_End -= m_Start;
+      m_Start = 0;
+    }
+
+    auto space = m_Buffer.size() - m_End;
+    if (space == 0) {
+      // only a single token longer than the whole buffer could get here
+      m_Buffer.resize(m_Buffer.size() * 2);
+      space = m_Buffer.size() - m_End;
+    }
+
+    std::size_t count;
+    if (m_Partial) {
+      // this could wait on the user, so they need to see everything printed so far, like a prompt
+      OutputBuffer::FlushAll();
+#ifdef GRACE_MSC
+      auto result = _read(_fileno(m_Stream), m_Buffer.data() + m_End, static_cast<unsigned int>(space));
+#else
+      auto result = read(fileno(m_Stream), m_Buffer.data() + m_End, space);
+#endif
+      m_Error = result < 0;
+      count = result < 0 ? 0 : static_cast<std::size_t>(result);
+    } else {
+      count = std::fread(m_Buffer.data() + m_End, 1, space, m_Stream);
+      m_Error = count == 0 && std::ferror(m_Stream);
+    }
+
+    m_End += count;
+    return count != 0;
+  }
+
+  InputBuffer& InputBuffer::Stdin()
+  {
+    static InputBuffer buffer(stdin, 1024 * 1024, true);
+    return buffer;
+  }
+} // namespace Grace
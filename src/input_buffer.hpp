@@ -0,0 +1,82 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the InputBuffer class, which reads a stream in large blocks
+ *  so lines and numbers can be pulled out of memory rather than a character at a time.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_INPUT_BUFFER_HPP
+#define GRACE_INPUT_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "grace.hpp"
+
+namespace Grace
+{
+  class InputBuffer
+  {
+    public:
+
+      static constexpr std::size_t s_DefaultCapacity = 64 * 1024;
+
+      // a partial stream hands over whatever it has instead of waiting to fill the buffer,
+      // so a line typed into a terminal or written down a pipe comes through straight away
+      InputBuffer(std::FILE* stream, std::size_t capacity = s_DefaultCapacity, bool partial = false);
+
+      InputBuffer(const InputBuffer&) = delete;
+      InputBuffer& operator=(const InputBuffer&) = delete;
+
+      // the next line without its line ending, or nothing at the end of the stream
+      GRACE_NODISCARD std::optional<std::string> ReadLine();
+      // reads into `line`, reusing its storage, and returns false at the end of the stream
+      bool ReadLine(std::string& line);
+      // up to `count` bytes, fewer only at the end of the stream
+      GRACE_NODISCARD std::string Read(std::size_t count);
+      GRACE_NODISCARD std::string ReadAll();
+      // skips whitespace and parses the next integer, or nothing at the end of the stream
+      // throws if the next thing in the stream isn't an integer
+      GRACE_NODISCARD std::optional<std::int64_t> ReadInt();
+
+      // throws away anything read ahead of the caller, returning how much that was
+      std::size_t Discard();
+
+      GRACE_NODISCARD GRACE_INLINE bool HasError() const
+      {
+        return m_Error;
+      }
+
+      // 1 MiB and partial, so pipelines aren't held back by the size of the buffer or by waiting to fill it
+      // shared by every thread, each read takes the buffer's lock so threads get whole lines and tokens
+      GRACE_NODISCARD static InputBuffer& Stdin();
+
+    private:
+
+      // keeps anything not yet consumed, moved to the front, and reads more after it
+      bool Fill();
+
+      std::FILE* m_Stream;
+      std::size_t m_Capacity;
+      bool m_Partial;
+      bool m_Error = false;
+
+      // not allocated until the first read, most files opened for writing never need it
+      std::vector<char> m_Buffer;
+      std::size_t m_Start = 0, m_End = 0;
+
+      std::mutex m_Mutex;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_INPUT_BUFFER_HPP
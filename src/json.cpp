@@ -0,0 +1,632 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the JSON parser and serialiser.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "json.hpp"
+#include "word_at_a_time.hpp"
+#include "objects/grace_dictionary.hpp"
+#include "objects/grace_bytes.hpp"
+#include "objects/grace_exception.hpp"
+#include "objects/grace_instance.hpp"
+#include "objects/grace_keyvaluepair.hpp"
+#include "objects/grace_list.hpp"
+#include "objects/grace_set.hpp"
+#include "objects/object_tracker.hpp"
+
+using namespace Grace::VM;
+using namespace Grace::WordAtATime;
+
+// deep enough for any real document, shallow enough that the recursion can't run out of stack
+static constexpr std::size_t s_MaxDepth = 512;
+
+// the bytes a JSON string can't hold as they are, everything else is copied 8 bytes at a time
+static constexpr std::uint64_t MatchStringSpecials(std::uint64_t word)
+{
+  return BytesInRange(word, '"', '"') | BytesInRange(word, '\\', '\\') | BytesInRange(word, 0x00, 0x1F);
+}
+
+static constexpr std::uint64_t MatchStringPlain(std::uint64_t word)
+{
+  return ~MatchStringSpecials(word) & Broadcast(0x80);
+}
+
+static bool IsStringPlain(char c)
+{
+  return c != '"' && c != '\\' && static_cast<std::uint8_t>(c) >= 0x20;
+}
+
+static constexpr std::uint64_t MatchWhitespace(std::uint64_t word)
+{
+  return BytesInRange(word, ' ', ' ') | BytesInRange(word, '\t', '\n') | BytesInRange(word, '\r', '\r');
+}
+
+static bool IsWhitespace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static void AppendUtf8(std::string& result, std::uint32_t codePoint)
+{
+  if (codePoint < 0x80) {
+    result.push_back(static_cast<char>(codePoint));
+  } else if (codePoint < 0x800) {
+    result.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+    result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else if (codePoint < 0x10000) {
+    result.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+    result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else {
+    result.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+    result.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+    result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  }
+}
+
+namespace Grace::Json
+{
+  class Parser
+  {
+    public:
+
+      explicit Parser(std::string_view text)
+        : m_Begin(text.data()), m_Current(text.data()), m_End(text.data() + text.size())
+      {
+
+      }
+
+      Value ParseDocument()
+      {
+        SkipWhitespace();
+        auto value = ParseValue(0);
+        SkipWhitespace();
+        if (m_Current != m_End) {
+          Fail("Unexpected text after the end of the document");
+        }
+        return value;
+      }
+
+    private:
+
+      Value ParseValue(std::size_t depth)
+      {
+        if (m_Current == m_End) {
+          Fail("Unexpected end of input");
+        }
+
+        switch (*m_Current) {
+          case '{': return ParseObject(depth + 1);
+          case '[': return ParseArray(depth + 1);
+          case '"': return Value(ParseString());
+          case 't': ExpectLiteral("true"); return Value(true);
+          case 'f': ExpectLiteral("false"); return Value(false);
+          case 'n': ExpectLiteral("null"); return Value();
+          default: return ParseNumber();
+        }
+      }
+
+      Value ParseObject(std::size_t depth)
+      {
+        CheckDepth(depth);
+        m_Current++;
+
+        auto result = Value::CreateObject<GraceDictionary>();
+        auto dict = result.GetObject()->GetAsDictionary();
+
+        SkipWhitespace();
+        if (Consume('}')) {
+          return result;
+        }
+
+        while (true) {
+          if (m_Current == m_End || *m_Current != '"') {
+            Fail("Expected a string for an object key");
+          }
+          Value key(ParseString());
+
+          SkipWhitespace();
+          if (!Consume(':')) {
+            Fail("Expected ':' after an object key");
+          }
+          SkipWhitespace();
+
+          auto value = ParseValue(depth);
+          dict->Insert(std::move(key), std::move(value));
+
+          SkipWhitespace();
+          if (Consume('}')) {
+            return result;
+          }
+          if (!Consume(',')) {
+            Fail("Expected ',' or '}' in an object");
+          }
+          SkipWhitespace();
+        }
+      }
+
+      Value ParseArray(std::size_t depth)
+      {
+        CheckDepth(depth);
+        m_Current++;
+
+        std::vector<Value> items;
+
+        SkipWhitespace();
+        if (Consume(']')) {
+          return Value::CreateObject<GraceList>(std::move(items));
+        }
+
+        while (true) {
+          items.push_back(ParseValue(depth));
+
+          SkipWhitespace();
+          if (Consume(']')) {
+            return Value::CreateObject<GraceList>(std::move(items));
+          }
+          if (!Consume(',')) {
+            Fail("Expected ',' or ']' in an array");
+          }
+          SkipWhitespace();
+        }
+      }
+
+      std::string ParseString()
+      {
+        // skip the opening quote
+        m_Current++;
+
+        auto runEnd = SkipRun(m_Current, m_End, MatchStringPlain, IsStringPlain);
+        std::string result(m_Current, runEnd);
+        m_Current = runEnd;
+
+        while (true) {
+          if (m_Current == m_End) {
+            Fail("Unterminated string");
+          }
+
+          auto c = *m_Current++;
+          if (c == '"') {
+            return result;
+          }
+          if (c != '\\') {
+            m_Current--;
+            Fail("Control characters must be escaped in strings");
+          }
+
+          if (m_Current == m_End) {
+            Fail("Unterminated string");
+          }
+
+          switch (*m_Current++) {
+            case '"': result.push_back('"'); break;
+            case '\\': result.push_back('\\'); break;
+            case '/': result.push_back('/'); break;
+            case 'b': result.push_back('\b'); break;
+            case 'f': result.push_back('\f'); break;
+            case 'n': result.push_back('\n'); break;
+            case 'r': result.push_back('\r'); break;
+            case 't': result.push_back('\t'); break;
+            case 'u': {
+              auto codePoint = ParseHex4();
+              if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                // a high surrogate has to be followed by a low one, together they make one code point
+                if (m_End - m_Current < 6 || m_Current[0] != '\\' || m_Current[1] != 'u') {
+                  Fail("Expected a low surrogate after a high surrogate");
+                }
+                m_Current += 2;
+                auto low = ParseHex4();
+                if (low < 0xDC00 || low >= 0xE000) {
+                  Fail("Expected a low surrogate after a high surrogate");
+                }
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+              } else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+                Fail("Unexpected low surrogate");
+              }
+              AppendUtf8(result, codePoint);
+              break;
+            }
+            default:
+              m_Current--;
+              Fail("Invalid escape sequence");
+          }
+
+          runEnd = SkipRun(m_Current, m_End, MatchStringPlain, IsStringPlain);
+          result.append(m_Current, runEnd);
+          m_Current = runEnd;
+        }
+      }
+
+      std::uint32_t ParseHex4()
+      {
+        if (m_End - m_Current < 4) {
+          Fail("Expected 4 hex digits after '\\u'");
+        }
+
+        std::uint32_t result{};
+        auto [end, error] = std::from_chars(m_Current, m_Current + 4, result, 16);
+        if (error != std::errc() || end != m_Current + 4) {
+          Fail("Expected 4 hex digits after '\\u'");
+        }
+        m_Current += 4;
+        return result;
+      }
+
+      Value ParseNumber()
+      {
+        auto start = m_Current;
+        auto isInteger = true;
+
+        Consume('-');
+        if (Consume('0')) {
+          // no leading zeros
+        } else if (m_Current != m_End && *m_Current >= '1' && *m_Current <= '9') {
+          SkipDigits();
+        } else {
+          Fail("Unexpected character");
+        }
+
+        if (Consume('.')) {
+          isInteger = false;
+          if (SkipDigits() == 0) {
+            Fail("Expected a digit after the decimal point");
+          }
+        }
+
+        if (Consume('e') || Consume('E')) {
+          isInteger = false;
+          if (!Consume('+')) {
+            Consume('-');
+          }
+          if (SkipDigits() == 0) {
+            Fail("Expected a digit in the exponent");
+          }
+        }
+
+        if (isInteger) {
+          std::int64_t result{};
+          auto [end, error] = std::from_chars(start, m_Current, result);
+          if (error == std::errc()) {
+            return Value(result);
+          }
+          // too big for an Int, so it has to be a Float
+        }
+
+        double result{};
+        std::from_chars(start, m_Current, result);
+        return Value(result);
+      }
+
+      std::size_t SkipDigits()
+      {
+        auto start = m_Current;
+        while (m_Current != m_End && *m_Current >= '0' && *m_Current <= '9') {
+          m_Current++;
+        }
+        return static_cast<std::size_t>(m_Current - start);
+      }
+
+      void ExpectLiteral(std::string_view literal)
+      {
+        if (static_cast<std::size_t>(m_End - m_Current) < literal.size() || std::memcmp(m_Current, literal.data(), literal.size()) != 0) {
+          Fail("Unexpected character");
+        }
+        m_Current += literal.size();
+      }
+
+      void CheckDepth(std::size_t depth)
+      {
+        if (depth > s_MaxDepth) {
+          Fail(fmt::format("Arrays and objects can't be nested more than {} deep", s_MaxDepth));
+        }
+      }
+
+      GRACE_INLINE bool Consume(char c)
+      {
+        if (m_Current != m_End && *m_Current == c) {
+          m_Current++;
+          return true;
+        }
+        return false;
+      }
+
+      GRACE_INLINE void SkipWhitespace()
+      {
+        // almost always no whitespace or a single space, so check before going word at a time
+        if (m_Current != m_End && IsWhitespace(*m_Current)) {
+          m_Current = SkipRun(m_Current, m_End, MatchWhitespace, IsWhitespace);
+        }
+      }
+
+      GRACE_NORETURN void Fail(std::string_view message)
+      {
+        // only worked out on failure, so parsing doesn't have to track lines
+        std::size_t line = 1, column = 1;
+        for (auto it = m_Begin; it != m_Current; ++it) {
+          if (*it == '\n') {
+            line++;
+            column = 1;
+          } else {
+            column++;
+          }
+        }
+
+        throw GraceException(
+          GraceException::Type::ParseFailed,
+          fmt::format("Invalid JSON at line {}, column {}: {}", line, column, message)
+        );
+      }
+
+      const char* m_Begin;
+      const char* m_Current;
+      const char* m_End;
+  };
+
+  class Writer
+  {
+    public:
+
+      Writer(OutputBuffer& sink, std::size_t indent)
+        : m_Sink(sink), m_Indent(indent)
+      {
+
+      }
+
+      void WriteValue(const Value& value)
+      {
+        switch (value.GetType()) {
+          case Value::Type::Null:
+            m_Sink.Write("null");
+            break;
+          case Value::Type::Bool:
+            m_Sink.Write(value.Get<bool>() ? "true" : "false");
+            break;
+          case Value::Type::Int:
+            m_Sink.Format("{}", value.Get<std::int64_t>());
+            break;
+          case Value::Type::Double:
+            WriteDouble(value.Get<double>());
+            break;
+          case Value::Type::Char: {
+            auto c = value.Get<char>();
+            WriteString(std::string_view(&c, 1));
+            break;
+          }
+          case Value::Type::String:
+            WriteString(value.Get<std::string>());
+            break;
+          case Value::Type::Object:
+            WriteObject(value.GetObject());
+            break;
+        }
+      }
+
+    private:
+
+      void WriteDouble(double value)
+      {
+        if (!std::isfinite(value)) {
+          throw GraceException(
+            GraceException::Type::InvalidArgument,
+            fmt::format("JSON has no way to represent `{}`", value)
+          );
+        }
+
+        char buffer[32];
+        auto end = fmt::format_to(buffer, "{}", value);
+        std::string_view text(buffer, static_cast<std::size_t>(end - buffer));
+        m_Sink.Write(text);
+        // keep it a Float when it's read back in
+        if (text.find_first_of(".e") == std::string_view::npos) {
+          m_Sink.Write(".0");
+        }
+      }
+
+      void WriteString(std::string_view text)
+      {
+        m_Sink.Write('"');
+
+        auto current = text.data();
+        auto end = text.data() + text.size();
+        while (current != end) {
+          auto runEnd = SkipRun(current, end, MatchStringPlain, IsStringPlain);
+          m_Sink.Write(std::string_view(current, static_cast<std::size_t>(runEnd - current)));
+          if (runEnd == end) {
+            break;
+          }
+
+          auto c = *runEnd;
+          switch (c) {
+            case '"': m_Sink.Write("\\\""); break;
+            case '\\': m_Sink.Write("\\\\"); break;
+            case '\b': m_Sink.Write("\\b"); break;
+            case '\f': m_Sink.Write("\\f"); break;
+            case '\n': m_Sink.Write("\\n"); break;
+            case '\r': m_Sink.Write("\\r"); break;
+            case '\t': m_Sink.Write("\\t"); break;
+            default: m_Sink.Format("\\u{:04x}", static_cast<unsigned>(static_cast<std::uint8_t>(c))); break;
+          }
+          current = runEnd + 1;
+        }
+
+        m_Sink.Write('"');
+      }
+
+      void WriteObject(GraceObject* object)
+      {
+        if (std::find(m_Parents.begin(), m_Parents.end(), object) != m_Parents.end()) {
+          throw GraceException(
+            GraceException::Type::InvalidArgument,
+            fmt::format("Cannot convert a `{}` that contains itself to JSON", object->ObjectName())
+          );
+        }
+
+        m_Parents.push_back(object);
+
+        switch (object->ObjectType()) {
+          case GraceObjectType::List: {
+            auto list = object->GetAsList();
+            BeginContainer('[', list->Length());
+            for (std::size_t i = 0; i < list->Length(); i++) {
+              Separator(i);
+              WriteValue(list->GetUnchecked(i));
+            }
+            EndContainer(']', list->Length());
+            break;
+          }
+          case GraceObjectType::Set: {
+            auto set = object->GetAsSet();
+            BeginContainer('[', set->Size());
+            std::size_t i = 0;
+            for (auto it = set->Begin(); !set->IsAtEnd(it); set->IncrementIterator(it)) {
+              Separator(i++);
+              WriteValue(*it);
+            }
+            EndContainer(']', set->Size());
+            break;
+          }
+          case GraceObjectType::KeyValuePair: {
+            auto kvp = object->GetAsKeyValuePair();
+            BeginContainer('[', 2);
+            Separator(0);
+            WriteValue(kvp->Key());
+            Separator(1);
+            WriteValue(kvp->Value());
+            EndContainer(']', 2);
+            break;
+          }
+          case GraceObjectType::Dictionary: {
+            auto dict = object->GetAsDictionary();
+            BeginContainer('{', dict->Size());
+            std::size_t i = 0;
+            for (auto it = dict->Begin(); !dict->IsAtEnd(it); dict->IncrementIterator(it)) {
+              auto kvp = it->GetObject()->GetAsKeyValuePair();
+              Separator(i++);
+              WriteKey(kvp->Key());
+              WriteValue(kvp->Value());
+            }
+            EndContainer('}', dict->Size());
+            break;
+          }
+          case GraceObjectType::Instance: {
+            const auto& members = object->GetAsInstance()->Members();
+            BeginContainer('{', members.size());
+            for (std::size_t i = 0; i < members.size(); i++) {
+              Separator(i);
+              WriteString(members[i].name);
+              m_Sink.Write(m_Indent == 0 ? ":" : ": ");
+              WriteValue(members[i].value);
+            }
+            EndContainer('}', members.size());
+            break;
+          }
+          case GraceObjectType::Bytes:
+            WriteString(object->GetAsBytes()->View());
+            break;
+          default:
+            throw GraceException(
+              GraceException::Type::InvalidType,
+              fmt::format("Cannot convert `{}` to JSON", object->ObjectName())
+            );
+        }
+
+        m_Parents.pop_back();
+      }
+
+      void WriteKey(const Value& key)
+      {
+        // JSON keys are always strings
+        if (key.GetType() == Value::Type::String) {
+          WriteString(key.Get<std::string>());
+        } else {
+          WriteString(key.AsString());
+        }
+        m_Sink.Write(m_Indent == 0 ? ":" : ": ");
+      }
+
+      void BeginContainer(char open, std::size_t size)
+      {
+        m_Sink.Write(open);
+        if (size != 0) {
+          m_Depth++;
+        }
+      }
+
+      void EndContainer(char close, std::size_t size)
+      {
+        if (size != 0) {
+          m_Depth--;
+          NewLine();
+        }
+        m_Sink.Write(close);
+      }
+
+      void Separator(std::size_t index)
+      {
+        if (index != 0) {
+          m_Sink.Write(',');
+        }
+        NewLine();
+      }
+
+      void NewLine()
+      {
+        if (m_Indent == 0) {
+          return;
+        }
+
+        m_Sink.Write('\n');
+        for (std::size_t i = 0; i < m_Depth * m_Indent; i++) {
+          m_Sink.Write(' ');
+        }
+      }
+
+      OutputBuffer& m_Sink;
+      std::size_t m_Indent;
+      std::size_t m_Depth = 0;
+      // the containers currently being written, to catch ones that contain themselves
+      std::vector<const GraceObject*> m_Parents;
+  };
+
+  Value Parse(std::string_view text)
+  {
+    // nothing the parser builds can be part of a cycle, so sweeping for them part way through is wasted work
+    auto gcEnabled = ObjectTracker::GetEnabled();
+    ObjectTracker::SetEnabled(false);
+
+    Value result;
+    try {
+      Parser parser(text);
+      result = parser.ParseDocument();
+    } catch (...) {
+      ObjectTracker::SetEnabled(gcEnabled);
+      throw;
+    }
+
+    ObjectTracker::SetEnabled(gcEnabled);
+    return result;
+  }
+
+  void Write(OutputBuffer& sink, const Value& value, std::size_t indent)
+  {
+    Writer writer(sink, indent);
+    writer.WriteValue(value);
+  }
+} // namespace Grace::Json
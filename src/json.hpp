@@ -0,0 +1,31 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the JSON parser and serialiser behind std::json,
+ *  which build Values straight from the text and write them straight into an OutputBuffer.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_JSON_HPP
+#define GRACE_JSON_HPP
+
+#include <cstddef>
+#include <string_view>
+
+#include "output_buffer.hpp"
+#include "value.hpp"
+
+namespace Grace::Json
+{
+  // objects become Dicts with String keys, arrays become Lists, and numbers become Ints unless they have a fraction or exponent
+  GRACE_NODISCARD VM::Value Parse(std::string_view text);
+
+  // an indent of 0 writes everything on one line
+  void Write(OutputBuffer& sink, const VM::Value& value, std::size_t indent);
+} // namespace Grace::Json
+
+#endif  // ifndef GRACE_JSON_HPP
@@ -36,6 +36,10 @@ static void Usage()
   fmt::print("  -V, --version                 Print version info and exit\n");
   fmt::print("  -v, --verbose                 Enable verbose mode - print compilation and run times, print compiler warnings\n");
   fmt::print("  -we, --warnings-error         Show compiler warnings, warnings result in errors\n");
+  fmt::print("  -O0, -O1, -O2                 Bytecode optimisation level, -O0 disables optimisation (default: -O1)\n");
+  fmt::print("  --check-types                 Check type annotations at runtime wherever the compiler can't prove them\n");
+  fmt::print("  --scan-only                   Only run the scanner over the file and print token throughput\n");
+  fmt::print("  --print-ops                   Compile and optimise the file, then print every function's ops instead of running it\n");
 }
 
 int main(int argc, const char* argv[])
@@ -54,6 +58,10 @@ int main(int argc, const char* argv[])
   std::filesystem::path filePath;
   bool verbose = false;
   bool warningsError = false;
+  bool checkTypes = false;
+  bool scanOnly = false;
+  bool printOps = false;
+  auto optimisation = Grace::VM::OptimisationLevel::O1;
 
   std::vector<std::string> graceMainArgs;
   auto appendToGraceArgs = false;
@@ -84,6 +92,30 @@ int main(int argc, const char* argv[])
       } else {
         warningsError = true;
       }
+    } else if (args[i] == "--check-types") {
+      if (appendToGraceArgs) {
+        graceMainArgs.push_back(args[i]);
+      } else {
+        checkTypes = true;
+      }
+    } else if (args[i] == "-O0" || args[i] == "-O1" || args[i] == "-O2") {
+      if (appendToGraceArgs) {
+        graceMainArgs.push_back(args[i]);
+      } else {
+        optimisation = static_cast<Grace::VM::OptimisationLevel>(args[i][2] - '0');
+      }
+    } else if (args[i] == "--scan-only") {
+      if (appendToGraceArgs) {
+        graceMainArgs.push_back(args[i]);
+      } else {
+        scanOnly = true;
+      }
+    } else if (args[i] == "--print-ops") {
+      if (appendToGraceArgs) {
+        graceMainArgs.push_back(args[i]);
+      } else {
+        printOps = true;
+      }
     } else if (args[i].ends_with(".gr")) {
       // first .gr file will be used as the file to run
       // any other command line flags for the interpreter, e.g. -v, should be given before the file
@@ -115,9 +147,21 @@ int main(int argc, const char* argv[])
     return 1;
   }
 
+  if (scanOnly) {
+    return static_cast<int>(Grace::Compiler::Scan(filePath.string()));
+  }
+
+  if (printOps) {
+    if (!Grace::Compiler::Load(filePath.string(), verbose, warningsError, checkTypes, optimisation)) {
+      return 1;
+    }
+    Grace::VM::VM::PrintOps();
+    return 0;
+  }
+
   return static_cast<int>(
     Grace::Compiler::Compile(
-      filePath.string(), verbose, warningsError, graceMainArgs
+      filePath.string(), verbose, warningsError, checkTypes, optimisation, graceMainArgs
     )
   );
 }
@@ -29,8 +29,8 @@ namespace Grace::Native
       // the arg vector is not const so that we can efficiently std::move the arguments to inner calls to Lists, Dicts etc
       using FuncDecl = VM::Value (*)(std::vector<VM::Value>&);
 
-      NativeFunction(std::string&& name, std::uint32_t arity, FuncDecl func)
-        : m_Name(std::move(name)), m_Arity(arity), m_Function(func)
+      NativeFunction(std::string&& name, std::uint32_t arity, FuncDecl func, bool pure = false)
+        : m_Name(std::move(name)), m_Arity(arity), m_Function(func), m_Pure(pure)
       {
 
       }
@@ -45,6 +45,11 @@ namespace Grace::Native
         return m_Arity;
       }
 
+      GRACE_NODISCARD GRACE_INLINE bool IsPure() const
+      {
+        return m_Pure;
+      }
+
       /*
        *  Call the inner function. The length of the args list is expected to match the function's arity,
        *  and the types are expected to be correct
@@ -59,6 +64,7 @@ namespace Grace::Native
       std::string m_Name;
       std::uint32_t m_Arity;
       FuncDecl m_Function;
+      bool m_Pure;
   };
 } // namespace Grace::Native
 
@@ -0,0 +1,92 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the GraceBytes class.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include "grace_bytes.hpp"
+#include "grace_exception.hpp"
+
+namespace Grace
+{
+  GraceBytes::GraceBytes(std::string&& data)
+  {
+    auto owned = std::make_shared<const std::string>(std::move(data));
+    m_View = *owned;
+    m_Storage = std::move(owned);
+  }
+
+  GraceBytes::GraceBytes(std::unique_ptr<Scanner::SourceFile>&& file)
+  {
+    std::shared_ptr<const Scanner::SourceFile> mapped = std::move(file);
+    m_View = mapped->GetText();
+    m_Storage = std::move(mapped);
+  }
+
+  GraceBytes::GraceBytes(const GraceBytes& parent, std::size_t start, std::size_t length)
+    : m_Storage(parent.m_Storage), m_View(parent.m_View.substr(start, length))
+  {
+
+  }
+
+  void GraceBytes::DebugPrint() const
+  {
+    fmt::print("Bytes: {}\n", ToString());
+  }
+
+  void GraceBytes::Write(OutputBuffer& sink) const
+  {
+    sink.Write("b\"");
+    for (auto c : m_View) {
+      auto byte = static_cast<std::uint8_t>(c);
+      if (c == '"' || c == '\\') {
+        sink.Write('\\');
+        sink.Write(c);
+      } else if (c == '\n') {
+        sink.Write("\\n");
+      } else if (c == '\t') {
+        sink.Write("\\t");
+      } else if (c == '\r') {
+        sink.Write("\\r");
+      } else if (byte >= 0x20 && byte < 0x7f) {
+        sink.Write(c);
+      } else {
+        sink.Format("\\x{:02x}", byte);
+      }
+    }
+    sink.Write('"');
+  }
+
+  bool GraceBytes::AsBool() const
+  {
+    return !m_View.empty();
+  }
+
+  std::uint8_t GraceBytes::At(std::int64_t index) const
+  {
+    if (index < 0 || static_cast<std::size_t>(index) >= m_View.size()) {
+      throw GraceException(
+        GraceException::Type::IndexOutOfRange,
+        fmt::format("Given index is {} but the length of the `Bytes` is {}", index, m_View.size())
+      );
+    }
+    return static_cast<std::uint8_t>(m_View[static_cast<std::size_t>(index)]);
+  }
+
+  std::optional<std::size_t> GraceBytes::Find(std::string_view needle, std::size_t start) const
+  {
+    auto index = m_View.find(needle, start);
+    if (index == std::string_view::npos) {
+      return std::nullopt;
+    }
+    return index;
+  }
+} // namespace Grace
@@ -0,0 +1,81 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the GraceBytes class, a read-only run of bytes in Grace,
+ *  backed either by memory it owns or by a memory mapped file.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_BYTES_HPP
+#define GRACE_BYTES_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "grace_object.hpp"
+#include "../source_file.hpp"
+
+namespace Grace
+{
+  class GraceBytes : public GraceObject
+  {
+    public:
+
+      explicit GraceBytes(std::string&& data);
+      explicit GraceBytes(std::unique_ptr<Scanner::SourceFile>&& file);
+      // a view into the same memory as `parent`, nothing is copied
+      GraceBytes(const GraceBytes& parent, std::size_t start, std::size_t length);
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "Bytes";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return false;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::Bytes;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceBytes* GetAsBytes() override
+      {
+        return this;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE std::string_view View() const
+      {
+        return m_View;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE std::size_t Length() const
+      {
+        return m_View.size();
+      }
+
+      GRACE_NODISCARD std::uint8_t At(std::int64_t index) const;
+      GRACE_NODISCARD std::optional<std::size_t> Find(std::string_view needle, std::size_t start) const;
+
+    private:
+
+      // shared between a Bytes and every slice taken from it, the memory is freed or unmapped when the last one goes
+      std::shared_ptr<const void> m_Storage;
+      std::string_view m_View;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_BYTES_HPP
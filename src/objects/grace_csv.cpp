@@ -0,0 +1,87 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the GraceCsvRows class.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <fmt/core.h>
+
+#include "grace_csv.hpp"
+#include "grace_list.hpp"
+
+namespace Grace
+{
+  using namespace VM;
+
+  GraceCsvRows::GraceCsvRows(const Value& file, char delimiter, char quote)
+    : GraceIterable{1}
+    , m_File{file}
+    , m_Reader{file, delimiter, quote}
+  {
+
+  }
+
+  GraceCsvRows::~GraceCsvRows()
+  {
+    InvalidateIterators();
+  }
+
+  void GraceCsvRows::DebugPrint() const
+  {
+    fmt::print("CsvRows: {}\n", ToString());
+  }
+
+  void GraceCsvRows::Write(OutputBuffer& sink) const
+  {
+    sink.Write("<Rows of ");
+    m_File.Write(sink);
+    sink.Write('>');
+  }
+
+  bool GraceCsvRows::AsBool() const
+  {
+    return !m_AtEnd;
+  }
+
+  GraceCsvRows::IteratorType GraceCsvRows::Begin()
+  {
+    ReadNext();
+    return m_Data.begin();
+  }
+
+  void GraceCsvRows::IncrementIterator(IteratorType& toIncrement)
+  {
+    ReadNext();
+    toIncrement = m_Data.begin();
+  }
+
+  bool GraceCsvRows::IsAtEnd(GRACE_MAYBE_UNUSED const IteratorType& iterator) const
+  {
+    return m_AtEnd;
+  }
+
+  void GraceCsvRows::ReadNext()
+  {
+    if (m_AtEnd) {
+      return;
+    }
+
+    if (!m_Reader.ReadRecord()) {
+      m_Data[0] = Value();
+      m_AtEnd = true;
+      return;
+    }
+
+    std::vector<Value> fields;
+    fields.reserve(m_Reader.FieldCount());
+    for (std::size_t i = 0; i < m_Reader.FieldCount(); i++) {
+      fields.emplace_back(std::string(m_Reader.Field(i)));
+    }
+    m_Data[0] = Value::CreateObject<GraceList>(std::move(fields));
+  }
+} // namespace Grace
@@ -0,0 +1,81 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the GraceCsvRows class, which iterates over the records of a CSV file
+ *  without reading the whole file in.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_CSV_HPP
+#define GRACE_CSV_HPP
+
+#include "grace_iterator.hpp"
+#include "../csv_reader.hpp"
+#include "../value.hpp"
+
+namespace Grace
+{
+  class GraceCsvRows : public GraceIterable
+  {
+    public:
+
+      // `file` must hold a GraceFile
+      GraceCsvRows(const VM::Value& file, char delimiter, char quote);
+      ~GraceCsvRows() override;
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "CsvRows";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return true;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::CsvRows;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceCsvRows* GetAsCsvRows() override
+      {
+        return this;
+      }
+
+      bool Freeze() override
+      {
+        return false;
+      }
+
+      // the first record isn't read until iteration starts
+      IteratorType Begin() override;
+
+      GRACE_NODISCARD GRACE_INLINE IteratorType End() override
+      {
+        return m_Data.end();
+      }
+
+      void IncrementIterator(IteratorType& toIncrement) override;
+      bool IsAtEnd(const IteratorType& iterator) const override;
+
+    private:
+
+      // only ever holds the current record, as a List of Strings
+      void ReadNext();
+
+      VM::Value m_File;
+      CsvReader m_Reader;
+      bool m_AtEnd = false;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_CSV_HPP
@@ -21,6 +21,8 @@ namespace Grace
   {
     m_CellStates = std::move(other.m_CellStates);
     m_Data = std::move(other.m_Data);
+    m_Size = other.m_Size;
+    m_Capacity = other.m_Capacity;
     other.m_Size = 0;
     other.m_Capacity = 0;
   }
@@ -35,32 +37,18 @@ namespace Grace
     fmt::print("Dictionary: {}\n", ToString());
   }
 
-  void GraceDictionary::Print(bool err) const
+  void GraceDictionary::Write(OutputBuffer& sink) const
   {
-    auto stream = err ? stderr : stdout;
-    fmt::print(stream, "{}", ToString());
-  }
-
-  void GraceDictionary::PrintLn(bool err) const
-  {
-    auto stream = err ? stderr : stdout;
-    fmt::print(stream, "{}\n", ToString());
-  }
-
-  std::string GraceDictionary::ToString() const
-  {
-    std::string res = "{";
+    sink.Write('{');
     std::size_t count = 0;
     for (std::size_t i = 0; i < m_Capacity; ++i) {
       if (m_CellStates[i] != CellState::Occupied) continue;
-      auto kvp = m_Data[i].GetObject()->GetAsKeyValuePair();
-      res.append(kvp->ToString());
+      m_Data[i].GetObject()->Write(sink);
       if (count++ < m_Size - 1) {
-        res.append(", ");
+        sink.Write(", ");
       }
     }
-    res.append("}");
-    return res;
+    sink.Write('}');
   }
 
   bool GraceDictionary::AsBool() const
@@ -93,6 +81,7 @@ namespace Grace
 
   void GraceDictionary::Insert(VM::Value&& key, VM::Value&& value)
   {
+    ThrowIfFrozen();
     auto fullness = static_cast<float>(m_Size) / static_cast<float>(m_Capacity);
     if (fullness > s_GrowFactor) {
       m_Capacity *= 2;
@@ -209,6 +198,7 @@ namespace Grace
 
   bool GraceDictionary::Remove(const VM::Value& key)
   {
+    ThrowIfFrozen();
     auto hash = m_Hasher(key);
     auto index = hash % m_Capacity;
     while (true) {
@@ -225,6 +215,7 @@ namespace Grace
           }
           m_Data[index] = VM::Value();
           m_CellStates[index] = CellState::Tombstone;
+          m_Size--;
           return true;
         case CellState::Tombstone:
           index++;
@@ -18,10 +18,12 @@ namespace Grace
   std::unordered_map<GraceException::Type, const char*> GraceException::s_ExceptionMessages = {
 		{GraceException::Type::AssertionFailed, "Assertion failed"},
 		{GraceException::Type::Exception, "Exception"},
+		{GraceException::Type::FiberFailed, "Fiber failed"},
 		{GraceException::Type::FileWriteFailed, "File write failed"},
 		{GraceException::Type::FileReadFailed, "File read failed"},
 		{GraceException::Type::FunctionNotExported, "Function not exported"},
 		{GraceException::Type::FunctionNotFound, "Function not found"},
+		{GraceException::Type::ImpureConstant, "Impure constant"},
 		{GraceException::Type::IncorrectArgCount, "Incorrect argument count"},
 		{GraceException::Type::IndexOutOfRange, "Index out of range"},
 		{GraceException::Type::InvalidArgument, "Invalid argument"},
@@ -34,7 +36,10 @@ namespace Grace
 		{GraceException::Type::LibraryLoadFailure, "Library load failure"},
 		{GraceException::Type::MemberNotFound, "Member not found"},
 		{GraceException::Type::NamespaceNotFound, "Namespace not found"},
+		{GraceException::Type::ParseFailed, "Parse failed"},
 		{GraceException::Type::PathError, "Path error"},
+		{GraceException::Type::ProcessFailed, "Process failed"},
+		{GraceException::Type::ThreadFailed, "Thread failed"},
 		{GraceException::Type::ThrownException, "Thrown exception"},
   };
 
@@ -43,21 +48,9 @@ namespace Grace
 		fmt::print("GraceException: {}: {}\n", what(), m_Message);
   }
 
-  void GraceException::Print(bool err) const
+  void GraceException::Write(OutputBuffer& sink) const
   {
-		auto stream = err ? stderr : stdout;
-		fmt::print(stream, "{}: {}", what(), m_Message);
-  }
-
-  void GraceException::PrintLn(bool err) const
-  {
-		auto stream = err ? stderr : stdout;
-		fmt::print(stream, "{}: {}\n", what(), m_Message);
-  }
-
-  std::string GraceException::ToString() const
-  {
-		return fmt::format("{}: {}", what(), m_Message);
+		sink.Format("{}: {}", what(), m_Message);
   }
 
   bool GraceException::AsBool() const
@@ -34,10 +34,12 @@ namespace Grace
       {
         AssertionFailed,
         Exception,
+        FiberFailed,
         FileWriteFailed,
         FileReadFailed,
         FunctionNotExported,
         FunctionNotFound,
+        ImpureConstant,
         IncorrectArgCount,
         IndexOutOfRange,
         InvalidArgument,
@@ -50,7 +52,10 @@ namespace Grace
         LibraryLoadFailure,
         MemberNotFound,
         NamespaceNotFound,
+        ParseFailed,
         PathError,
+        ProcessFailed,
+        ThreadFailed,
         ThrownException,
       };
 
@@ -90,9 +95,7 @@ namespace Grace
       }
 
       void DebugPrint() const override;
-      void Print(bool err) const override;
-      void PrintLn(bool err) const override;
-      GRACE_NODISCARD std::string ToString() const override;
+      void Write(OutputBuffer& sink) const override;
       GRACE_NODISCARD bool AsBool() const override;
       
       GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
@@ -134,10 +137,12 @@ struct fmt::formatter<Grace::GraceException::Type> : fmt::formatter<std::string_
     switch (type) {
       case GraceException::Type::AssertionFailed: name = "AssertionFailed"; break;
       case GraceException::Type::Exception: name = "Exception"; break;
+      case GraceException::Type::FiberFailed: name = "FiberFailed"; break;
       case GraceException::Type::FileWriteFailed: name = "FileWriteFailed"; break;
       case GraceException::Type::FileReadFailed: name = "FileReadFailed"; break;
       case GraceException::Type::FunctionNotExported: name = "FunctionNotExported"; break;
       case GraceException::Type::FunctionNotFound: name = "FunctionNotFound"; break;
+      case GraceException::Type::ImpureConstant: name = "ImpureConstant"; break;
       case GraceException::Type::IncorrectArgCount: name = "IncorrectArgCount"; break;
       case GraceException::Type::IndexOutOfRange: name = "IndexOutOfRange"; break;
       case GraceException::Type::InvalidArgument: name = "InvalidArgument"; break;
@@ -150,7 +155,10 @@ struct fmt::formatter<Grace::GraceException::Type> : fmt::formatter<std::string_
       case GraceException::Type::LibraryLoadFailure: name = "LibraryLoadFailure"; break;
       case GraceException::Type::MemberNotFound: name = "MemberNotFound"; break;
       case GraceException::Type::NamespaceNotFound: name = "NamespaceNotFound"; break;
+      case GraceException::Type::ParseFailed: name = "ParseFailed"; break;
       case GraceException::Type::PathError: name = "PathError"; break;
+      case GraceException::Type::ProcessFailed: name = "ProcessFailed"; break;
+      case GraceException::Type::ThreadFailed: name = "ThreadFailed"; break;
       case GraceException::Type::ThrownException: name = "ThrownException"; break;
     }
     return fmt::formatter<std::string_view>::format(name, context);
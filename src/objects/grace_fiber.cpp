@@ -0,0 +1,264 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the GraceFiber, GraceStream and GraceProcess classes.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <algorithm>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include "grace_fiber.hpp"
+#include "grace_exception.hpp"
+
+namespace Grace
+{
+  using namespace VM;
+
+  GraceFiber::GraceFiber(std::string functionName, std::function<Value()>&& body)
+    : m_FunctionName(std::move(functionName))
+    , m_Outcome(std::make_shared<Outcome>())
+  {
+    m_Fiber = EventLoop::Spawn([outcome = m_Outcome, body = std::move(body)]() {
+      try {
+        outcome->result = body();
+      } catch (const GraceException& e) {
+        outcome->error = e.Message();
+      }
+    });
+  }
+
+  void GraceFiber::DebugPrint() const
+  {
+    fmt::print("Fiber: {}\n", ToString());
+  }
+
+  void GraceFiber::Write(OutputBuffer& sink) const
+  {
+    auto state = m_Joined ? " (joined)" : EventLoop::IsFinished(m_Fiber) ? " (finished)" : "";
+    sink.Format("<Fiber running `{}`{}>", m_FunctionName, state);
+  }
+
+  bool GraceFiber::AsBool() const
+  {
+    return !m_Joined;
+  }
+
+  Value GraceFiber::Join()
+  {
+    if (m_Joined) {
+      throw GraceException(
+        GraceException::Type::FiberFailed,
+        fmt::format("The Fiber running `{}` has already been joined", m_FunctionName)
+      );
+    }
+
+    EventLoop::Join(m_Fiber);
+    m_Joined = true;
+
+    if (m_Outcome->error) {
+      throw GraceException(
+        GraceException::Type::FiberFailed,
+        fmt::format("`{}` failed on its Fiber: {}", m_FunctionName, *m_Outcome->error)
+      );
+    }
+
+    return std::move(m_Outcome->result);
+  }
+
+  GraceStream::GraceStream(int fd, std::string description, bool readable, bool writable)
+    : m_Fd(fd)
+    , m_Description(std::move(description))
+    , m_Readable(readable)
+    , m_Writable(writable)
+  {
+
+  }
+
+  GraceStream::~GraceStream()
+  {
+    if (m_Fd != -1) {
+      EventLoop::Close(m_Fd);
+    }
+  }
+
+  void GraceStream::DebugPrint() const
+  {
+    fmt::print("Stream: {}\n", ToString());
+  }
+
+  void GraceStream::Write(OutputBuffer& sink) const
+  {
+    sink.Format("<Stream {}{}>", m_Description, m_Fd == -1 ? " (closed)" : "");
+  }
+
+  bool GraceStream::AsBool() const
+  {
+    return m_Fd != -1;
+  }
+
+  std::optional<std::string> GraceStream::ReadLine()
+  {
+    FdOrThrow("read_line", false);
+
+    // only what has been read since the last look needs searching
+    auto searchFrom = m_BufferStart;
+    while (true) {
+      auto newline = m_Buffer.find('\n', searchFrom);
+      if (newline != std::string::npos) {
+        auto end = newline > m_BufferStart && m_Buffer[newline - 1] == '\r' ? newline - 1 : newline;
+        std::string line(m_Buffer, m_BufferStart, end - m_BufferStart);
+        m_BufferStart = newline + 1;
+        return line;
+      }
+
+      auto searched = m_Buffer.size() - m_BufferStart;
+      if (!Fill()) {
+        break;
+      }
+      searchFrom = m_BufferStart + searched;
+    }
+
+    if (m_BufferStart == m_Buffer.size()) {
+      return std::nullopt;
+    }
+    return Take(m_Buffer.size() - m_BufferStart);
+  }
+
+  std::string GraceStream::ReadChunk(std::size_t count)
+  {
+    FdOrThrow("read_chunk", false);
+    while (m_Buffer.size() - m_BufferStart < count && Fill()) {
+
+    }
+    return Take(std::min(count, m_Buffer.size() - m_BufferStart));
+  }
+
+  std::string GraceStream::ReadAll()
+  {
+    FdOrThrow("read_all", false);
+    while (Fill()) {
+
+    }
+    return Take(m_Buffer.size() - m_BufferStart);
+  }
+
+  void GraceStream::WriteText(std::string_view text)
+  {
+    EventLoop::Write(FdOrThrow("write", true), text);
+  }
+
+  void GraceStream::Close()
+  {
+    if (m_Fd == -1) {
+      return;
+    }
+
+    EventLoop::Close(m_Fd);
+    m_Fd = -1;
+    m_Buffer.clear();
+    m_BufferStart = 0;
+  }
+
+  int GraceStream::FdOrThrow(std::string_view operation, bool writing) const
+  {
+    if (m_Fd == -1) {
+      throw GraceException(
+        writing ? GraceException::Type::FileWriteFailed : GraceException::Type::FileReadFailed,
+        fmt::format("Cannot {} Stream {}, it has been closed", operation, m_Description)
+      );
+    }
+
+    if (writing ? !m_Writable : !m_Readable) {
+      throw GraceException(
+        writing ? GraceException::Type::FileWriteFailed : GraceException::Type::FileReadFailed,
+        fmt::format("Cannot {} Stream {}, it can only be {}", operation, m_Description, writing ? "read from" : "written to")
+      );
+    }
+
+    return m_Fd;
+  }
+
+  bool GraceStream::Fill()
+  {
+    if (m_AtEnd) {
+      return false;
+    }
+
+    // another fiber can use this Stream while this one waits, so nothing is added to m_Buffer until the read is done
+    std::string chunk(s_BufferSize, '\0');
+    auto count = EventLoop::Read(m_Fd, chunk.data(), chunk.size());
+    if (count == 0) {
+      m_AtEnd = true;
+      return false;
+    }
+
+    // what has already been given back only needs dropping once it's most of the buffer
+    if (m_BufferStart > m_Buffer.size() / 2) {
+      m_Buffer.erase(0, m_BufferStart);
+      m_BufferStart = 0;
+    }
+    m_Buffer.append(chunk.data(), count);
+    return true;
+  }
+
+  std::string GraceStream::Take(std::size_t count)
+  {
+    std::string taken(m_Buffer, m_BufferStart, count);
+    m_BufferStart += count;
+    if (m_BufferStart == m_Buffer.size()) {
+      m_Buffer.clear();
+      m_BufferStart = 0;
+    }
+    return taken;
+  }
+
+  GraceProcess::GraceProcess(std::string command, int pid, Value input, Value output)
+    : m_Command(std::move(command))
+    , m_Pid(pid)
+    , m_Input(std::move(input))
+    , m_Output(std::move(output))
+  {
+
+  }
+
+  GraceProcess::~GraceProcess()
+  {
+    if (!m_ExitCode) {
+      EventLoop::ForgetProcess(m_Pid);
+    }
+  }
+
+  void GraceProcess::DebugPrint() const
+  {
+    fmt::print("Process: {}\n", ToString());
+  }
+
+  void GraceProcess::Write(OutputBuffer& sink) const
+  {
+    if (m_ExitCode) {
+      sink.Format("<Process `{}` (exited with {})>", m_Command, *m_ExitCode);
+    } else {
+      sink.Format("<Process `{}` (running)>", m_Command);
+    }
+  }
+
+  bool GraceProcess::AsBool() const
+  {
+    return !m_ExitCode;
+  }
+
+  int GraceProcess::Wait()
+  {
+    if (!m_ExitCode) {
+      m_ExitCode = EventLoop::WaitForProcess(m_Pid);
+    }
+    return *m_ExitCode;
+  }
+} // namespace Grace
@@ -0,0 +1,209 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the GraceFiber, GraceStream and GraceProcess classes behind std::fiber.
+ *  A Fiber shares its thread's heap, so unlike a Thread its arguments and result are never copied.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_FIBER_HPP
+#define GRACE_FIBER_HPP
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "grace_object.hpp"
+#include "../event_loop.hpp"
+#include "../value.hpp"
+
+namespace Grace
+{
+  class GraceFiber : public GraceObject
+  {
+    public:
+
+      // body runs on the new fiber and gives back its result, or throws if it failed
+      GraceFiber(std::string functionName, std::function<VM::Value()>&& body);
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "Fiber";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return false;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::Fiber;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceFiber* GetAsFiber() override
+      {
+        return this;
+      }
+
+      bool Freeze() override
+      {
+        return false;
+      }
+
+      // lets the other fibers run until this one has finished, and gives back its result
+      // throws if the fiber failed or has already been joined
+      GRACE_NODISCARD VM::Value Join();
+
+    private:
+
+      // outlives this object if the fiber is still running when the last reference to it goes
+      struct Outcome
+      {
+        VM::Value result;
+        std::optional<std::string> error;
+      };
+
+      std::string m_FunctionName;
+      std::shared_ptr<Outcome> m_Outcome;
+      EventLoop::FiberHandle m_Fiber;
+      bool m_Joined = false;
+  };
+
+  // a file, pipe or the end of a child process's stdin or stdout, which lets other fibers run while it waits
+  class GraceStream : public GraceObject
+  {
+    public:
+
+      static constexpr std::size_t s_BufferSize = 64 * 1024;
+
+      // takes ownership of fd, description is what it was opened from, for printing and error messages
+      GraceStream(int fd, std::string description, bool readable, bool writable);
+      ~GraceStream() override;
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "Stream";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return false;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::Stream;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceStream* GetAsStream() override
+      {
+        return this;
+      }
+
+      bool Freeze() override
+      {
+        return false;
+      }
+
+      // the next line without its line ending, or nothing once everything has been read
+      GRACE_NODISCARD std::optional<std::string> ReadLine();
+      // up to `count` bytes, fewer only at the end
+      GRACE_NODISCARD std::string ReadChunk(std::size_t count);
+      // everything until the other end is closed
+      GRACE_NODISCARD std::string ReadAll();
+      void WriteText(std::string_view text);
+      void Close();
+
+    private:
+
+      int FdOrThrow(std::string_view operation, bool writing) const;
+      // reads whatever is available into m_Buffer, waiting for some if there isn't any, and gives back false at the end
+      bool Fill();
+      std::string Take(std::size_t count);
+
+      int m_Fd;
+      std::string m_Description;
+      bool m_Readable, m_Writable;
+
+      // read but not yet given back, starting at m_BufferStart
+      std::string m_Buffer;
+      std::size_t m_BufferStart = 0;
+      bool m_AtEnd = false;
+  };
+
+  class GraceProcess : public GraceObject
+  {
+    public:
+
+      // input and output are the Streams connected to the child's stdin and stdout
+      GraceProcess(std::string command, int pid, VM::Value input, VM::Value output);
+      // a child that is never waited for is cleaned up if it has already exited
+      ~GraceProcess() override;
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "Process";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return false;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::Process;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceProcess* GetAsProcess() override
+      {
+        return this;
+      }
+
+      bool Freeze() override
+      {
+        return false;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE const VM::Value& Input() const
+      {
+        return m_Input;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE const VM::Value& Output() const
+      {
+        return m_Output;
+      }
+
+      // lets other fibers run until the child exits, and gives back its exit code
+      GRACE_NODISCARD int Wait();
+
+    private:
+
+      std::string m_Command;
+      int m_Pid;
+      VM::Value m_Input, m_Output;
+      std::optional<int> m_ExitCode;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_FIBER_HPP
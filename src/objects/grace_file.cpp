@@ -0,0 +1,273 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the GraceFile and GraceFileLines classes.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include "grace_file.hpp"
+#include "grace_exception.hpp"
+
+namespace Grace
+{
+  using namespace VM;
+
+  GraceFile::GraceFile(const std::string& path, const std::string& mode)
+    : m_Path(path), m_Mode(mode)
+  {
+    if (mode != "r" && mode != "w" && mode != "a" && mode != "r+" && mode != "w+" && mode != "a+") {
+      throw GraceException(
+        GraceException::Type::InvalidArgument,
+        fmt::format("Invalid mode '{}' for `std::file::open(path, mode)`, expected one of 'r', 'w', 'a', 'r+', 'w+' or 'a+'", mode)
+      );
+    }
+
+    // always binary so line endings come through untouched on every platform, ReadLine deals with '\r'
+    auto binaryMode = mode.back() == '+' ? fmt::format("{}b+", mode.front()) : mode + 'b';
+    m_File = std::fopen(path.c_str(), binaryMode.c_str());
+    if (m_File == nullptr) {
+      throw GraceException(
+        mode == "r" ? GraceException::Type::FileReadFailed : GraceException::Type::FileWriteFailed,
+        fmt::format("Failed to open file '{}': {}", path, std::strerror(errno))
+      );
+    }
+
+    std::setvbuf(m_File, nullptr, _IOFBF, s_BufferSize);
+    m_Reader.emplace(m_File, s_BufferSize);
+  }
+
+  GraceFile::~GraceFile()
+  {
+    if (m_File != nullptr) {
+      std::fclose(m_File);
+    }
+  }
+
+  void GraceFile::DebugPrint() const
+  {
+    fmt::print("File: {}\n", ToString());
+  }
+
+  void GraceFile::Write(OutputBuffer& sink) const
+  {
+    sink.Format("<File '{}' ({}{})>", m_Path, m_Mode, m_File == nullptr ? ", closed" : "");
+  }
+
+  bool GraceFile::AsBool() const
+  {
+    return m_File != nullptr;
+  }
+
+  std::optional<std::string> GraceFile::ReadLine()
+  {
+    HandleOrThrow("read_line");
+    PrepareForRead();
+
+    auto line = m_Reader->ReadLine();
+    ThrowIfReadFailed();
+    return line;
+  }
+
+  bool GraceFile::ReadLine(std::string& line)
+  {
+    HandleOrThrow("read_line");
+    PrepareForRead();
+
+    auto found = m_Reader->ReadLine(line);
+    ThrowIfReadFailed();
+    return found;
+  }
+
+  std::string GraceFile::ReadChunk(std::size_t count)
+  {
+    HandleOrThrow("read_chunk");
+    PrepareForRead();
+
+    auto chunk = m_Reader->Read(count);
+    ThrowIfReadFailed();
+    return chunk;
+  }
+
+  void GraceFile::WriteText(std::string_view text)
+  {
+    auto file = HandleOrThrow("write");
+    PrepareForWrite();
+
+    if (std::fwrite(text.data(), 1, text.size(), file) != text.size()) {
+      throw GraceException(
+        GraceException::Type::FileWriteFailed,
+        fmt::format("Failed to write to file '{}': {}", m_Path, std::strerror(errno))
+      );
+    }
+  }
+
+  void GraceFile::AppendText(std::string_view text)
+  {
+    auto file = HandleOrThrow("append");
+    PrepareForWrite();
+
+    if (std::fseek(file, 0, SEEK_END) != 0) {
+      throw GraceException(
+        GraceException::Type::FileWriteFailed,
+        fmt::format("Failed to append to file '{}': {}", m_Path, std::strerror(errno))
+      );
+    }
+
+    WriteText(text);
+  }
+
+  void GraceFile::Close()
+  {
+    if (m_File == nullptr) {
+      return;
+    }
+
+    auto result = std::fclose(m_File);
+    m_File = nullptr;
+    m_Reader.reset();
+
+    if (result != 0) {
+      throw GraceException(
+        GraceException::Type::FileWriteFailed,
+        fmt::format("Failed to close file '{}', some writes may have been lost", m_Path)
+      );
+    }
+  }
+
+  std::FILE* GraceFile::HandleOrThrow(std::string_view operation) const
+  {
+    if (m_File == nullptr) {
+      throw GraceException(
+        operation.starts_with("read") ? GraceException::Type::FileReadFailed : GraceException::Type::FileWriteFailed,
+        fmt::format("Cannot `{}` file '{}' after it has been closed", operation, m_Path)
+      );
+    }
+    return m_File;
+  }
+
+  void GraceFile::ThrowIfReadFailed() const
+  {
+    if (m_Reader->HasError()) {
+      throw GraceException(
+        GraceException::Type::FileReadFailed,
+        fmt::format("Failed to read from file '{}': {}", m_Path, std::strerror(errno))
+      );
+    }
+  }
+
+  void GraceFile::PrepareForRead()
+  {
+    if (m_Mode == "w" || m_Mode == "a") {
+      throw GraceException(
+        GraceException::Type::FileReadFailed,
+        fmt::format("Cannot read from file '{}' opened with mode '{}'", m_Path, m_Mode)
+      );
+    }
+
+    if (m_Writing) {
+      std::fflush(m_File);
+      m_Writing = false;
+    }
+  }
+
+  void GraceFile::PrepareForWrite()
+  {
+    if (m_Mode == "r") {
+      throw GraceException(
+        GraceException::Type::FileWriteFailed,
+        fmt::format("Cannot write to file '{}' opened with mode 'r'", m_Path)
+      );
+    }
+
+    if (m_Writing) {
+      return;
+    }
+
+    // anything still in the read buffer hasn't been seen yet, so move the C stream back to where the reader is up to
+    auto unread = static_cast<long>(m_Reader->Discard());
+    std::fseek(m_File, -unread, SEEK_CUR);
+    m_Writing = true;
+  }
+
+  GraceFileLines::GraceFileLines(const Value& file)
+    : GraceIterable{1}
+    , m_File{file}
+  {
+
+  }
+
+  GraceFileLines::GraceFileLines()
+    : GraceIterable{1}
+  {
+
+  }
+
+  GraceFileLines::~GraceFileLines()
+  {
+    InvalidateIterators();
+  }
+
+  void GraceFileLines::DebugPrint() const
+  {
+    fmt::print("FileLines: {}\n", ToString());
+  }
+
+  void GraceFileLines::Write(OutputBuffer& sink) const
+  {
+    if (m_File.GetType() == Value::Type::Null) {
+      sink.Write("<Lines of stdin>");
+      return;
+    }
+
+    sink.Write("<Lines of ");
+    m_File.Write(sink);
+    sink.Write('>');
+  }
+
+  bool GraceFileLines::AsBool() const
+  {
+    return !m_AtEnd;
+  }
+
+  GraceFileLines::IteratorType GraceFileLines::Begin()
+  {
+    ReadNext();
+    return m_Data.begin();
+  }
+
+  void GraceFileLines::IncrementIterator(IteratorType& toIncrement)
+  {
+    ReadNext();
+    toIncrement = m_Data.begin();
+  }
+
+  bool GraceFileLines::IsAtEnd(GRACE_MAYBE_UNUSED const IteratorType& iterator) const
+  {
+    return m_AtEnd;
+  }
+
+  void GraceFileLines::ReadNext()
+  {
+    if (m_AtEnd) {
+      return;
+    }
+
+    auto line = m_File.GetType() == Value::Type::Null ? InputBuffer::Stdin().ReadLine() : m_File.GetObject()->GetAsFile()->ReadLine();
+    if (line) {
+      m_Data[0] = Value(*line);
+    } else {
+      m_Data[0] = Value();
+      m_AtEnd = true;
+    }
+  }
+} // namespace Grace
@@ -0,0 +1,152 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the GraceFile class, an open file handle in Grace, and the GraceFileLines class,
+ *  which iterates over the lines of a GraceFile without reading the whole file in.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_FILE_HPP
+#define GRACE_FILE_HPP
+
+#include <cstdio>
+#include <optional>
+#include <string>
+
+#include "grace_iterator.hpp"
+#include "../input_buffer.hpp"
+#include "../value.hpp"
+
+namespace Grace
+{
+  class GraceFile : public GraceObject
+  {
+    public:
+
+      static constexpr std::size_t s_BufferSize = 64 * 1024;
+
+      GraceFile(const std::string& path, const std::string& mode);
+      ~GraceFile() override;
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "File";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return false;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::File;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceFile* GetAsFile() override
+      {
+        return this;
+      }
+
+      // a `const` can't hold a handle, closing it would change every use of it
+      bool Freeze() override
+      {
+        return false;
+      }
+
+      // the next line without its line ending, or nothing at the end of the file
+      GRACE_NODISCARD std::optional<std::string> ReadLine();
+      // reads into `line`, reusing its storage, and returns false at the end of the file
+      bool ReadLine(std::string& line);
+      // up to `count` bytes, fewer only at the end of the file
+      GRACE_NODISCARD std::string ReadChunk(std::size_t count);
+      void WriteText(std::string_view text);
+      // writes at the end of the file, wherever the handle currently is
+      void AppendText(std::string_view text);
+      void Close();
+
+    private:
+
+      std::FILE* HandleOrThrow(std::string_view operation) const;
+      void ThrowIfReadFailed() const;
+      // C only allows switching between reading and writing after a seek or flush
+      void PrepareForRead();
+      void PrepareForWrite();
+
+      std::string m_Path, m_Mode;
+      std::FILE* m_File = nullptr;
+
+      // reads go through our own buffer so a line can be found with memchr instead of a getc per character
+      std::optional<InputBuffer> m_Reader;
+      bool m_Writing = false;
+  };
+
+  class GraceFileLines : public GraceIterable
+  {
+    public:
+
+      explicit GraceFileLines(const VM::Value& file);
+      // the lines of stdin
+      GraceFileLines();
+      ~GraceFileLines() override;
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "FileLines";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return true;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::FileLines;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceFileLines* GetAsFileLines() override
+      {
+        return this;
+      }
+
+      bool Freeze() override
+      {
+        return false;
+      }
+
+      // the first line isn't read until iteration starts
+      IteratorType Begin() override;
+
+      GRACE_NODISCARD GRACE_INLINE IteratorType End() override
+      {
+        return m_Data.end();
+      }
+
+      void IncrementIterator(IteratorType& toIncrement) override;
+      bool IsAtEnd(const IteratorType& iterator) const override;
+
+    private:
+
+      // only ever holds the current line, so memory use doesn't grow with the size of the file
+      void ReadNext();
+
+      // null when reading stdin
+      VM::Value m_File;
+      bool m_AtEnd = false;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_FILE_HPP
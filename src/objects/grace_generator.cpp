@@ -0,0 +1,97 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the GraceGenerator class.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include "grace_generator.hpp"
+#include "grace_exception.hpp"
+
+namespace Grace
+{
+  using namespace VM;
+
+  GraceGenerator::GraceGenerator(Frame&& frame)
+    : GraceIterable{1}
+    , m_Frame{std::move(frame)}
+  {
+
+  }
+
+  GraceGenerator::~GraceGenerator()
+  {
+    InvalidateIterators();
+  }
+
+  void GraceGenerator::DebugPrint() const
+  {
+    fmt::print("Generator: {}\n", ToString());
+  }
+
+  void GraceGenerator::Write(OutputBuffer& sink) const
+  {
+    sink.Format("<Generator `{}`{}>", m_Frame.functionName, m_State == State::Finished ? " (finished)" : "");
+  }
+
+  bool GraceGenerator::AsBool() const
+  {
+    return m_State != State::Finished;
+  }
+
+  void GraceGenerator::IncrementIterator(IteratorType& toIncrement)
+  {
+    toIncrement = m_Data.begin();
+  }
+
+  bool GraceGenerator::IsAtEnd(GRACE_MAYBE_UNUSED const IteratorType& iterator) const
+  {
+    return m_State == State::Finished;
+  }
+
+  void GraceGenerator::Resume()
+  {
+    if (m_State == State::Running) {
+      throw GraceException(
+        GraceException::Type::InvalidIterator,
+        fmt::format("Generator `{}` is already running, it can't be iterated over from inside itself", m_Frame.functionName)
+      );
+    }
+
+    m_State = State::Running;
+  }
+
+  Value GraceGenerator::Take()
+  {
+    if (m_State != State::Yielded) {
+      return Value();
+    }
+
+    m_State = State::Suspended;
+    auto value = std::move(m_Data[0]);
+    m_Data[0] = Value();
+    return value;
+  }
+
+  void GraceGenerator::Yield(Value&& value)
+  {
+    m_Data[0] = std::move(value);
+    m_State = State::Yielded;
+  }
+
+  void GraceGenerator::Finish()
+  {
+    m_Data[0] = Value();
+    m_Frame.locals.clear();
+    m_Frame.stack.clear();
+    m_Frame.heldIterators.clear();
+    m_State = State::Finished;
+  }
+} // namespace Grace
@@ -0,0 +1,133 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the GraceGenerator class, the result of calling a function that contains `yield`.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_GENERATOR_HPP
+#define GRACE_GENERATOR_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "grace_iterator.hpp"
+#include "../value.hpp"
+
+namespace Grace
+{
+  // Holds the frame of a generator function while it isn't running. The VM moves the frame back onto its stacks to resume it,
+  // and off again when it reaches a `yield`, so the function's locals and loops carry on from where they were.
+  // Only the value most recently yielded is kept, so iterating over a generator takes the same memory however long it is.
+  class GraceGenerator : public GraceIterable
+  {
+    public:
+
+      enum class State
+      {
+        // waiting to run up to its next `yield`
+        Suspended,
+        // its frame is on the VM's stacks
+        Running,
+        // has yielded a value that hasn't been taken yet
+        Yielded,
+        // returned or threw, and won't yield anything else
+        Finished,
+      };
+
+      struct Frame
+      {
+        std::string functionName, fileName;
+        std::int64_t nameHash{}, fileNameHash{};
+        // the start of the function, jumps inside it are relative to these
+        std::size_t opIndexStart{}, constantIndexStart{};
+        // where it carries on from when it's next resumed
+        std::size_t opIndex{}, constantIndex{};
+        std::vector<VM::Value> locals, stack, heldIterators;
+      };
+
+      // the arguments become the first locals, nothing runs until the generator is first iterated over
+      GraceGenerator(Frame&& frame);
+      ~GraceGenerator() override;
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "Generator";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return true;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::Generator;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceGenerator* GetAsGenerator() override
+      {
+        return this;
+      }
+
+      bool Freeze() override
+      {
+        return false;
+      }
+
+      // the VM advances the generator by running it, so the iterator only ever looks at the value it last yielded
+      GRACE_NODISCARD GRACE_INLINE IteratorType Begin() override
+      {
+        return m_Data.begin();
+      }
+
+      GRACE_NODISCARD GRACE_INLINE IteratorType End() override
+      {
+        return m_Data.end();
+      }
+
+      void IncrementIterator(IteratorType& toIncrement) override;
+      bool IsAtEnd(const IteratorType& iterator) const override;
+
+      GRACE_NODISCARD GRACE_INLINE State GetState() const
+      {
+        return m_State;
+      }
+
+      // whether there is a value or the end of the generator to take, otherwise it needs to run first
+      GRACE_NODISCARD GRACE_INLINE bool IsReady() const
+      {
+        return m_State == State::Yielded || m_State == State::Finished;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE Frame& GetFrame()
+      {
+        return m_Frame;
+      }
+
+      // called before the VM moves the frame onto its stacks, throws if it's already running
+      void Resume();
+      // gives back the value waiting to be taken, or null if it's finished
+      GRACE_NODISCARD VM::Value Take();
+
+      void Yield(VM::Value&& value);
+      // anything left in the frame is released
+      void Finish();
+
+    private:
+
+      Frame m_Frame;
+      State m_State = State::Suspended;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_GENERATOR_HPP
@@ -45,23 +45,11 @@ namespace Grace
 		fmt::print("{}", res);
   }
 
-  void GraceInstance::Print(bool err) const
+  void GraceInstance::Write(OutputBuffer& sink) const
   {
-		auto stream = err ? stderr : stdout;
-		fmt::print(stream, "{}", ToString());
+		sink.Format("<{} instance at {}>", m_ClassName, fmt::ptr(this));
   }
 
-  void GraceInstance::PrintLn(bool err) const
-  {
-		auto stream = err ? stderr : stdout;
-		fmt::print(stream, "{}\n", ToString());
-  }
-
-  std::string GraceInstance::ToString() const
-  {	
-		return fmt::format("<{} instance at {}>", m_ClassName, fmt::ptr(this));
-  }  
-
   void GraceInstance::AssignMember(const std::string& memberName, VM::Value&& value)
   {
 		for (auto& [name, val] : m_Members) {
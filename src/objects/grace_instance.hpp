@@ -39,9 +39,7 @@ namespace Grace
 		~GraceInstance() override = default;
 
 		void DebugPrint() const override;
-		void Print(bool err) const override;
-		void PrintLn(bool err) const override;
-		GRACE_NODISCARD std::string ToString() const override;	
+		void Write(OutputBuffer& sink) const override;
 
 		GRACE_NODISCARD constexpr bool AsBool() const override
 		{
@@ -72,6 +70,17 @@ namespace Grace
 		GRACE_NODISCARD const VM::Value& LoadMember(const std::string& memberName);
 		GRACE_NODISCARD bool HasMember(const std::string& memberName) const;
 
+		GRACE_NODISCARD GRACE_INLINE const std::vector<Member>& Members() const
+		{
+			return m_Members;
+		}
+
+		// members can always be reassigned, so an instance can't be the value of a `const`
+		bool Freeze() override
+		{
+			return false;
+		}
+
 		GRACE_NODISCARD std::vector<GraceObject*> GetObjectMembers() const override;
 		GRACE_NODISCARD bool AnyMemberMatches(const GraceObject* match) const override;
 		void RemoveMember(GraceObject* object) override;
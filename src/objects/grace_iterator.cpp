@@ -28,8 +28,7 @@ namespace Grace
     m_Iterable->RemoveIterator(this);
 
     if (m_Iterable->DecreaseRef() == 0) {
-      ObjectTracker::StopTrackingObject(m_Iterable);
-      delete m_Iterable;
+      VM::Value::DestroyObject(m_Iterable);
     }
   }
 
@@ -49,29 +48,12 @@ namespace Grace
     return m_Iterable->IsAtEnd(m_Iterator);
   }
 
-  void GraceIterator::Print(bool err) const
+  void GraceIterator::Write(OutputBuffer& sink) const
   {
     if (m_Iterator == m_Iterable->End()) {
-      fmt::print(err ? stderr : stdout, "null");
+      sink.Write("null");
     } else {
-      Value().Print(err);
+      Value().Write(sink);
     }
   }
-
-  void GraceIterator::PrintLn(bool err) const
-  {
-    if (m_Iterator == m_Iterable->End()) {
-      fmt::print(err ? stderr : stdout, "null\n");
-    } else {
-      Value().PrintLn(err);
-    }
-  }
-
-  std::string GraceIterator::ToString() const
-  {
-    if (m_Iterator == m_Iterable->End()) {
-      return "null";
-    }
-    return Value().AsString();
-  }
 } // namespace Grace
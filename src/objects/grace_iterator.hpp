@@ -36,6 +36,9 @@ namespace Grace
         Dictionary,
         Set,
         Range,
+        FileLines,
+        CsvRows,
+        Generator,
       };
 
       using IteratorType = std::vector<VM::Value>::iterator;
@@ -59,10 +62,7 @@ namespace Grace
         fmt::print("Iterator: {}\n", ToString());
       }
 
-      void Print(bool err) const override;
-      void PrintLn(bool err) const override;
-
-      GRACE_NODISCARD std::string ToString() const override;
+      void Write(OutputBuffer& sink) const override;
 
       GRACE_NODISCARD bool AsBool() const override
       {
@@ -105,6 +105,11 @@ namespace Grace
         return m_IterableType;
       }
 
+      GRACE_NODISCARD GRACE_INLINE GraceIterable* GetIterable() const
+      {
+        return m_Iterable;
+      }
+
     private:
       GraceIterable* m_Iterable;
       IteratorType m_Iterator;
@@ -145,13 +150,22 @@ namespace Grace
         return iterator == m_Data.end();
       }
 
+      // a frozen collection can't be modified, so its iterators never need invalidating
+      // not keeping track of them also means threads iterating over the same `const` don't race on the list
       void AddIterator(GraceIterator* iterator)
       {
+        if (m_Frozen) {
+          return;
+        }
         m_ActiveIterators.push_back(iterator);
       }
 
       void RemoveIterator(GraceIterator* iterator)
       {
+        if (m_Frozen) {
+          return;
+        }
+
         auto it = std::find(m_ActiveIterators.begin(), m_ActiveIterators.end(), iterator);
         if (it == m_ActiveIterators.end()) {
 #ifdef GRACE_DEBUG
@@ -161,6 +175,33 @@ namespace Grace
         }
         m_ActiveIterators.erase(it);
       }
+
+      bool Freeze() override
+      {
+        if (m_Frozen) {
+          return true;
+        }
+
+        m_Frozen = true;
+        for (const auto& value : m_Data) {
+          auto object = value.GetObject();
+          if (object != nullptr && !object->Freeze()) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      // anything that changes the collection calls this first
+      void ThrowIfFrozen() const
+      {
+        if (m_Frozen) {
+          throw GraceException(
+            GraceException::Type::InvalidCollectionOperation,
+            fmt::format("`{}` belongs to a `const` and cannot be modified", ObjectName())
+          );
+        }
+      }
       
     protected:
       void InvalidateIterators()
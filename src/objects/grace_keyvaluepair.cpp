@@ -32,106 +32,13 @@ namespace Grace
     fmt::print("KeyValuePair: {}\n", ToString());
   }
 
-  void GraceKeyValuePair::Print(bool err) const
+  void GraceKeyValuePair::Write(OutputBuffer& sink) const
   {
-    auto stream = err ? stderr : stdout;
-    fmt::print(stream, "{}", ToString());
-  }
-
-  void GraceKeyValuePair::PrintLn(bool err) const
-  {
-    auto stream = err ? stderr : stdout;
-    fmt::print(stream, "{}\n", ToString());
-  }
-
-  std::string GraceKeyValuePair::ToString() const
-  {
-    std::string res = "(";
-    if (m_Key.GetType() == VM::Value::Type::String) {
-      res.push_back('"');
-      res.append(m_Key.AsString());
-      res.push_back('"');
-    } else if (m_Key.GetType() == VM::Value::Type::Char) {
-      res.push_back('\'');
-      res.append(m_Key.AsString());
-      res.push_back('\'');
-    } else if (m_Key.GetType() == VM::Value::Type::Object) {
-      auto object = m_Key.GetObject();
-      auto type = object->ObjectType();
-      if (type == GraceObjectType::Exception || type == GraceObjectType::Iterator || type == GraceObjectType::Instance) {
-        res.append(object->ToString());
-      }
-      else {
-        std::vector<GraceObject*> visited;
-        if (AnyMemberMatchesRecursive(this, object, visited)) {
-          switch (type) {
-            case GraceObjectType::Dictionary:
-              res.append("{...}");
-              break;
-            case GraceObjectType::List:
-              res.append("[...]");
-              break;
-            case GraceObjectType::KeyValuePair:
-              res.append("(...)");
-              break;
-            default:
-              GRACE_UNREACHABLE();
-              break;
-          }
-        }
-        else {
-          res.append(object->ToString());
-        }
-      }
-    } else {
-      res.append(m_Key.AsString());
-    }
-
-    res.append(": ");
-
-    if (m_Value.GetType() == VM::Value::Type::String) {
-      res.push_back('"');
-      res.append(m_Value.AsString());
-      res.push_back('"');
-    }
-    else if (m_Value.GetType() == VM::Value::Type::Char) {
-      res.push_back('\'');
-      res.append(m_Value.AsString());
-      res.push_back('\'');
-    } else if (m_Value.GetType() == VM::Value::Type::Object) {
-      auto object = m_Value.GetObject();
-      auto type = object->ObjectType();
-      if (type == GraceObjectType::Exception || type == GraceObjectType::Iterator || type == GraceObjectType::Instance) {
-        res.append(object->ToString());
-      }
-      else {
-        std::vector<GraceObject*> visited;
-        if (AnyMemberMatchesRecursive(this, object, visited)) {
-          switch (type) {
-            case GraceObjectType::Dictionary:
-              res.append("{...}");
-              break;
-            case GraceObjectType::List:
-              res.append("[...]");
-              break;
-            case GraceObjectType::KeyValuePair:
-              res.append("(...)");
-              break;
-            default:
-              GRACE_UNREACHABLE();
-              break;
-          }
-        }
-        else {
-          res.append(object->ToString());
-        }
-      }
-    } else {
-      res.append(m_Value.AsString());
-    }
-
-    res.push_back(')');
-    return res;
+    sink.Write('(');
+    WriteMember(sink, m_Key);
+    sink.Write(": ");
+    WriteMember(sink, m_Value);
+    sink.Write(')');
   }
 
   bool GraceKeyValuePair::AsBool() const
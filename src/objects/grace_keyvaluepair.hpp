@@ -30,9 +30,7 @@ namespace Grace
       ~GraceKeyValuePair() override = default;
 
       void DebugPrint() const override;
-      void Print(bool err) const override;
-      void PrintLn(bool err) const override;
-      GRACE_NODISCARD std::string ToString() const override;
+      void Write(OutputBuffer& sink) const override;
       GRACE_NODISCARD bool AsBool() const override;
       
       GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
@@ -65,6 +63,17 @@ namespace Grace
         return m_Value;
       }
 
+      bool Freeze() override
+      {
+        if (m_Frozen) {
+          return true;
+        }
+
+        m_Frozen = true;
+        auto key = m_Key.GetObject(), value = m_Value.GetObject();
+        return (key == nullptr || key->Freeze()) && (value == nullptr || value->Freeze());
+      }
+
       GRACE_NODISCARD bool AnyMemberMatches(const GraceObject* match) const override;
       GRACE_NODISCARD std::vector<GraceObject*> GetObjectMembers() const override;
       void RemoveMember(GraceObject* object) override;
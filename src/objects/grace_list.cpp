@@ -9,17 +9,23 @@
  *  For licensing information, see grace.hpp
  */
 
+#include <algorithm>
+
 #include <fmt/core.h>
 #include <fmt/format.h>
 
 #include "grace_list.hpp"
 #include "grace_dictionary.hpp"
 #include "object_tracker.hpp"
+#include "../thread_pool.hpp"
 
 namespace Grace
 {
   using namespace VM;
 
+  // each thread sorts at least this many elements, below it starting the threads costs more than it saves
+  static constexpr std::size_t s_MinParallelSortChunk = 16384;
+
   GraceList::GraceList(std::vector<Value>&& items)
     : GraceIterable{std::move(items)}
   {
@@ -98,12 +104,14 @@ namespace Grace
 
   void GraceList::Append(VM::Value&& value)
   {
+    ThrowIfFrozen();
     m_Data.push_back(std::forward<VM::Value>(value));
     InvalidateIterators();
   }
 
   void GraceList::Insert(VM::Value&& value, std::size_t index)
   {
+    ThrowIfFrozen();
     if (index >= m_Data.size()) {
       throw GraceException(
         GraceException::Type::IndexOutOfRange,
@@ -117,6 +125,7 @@ namespace Grace
 
   void GraceList::Append(const std::vector<Value>& items)
   {
+    ThrowIfFrozen();
     m_Data.reserve(items.size());
     m_Data.insert(m_Data.end(), items.begin(), items.end());
     InvalidateIterators();
@@ -124,6 +133,7 @@ namespace Grace
 
   VM::Value GraceList::Remove(std::size_t index)
   {
+    ThrowIfFrozen();
     if (index >= m_Data.size()) {
       throw GraceException(
         GraceException::Type::IndexOutOfRange,
@@ -139,6 +149,7 @@ namespace Grace
 
   VM::Value GraceList::Pop()
   {
+    ThrowIfFrozen();
     InvalidateIterators();
     auto res = std::move(m_Data.back());
     m_Data.pop_back();
@@ -147,88 +158,145 @@ namespace Grace
 
   void GraceList::Sort()
   {
+    ThrowIfFrozen();
     std::sort(m_Data.begin(), m_Data.end());
     InvalidateIterators();
   }
 
   void GraceList::SortDescending()
   {
+    ThrowIfFrozen();
     std::sort(m_Data.begin(), m_Data.end(), std::greater<Value>());
     InvalidateIterators();
   }
 
-  void GraceList::DebugPrint() const
+  void GraceList::ParallelSort()
   {
-    fmt::print("GraceList: {}\n", ToString());
+    ThrowIfFrozen();
+
+    // comparing numbers and Chars never throws or touches a reference count, so it's safe on any thread
+    auto isNumber = [](const Value& value) {
+      return value.GetType() == Value::Type::Int || value.GetType() == Value::Type::Double;
+    };
+    auto isChar = [](const Value& value) {
+      return value.GetType() == Value::Type::Char;
+    };
+
+    auto chunks = std::min(ThreadPool::GetSize(), m_Data.size() / s_MinParallelSortChunk);
+    if (chunks < 2 || !(std::all_of(m_Data.begin(), m_Data.end(), isNumber) || std::all_of(m_Data.begin(), m_Data.end(), isChar))) {
+      Sort();
+      return;
+    }
+
+    std::vector<std::vector<Value>::iterator> bounds;
+    for (std::size_t i = 0; i <= chunks; i++) {
+      bounds.push_back(m_Data.begin() + static_cast<std::ptrdiff_t>(m_Data.size() * i / chunks));
+    }
+
+    ThreadPool::ParallelFor(chunks, 1, [&bounds](std::size_t begin, std::size_t end) {
+      for (auto i = begin; i < end; i++) {
+        std::sort(bounds[i], bounds[i + 1]);
+      }
+    });
+
+    // merge neighbouring runs in pairs, doubling their length each time
+    for (std::size_t width = 1; width < chunks; width *= 2) {
+      auto pairs = (chunks + 2 * width - 1) / (2 * width);
+      ThreadPool::ParallelFor(pairs, 1, [&bounds, width, chunks](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; i++) {
+          auto first = 2 * width * i;
+          auto middle = std::min(first + width, chunks);
+          auto last = std::min(first + 2 * width, chunks);
+          if (middle < last) {
+            std::inplace_merge(bounds[first], bounds[middle], bounds[last]);
+          }
+        }
+      });
+    }
+
+    InvalidateIterators();
+  }
+
+  std::int64_t GraceList::IndexOf(const Value& value) const
+  {
+    auto it = m_Data.end();
+    switch (value.GetType()) {
+      // Ints and Strings are the common cases, so compare them directly instead of through Value::operator==
+      case Value::Type::Int: {
+        auto needle = value.Get<std::int64_t>();
+        it = std::find_if(m_Data.begin(), m_Data.end(), [needle, &value](const Value& element) {
+          return element.GetType() == Value::Type::Int ? element.Get<std::int64_t>() == needle : element == value;
+        });
+        break;
+      }
+      case Value::Type::String: {
+        const auto& needle = value.Get<std::string>();
+        it = std::find_if(m_Data.begin(), m_Data.end(), [&needle, &value](const Value& element) {
+          return element.GetType() == Value::Type::String ? element.Get<std::string>() == needle : element == value;
+        });
+        break;
+      }
+      default:
+        it = std::find(m_Data.begin(), m_Data.end(), value);
+        break;
+    }
+
+    return it == m_Data.end() ? -1 : static_cast<std::int64_t>(it - m_Data.begin());
   }
 
-  void GraceList::Print(bool err) const
+  void GraceList::Reverse()
   {
-    auto stream = err ? stderr : stdout;
-    fmt::print(stream, "{}", ToString());
+    ThrowIfFrozen();
+    std::reverse(m_Data.begin(), m_Data.end());
+    InvalidateIterators();
+  }
+
+  void GraceList::Extend(const GraceList& other)
+  {
+    ThrowIfFrozen();
+    // other can be this List, so take the size before anything is added
+    auto count = other.m_Data.size();
+    m_Data.reserve(m_Data.size() + count);
+    for (std::size_t i = 0; i < count; i++) {
+      m_Data.push_back(other.m_Data[i]);
+    }
+    InvalidateIterators();
   }
 
-  void GraceList::PrintLn(bool err) const
+  void GraceList::Fill(const Value& value)
   {
-    auto stream = err ? stderr : stdout;
-    fmt::print(stream, "{}\n", ToString());
+    ThrowIfFrozen();
+    std::fill(m_Data.begin(), m_Data.end(), value);
   }
 
-  std::string GraceList::ToString() const
+  std::vector<Value> GraceList::Slice(std::size_t start, std::size_t length) const
   {
-    std::string res = "[";
+    if (start > m_Data.size() || length > m_Data.size() - start) {
+      throw GraceException(
+        GraceException::Type::IndexOutOfRange,
+        fmt::format("Cannot slice {} items from index {} of a List of length {}", length, start, m_Data.size())
+      );
+    }
+
+    auto first = m_Data.begin() + static_cast<std::ptrdiff_t>(start);
+    return std::vector<Value>(first, first + static_cast<std::ptrdiff_t>(length));
+  }
+
+  void GraceList::DebugPrint() const
+  {
+    fmt::print("GraceList: {}\n", ToString());
+  }
+
+  void GraceList::Write(OutputBuffer& sink) const
+  {
+    sink.Write('[');
     for (std::size_t i = 0; i < m_Data.size(); i++) {
-      const auto& el = m_Data[i];
-      switch (el.GetType()) {
-        case Value::Type::Char:
-          res.push_back('\'');
-          res.push_back(el.Get<char>());
-          res.push_back('\'');
-          break;
-        case Value::Type::String:
-          res.push_back('"');
-          res.append(el.Get<std::string>());
-          res.push_back('"');
-          break;
-        case Value::Type::Object: {
-          auto object = el.GetObject();
-          auto type = object->ObjectType();
-          if (type == GraceObjectType::Exception || type == GraceObjectType::Iterator || type == GraceObjectType::Instance) {
-            res.append(object->ToString());
-          } else {
-            std::vector<GraceObject*> visisted;
-            if (AnyMemberMatchesRecursive(this, object, visisted)) {
-              switch (type) {
-                case GraceObjectType::Dictionary:
-                case GraceObjectType::Set:
-                  res.append("{...}");
-                  break;
-                case GraceObjectType::List:
-                  res.append("[...]");
-                  break;
-                case GraceObjectType::KeyValuePair:
-                  res.append("(...)");
-                  break;
-                default:
-                  GRACE_UNREACHABLE();
-                  break;
-              }
-            } else {
-              res.append(object->ToString());
-            }
-          }
-          break;
-        }
-        default:
-          res.append(el.AsString());
-          break;
-      }
+      WriteMember(sink, m_Data[i]);
       if (i < m_Data.size() - 1) {
-        res.append(", ");
+        sink.Write(", ");
       }
     }
-    res.push_back(']');
-    return res;
+    sink.Write(']');
   }
 
   bool GraceList::AsBool() const
@@ -40,6 +40,7 @@ namespace Grace
       template<VM::BuiltinGraceType T>
       GRACE_INLINE void Append(const T& value)
       {
+        ThrowIfFrozen();
         m_Data.emplace_back(value);
         InvalidateIterators();
       }
@@ -55,6 +56,19 @@ namespace Grace
 
       void Sort();
       void SortDescending();
+      // sorts chunks of the List on the ThreadPool and merges them, only numbers and Chars are sorted in parallel
+      // anything else, or a List too short to be worth it, goes through Sort()
+      void ParallelSort();
+
+      // -1 if the value isn't in the List
+      GRACE_NODISCARD std::int64_t IndexOf(const VM::Value& value) const;
+
+      void Reverse();
+      void Extend(const GraceList& other);
+      void Fill(const VM::Value& value);
+
+      // `length` items from `start`, which must all be in range
+      GRACE_NODISCARD std::vector<VM::Value> Slice(std::size_t start, std::size_t length) const;
 
       GRACE_NODISCARD GRACE_INLINE std::size_t Length() const
       {
@@ -77,9 +91,7 @@ namespace Grace
       }
 
       void DebugPrint() const override;
-      void Print(bool err) const override;
-      void PrintLn(bool err) const override;
-      GRACE_NODISCARD std::string ToString() const override;
+      void Write(OutputBuffer& sink) const override;
       GRACE_NODISCARD bool AsBool() const override;      
 
       GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
@@ -126,6 +138,12 @@ namespace Grace
         return m_Data[index];
       }
 
+      // For indices that have already been checked, e.g. by a Range the optimiser has proven covers them
+      GRACE_NODISCARD GRACE_INLINE VM::Value& GetUnchecked(std::size_t index)
+      {
+        return m_Data[index];
+      }
+
       GRACE_INLINE const VM::Value& First() const
       {
         if (m_Data.empty()) {
@@ -0,0 +1,70 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the GraceObject class.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include "grace_object.hpp"
+#include "../value.hpp"
+
+namespace Grace
+{
+  void GraceObject::WriteMember(OutputBuffer& sink, const VM::Value& member) const
+  {
+    switch (member.GetType()) {
+      case VM::Value::Type::Char:
+        sink.Write('\'');
+        sink.Write(member.Get<char>());
+        sink.Write('\'');
+        break;
+      case VM::Value::Type::String:
+        sink.Write('"');
+        sink.Write(member.Get<std::string>());
+        sink.Write('"');
+        break;
+      case VM::Value::Type::Object: {
+        auto object = member.GetObject();
+        auto type = object->ObjectType();
+        if (type == GraceObjectType::Exception || type == GraceObjectType::Iterator || type == GraceObjectType::Instance || type == GraceObjectType::Range
+          || type == GraceObjectType::File || type == GraceObjectType::FileLines || type == GraceObjectType::Bytes
+          || type == GraceObjectType::CsvRows || type == GraceObjectType::StringBuilder
+          || type == GraceObjectType::Channel || type == GraceObjectType::Thread || type == GraceObjectType::Generator
+          || type == GraceObjectType::Fiber || type == GraceObjectType::Stream || type == GraceObjectType::Process) {
+          object->Write(sink);
+          break;
+        }
+
+        std::unordered_set<GraceObject*> visited;
+        if (!AnyMemberMatchesRecursive(this, object, visited)) {
+          object->Write(sink);
+          break;
+        }
+
+        switch (type) {
+          case GraceObjectType::Dictionary:
+          case GraceObjectType::Set:
+            sink.Write("{...}");
+            break;
+          case GraceObjectType::List:
+            sink.Write("[...]");
+            break;
+          case GraceObjectType::KeyValuePair:
+            sink.Write("(...)");
+            break;
+          default:
+            GRACE_UNREACHABLE();
+            break;
+        }
+        break;
+      }
+      default:
+        member.Write(sink);
+        break;
+    }
+  }
+} // namespace Grace
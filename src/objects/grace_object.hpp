@@ -12,13 +12,16 @@
 #ifndef GRACE_OBJECT_HPP
 #define GRACE_OBJECT_HPP
 
+#include <algorithm>
 #include <cstdint>
 #include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_set>
 #include <vector>
 
 #include "../grace.hpp"
+#include "../output_buffer.hpp"
 
 namespace Grace 
 {
@@ -37,6 +40,17 @@ namespace Grace
     Range,
     Instance,
     Iterator,
+    File,
+    FileLines,
+    Bytes,
+    CsvRows,
+    StringBuilder,
+    Channel,
+    Thread,
+    Generator,
+    Fiber,
+    Stream,
+    Process,
   };
 
   class GraceList;
@@ -47,6 +61,17 @@ namespace Grace
   class GraceRange;
   class GraceIterator;
   class GraceSet;
+  class GraceFile;
+  class GraceFileLines;
+  class GraceBytes;
+  class GraceCsvRows;
+  class GraceStringBuilder;
+  class GraceChannel;
+  class GraceThread;
+  class GraceGenerator;
+  class GraceFiber;
+  class GraceStream;
+  class GraceProcess;
 
   class GraceObject
   {
@@ -58,26 +83,69 @@ namespace Grace
       virtual ~GraceObject() = default;
 
       virtual void DebugPrint() const = 0;
-      virtual void Print(bool err) const = 0;
-      virtual void PrintLn(bool err) const = 0;
-      GRACE_NODISCARD virtual std::string ToString() const = 0;
+      // writes the object as it is printed, objects are written straight into the output instead of becoming a string first
+      virtual void Write(OutputBuffer& sink) const = 0;
+
+      GRACE_NODISCARD std::string ToString() const
+      {
+        OutputBuffer sink;
+        Write(sink);
+        return sink.TakeString();
+      }
+
       GRACE_NODISCARD virtual bool AsBool() const = 0;
       GRACE_NODISCARD virtual constexpr std::string_view ObjectName() const = 0;
       GRACE_NODISCARD virtual constexpr bool IsIterable() const = 0;
       GRACE_NODISCARD virtual constexpr GraceObjectType ObjectType() const = 0;
 
+      // a frozen object belongs to a `const`, so it lives for the whole program and can be shared by every thread
+      // its count is left alone so that threads don't race on it, and it never reaches 0
       GRACE_INLINE std::uint32_t IncreaseRef()
       {
-        return ++m_RefCount;
+        return m_Frozen ? m_RefCount : ++m_RefCount;
       }
 
       GRACE_INLINE std::uint32_t DecreaseRef()
       {
-        return --m_RefCount;
+        return m_Frozen ? m_RefCount : --m_RefCount;
       }
 
       GRACE_NODISCARD GRACE_INLINE std::uint32_t RefCount() const { return m_RefCount; }
 
+      // the size this object was allocated with if it lives in the ObjectArena, otherwise 0
+      GRACE_NODISCARD GRACE_INLINE std::uint32_t ArenaSize() const { return m_ArenaSize; }
+      GRACE_INLINE void SetArenaSize(std::uint32_t size) { m_ArenaSize = size; }
+
+      // where this object is in the ObjectTracker's list, so it can stop being tracked without searching for it
+      static constexpr std::size_t s_Untracked = static_cast<std::size_t>(-1);
+      GRACE_NODISCARD GRACE_INLINE std::size_t TrackerIndex() const { return m_TrackerIndex; }
+      GRACE_INLINE void SetTrackerIndex(std::size_t index) { m_TrackerIndex = index; }
+
+      // the value of a `const` is worked out at compile time and shared by every use of it, so it must never change
+      // returns false if the object can't be frozen, along with anything it contains
+      virtual bool Freeze()
+      {
+        m_Frozen = true;
+        return true;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE bool IsFrozen() const { return m_Frozen; }
+
+      // only containers can refer to other objects, everything else is a leaf as far as cycles are concerned
+      GRACE_NODISCARD GRACE_INLINE bool HasObjectMembers() const
+      {
+        switch (ObjectType()) {
+          case GraceObjectType::List:
+          case GraceObjectType::Dictionary:
+          case GraceObjectType::KeyValuePair:
+          case GraceObjectType::Set:
+          case GraceObjectType::Instance:
+            return true;
+          default:
+            return false;
+        }
+      }
+
       // it would be nice to give more detailed messages here, but ObjectName() can't be called here
       // and I couldn't be bothered making them pure virtual and implementing them in every class
       GRACE_NODISCARD virtual bool AnyMemberMatches(GRACE_MAYBE_UNUSED const GraceObject* match) const
@@ -112,16 +180,27 @@ namespace Grace
       GRACE_NODISCARD GRACE_INLINE virtual GraceIterator* GetAsIterator() { return nullptr; }
       GRACE_NODISCARD GRACE_INLINE virtual GraceSet* GetAsSet() { return nullptr; }
       GRACE_NODISCARD GRACE_INLINE virtual GraceRange* GetAsRange() { return nullptr; }
-
-
-      GRACE_NODISCARD static bool AnyMemberMatchesRecursive(const GraceObject* toFind, GraceObject* root, std::vector<GraceObject*>& visitedObjects)
+      GRACE_NODISCARD GRACE_INLINE virtual GraceFile* GetAsFile() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceFileLines* GetAsFileLines() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceBytes* GetAsBytes() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceCsvRows* GetAsCsvRows() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceStringBuilder* GetAsStringBuilder() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceChannel* GetAsChannel() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceThread* GetAsThread() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceGenerator* GetAsGenerator() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceFiber* GetAsFiber() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceStream* GetAsStream() { return nullptr; }
+      GRACE_NODISCARD GRACE_INLINE virtual GraceProcess* GetAsProcess() { return nullptr; }
+
+
+      // a sweep can walk every object in the program from one root, so the visited objects need constant time lookup
+      GRACE_NODISCARD static bool AnyMemberMatchesRecursive(const GraceObject* toFind, GraceObject* root, std::unordered_set<GraceObject*>& visitedObjects)
       {
         for (auto object : root->GetObjectMembers()) {
           if (object == toFind) {
             return true;
           } else {
-            if (std::find(visitedObjects.begin(), visitedObjects.end(), object) == visitedObjects.end()) {
-              visitedObjects.push_back(object);
+            if (object->HasObjectMembers() && visitedObjects.insert(object).second) {
               if (AnyMemberMatchesRecursive(toFind, object, visitedObjects)) {
                 return true;
               }
@@ -133,7 +212,14 @@ namespace Grace
       }
 
     protected:
+
+      // writes a member of a container, Strings and Chars are quoted and members that contain this are abbreviated
+      void WriteMember(OutputBuffer& sink, const VM::Value& member) const;
+
       std::uint32_t m_RefCount = 0;      
+      std::uint32_t m_ArenaSize = 0;
+      std::size_t m_TrackerIndex = s_Untracked;
+      bool m_Frozen = false;
   };
 } // namespace Grace
 
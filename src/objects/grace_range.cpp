@@ -77,21 +77,9 @@ namespace Grace
     fmt::print("Range: {}, current {}\n", ToString(), m_Data[m_Current]);
   }
 
-  void GraceRange::Print(bool err) const
+  void GraceRange::Write(OutputBuffer& sink) const
   {
-    auto stream = err ? stdout : stderr;
-    fmt::print(stream, "{}", ToString());
-  }
-
-  void GraceRange::PrintLn(bool err) const
-  {
-    auto stream = err ? stdout : stderr;
-    fmt::print(stream, "{}\n", ToString());
-  }
-
-  GRACE_NODISCARD std::string GraceRange::ToString() const
-  {
-    return fmt::format("[{}..{} by {}]", m_Min, m_Max, m_Increment);
+    sink.Format("[{}..{} by {}]", m_Min, m_Max, m_Increment);
   }
   
   GRACE_NODISCARD bool GraceRange::AsBool() const
@@ -119,4 +107,15 @@ namespace Grace
   {
     return m_Direction ? m_Data[m_Current] >= m_Max : m_Data[m_Current] <= m_Max;
   }
+
+  bool GraceRange::IndexesWithin(std::size_t length) const
+  {
+    // the constructor has already checked these are all Ints
+    auto minVal = m_Min.Get<std::int64_t>();
+    auto maxVal = m_Max.Get<std::int64_t>();
+    auto incVal = m_Increment.Get<std::int64_t>();
+
+    // iteration stops at the first value >= max, so counting up from min every value is in [min, max)
+    return incVal > 0 && minVal >= 0 && minVal < maxVal && static_cast<std::size_t>(maxVal) <= length;
+  }
 }
\ No newline at end of file
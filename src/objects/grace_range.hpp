@@ -25,9 +25,7 @@ namespace Grace
 	  ~GraceRange() override;
 
     void DebugPrint() const override;
-    void Print(bool err) const override;
-    void PrintLn(bool err) const override;
-    GRACE_NODISCARD std::string ToString() const override;
+    void Write(OutputBuffer& sink) const override;
     GRACE_NODISCARD bool AsBool() const override;
 
     GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
@@ -62,6 +60,9 @@ namespace Grace
 
     void IncrementIterator(IteratorType& toIncrement) override;
     bool IsAtEnd(const IteratorType& iterator) const override;
+
+    // Whether every value iterating over this Range gives is a valid index into a collection of the given length
+    GRACE_NODISCARD bool IndexesWithin(std::size_t length) const;
     
   private:
     
@@ -83,6 +83,7 @@ namespace Grace
 
   void GraceSet::Add(VM::Value&& value)
   {
+    ThrowIfFrozen();
     auto fullness = static_cast<float>(m_Size) / static_cast<float>(m_Capacity);
     if (fullness > s_GrowFactor) {
       m_Capacity *= 2;
@@ -165,73 +166,16 @@ namespace Grace
     fmt::print("Set: {}\n", ToString());
   }
 
-  void GraceSet::Print(bool err) const
+  void GraceSet::Write(OutputBuffer& sink) const
   {
-    auto stream = err ? stderr : stdout;
-    fmt::print(stream, "{}", ToString());
-  }
-
-  void GraceSet::PrintLn(bool err) const
-  {
-    auto stream = err ? stderr : stdout;
-    fmt::print(stream, "{}\n", ToString());
-  }
-
-  std::string GraceSet::ToString() const
-  {
-    std::string res = "{";
+    sink.Write('{');
     for (std::size_t i = 0; i < m_Data.size(); i++) {
-      const auto& el = m_Data[i];
-      switch (el.GetType()) {
-        case VM::Value::Type::Char:
-          res.push_back('\'');
-          res.push_back(el.Get<char>());
-          res.push_back('\'');
-          break;
-        case VM::Value::Type::String:
-          res.push_back('"');
-          res.append(el.Get<std::string>());
-          res.push_back('"');
-          break;
-        case VM::Value::Type::Object: {
-          auto object = el.GetObject();
-          auto type = object->ObjectType();
-          if (type == GraceObjectType::Exception || type == GraceObjectType::Iterator || type == GraceObjectType::Instance) {
-            res.append(object->ToString());
-          } else {
-            std::vector<GraceObject*> visisted;
-            if (AnyMemberMatchesRecursive(this, object, visisted)) {
-              switch (type) {
-                case GraceObjectType::Dictionary:
-                case GraceObjectType::Set:
-                  res.append("{...}");
-                  break;
-                case GraceObjectType::List:
-                  res.append("[...]");
-                  break;
-                case GraceObjectType::KeyValuePair:
-                  res.append("(...)");
-                  break;
-                default:
-                  GRACE_UNREACHABLE();
-                  break;
-              }
-            } else {
-              res.append(object->ToString());
-            }
-          }
-          break;
-        }
-        default:
-          res.append(el.AsString());
-          break;
-      }
+      WriteMember(sink, m_Data[i]);
       if (i < m_Data.size() - 1) {
-        res.append(", ");
+        sink.Write(", ");
       }
     }
-    res.push_back('}');
-    return res;
+    sink.Write('}');
   }
 
   GRACE_NODISCARD bool GraceSet::AsBool() const
@@ -34,9 +34,7 @@ namespace Grace
       }
 
       void DebugPrint() const override;
-      void Print(bool err) const override;
-      void PrintLn(bool err) const override;
-      GRACE_NODISCARD std::string ToString() const override;
+      void Write(OutputBuffer& sink) const override;
       GRACE_NODISCARD bool AsBool() const override;
 
       GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
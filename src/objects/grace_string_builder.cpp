@@ -0,0 +1,55 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the GraceStringBuilder class.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <charconv>
+
+#include <fmt/core.h>
+
+#include "grace_string_builder.hpp"
+
+namespace Grace
+{
+  void GraceStringBuilder::DebugPrint() const
+  {
+    fmt::print("StringBuilder: {}\n", m_Buffer);
+  }
+
+  void GraceStringBuilder::Write(OutputBuffer& sink) const
+  {
+    sink.Write(m_Buffer);
+  }
+
+  bool GraceStringBuilder::AsBool() const
+  {
+    return !m_Buffer.empty();
+  }
+
+  void GraceStringBuilder::Append(const VM::Value& value)
+  {
+    switch (value.GetType()) {
+      case VM::Value::Type::String:
+        m_Buffer.append(value.Get<std::string>());
+        break;
+      case VM::Value::Type::Char:
+        m_Buffer.push_back(value.Get<char>());
+        break;
+      case VM::Value::Type::Int: {
+        char digits[20];
+        auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value.Get<std::int64_t>());
+        m_Buffer.append(digits, end);
+        break;
+      }
+      default:
+        m_Buffer.append(value.AsString());
+        break;
+    }
+  }
+} // namespace Grace
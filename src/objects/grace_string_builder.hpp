@@ -0,0 +1,74 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the GraceStringBuilder class, which builds up a String in one growing buffer
+ *  instead of making a new String for every `+`.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_STRING_BUILDER_HPP
+#define GRACE_STRING_BUILDER_HPP
+
+#include <string>
+#include <string_view>
+
+#include "grace_object.hpp"
+#include "../value.hpp"
+
+namespace Grace
+{
+  class GraceStringBuilder : public GraceObject
+  {
+    public:
+
+      GraceStringBuilder() = default;
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "StringBuilder";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return false;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::StringBuilder;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceStringBuilder* GetAsStringBuilder() override
+      {
+        return this;
+      }
+
+      // Strings and Chars are copied straight in, anything else is added as it would be printed
+      void Append(const VM::Value& value);
+
+      GRACE_INLINE void Clear()
+      {
+        m_Buffer.clear();
+      }
+
+      GRACE_NODISCARD GRACE_INLINE const std::string& Buffer() const
+      {
+        return m_Buffer;
+      }
+
+    private:
+
+      // std::string grows geometrically, and keeps its capacity through Clear() so a builder can be reused
+      std::string m_Buffer;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_STRING_BUILDER_HPP
@@ -0,0 +1,180 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the GraceThread and GraceChannel classes.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include "grace_thread.hpp"
+#include "grace_exception.hpp"
+#include "object_tracker.hpp"
+
+namespace Grace
+{
+  using namespace VM;
+
+  ThreadMessage ThreadMessage::Encode(const Value& value)
+  {
+    ThreadMessage message;
+    message.data = Serialize::Encode(value, &message.channels);
+    return message;
+  }
+
+  Value ThreadMessage::Decode() const
+  {
+    return Serialize::Decode(data, &channels);
+  }
+
+  GraceChannel::GraceChannel(std::shared_ptr<ChannelState> state)
+    : m_State(std::move(state))
+  {
+
+  }
+
+  void GraceChannel::DebugPrint() const
+  {
+    fmt::print("Channel: {}\n", ToString());
+  }
+
+  void GraceChannel::Write(OutputBuffer& sink) const
+  {
+    std::lock_guard lock(m_State->mutex);
+    sink.Format("<Channel ({} waiting{})>", m_State->messages.size(), m_State->closed ? ", closed" : "");
+  }
+
+  bool GraceChannel::AsBool() const
+  {
+    std::lock_guard lock(m_State->mutex);
+    return !m_State->closed;
+  }
+
+  void GraceChannel::Send(const Value& value)
+  {
+    // encoded before locking, so other threads aren't held up while a large value is written out
+    auto message = ThreadMessage::Encode(value);
+    {
+      std::lock_guard lock(m_State->mutex);
+      if (m_State->closed) {
+        throw GraceException(
+          GraceException::Type::InvalidCollectionOperation,
+          "Cannot send on a Channel that has been closed"
+        );
+      }
+      m_State->messages.push_back(std::move(message));
+    }
+    m_State->ready.notify_one();
+  }
+
+  std::optional<Value> GraceChannel::Receive()
+  {
+    ThreadMessage message;
+    {
+      std::unique_lock lock(m_State->mutex);
+      m_State->ready.wait(lock, [this] { return !m_State->messages.empty() || m_State->closed; });
+      if (m_State->messages.empty()) {
+        return std::nullopt;
+      }
+      message = std::move(m_State->messages.front());
+      m_State->messages.pop_front();
+    }
+    return message.Decode();
+  }
+
+  std::optional<Value> GraceChannel::TryReceive()
+  {
+    ThreadMessage message;
+    {
+      std::lock_guard lock(m_State->mutex);
+      if (m_State->messages.empty()) {
+        return std::nullopt;
+      }
+      message = std::move(m_State->messages.front());
+      m_State->messages.pop_front();
+    }
+    return message.Decode();
+  }
+
+  void GraceChannel::Close()
+  {
+    {
+      std::lock_guard lock(m_State->mutex);
+      m_State->closed = true;
+    }
+    // anything waiting on an empty Channel would otherwise wait forever
+    m_State->ready.notify_all();
+  }
+
+  GraceThread::GraceThread(std::string functionName, std::function<ThreadMessage()>&& body)
+    : m_FunctionName(std::move(functionName))
+  {
+    m_Thread = std::thread([this, body = std::move(body)]() {
+      try {
+        m_Result = body();
+      } catch (const GraceException& e) {
+        m_Error = e.Message();
+      } catch (const std::exception& e) {
+        // anything else escaping the thread would call std::terminate and take the whole program with it
+        m_Error = fmt::format("Unexpected error: {}", e.what());
+      } catch (...) {
+        m_Error = "Unexpected error";
+      }
+
+      // everything the thread made has gone out of scope by now, so this only cleans up cycles left in its heap
+      ObjectTracker::Finalise();
+    });
+  }
+
+  GraceThread::~GraceThread()
+  {
+    if (m_Thread.joinable()) {
+      m_Thread.join();
+    }
+  }
+
+  void GraceThread::DebugPrint() const
+  {
+    fmt::print("Thread: {}\n", ToString());
+  }
+
+  void GraceThread::Write(OutputBuffer& sink) const
+  {
+    sink.Format("<Thread running `{}`{}>", m_FunctionName, m_Joined ? " (joined)" : "");
+  }
+
+  bool GraceThread::AsBool() const
+  {
+    return !m_Joined;
+  }
+
+  Value GraceThread::Join()
+  {
+    if (m_Joined) {
+      throw GraceException(
+        GraceException::Type::ThreadFailed,
+        fmt::format("The Thread running `{}` has already been joined", m_FunctionName)
+      );
+    }
+
+    m_Thread.join();
+    m_Joined = true;
+
+    if (m_Error) {
+      throw GraceException(
+        GraceException::Type::ThreadFailed,
+        fmt::format("`{}` failed on its Thread: {}", m_FunctionName, *m_Error)
+      );
+    }
+
+    // the result only needs decoding once, so its memory can go straight away
+    auto result = m_Result.Decode();
+    m_Result = {};
+    return result;
+  }
+} // namespace Grace
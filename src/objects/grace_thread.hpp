@@ -0,0 +1,158 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the GraceThread and GraceChannel classes behind std::thread.
+ *  Every thread has its own heap and ObjectTracker, so no object is ever shared between threads,
+ *  values are serialised on the way in and rebuilt on the other side instead.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_THREAD_HPP
+#define GRACE_THREAD_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "grace_object.hpp"
+#include "../serialize.hpp"
+#include "../value.hpp"
+
+namespace Grace
+{
+  // a value on its way to another thread, which the receiving thread decodes into its own heap
+  struct ThreadMessage
+  {
+    std::string data;
+    Serialize::ChannelList channels;
+
+    GRACE_NODISCARD static ThreadMessage Encode(const VM::Value& value);
+    GRACE_NODISCARD VM::Value Decode() const;
+  };
+
+  // shared by the GraceChannels on every thread that has been given the same Channel
+  struct ChannelState
+  {
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<ThreadMessage> messages;
+    bool closed = false;
+  };
+
+  class GraceChannel : public GraceObject
+  {
+    public:
+
+      explicit GraceChannel(std::shared_ptr<ChannelState> state = std::make_shared<ChannelState>());
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "Channel";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return false;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::Channel;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceChannel* GetAsChannel() override
+      {
+        return this;
+      }
+
+      bool Freeze() override
+      {
+        return false;
+      }
+
+      // the value is copied as it is now, changing it afterwards doesn't change what the receiver gets
+      void Send(const VM::Value& value);
+      // waits until there is a message, gives back nothing once the Channel is closed and empty
+      GRACE_NODISCARD std::optional<VM::Value> Receive();
+      // gives back nothing straight away if there is no message waiting
+      GRACE_NODISCARD std::optional<VM::Value> TryReceive();
+      // messages already sent can still be received, but no more can be sent
+      void Close();
+
+      GRACE_NODISCARD GRACE_INLINE const std::shared_ptr<ChannelState>& State() const
+      {
+        return m_State;
+      }
+
+    private:
+
+      std::shared_ptr<ChannelState> m_State;
+  };
+
+  class GraceThread : public GraceObject
+  {
+    public:
+
+      // body runs on the new thread and gives back its encoded result, or throws if it failed
+      GraceThread(std::string functionName, std::function<ThreadMessage()>&& body);
+      // joins the thread if nothing else has, so it never outlives its handle
+      ~GraceThread() override;
+
+      void DebugPrint() const override;
+      void Write(OutputBuffer& sink) const override;
+      GRACE_NODISCARD bool AsBool() const override;
+
+      GRACE_NODISCARD GRACE_INLINE constexpr std::string_view ObjectName() const override
+      {
+        return "Thread";
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr bool IsIterable() const override
+      {
+        return false;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE constexpr GraceObjectType ObjectType() const override
+      {
+        return GraceObjectType::Thread;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE GraceThread* GetAsThread() override
+      {
+        return this;
+      }
+
+      bool Freeze() override
+      {
+        return false;
+      }
+
+      // waits for the thread to finish and gives back its result, decoded into the calling thread's heap
+      // throws if the thread failed or has already been joined
+      GRACE_NODISCARD VM::Value Join();
+
+    private:
+
+      std::string m_FunctionName;
+      // only touched by the thread until it has been joined
+      ThreadMessage m_Result;
+      std::optional<std::string> m_Error;
+      std::thread m_Thread;
+      bool m_Joined = false;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_THREAD_HPP
@@ -0,0 +1,72 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the ObjectArena
+ *  
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <memory>
+#include <vector>
+
+#include "object_arena.hpp"
+#include "grace_object.hpp"
+
+using namespace Grace;
+
+static constexpr std::size_t s_BlockSize = 64 * 1024;
+static constexpr std::size_t s_Alignment = alignof(std::max_align_t);
+
+// each thread allocates from its own blocks, the same as it has its own ObjectTracker
+static thread_local std::vector<std::unique_ptr<std::byte[]>> s_Blocks;
+static thread_local std::size_t s_BlockOffset = s_BlockSize;
+
+// freed memory, indexed by size / s_Alignment
+static thread_local std::vector<std::vector<void*>> s_FreeLists;
+
+static std::size_t SizeClass(std::size_t size)
+{
+  return (size + s_Alignment - 1) / s_Alignment;
+}
+
+void* ObjectArena::Allocate(std::size_t size)
+{
+  auto sizeClass = SizeClass(size);
+  GRACE_ASSERT(sizeClass * s_Alignment <= s_BlockSize, "Object is too big for the arena");
+
+  if (sizeClass < s_FreeLists.size() && !s_FreeLists[sizeClass].empty()) {
+    auto memory = s_FreeLists[sizeClass].back();
+    s_FreeLists[sizeClass].pop_back();
+    return memory;
+  }
+
+  if (s_BlockOffset + sizeClass * s_Alignment > s_BlockSize) {
+    // new[] of std::byte is aligned to at least alignof(std::max_align_t)
+    s_Blocks.emplace_back(new std::byte[s_BlockSize]);
+    s_BlockOffset = 0;
+  }
+
+  auto memory = s_Blocks.back().get() + s_BlockOffset;
+  s_BlockOffset += sizeClass * s_Alignment;
+  return memory;
+}
+
+void ObjectArena::Deallocate(void* memory, std::size_t size)
+{
+  auto sizeClass = SizeClass(size);
+  if (sizeClass >= s_FreeLists.size()) {
+    s_FreeLists.resize(sizeClass + 1);
+  }
+  s_FreeLists[sizeClass].push_back(memory);
+}
+
+void ObjectArena::Destroy(GraceObject* object)
+{
+  auto size = object->ArenaSize();
+  GRACE_ASSERT(size != 0, "Trying to destroy an object that wasn't allocated in the arena");
+  object->~GraceObject();
+  Deallocate(object, size);
+}
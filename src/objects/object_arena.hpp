@@ -0,0 +1,36 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the ObjectArena, which holds GraceObjects the optimiser has proven never escape the Function that creates them
+ *  
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_OBJECT_ARENA_HPP
+#define GRACE_OBJECT_ARENA_HPP
+
+#include <cstddef>
+
+#include "../grace.hpp"
+
+namespace Grace
+{
+  class GraceObject;
+
+  // Objects in the arena aren't seen by the ObjectTracker, since something that never escapes can't end up in a cycle.
+  // Memory is carved out of large blocks and recycled by size when an object dies, so short lived objects created in a loop
+  // keep reusing the same few slots instead of going through `new` and `delete`.
+  namespace ObjectArena
+  {
+    GRACE_NODISCARD void* Allocate(std::size_t size);
+    void Deallocate(void* memory, std::size_t size);
+
+    // Calls the object's destructor and gives its memory back to the arena
+    void Destroy(GraceObject* object);
+  } // namespace ObjectArena
+} // namespace Grace
+
+#endif  // ifndef GRACE_OBJECT_ARENA_HPP
@@ -19,20 +19,33 @@
 
 using namespace Grace;
 
-static bool s_Enabled = true;
-static bool s_Verbose = false;
-static std::vector<GraceObject*> s_TrackedObjects;
+// every thread running Grace code has its own heap, so nothing here is shared between threads
+// objects never move between threads, values are serialised across instead, so each tracker only ever sees its own
+static thread_local bool s_Enabled = true;
+static thread_local bool s_Verbose = false;
+static thread_local std::vector<GraceObject*> s_TrackedObjects;
 
-static std::size_t s_NextSweepThreshold = 8;
-static std::size_t s_GrowFactor = 2;
+static thread_local std::size_t s_NextSweepThreshold = 8;
+static thread_local std::size_t s_GrowFactor = 2;
 
 #ifdef GRACE_DEBUG
 // track every single object that gets allocated but never remove any so we can
 // set a breakpoint and make sure they're all garbage at the end of the program
-static std::vector<GraceObject*> s_AllObjects;
+static thread_local std::vector<GraceObject*> s_AllObjects;
 #endif
 
-static bool s_CycleCleanerRunning;
+static thread_local bool s_CycleCleanerRunning;
+
+// the order of tracked objects doesn't matter, so the last one can be moved into the gap
+static void RemoveTrackedObject(GraceObject* object)
+{
+  auto index = object->TrackerIndex();
+  auto last = s_TrackedObjects.back();
+  s_TrackedObjects[index] = last;
+  last->SetTrackerIndex(index);
+  s_TrackedObjects.pop_back();
+  object->SetTrackerIndex(GraceObject::s_Untracked);
+}
 
 static void CleanCycles();
 static void CleanCyclesInternal();
@@ -86,8 +99,8 @@ std::size_t ObjectTracker::GetThreshold()
 void ObjectTracker::TrackObject(GraceObject* object)
 {
   GRACE_ASSERT(object != nullptr, "Trying to track an object that is a nullptr");
-  GRACE_ASSERT(std::find(s_TrackedObjects.begin(), s_TrackedObjects.end(), object) == s_TrackedObjects.end(), 
-    "Object is already being tracked");
+  GRACE_ASSERT(object->TrackerIndex() == GraceObject::s_Untracked, "Object is already being tracked");
+  object->SetTrackerIndex(s_TrackedObjects.size());
   s_TrackedObjects.push_back(object);
 
 #ifdef GRACE_DEBUG
@@ -107,11 +120,9 @@ void ObjectTracker::TrackObject(GraceObject* object)
 void ObjectTracker::StopTrackingObject(GraceObject* object)
 {
   GRACE_ASSERT(object != nullptr, "Trying to stop tracking an object that is a nullptr");
-  auto it = std::find(s_TrackedObjects.begin(), s_TrackedObjects.end(), object);
-
-  if (it != s_TrackedObjects.end()) {
+  if (object->TrackerIndex() != GraceObject::s_Untracked) {
     // this function could get called from the Value destructor after the object has already been removed by CleanCycles()
-    s_TrackedObjects.erase(it);
+    RemoveTrackedObject(object);
 
     if (s_Verbose) {
       fmt::print(stderr, "Stopped tracking on object at {}: ", fmt::ptr(object));
@@ -141,9 +152,8 @@ static void CleanObjects(const std::vector<VM::Value>& objectsToBeDeleted)
 {
   for (auto& value : objectsToBeDeleted) {
     auto object = value.GetObject();
-    auto it = std::find(s_TrackedObjects.begin(), s_TrackedObjects.end(), object);
-    if (it != s_TrackedObjects.end()) {
-      s_TrackedObjects.erase(it);
+    if (object->TrackerIndex() != GraceObject::s_Untracked) {
+      RemoveTrackedObject(object);
     }
 
     for (auto member : object->GetObjectMembers()) {
@@ -197,14 +207,14 @@ static void CleanCyclesInternal()
   for (std::size_t i = 0; i < s_TrackedObjects.size(); i++) {
     auto root = s_TrackedObjects[i];
 
-    auto type = root->ObjectType();
-    if (type == GraceObjectType::Exception || type == GraceObjectType::Iterator || type == GraceObjectType::Range) {
-      // these objects don't have members/elements
+    if (!root->HasObjectMembers()) {
       continue;
     }
 
+    auto type = root->ObjectType();
+
     if (root->RefCount() > 1) {
-      if (type != GraceObjectType::Dictionary && root->OnlyReferenceIsSelf()) {
+      if (type != GraceObjectType::Dictionary && type != GraceObjectType::Set && root->OnlyReferenceIsSelf()) {
         objectsToBeDeleted.emplace_back(root);
         if (s_Verbose) {
           fmt::print(stderr, "Preparing to delete object at {}: ", fmt::ptr(root));
@@ -212,7 +222,7 @@ static void CleanCyclesInternal()
         }
       }
     } else {
-      std::vector<GraceObject*> visitedObjects;
+      std::unordered_set<GraceObject*> visitedObjects;
       if (GraceObject::AnyMemberMatchesRecursive(root, root, visitedObjects)) {
         objectsToBeDeleted.emplace_back(root);
         if (s_Verbose) {
@@ -244,9 +254,7 @@ static void CleanCyclesInternal()
   for (auto object : s_TrackedObjects) {
     if (object->RefCount() > 1) continue;
       
-    auto type = object->ObjectType();
-    if (type == GraceObjectType::Exception || type == GraceObjectType::Iterator || type == GraceObjectType::Range) {
-      // these objects don't have members/elements
+    if (!object->HasObjectMembers()) {
       continue;
     }
 
@@ -254,9 +262,7 @@ static void CleanCyclesInternal()
     for (auto member : members) {
       if (member->RefCount() > 1) continue;
 
-      auto memberType = member->ObjectType();
-      if (memberType == GraceObjectType::Exception || memberType == GraceObjectType::Iterator) {
-        // these objects don't have members/elements
+      if (!member->HasObjectMembers()) {
         continue;
       }
 
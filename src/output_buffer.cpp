@@ -0,0 +1,97 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the OutputBuffer class.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifdef GRACE_MSC
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+#include "output_buffer.hpp"
+
+namespace Grace
+{
+  OutputBuffer::OutputBuffer(std::FILE* stream, Mode mode, std::size_t capacity)
+    : m_Stream(stream), m_Mode(mode), m_Capacity(capacity)
+  {
+    m_Buffer.reserve(capacity);
+  }
+
+  OutputBuffer::~OutputBuffer()
+  {
+    Flush();
+  }
+
+  void OutputBuffer::EndPrint()
+  {
+    switch (m_Mode) {
+      case Mode::None:
+        Flush();
+        break;
+      case Mode::Line:
+        if (m_Buffer.find('\n', m_Unchecked) != std::string::npos) {
+          Flush();
+        } else {
+          m_Unchecked = m_Buffer.size();
+        }
+        break;
+      case Mode::Full:
+        FlushIfFull();
+        break;
+    }
+  }
+
+  void OutputBuffer::Flush()
+  {
+    if (m_Stream == nullptr) {
+      return;
+    }
+
+    if (!m_Buffer.empty()) {
+      std::fwrite(m_Buffer.data(), 1, m_Buffer.size(), m_Stream);
+      m_Buffer.clear();
+    }
+    m_Unchecked = 0;
+    std::fflush(m_Stream);
+  }
+
+  void OutputBuffer::SetMode(Mode mode, std::size_t capacity)
+  {
+    Flush();
+    m_Mode = mode;
+    m_Capacity = capacity;
+    m_Buffer.shrink_to_fit();
+    m_Buffer.reserve(capacity);
+  }
+
+  // every thread buffers its own output, std::fwrite locks the stream so a flush is never torn by another thread
+  OutputBuffer& OutputBuffer::Stdout()
+  {
+#ifdef GRACE_MSC
+    static thread_local OutputBuffer buffer(stdout, _isatty(_fileno(stdout)) ? Mode::Line : Mode::Full);
+#else
+    static thread_local OutputBuffer buffer(stdout, isatty(fileno(stdout)) ? Mode::Line : Mode::Full);
+#endif
+    return buffer;
+  }
+
+  OutputBuffer& OutputBuffer::Stderr()
+  {
+    static thread_local OutputBuffer buffer(stderr, Mode::None);
+    return buffer;
+  }
+
+  void OutputBuffer::FlushAll()
+  {
+    Stdout().Flush();
+    Stderr().Flush();
+  }
+} // namespace Grace
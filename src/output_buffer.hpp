@@ -0,0 +1,107 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the OutputBuffer class, which Values and objects write themselves into
+ *  so printing doesn't need a whole string built first or a call to the C library for every value.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_OUTPUT_BUFFER_HPP
+#define GRACE_OUTPUT_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "grace.hpp"
+
+namespace Grace
+{
+  class OutputBuffer
+  {
+    public:
+
+      enum class Mode
+      {
+        // flushed after every print
+        None,
+        // flushed after a print that wrote a newline
+        Line,
+        // flushed when full
+        Full,
+      };
+
+      static constexpr std::size_t s_DefaultCapacity = 64 * 1024;
+
+      // a buffer with no stream never flushes, it just collects what was written for TakeString()
+      OutputBuffer() = default;
+      OutputBuffer(std::FILE* stream, Mode mode, std::size_t capacity = s_DefaultCapacity);
+      ~OutputBuffer();
+
+      OutputBuffer(const OutputBuffer&) = delete;
+      OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+      GRACE_INLINE void Write(char c)
+      {
+        FlushIfFull();
+        m_Buffer.push_back(c);
+      }
+
+      GRACE_INLINE void Write(std::string_view text)
+      {
+        FlushIfFull();
+        m_Buffer.append(text);
+      }
+
+      template<typename... Args>
+      GRACE_INLINE void Format(fmt::format_string<Args...> format, Args&&... args)
+      {
+        FlushIfFull();
+        fmt::format_to(std::back_inserter(m_Buffer), format, std::forward<Args>(args)...);
+      }
+
+      // called by the VM once a print has been written, to flush according to the Mode
+      void EndPrint();
+      void Flush();
+      void SetMode(Mode mode, std::size_t capacity);
+
+      GRACE_NODISCARD GRACE_INLINE std::string TakeString()
+      {
+        return std::move(m_Buffer);
+      }
+
+      // line buffered if stdout is a terminal, fully buffered otherwise
+      GRACE_NODISCARD static OutputBuffer& Stdout();
+      GRACE_NODISCARD static OutputBuffer& Stderr();
+
+      // anything that writes to the console without going through these, or waits on the user, needs to call this first
+      static void FlushAll();
+
+    private:
+
+      GRACE_INLINE void FlushIfFull()
+      {
+        if (m_Stream != nullptr && m_Buffer.size() >= m_Capacity) {
+          Flush();
+        }
+      }
+
+      std::FILE* m_Stream = nullptr;
+      Mode m_Mode = Mode::Full;
+      std::size_t m_Capacity = s_DefaultCapacity;
+      std::string m_Buffer;
+      // where EndPrint() should start looking for a newline from
+      std::size_t m_Unchecked = 0;
+  };
+} // namespace Grace
+
+#endif  // ifndef GRACE_OUTPUT_BUFFER_HPP
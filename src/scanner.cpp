@@ -1,89 +1,201 @@
 /*
  *  The Grace Programming Language.
  *
- *  This file contains the out of line definitions for the Scanner class, which 
- *  produces Tokens based on inputted source code, as well as some static helper functions. 
- *  
+ *  This file contains the out of line definitions for the Scanner class, which
+ *  produces Tokens based on inputted source code, as well as some static helper functions.
+ *
  *  Copyright (c) 2022 - Present, Ryan Jeffares.
  *  All rights reserved.
  *
  *  For licensing information, see grace.hpp
  */
 
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
 #include <stack>
 #include <unordered_map>
 #include <utility>
 
 #include "scanner.hpp"
+#include "source_file.hpp"
 #include "value.hpp"
+#include "word_at_a_time.hpp"
 
 namespace Grace::Scanner
 {
-  static std::unordered_map<char, TokenType> s_SymbolLookup =
-  {
-    {';', TokenType::Semicolon},
-    {'(', TokenType::LeftParen},
-    {')', TokenType::RightParen},
-    {'[', TokenType::LeftSquareParen},
-    {']', TokenType::RightSquareParen},
-    {'{', TokenType::LeftCurlyParen},
-    {'}', TokenType::RightCurlyParen},
-    {',', TokenType::Comma},
-    {'~', TokenType::Tilde},
+  struct Keyword
+  {
+    std::string_view text;
+    TokenType type = TokenType::Identifier;
   };
 
-  static std::unordered_map<std::string, TokenType> s_KeywordLookup =
-  {
-    {"assert", TokenType::Assert},
-    {"and", TokenType::And},
-    {"or", TokenType::Or},
-    {"break", TokenType::Break},
-    {"by", TokenType::By},
-    {"class", TokenType::Class},
-    {"catch", TokenType::Catch},
-    {"const", TokenType::Const},
-    {"constructor", TokenType::Constructor},
-    {"continue", TokenType::Continue},
-    {"end", TokenType::End},
-    {"else", TokenType::Else},
-    {"false", TokenType::False},
-    {"final", TokenType::Final},
-    {"for", TokenType::For},
-    {"func", TokenType::Func},
-    {"if", TokenType::If},
-    {"import", TokenType::Import},
-    {"in", TokenType::In},
-    {"instanceof", TokenType::InstanceOf},
-    {"isobject", TokenType::IsObject},
-    {"null", TokenType::Null},
-    {"print", TokenType::Print},
-    {"println", TokenType::PrintLn},
-    {"eprint", TokenType::Eprint},
-    {"eprintln", TokenType::EprintLn},
-    {"export", TokenType::Export},
-    {"return", TokenType::Return},
-    {"while", TokenType::While},
-    {"this", TokenType::This},
-    {"throw", TokenType::Throw},
-    {"true", TokenType::True},
-    {"try", TokenType::Try},
-    {"typename", TokenType::Typename},
-    {"var", TokenType::Var},
-    {"Int", TokenType::IntIdent},
-    {"Float", TokenType::FloatIdent},
-    {"Bool", TokenType::BoolIdent},
-    {"String", TokenType::StringIdent},
-    {"Char", TokenType::CharIdent},
-    {"List", TokenType::ListIdent},
-    {"Dict", TokenType::DictIdent},
-    {"Exception", TokenType::ExceptionIdent},
-    {"KeyValuePair", TokenType::KeyValuePairIdent},
-    {"Set", TokenType::SetIdent},
+  static constexpr std::array s_Keywords =
+  {
+    Keyword{"assert", TokenType::Assert},
+    Keyword{"and", TokenType::And},
+    Keyword{"or", TokenType::Or},
+    Keyword{"break", TokenType::Break},
+    Keyword{"by", TokenType::By},
+    Keyword{"class", TokenType::Class},
+    Keyword{"catch", TokenType::Catch},
+    Keyword{"const", TokenType::Const},
+    Keyword{"constructor", TokenType::Constructor},
+    Keyword{"continue", TokenType::Continue},
+    Keyword{"end", TokenType::End},
+    Keyword{"else", TokenType::Else},
+    Keyword{"false", TokenType::False},
+    Keyword{"final", TokenType::Final},
+    Keyword{"for", TokenType::For},
+    Keyword{"func", TokenType::Func},
+    Keyword{"if", TokenType::If},
+    Keyword{"import", TokenType::Import},
+    Keyword{"in", TokenType::In},
+    Keyword{"instanceof", TokenType::InstanceOf},
+    Keyword{"isobject", TokenType::IsObject},
+    Keyword{"null", TokenType::Null},
+    Keyword{"print", TokenType::Print},
+    Keyword{"println", TokenType::PrintLn},
+    Keyword{"eprint", TokenType::Eprint},
+    Keyword{"eprintln", TokenType::EprintLn},
+    Keyword{"export", TokenType::Export},
+    Keyword{"return", TokenType::Return},
+    Keyword{"while", TokenType::While},
+    Keyword{"this", TokenType::This},
+    Keyword{"throw", TokenType::Throw},
+    Keyword{"true", TokenType::True},
+    Keyword{"try", TokenType::Try},
+    Keyword{"typename", TokenType::Typename},
+    Keyword{"var", TokenType::Var},
+    Keyword{"yield", TokenType::Yield},
+    Keyword{"Int", TokenType::IntIdent},
+    Keyword{"Float", TokenType::FloatIdent},
+    Keyword{"Bool", TokenType::BoolIdent},
+    Keyword{"String", TokenType::StringIdent},
+    Keyword{"Char", TokenType::CharIdent},
+    Keyword{"List", TokenType::ListIdent},
+    Keyword{"Dict", TokenType::DictIdent},
+    Keyword{"Exception", TokenType::ExceptionIdent},
+    Keyword{"KeyValuePair", TokenType::KeyValuePairIdent},
+    Keyword{"Set", TokenType::SetIdent},
+  };
+
+  static constexpr std::size_t s_KeywordTableSize = 128;
+
+  static constexpr std::size_t s_MinKeywordLength = [] {
+    auto min = s_Keywords[0].text.length();
+    for (const auto& keyword : s_Keywords) {
+      min = keyword.text.length() < min ? keyword.text.length() : min;
+    }
+    return min;
+  }();
+
+  static constexpr std::size_t s_MaxKeywordLength = [] {
+    std::size_t max = 0;
+    for (const auto& keyword : s_Keywords) {
+      max = keyword.text.length() > max ? keyword.text.length() : max;
+    }
+    return max;
+  }();
+
+  // Perfect hash over s_Keywords using the first two chars, the last char and the length.
+  // The multipliers were found by brute force, if a new keyword collides the static_assert below will fail
+  // and they'll need to be searched for again.
+  static constexpr std::size_t KeywordHash(std::string_view text)
+  {
+    return (static_cast<unsigned char>(text[0]) * 11
+      + static_cast<unsigned char>(text[1]) * 22
+      + static_cast<unsigned char>(text.back()) * 29
+      + text.length()) % s_KeywordTableSize;
+  }
+
+  static constexpr auto s_KeywordTable = [] {
+    std::array<Keyword, s_KeywordTableSize> table{};
+    for (const auto& keyword : s_Keywords) {
+      table[KeywordHash(keyword.text)] = keyword;
+    }
+    return table;
+  }();
+
+  static_assert(s_MinKeywordLength >= 2, "KeywordHash reads the first two chars of a keyword");
+  static_assert([] {
+    for (const auto& keyword : s_Keywords) {
+      if (s_KeywordTable[KeywordHash(keyword.text)].text != keyword.text) {
+        return false;
+      }
+    }
+    return true;
+  }(), "Keyword hash collision, find new multipliers for KeywordHash");
+
+  static TokenType IdentifierType(std::string_view text)
+  {
+    if (text.length() < s_MinKeywordLength || text.length() > s_MaxKeywordLength) {
+      return TokenType::Identifier;
+    }
+
+    const auto& keyword = s_KeywordTable[KeywordHash(text)];
+    return keyword.text == text ? keyword.type : TokenType::Identifier;
+  }
+
+  enum CharClass : std::uint8_t
+  {
+    IdentifierStart = 1 << 0,
+    Digit = 1 << 1,
+    HexDigit = 1 << 2,
   };
 
+  static constexpr auto s_CharClassTable = [] {
+    std::array<std::uint8_t, 256> table{};
+    for (auto c = 'a'; c <= 'z'; c++) {
+      table[static_cast<unsigned char>(c)] |= IdentifierStart;
+    }
+    for (auto c = 'A'; c <= 'Z'; c++) {
+      table[static_cast<unsigned char>(c)] |= IdentifierStart;
+    }
+    table['_'] |= IdentifierStart;
+    for (auto c = '0'; c <= '9'; c++) {
+      table[static_cast<unsigned char>(c)] |= Digit | HexDigit;
+    }
+    for (auto c = 'a'; c <= 'f'; c++) {
+      table[static_cast<unsigned char>(c)] |= HexDigit;
+      table[static_cast<unsigned char>(c - 'a' + 'A')] |= HexDigit;
+    }
+    return table;
+  }();
+
+  static bool HasCharClass(char c, std::uint8_t charClass)
+  {
+    return (s_CharClassTable[static_cast<unsigned char>(c)] & charClass) != 0;
+  }
+
   static bool IsIdentifierChar(char c)
   {
-    return std::isalpha(c) || c == '_';
+    return HasCharClass(c, IdentifierStart | Digit);
+  }
+
+  /*
+   *  Word at a time matchers, used to skip runs of spaces, digits and identifier characters 8 bytes per step.
+   */
+
+  using WordAtATime::BytesInRange;
+  using WordAtATime::SkipRun;
+
+  static constexpr std::uint64_t MatchSpaces(std::uint64_t word)
+  {
+    return BytesInRange(word, ' ', ' ');
+  }
+
+  static constexpr std::uint64_t MatchDigits(std::uint64_t word)
+  {
+    return BytesInRange(word, '0', '9');
+  }
+
+  static constexpr std::uint64_t MatchIdentifierChars(std::uint64_t word)
+  {
+    return BytesInRange(word, 'a', 'z') | BytesInRange(word, 'A', 'Z') | BytesInRange(word, '0', '9') | BytesInRange(word, '_', '_');
   }
 
   Token::Token(TokenType type,
@@ -91,9 +203,9 @@ namespace Grace::Scanner
     std::size_t length,
     std::size_t line,
     std::size_t column,
-    const std::string& code
+    std::string_view code
   ) : m_Type(type), m_Start(start), m_Length(length),
-    m_Line(line), m_Column(column), m_Text(code.c_str() + start, length)
+    m_Line(line), m_Column(column), m_Text(code.substr(start, length))
   {
 
   }
@@ -123,33 +235,44 @@ namespace Grace::Scanner
   GRACE_NODISCARD static Token Number();
   GRACE_NODISCARD static Token MakeToken(TokenType);
   GRACE_NODISCARD static Token MakeString();
+  GRACE_NODISCARD static Token MakeInterpolatedString();
   GRACE_NODISCARD static Token MakeChar();
 
   struct ScannerContext
   {
-    std::string codeString;
+    // view into a SourceFile owned by s_SourceFilesLookup, which outlives the context
+    std::string_view codeString;
     std::size_t scannerStart = 0, scannerCurrent = 0;
     std::size_t scannerLine = 1, scannerColumn = 1;
 
-    ScannerContext(std::string&& code)
-      : codeString(std::move(code))
+    ScannerContext(std::string_view code)
+      : codeString(code)
     {
 
     }
   };
 
   static std::stack<ScannerContext> s_ScannerContextStack;
-  static std::unordered_map<std::string, std::string> s_CodeStringsLookup;
+
+  // files stay mapped for the lifetime of the program so that Token text and GetCodeAtLine remain valid
+  static std::unordered_map<std::string, std::unique_ptr<SourceFile>> s_SourceFilesLookup;
 
   bool HasFile(const std::string& fullPath)
   {
-    return s_CodeStringsLookup.find(fullPath) != s_CodeStringsLookup.end();
+    return s_SourceFilesLookup.find(fullPath) != s_SourceFilesLookup.end();
+  }
+
+  void InitScanner(const std::string& fullPath, std::unique_ptr<SourceFile>&& file)
+  {
+    auto [it, inserted] = s_SourceFilesLookup.try_emplace(fullPath, std::move(file));
+    s_ScannerContextStack.emplace(it->second->GetText());
   }
 
-  void InitScanner(const std::string& fullPath, std::string&& code)
+  void InitScanner(std::string_view code, std::size_t line, std::size_t column)
   {
-    s_CodeStringsLookup.try_emplace(fullPath, code);
-    s_ScannerContextStack.emplace(std::move(code));
+    auto& context = s_ScannerContextStack.emplace(code);
+    context.scannerLine = line;
+    context.scannerColumn = column;
   }
 
   void PopScanner()
@@ -157,7 +280,7 @@ namespace Grace::Scanner
     s_ScannerContextStack.pop();
   }
 
-  static Token MatchChars(const std::unordered_map<char, TokenType>& pairs, TokenType defaultType)
+  static Token MatchChars(std::initializer_list<std::pair<char, TokenType>> pairs, TokenType defaultType)
   {
     for (const auto& [c, type] : pairs) {
       if (Peek() == c) {
@@ -179,15 +302,38 @@ namespace Grace::Scanner
       return Token(TokenType::EndOfFile, 0, 0, s_ScannerContextStack.top().scannerLine - 1, s_ScannerContextStack.top().scannerColumn - 1, "");
     }
 
-    if (std::isalpha(c) || c == '_') {
+    if (c == 'f' && Peek() == '"') {
+      Advance();
+      return MakeInterpolatedString();
+    }
+
+    if (HasCharClass(c, IdentifierStart)) {
       return Identifier();
     }
 
-    if (std::isdigit(c)) {
+    if (HasCharClass(c, Digit)) {
       return Number();
     }
 
     switch (c) {
+      case ';':
+        return MakeToken(TokenType::Semicolon);
+      case '(':
+        return MakeToken(TokenType::LeftParen);
+      case ')':
+        return MakeToken(TokenType::RightParen);
+      case '[':
+        return MakeToken(TokenType::LeftSquareParen);
+      case ']':
+        return MakeToken(TokenType::RightSquareParen);
+      case '{':
+        return MakeToken(TokenType::LeftCurlyParen);
+      case '}':
+        return MakeToken(TokenType::RightCurlyParen);
+      case ',':
+        return MakeToken(TokenType::Comma);
+      case '~':
+        return MakeToken(TokenType::Tilde);
       case '!':
         return MatchChars({ {'=', TokenType::BangEqual} }, TokenType::Bang);
       case '=':
@@ -236,20 +382,18 @@ namespace Grace::Scanner
       case '\'':
         return MakeChar();
       default:
-        if (s_SymbolLookup.find(c) != s_SymbolLookup.end()) {
-          return MakeToken(s_SymbolLookup[c]);
-        }
         return ErrorToken(fmt::format("Unexpected character: {}", c));
     }
   }
 
   std::string GetCodeAtLine(const std::string& fileName, std::size_t line)
   {
-    if (s_CodeStringsLookup.find(fileName) == s_CodeStringsLookup.end()) {
+    auto it = s_SourceFilesLookup.find(fileName);
+    if (it == s_SourceFilesLookup.end()) {
       return fmt::format("Couldn't find file `{}`\n", fileName);
     }
 
-    const auto& code = s_CodeStringsLookup.at(fileName);
+    auto code = it->second->GetText();
     std::size_t curr = 1;
     std::size_t strIndex = 0;
     while (curr < line) {
@@ -261,65 +405,85 @@ namespace Grace::Scanner
       }
     }
 
-    std::string codeSubStr = code.substr(strIndex, code.length() - strIndex);
-    codeSubStr = codeSubStr.substr(0, codeSubStr.find_first_of('\n'));
-    return codeSubStr;
+    auto codeSubStr = code.substr(strIndex, code.length() - strIndex);
+    return std::string(codeSubStr.substr(0, codeSubStr.find_first_of('\n')));
   }
 
   static void SkipWhitespace()
   {
-    while (true) {
-      if (IsAtEnd()) {
-        return;
-      }
-
-      switch (Peek()) {
+    // work on locals and write the position back once, this is the hottest loop in the scanner
+    auto& context = s_ScannerContextStack.top();
+    const auto* const begin = context.codeString.data();
+    const auto* const end = begin + context.codeString.length();
+    const auto* current = begin + context.scannerCurrent;
+    auto line = context.scannerLine;
+    auto column = context.scannerColumn;
+
+    auto done = false;
+    while (!done && current != end) {
+      switch (*current) {
+        case ' ': {
+          auto next = SkipRun(current, end, MatchSpaces, [](char c) { return c == ' '; });
+          column += static_cast<std::size_t>(next - current);
+          current = next;
+          break;
+        }
         case '\t':
-          s_ScannerContextStack.top().scannerColumn += 8;
-          s_ScannerContextStack.top().scannerCurrent++;
+          column += 8;
+          current++;
           break;
-        case ' ':
         case '\r':
-          Advance();
+          column++;
+          current++;
           break;
         case '\n':
-          s_ScannerContextStack.top().scannerLine++;
-          s_ScannerContextStack.top().scannerColumn = 0;
-          Advance();
+          line++;
+          column = 1;
+          current++;
           break;
         case '/': {
-          if (PeekNext() == '/') {
-            while (!IsAtEnd() && Peek() != '\n') {
-              Advance();
-            }
-          } else if (PeekNext() == '*') {
-            while (!IsAtEnd()) {
-              if (Peek() == '\n') {
-                s_ScannerContextStack.top().scannerLine++;
-                s_ScannerContextStack.top().scannerColumn = 0;
-              } else if (Peek() == '\t') {
-                s_ScannerContextStack.top().scannerCurrent += 8;
+          if (end - current < 2) {
+            done = true;
+          } else if (current[1] == '/') {
+            const auto* newLine = static_cast<const char*>(std::memchr(current, '\n', static_cast<std::size_t>(end - current)));
+            auto next = newLine == nullptr ? end : newLine;
+            column += static_cast<std::size_t>(next - current);
+            current = next;
+          } else if (current[1] == '*') {
+            current += 2;
+            column += 2;
+            while (current != end) {
+              if (*current == '\n') {
+                line++;
+                column = 1;
+              } else if (*current == '\t') {
+                column += 8;
+              } else {
+                column++;
               }
 
-              if (Peek() == '*') {
-                Advance();
-                if (Peek() == '/') {
-                  Advance();
-                  break;
-                }
-              } else {
-                Advance();
+              if (*current == '*' && end - current >= 2 && current[1] == '/') {
+                current += 2;
+                column++;
+                break;
               }
+
+              current++;
             }
           } else {
-            return;
+            done = true;
           }
           break;
         }
         default:
-          return;
+          done = true;
+          break;
       }
     }
+
+    context.scannerCurrent = static_cast<std::size_t>(current - begin);
+    context.scannerLine = line;
+    context.scannerColumn = column;
   }
 
   static char Advance()
@@ -340,6 +504,11 @@ namespace Grace::Scanner
 
   static char Peek()
   {
+    // the mapped source isn't null terminated
+    if (IsAtEnd()) {
+      return '\0';
+    }
+
     return s_ScannerContextStack.top().codeString[s_ScannerContextStack.top().scannerCurrent];
   }
 
@@ -362,18 +531,24 @@ namespace Grace::Scanner
     return Token(TokenType::Error, s_ScannerContextStack.top().scannerLine, s_ScannerContextStack.top().scannerColumn, std::move(message));
   }
 
+  // advances the current context over a run matched by SkipRun, identifiers and numbers never span lines
+  template<typename WordMatcher, typename CharMatcher>
+  static void AdvanceRun(WordMatcher wordMatcher, CharMatcher charMatcher)
+  {
+    auto& context = s_ScannerContextStack.top();
+    const auto* const begin = context.codeString.data();
+    const auto* const current = begin + context.scannerCurrent;
+    auto next = SkipRun(current, begin + context.codeString.length(), wordMatcher, charMatcher);
+    context.scannerCurrent += static_cast<std::size_t>(next - current);
+    context.scannerColumn += static_cast<std::size_t>(next - current);
+  }
+
   static Token Identifier()
   {
-    while (!IsAtEnd() && (IsIdentifierChar(Peek()) || std::isdigit(Peek()))) {
-      Advance();
-    }
+    AdvanceRun(MatchIdentifierChars, IsIdentifierChar);
 
-    std::string tokenStr = s_ScannerContextStack.top().codeString.substr(s_ScannerContextStack.top().scannerStart, s_ScannerContextStack.top().scannerCurrent - s_ScannerContextStack.top().scannerStart);
-    if (s_KeywordLookup.find(tokenStr) != s_KeywordLookup.end()) {
-      return MakeToken(s_KeywordLookup[tokenStr]);
-    } else {
-      return MakeToken(TokenType::Identifier);
-    }
+    const auto& context = s_ScannerContextStack.top();
+    return MakeToken(IdentifierType(context.codeString.substr(context.scannerStart, context.scannerCurrent - context.scannerStart)));
   }
 
   static Token BinaryLiteral()
@@ -385,20 +560,20 @@ namespace Grace::Scanner
     return MakeToken(TokenType::BinaryLiteral);
   }
 
-  static bool IsHexCharacter(char c)
-  {
-    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
-  }
-
   static Token HexLiteral()
   {
-    while (!IsAtEnd() && IsHexCharacter(Peek())) {
+    while (!IsAtEnd() && HasCharClass(Peek(), HexDigit)) {
       Advance();
     }
 
     return MakeToken(TokenType::HexLiteral);
   }
 
+  static bool IsDigit(char c)
+  {
+    return HasCharClass(c, Digit);
+  }
+
   static Token Number()
   {
     if (Peek() == 'b' || Peek() == 'B') {
@@ -410,16 +585,11 @@ namespace Grace::Scanner
       return HexLiteral();
     }
 
-    while (!IsAtEnd() && std::isdigit(Peek())) {
-      Advance();
-    }
+    AdvanceRun(MatchDigits, IsDigit);
 
-    if (!IsAtEnd() && Peek() == '.' && std::isdigit(PeekNext())) {
+    if (!IsAtEnd() && Peek() == '.' && IsDigit(PeekNext())) {
       Advance();
-      while (std::isdigit(Peek())) {
-        Advance();
-      }
-
+      AdvanceRun(MatchDigits, IsDigit);
       return MakeToken(TokenType::Double);
     } else {
       return MakeToken(TokenType::Integer);
@@ -454,6 +624,44 @@ namespace Grace::Scanner
     return MakeToken(TokenType::String);
   }
 
+  // the whole of f"..." is one token, the compiler scans the expressions inside braces when it compiles it
+  // a `"` only ends the token outside of braces, so the expressions can contain Strings of their own
+  static Token MakeInterpolatedString()
+  {
+    std::size_t depth = 0;
+    auto inNestedString = false;
+    while (!IsAtEnd()) {
+      auto c = Peek();
+      if (c == '"' && PeekPrevious() != '\\') {
+        if (depth == 0) {
+          break;
+        }
+        inNestedString = !inNestedString;
+      } else if (!inNestedString) {
+        if (c == '{' && depth == 0 && PeekNext() == '{') {
+          // an escaped brace
+          Advance();
+        } else if (c == '{') {
+          depth++;
+        } else if (c == '}' && depth > 0) {
+          depth--;
+        }
+      }
+
+      if (c == '\n') {
+        s_ScannerContextStack.top().scannerLine++;
+      }
+      Advance();
+    }
+
+    if (IsAtEnd()) {
+      return ErrorToken("Unterminated string");
+    }
+
+    Advance();
+    return MakeToken(TokenType::InterpolatedString);
+  }
+
   // not doing error checking here to do better error reporting in the compiler
   static Token MakeChar()
   {
@@ -12,6 +12,7 @@
 #ifndef GRACE_SCANNER_HPP
 #define GRACE_SCANNER_HPP
 
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -33,6 +34,7 @@ namespace Grace::Scanner
     Identifier,
     Integer,
     HexLiteral,
+    InterpolatedString,
     String,
     IntIdent,
     FloatIdent,
@@ -126,6 +128,7 @@ namespace Grace::Scanner
     Typename,
     Var,
     While,
+    Yield,
   };
 
   class Token
@@ -137,7 +140,7 @@ namespace Grace::Scanner
         std::size_t length,
         std::size_t line,
         std::size_t column,
-        const std::string& code
+        std::string_view code
       );
 
       Token(TokenType, std::size_t line, std::size_t column, std::string&& errorMessage);
@@ -163,7 +166,12 @@ namespace Grace::Scanner
       std::string m_ErrorMessage;
   };
 
-  void InitScanner(const std::string& fileName, std::string&& code);
+  class SourceFile;
+
+  void InitScanner(const std::string& fileName, std::unique_ptr<SourceFile>&& file);
+  // scans part of a file that is already being scanned, like an expression inside an interpolated string
+  // `code` must be a view into that file, `line` and `column` are where it starts
+  void InitScanner(std::string_view code, std::size_t line, std::size_t column);
   void PopScanner();
 
   GRACE_NODISCARD Token ScanToken();
@@ -189,6 +197,7 @@ struct fmt::formatter<Grace::Scanner::TokenType> : fmt::formatter<std::string_vi
       case TokenType::Double: name = "TokenType::Float"; break;
       case TokenType::Identifier: name = "TokenType::Identifier"; break;
       case TokenType::Integer: name = "TokenType::Integer"; break;
+      case TokenType::InterpolatedString: name = "TokenType::InterpolatedString"; break;
       case TokenType::String: name = "TokenType::String"; break;
       case TokenType::Colon: name = "TokenType::Colon"; break;
       case TokenType::ColonColon: name = "TokenType::ColonColon"; break;
@@ -237,6 +246,7 @@ struct fmt::formatter<Grace::Scanner::TokenType> : fmt::formatter<std::string_vi
       case TokenType::IsObject: name = "TokenType::IsObject"; break;
       case TokenType::Null: name = "TokenType::Null"; break;
       case TokenType::While: name = "TokenType::While"; break;
+      case TokenType::Yield: name = "TokenType::Yield"; break;
       case TokenType::Print: name = "TokenType::Print"; break;
       case TokenType::PrintLn: name = "TokenType::PrintLn"; break;
       case TokenType::Eprint: name = "TokenType::Eprint"; break;
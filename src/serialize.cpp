@@ -0,0 +1,528 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the binary serialiser.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <bit>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "serialize.hpp"
+#include "objects/grace_bytes.hpp"
+#include "objects/grace_dictionary.hpp"
+#include "objects/grace_exception.hpp"
+#include "objects/grace_instance.hpp"
+#include "objects/grace_keyvaluepair.hpp"
+#include "objects/grace_list.hpp"
+#include "objects/grace_set.hpp"
+#include "objects/grace_thread.hpp"
+#include "objects/object_tracker.hpp"
+
+using namespace Grace::VM;
+
+/*
+ *  The encoding is a 3 byte magic number and a version byte, followed by a single value.
+ *  Every value starts with a Tag byte, integers and lengths are LEB128 varints and Ints are zigzag encoded first.
+ *  Objects are numbered in the order they're first reached, and any later use of the same object is just a Reference to that number.
+ *  Instances refer to a shape, their class name and member names, which is written out in full the first time it's used.
+ */
+
+static constexpr std::string_view s_Magic = "GRS";
+
+// recursion is used on the way in and out, so this stops a very deep structure running out of stack
+static constexpr std::size_t s_MaxDepth = 4096;
+
+enum class Tag : std::uint8_t
+{
+  Null,
+  False,
+  True,
+  Int,
+  Float,
+  Char,
+  String,
+  List,
+  Dictionary,
+  Set,
+  KeyValuePair,
+  Instance,
+  Bytes,
+  Reference,
+  Channel,
+};
+
+namespace Grace::Serialize
+{
+  class Encoder
+  {
+    public:
+
+      explicit Encoder(ChannelList* channels)
+        : m_Channels(channels)
+      {
+
+      }
+
+      std::string Encode(const Value& value)
+      {
+        m_Out.append(s_Magic);
+        m_Out.push_back(static_cast<char>(s_Version));
+        EncodeValue(value, 0);
+        return std::move(m_Out);
+      }
+
+    private:
+
+      void EncodeValue(const Value& value, std::size_t depth)
+      {
+        switch (value.GetType()) {
+          case Value::Type::Null:
+            WriteTag(Tag::Null);
+            break;
+          case Value::Type::Bool:
+            WriteTag(value.Get<bool>() ? Tag::True : Tag::False);
+            break;
+          case Value::Type::Int: {
+            auto integer = value.Get<std::int64_t>();
+            WriteTag(Tag::Int);
+            WriteVarint((static_cast<std::uint64_t>(integer) << 1) ^ static_cast<std::uint64_t>(integer >> 63));
+            break;
+          }
+          case Value::Type::Double: {
+            auto bits = std::bit_cast<std::uint64_t>(value.Get<double>());
+            WriteTag(Tag::Float);
+            for (auto i = 0; i < 8; i++) {
+              m_Out.push_back(static_cast<char>(bits >> (i * 8)));
+            }
+            break;
+          }
+          case Value::Type::Char:
+            WriteTag(Tag::Char);
+            m_Out.push_back(value.Get<char>());
+            break;
+          case Value::Type::String:
+            WriteTag(Tag::String);
+            WriteString(value.Get<std::string>());
+            break;
+          case Value::Type::Object:
+            EncodeObject(value.GetObject(), depth + 1);
+            break;
+        }
+      }
+
+      void EncodeObject(GraceObject* object, std::size_t depth)
+      {
+        auto [it, firstUse] = m_ObjectIndices.try_emplace(object, m_ObjectIndices.size());
+        if (!firstUse) {
+          WriteTag(Tag::Reference);
+          WriteVarint(it->second);
+          return;
+        }
+
+        if (depth > s_MaxDepth) {
+          throw GraceException(
+            GraceException::Type::InvalidArgument,
+            fmt::format("Cannot serialise objects nested more than {} deep", s_MaxDepth)
+          );
+        }
+
+        switch (object->ObjectType()) {
+          case GraceObjectType::List: {
+            auto list = object->GetAsList();
+            WriteTag(Tag::List);
+            WriteVarint(list->Length());
+            for (std::size_t i = 0; i < list->Length(); i++) {
+              EncodeValue(list->GetUnchecked(i), depth);
+            }
+            break;
+          }
+          case GraceObjectType::Dictionary: {
+            auto dict = object->GetAsDictionary();
+            WriteTag(Tag::Dictionary);
+            WriteVarint(dict->Size());
+            for (auto it = dict->Begin(); !dict->IsAtEnd(it); dict->IncrementIterator(it)) {
+              auto kvp = it->GetObject()->GetAsKeyValuePair();
+              EncodeValue(kvp->Key(), depth);
+              EncodeValue(kvp->Value(), depth);
+            }
+            break;
+          }
+          case GraceObjectType::Set: {
+            auto set = object->GetAsSet();
+            WriteTag(Tag::Set);
+            WriteVarint(set->Size());
+            for (auto it = set->Begin(); !set->IsAtEnd(it); set->IncrementIterator(it)) {
+              EncodeValue(*it, depth);
+            }
+            break;
+          }
+          case GraceObjectType::KeyValuePair: {
+            auto kvp = object->GetAsKeyValuePair();
+            WriteTag(Tag::KeyValuePair);
+            EncodeValue(kvp->Key(), depth);
+            EncodeValue(kvp->Value(), depth);
+            break;
+          }
+          case GraceObjectType::Instance: {
+            auto instance = object->GetAsInstance();
+            WriteTag(Tag::Instance);
+            WriteShape(instance);
+            for (const auto& member : instance->Members()) {
+              EncodeValue(member.value, depth);
+            }
+            break;
+          }
+          case GraceObjectType::Bytes:
+            WriteTag(Tag::Bytes);
+            WriteString(object->GetAsBytes()->View());
+            break;
+          case GraceObjectType::Channel:
+            if (m_Channels != nullptr) {
+              WriteTag(Tag::Channel);
+              WriteVarint(m_Channels->size());
+              m_Channels->push_back(object->GetAsChannel()->State());
+              break;
+            }
+            [[fallthrough]];
+          default:
+            throw GraceException(
+              GraceException::Type::InvalidType,
+              fmt::format("Cannot serialise `{}`", object->ObjectName())
+            );
+        }
+      }
+
+      void WriteShape(GraceInstance* instance)
+      {
+        auto it = m_ShapeIndices.find(instance->ObjectName());
+        if (it != m_ShapeIndices.end() && SameMembers(m_Shapes[it->second], instance)) {
+          WriteVarint(it->second);
+          return;
+        }
+
+        // the index of a new shape is always the next one, so the decoder knows a definition follows
+        auto index = m_Shapes.size();
+        m_Shapes.push_back(instance);
+        m_ShapeIndices.insert_or_assign(instance->ObjectName(), index);
+
+        WriteVarint(index);
+        WriteString(instance->ObjectName());
+        WriteVarint(instance->Members().size());
+        for (const auto& member : instance->Members()) {
+          WriteString(member.name);
+        }
+      }
+
+      GRACE_NODISCARD static bool SameMembers(const GraceInstance* first, const GraceInstance* second)
+      {
+        const auto& firstMembers = first->Members();
+        const auto& secondMembers = second->Members();
+        if (firstMembers.size() != secondMembers.size()) {
+          return false;
+        }
+
+        for (std::size_t i = 0; i < firstMembers.size(); i++) {
+          if (firstMembers[i].name != secondMembers[i].name) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      GRACE_INLINE void WriteTag(Tag tag)
+      {
+        m_Out.push_back(static_cast<char>(tag));
+      }
+
+      GRACE_INLINE void WriteVarint(std::uint64_t value)
+      {
+        while (value >= 0x80) {
+          m_Out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+          value >>= 7;
+        }
+        m_Out.push_back(static_cast<char>(value));
+      }
+
+      GRACE_INLINE void WriteString(std::string_view text)
+      {
+        WriteVarint(text.size());
+        m_Out.append(text);
+      }
+
+      std::string m_Out;
+      std::unordered_map<const GraceObject*, std::size_t> m_ObjectIndices;
+      ChannelList* m_Channels;
+
+      // the first instance seen with each shape, names point into the instances which outlive the encoder
+      std::vector<const GraceInstance*> m_Shapes;
+      std::unordered_map<std::string_view, std::size_t> m_ShapeIndices;
+  };
+
+  class Decoder
+  {
+    public:
+
+      Decoder(std::string_view data, const ChannelList* channels)
+        : m_Current(data.data()), m_End(data.data() + data.size()), m_Channels(channels)
+      {
+
+      }
+
+      Value Decode()
+      {
+        auto magic = ReadBytes(s_Magic.size());
+        if (magic != s_Magic) {
+          Fail("missing the header");
+        }
+
+        auto version = ReadByte();
+        if (version != s_Version) {
+          Fail(fmt::format("written by version {} of the encoding but only version {} can be read", version, s_Version));
+        }
+
+        auto result = DecodeValue(0);
+        if (m_Current != m_End) {
+          Fail("unexpected data after the end of the value");
+        }
+        return result;
+      }
+
+    private:
+
+      struct Shape
+      {
+        std::string className;
+        std::vector<std::string> memberNames;
+      };
+
+      Value DecodeValue(std::size_t depth)
+      {
+        if (depth > s_MaxDepth) {
+          Fail(fmt::format("objects are nested more than {} deep", s_MaxDepth));
+        }
+
+        auto tag = static_cast<Tag>(ReadByte());
+        switch (tag) {
+          case Tag::Null:
+            return Value();
+          case Tag::False:
+            return Value(false);
+          case Tag::True:
+            return Value(true);
+          case Tag::Int: {
+            auto zigzag = ReadVarint();
+            return Value(static_cast<std::int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1)));
+          }
+          case Tag::Float: {
+            auto bytes = ReadBytes(8);
+            std::uint64_t bits = 0;
+            for (auto i = 0; i < 8; i++) {
+              bits |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(bytes[i])) << (i * 8);
+            }
+            return Value(std::bit_cast<double>(bits));
+          }
+          case Tag::Char:
+            return Value(static_cast<char>(ReadByte()));
+          case Tag::String:
+            return Value(std::string(ReadString()));
+          case Tag::List: {
+            auto length = ReadLength();
+            // made at its final size and registered before its items, so any of them can refer back to it
+            auto result = Value::CreateObject<GraceList>(std::vector<Value>(length));
+            m_Objects.push_back(result);
+            auto list = result.GetObject()->GetAsList();
+            for (std::size_t i = 0; i < length; i++) {
+              list->GetUnchecked(i) = DecodeValue(depth + 1);
+            }
+            return result;
+          }
+          case Tag::Dictionary: {
+            auto size = ReadLength();
+            auto result = Value::CreateObject<GraceDictionary>();
+            m_Objects.push_back(result);
+            auto dict = result.GetObject()->GetAsDictionary();
+            for (std::size_t i = 0; i < size; i++) {
+              auto key = DecodeValue(depth + 1);
+              auto value = DecodeValue(depth + 1);
+              dict->Insert(std::move(key), std::move(value));
+            }
+            return result;
+          }
+          case Tag::Set: {
+            auto size = ReadLength();
+            auto result = Value::CreateObject<GraceSet>();
+            m_Objects.push_back(result);
+            auto set = result.GetObject()->GetAsSet();
+            for (std::size_t i = 0; i < size; i++) {
+              set->Add(DecodeValue(depth + 1));
+            }
+            return result;
+          }
+          case Tag::KeyValuePair: {
+            auto result = Value::CreateObject<GraceKeyValuePair>(Value(), Value());
+            m_Objects.push_back(result);
+            auto kvp = result.GetObject()->GetAsKeyValuePair();
+            kvp->Key() = DecodeValue(depth + 1);
+            kvp->Value() = DecodeValue(depth + 1);
+            return result;
+          }
+          case Tag::Instance: {
+            const auto& shape = ReadShape();
+            std::vector<GraceInstance::Member> members(shape.memberNames.size());
+            for (std::size_t i = 0; i < members.size(); i++) {
+              members[i].name = shape.memberNames[i];
+            }
+
+            auto result = Value::CreateObject<GraceInstance>(std::string(shape.className), std::move(members));
+            m_Objects.push_back(result);
+            auto instance = result.GetObject()->GetAsInstance();
+            for (const auto& name : shape.memberNames) {
+              instance->AssignMember(name, DecodeValue(depth + 1));
+            }
+            return result;
+          }
+          case Tag::Bytes: {
+            auto result = Value::CreateObject<GraceBytes>(std::string(ReadString()));
+            m_Objects.push_back(result);
+            return result;
+          }
+          case Tag::Reference: {
+            auto index = ReadVarint();
+            if (index >= m_Objects.size()) {
+              Fail(fmt::format("reference to object {} before it was defined", index));
+            }
+            return m_Objects[index];
+          }
+          case Tag::Channel: {
+            auto index = ReadVarint();
+            if (m_Channels == nullptr || index >= m_Channels->size()) {
+              Fail(fmt::format("reference to channel {} which was not sent with the data", index));
+            }
+            auto result = Value::CreateObject<GraceChannel>((*m_Channels)[index]);
+            m_Objects.push_back(result);
+            return result;
+          }
+        }
+
+        Fail(fmt::format("unknown tag {}", static_cast<int>(tag)));
+      }
+
+      const Shape& ReadShape()
+      {
+        auto index = ReadVarint();
+        if (index < m_Shapes.size()) {
+          return m_Shapes[index];
+        }
+        if (index != m_Shapes.size()) {
+          Fail(fmt::format("reference to shape {} before it was defined", index));
+        }
+
+        Shape shape;
+        shape.className = ReadString();
+        auto memberCount = ReadLength();
+        shape.memberNames.reserve(memberCount);
+        for (std::size_t i = 0; i < memberCount; i++) {
+          shape.memberNames.emplace_back(ReadString());
+        }
+
+        m_Shapes.push_back(std::move(shape));
+        return m_Shapes.back();
+      }
+
+      std::uint8_t ReadByte()
+      {
+        if (m_Current == m_End) {
+          Fail("unexpected end of data");
+        }
+        return static_cast<std::uint8_t>(*m_Current++);
+      }
+
+      std::uint64_t ReadVarint()
+      {
+        std::uint64_t result = 0;
+        for (auto shift = 0; shift < 64; shift += 7) {
+          auto byte = ReadByte();
+          result |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+          if ((byte & 0x80) == 0) {
+            return result;
+          }
+        }
+        Fail("varint is too long");
+      }
+
+      // a count of things that each take at least one byte, so a corrupt count can't ask for a huge allocation
+      std::size_t ReadLength()
+      {
+        auto length = ReadVarint();
+        if (length > static_cast<std::uint64_t>(m_End - m_Current)) {
+          Fail("length is longer than the remaining data");
+        }
+        return static_cast<std::size_t>(length);
+      }
+
+      std::string_view ReadBytes(std::size_t count)
+      {
+        if (static_cast<std::size_t>(m_End - m_Current) < count) {
+          Fail("unexpected end of data");
+        }
+        std::string_view result(m_Current, count);
+        m_Current += count;
+        return result;
+      }
+
+      std::string_view ReadString()
+      {
+        return ReadBytes(ReadLength());
+      }
+
+      GRACE_NORETURN void Fail(std::string_view message)
+      {
+        throw GraceException(
+          GraceException::Type::ParseFailed,
+          fmt::format("Invalid serialised data: {}", message)
+        );
+      }
+
+      const char* m_Current;
+      const char* m_End;
+      const ChannelList* m_Channels;
+
+      // every object decoded so far, in the same order the encoder numbered them
+      std::vector<Value> m_Objects;
+      std::vector<Shape> m_Shapes;
+  };
+
+  std::string Encode(const Value& value, ChannelList* channels)
+  {
+    Encoder encoder(channels);
+    return encoder.Encode(value);
+  }
+
+  Value Decode(std::string_view data, const ChannelList* channels)
+  {
+    // anything still only half built could look like garbage to a sweep, so wait until it's all connected up
+    auto gcEnabled = ObjectTracker::GetEnabled();
+    ObjectTracker::SetEnabled(false);
+
+    Value result;
+    try {
+      Decoder decoder(data, channels);
+      result = decoder.Decode();
+    } catch (...) {
+      ObjectTracker::SetEnabled(gcEnabled);
+      throw;
+    }
+
+    ObjectTracker::SetEnabled(gcEnabled);
+    return result;
+  }
+} // namespace Grace::Serialize
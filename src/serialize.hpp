@@ -0,0 +1,46 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the binary serialiser behind std::serialize, which encodes a Value and everything it refers to
+ *  so it can be written to a file or sent to another process and read back exactly as it was.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_SERIALIZE_HPP
+#define GRACE_SERIALIZE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "value.hpp"
+
+namespace Grace
+{
+  struct ChannelState;
+} // namespace Grace
+
+namespace Grace::Serialize
+{
+  // bumped whenever the encoding changes, data from any other version is refused rather than misread
+  static constexpr std::uint8_t s_Version = 1;
+
+  // Channels can't be written out, since they're shared between threads rather than copied
+  // when a value is sent to another thread in the same process, its Channels are collected here and only their index is encoded
+  using ChannelList = std::vector<std::shared_ptr<ChannelState>>;
+
+  // an object reachable more than once is only encoded once, so shared references and cycles survive a round trip
+  // without a ChannelList, a Channel can't be serialised
+  GRACE_NODISCARD std::string Encode(const VM::Value& value, ChannelList* channels = nullptr);
+
+  // channels must be the list the data was encoded with, if it contains any Channels
+  GRACE_NODISCARD VM::Value Decode(std::string_view data, const ChannelList* channels = nullptr);
+} // namespace Grace::Serialize
+
+#endif  // ifndef GRACE_SERIALIZE_HPP
@@ -0,0 +1,121 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the SourceFile class,
+ *  which maps source files into memory with mmap on POSIX and MapViewOfFile on Windows.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifdef GRACE_MSC
+# define WIN32_LEAN_AND_MEAN
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+#include "source_file.hpp"
+
+using namespace Grace::Scanner;
+
+std::unique_ptr<SourceFile> SourceFile::Open(const std::filesystem::path& path)
+{
+  // private constructor, so can't use make_unique
+  std::unique_ptr<SourceFile> file(new SourceFile());
+
+#ifdef GRACE_MSC
+  auto fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(fileHandle, &size)) {
+    CloseHandle(fileHandle);
+    return nullptr;
+  }
+
+  file->m_FileHandle = fileHandle;
+  file->m_Size = static_cast<std::size_t>(size.QuadPart);
+
+  // CreateFileMapping fails on empty files, leave the view empty
+  if (file->m_Size == 0) {
+    return file;
+  }
+
+  auto mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mappingHandle == nullptr) {
+    return nullptr;
+  }
+
+  file->m_MappingHandle = mappingHandle;
+
+  auto view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    return nullptr;
+  }
+
+  file->m_Data = static_cast<const char*>(view);
+#else
+  auto fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return nullptr;
+  }
+
+  file->m_Size = static_cast<std::size_t>(st.st_size);
+
+  // mmap fails on empty files, leave the view empty
+  if (file->m_Size == 0) {
+    close(fd);
+    return file;
+  }
+
+  auto view = mmap(nullptr, file->m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  // the mapping holds its own reference to the file
+  close(fd);
+
+  if (view == MAP_FAILED) {
+    file->m_Size = 0;
+    return nullptr;
+  }
+
+  // the scanner reads front to back
+  madvise(view, file->m_Size, MADV_SEQUENTIAL);
+
+  file->m_Data = static_cast<const char*>(view);
+#endif
+
+  return file;
+}
+
+SourceFile::~SourceFile()
+{
+#ifdef GRACE_MSC
+  if (m_Data != nullptr) {
+    UnmapViewOfFile(m_Data);
+  }
+  if (m_MappingHandle != nullptr) {
+    CloseHandle(m_MappingHandle);
+  }
+  if (m_FileHandle != nullptr) {
+    CloseHandle(m_FileHandle);
+  }
+#else
+  if (m_Data != nullptr) {
+    munmap(const_cast<char*>(m_Data), m_Size);
+  }
+#endif
+}
@@ -0,0 +1,54 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the SourceFile class, a read-only memory mapping of a source file
+ *  that the Scanner reads directly and keeps alive for error reporting.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_SOURCE_FILE_HPP
+#define GRACE_SOURCE_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+#include "grace.hpp"
+
+namespace Grace::Scanner
+{
+  class SourceFile
+  {
+    public:
+
+      // Returns nullptr if the file could not be opened or mapped
+      GRACE_NODISCARD static std::unique_ptr<SourceFile> Open(const std::filesystem::path& path);
+
+      ~SourceFile();
+
+      SourceFile(const SourceFile&) = delete;
+      SourceFile& operator=(const SourceFile&) = delete;
+
+      GRACE_NODISCARD GRACE_INLINE std::string_view GetText() const { return std::string_view(m_Data, m_Size); }
+      GRACE_NODISCARD GRACE_INLINE std::size_t GetSize() const { return m_Size; }
+
+    private:
+
+      SourceFile() = default;
+
+      const char* m_Data = nullptr;
+      std::size_t m_Size = 0;
+
+#ifdef GRACE_MSC
+      void* m_FileHandle = nullptr;
+      void* m_MappingHandle = nullptr;
+#endif
+  };
+} // namespace Grace::Scanner
+
+#endif  // ifndef GRACE_SOURCE_FILE_HPP
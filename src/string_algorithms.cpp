@@ -0,0 +1,173 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the String algorithms.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "string_algorithms.hpp"
+#include "word_at_a_time.hpp"
+
+namespace Grace::StringAlgorithms
+{
+  static bool IsWhitespace(char c)
+  {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+  }
+
+  // flips the case bit of every byte in [low, high], 8 bytes at a time
+  static std::string ChangeCase(std::string_view text, std::uint8_t low, std::uint8_t high)
+  {
+    std::string result(text);
+    auto current = result.data();
+    auto end = result.data() + result.size();
+
+    while (end - current >= 8) {
+      std::uint64_t word;
+      std::memcpy(&word, current, sizeof(word));
+      // the match bit is 0x80 in each byte, the case bit is 0x20
+      word ^= WordAtATime::BytesInRange(word, low, high) >> 2;
+      std::memcpy(current, &word, sizeof(word));
+      current += 8;
+    }
+
+    for (; current != end; current++) {
+      if (*current >= static_cast<char>(low) && *current <= static_cast<char>(high)) {
+        *current ^= 0x20;
+      }
+    }
+
+    return result;
+  }
+
+  std::size_t Find(std::string_view haystack, std::string_view needle, std::size_t start)
+  {
+    if (start > haystack.size() || needle.size() > haystack.size() - start) {
+      return std::string_view::npos;
+    }
+
+    if (needle.empty()) {
+      return start;
+    }
+
+    // memchr to the next place the first character appears, which the C library vectorises, then check the rest there
+    auto current = haystack.data() + start;
+    auto lastStart = haystack.data() + haystack.size() - needle.size();
+    while (current <= lastStart) {
+      auto candidate = static_cast<const char*>(std::memchr(current, needle.front(), static_cast<std::size_t>(lastStart - current) + 1));
+      if (candidate == nullptr) {
+        break;
+      }
+
+      if (std::memcmp(candidate + 1, needle.data() + 1, needle.size() - 1) == 0) {
+        return static_cast<std::size_t>(candidate - haystack.data());
+      }
+      current = candidate + 1;
+    }
+
+    return std::string_view::npos;
+  }
+
+  std::size_t FindLast(std::string_view haystack, std::string_view needle)
+  {
+    return haystack.rfind(needle);
+  }
+
+  std::size_t Count(std::string_view haystack, std::string_view needle)
+  {
+    GRACE_ASSERT(!needle.empty(), "Cannot count occurrences of an empty String");
+
+    if (needle.size() == 1) {
+      return static_cast<std::size_t>(std::count(haystack.begin(), haystack.end(), needle.front()));
+    }
+
+    std::size_t count = 0;
+    for (auto position = Find(haystack, needle); position != std::string_view::npos; position = Find(haystack, needle, position + needle.size())) {
+      count++;
+    }
+
+    return count;
+  }
+
+  std::string ReplaceAll(std::string_view text, std::string_view from, std::string_view to)
+  {
+    GRACE_ASSERT(!from.empty(), "Cannot replace an empty String");
+
+    // count first so the result is only allocated once
+    auto matches = Count(text, from);
+    if (matches == 0) {
+      return std::string(text);
+    }
+
+    std::string result;
+    result.reserve(text.size() - matches * from.size() + matches * to.size());
+
+    std::size_t copiedUpTo = 0;
+    for (auto position = Find(text, from); position != std::string_view::npos; position = Find(text, from, copiedUpTo)) {
+      result.append(text.substr(copiedUpTo, position - copiedUpTo));
+      result.append(to);
+      copiedUpTo = position + from.size();
+    }
+    result.append(text.substr(copiedUpTo));
+
+    return result;
+  }
+
+  std::string Repeat(std::string_view text, std::size_t count)
+  {
+    std::string result;
+    if (text.empty() || count == 0) {
+      return result;
+    }
+
+    result.resize(text.size() * count);
+    std::memcpy(result.data(), text.data(), text.size());
+
+    // copy what has been written so far onto the end, doubling it each time
+    auto filled = text.size();
+    while (filled < result.size()) {
+      auto chunk = std::min(filled, result.size() - filled);
+      std::memcpy(result.data() + filled, result.data(), chunk);
+      filled += chunk;
+    }
+
+    return result;
+  }
+
+  std::string ToUpper(std::string_view text)
+  {
+    return ChangeCase(text, 'a', 'z');
+  }
+
+  std::string ToLower(std::string_view text)
+  {
+    return ChangeCase(text, 'A', 'Z');
+  }
+
+  std::string_view Trim(std::string_view text)
+  {
+    auto begin = WordAtATime::SkipRun(
+      text.data(),
+      text.data() + text.size(),
+      [](std::uint64_t word) {
+        return WordAtATime::BytesInRange(word, '\t', '\r') | WordAtATime::BytesInRange(word, ' ', ' ');
+      },
+      IsWhitespace
+    );
+
+    auto end = text.data() + text.size();
+    while (end != begin && IsWhitespace(*(end - 1))) {
+      end--;
+    }
+
+    return std::string_view(begin, static_cast<std::size_t>(end - begin));
+  }
+} // namespace Grace::StringAlgorithms
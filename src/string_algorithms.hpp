@@ -0,0 +1,43 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the String algorithms behind std::string, written to work on whole buffers at a time
+ *  rather than a Value per character.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_STRING_ALGORITHMS_HPP
+#define GRACE_STRING_ALGORITHMS_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "grace.hpp"
+
+namespace Grace::StringAlgorithms
+{
+  // all of these return std::string_view::npos when there is no match
+  // an empty needle matches at `start`
+  GRACE_NODISCARD std::size_t Find(std::string_view haystack, std::string_view needle, std::size_t start = 0);
+  GRACE_NODISCARD std::size_t FindLast(std::string_view haystack, std::string_view needle);
+
+  // non-overlapping matches, the same ones ReplaceAll() would replace
+  GRACE_NODISCARD std::size_t Count(std::string_view haystack, std::string_view needle);
+
+  GRACE_NODISCARD std::string ReplaceAll(std::string_view text, std::string_view from, std::string_view to);
+  GRACE_NODISCARD std::string Repeat(std::string_view text, std::size_t count);
+
+  // only ASCII letters are changed, any other bytes including UTF-8 sequences are left as they are
+  GRACE_NODISCARD std::string ToUpper(std::string_view text);
+  GRACE_NODISCARD std::string ToLower(std::string_view text);
+
+  // strips ASCII whitespace from both ends
+  GRACE_NODISCARD std::string_view Trim(std::string_view text);
+} // namespace Grace::StringAlgorithms
+
+#endif  // ifndef GRACE_STRING_ALGORITHMS_HPP
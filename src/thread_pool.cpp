@@ -0,0 +1,258 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the ThreadPool.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+namespace Grace::ThreadPool
+{
+  // one call to ParallelFor(), which lives on the stack of the thread that made it
+  struct Job
+  {
+    const std::function<void(std::size_t, std::size_t)>* body;
+    std::size_t remaining;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+
+  struct Task
+  {
+    Job* job;
+    std::size_t begin, end;
+  };
+
+  struct WorkQueue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // more tasks than threads, so a thread that finishes early has something to steal
+  static constexpr std::size_t s_TasksPerThread = 4;
+
+  static std::size_t s_Size = std::max(std::thread::hardware_concurrency(), 1u);
+
+  // held shared while a job is running, and exclusively to start or stop the threads
+  static std::shared_mutex s_ResizeMutex;
+  static std::vector<std::unique_ptr<WorkQueue>> s_Queues;
+  static std::vector<std::thread> s_Threads;
+  static std::atomic<bool> s_Started = false;
+
+  // guards sleeping and waking the threads, s_Queued is the number of tasks in all of the queues
+  static std::mutex s_SleepMutex;
+  static std::condition_variable s_WakeUp;
+  static std::atomic<std::size_t> s_Queued = 0;
+  static bool s_Stopping = false;
+
+  // the index of the calling thread's queue, if it is one of the pool's threads
+  static thread_local std::size_t s_QueueIndex = static_cast<std::size_t>(-1);
+
+  static void RunTask(const Task& task)
+  {
+    auto job = task.job;
+    try {
+      (*job->body)(task.begin, task.end);
+    } catch (...) {
+      std::lock_guard lock(job->mutex);
+      if (!job->error) {
+        job->error = std::current_exception();
+      }
+    }
+
+    // the job can go out of scope as soon as remaining reaches 0, so it's only touched under its lock
+    std::lock_guard lock(job->mutex);
+    if (--job->remaining == 0) {
+      job->finished.notify_all();
+    }
+  }
+
+  // the thread's own queue from the back, then the others from the front
+  static bool TryRunTask(std::size_t ownIndex)
+  {
+    auto queueCount = s_Queues.size();
+    for (std::size_t i = 0; i < queueCount; i++) {
+      auto index = (ownIndex + i) % queueCount;
+      auto& queue = *s_Queues[index];
+
+      Task task;
+      {
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) {
+          continue;
+        }
+
+        if (index == ownIndex) {
+          task = queue.tasks.back();
+          queue.tasks.pop_back();
+        } else {
+          task = queue.tasks.front();
+          queue.tasks.pop_front();
+        }
+        s_Queued--;
+      }
+
+      RunTask(task);
+      return true;
+    }
+
+    return false;
+  }
+
+  static void WorkerLoop(std::size_t index)
+  {
+    s_QueueIndex = index;
+    while (true) {
+      if (TryRunTask(index)) {
+        continue;
+      }
+
+      std::unique_lock lock(s_SleepMutex);
+      s_WakeUp.wait(lock, [] { return s_Stopping || s_Queued > 0; });
+      if (s_Stopping) {
+        return;
+      }
+    }
+  }
+
+  // only called with s_ResizeMutex held exclusively
+  static void Start()
+  {
+    s_Stopping = false;
+    // the calling thread is one of the s_Size, so it doesn't need a thread of its own
+    for (std::size_t i = 0; i + 1 < s_Size; i++) {
+      s_Queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (std::size_t i = 0; i + 1 < s_Size; i++) {
+      s_Threads.emplace_back(WorkerLoop, i);
+    }
+    s_Started = true;
+  }
+
+  // only called with s_ResizeMutex held exclusively
+  static void Stop()
+  {
+    {
+      std::lock_guard lock(s_SleepMutex);
+      s_Stopping = true;
+    }
+    s_WakeUp.notify_all();
+
+    for (auto& thread : s_Threads) {
+      thread.join();
+    }
+    s_Threads.clear();
+    s_Queues.clear();
+    s_Started = false;
+  }
+
+  // stops the threads when the program exits, since they wait forever otherwise
+  struct PoolShutdown
+  {
+    ~PoolShutdown()
+    {
+      std::unique_lock lock(s_ResizeMutex);
+      if (s_Started) {
+        Stop();
+      }
+    }
+  };
+
+  static PoolShutdown s_Shutdown;
+
+  void SetSize(std::size_t size)
+  {
+    std::unique_lock lock(s_ResizeMutex);
+    if (s_Started) {
+      Stop();
+    }
+    // started again the next time a job needs it
+    s_Size = size == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : size;
+  }
+
+  std::size_t GetSize()
+  {
+    std::shared_lock lock(s_ResizeMutex);
+    return s_Size;
+  }
+
+  void ParallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body)
+  {
+    grain = std::max(grain, std::size_t{1});
+    if (count <= grain) {
+      body(0, count);
+      return;
+    }
+
+    if (!s_Started) {
+      std::unique_lock lock(s_ResizeMutex);
+      if (!s_Started && s_Size > 1) {
+        Start();
+      }
+    }
+
+    std::shared_lock resizeLock(s_ResizeMutex);
+    if (s_Queues.empty()) {
+      body(0, count);
+      return;
+    }
+
+    auto taskCount = std::min((count + grain - 1) / grain, s_Size * s_TasksPerThread);
+    Job job;
+    job.body = &body;
+    job.remaining = taskCount;
+
+    // dealt out across the queues, starting with the calling thread's own if it's one of the pool's
+    auto queueCount = s_Queues.size();
+    auto firstQueue = s_QueueIndex < queueCount ? s_QueueIndex : 0;
+    for (std::size_t i = 0; i < taskCount; i++) {
+      auto& queue = *s_Queues[(firstQueue + i) % queueCount];
+      std::lock_guard lock(queue.mutex);
+      queue.tasks.push_back({ &job, count * i / taskCount, count * (i + 1) / taskCount });
+    }
+
+    {
+      std::lock_guard lock(s_SleepMutex);
+      s_Queued += taskCount;
+    }
+    s_WakeUp.notify_all();
+
+    // help out until there's nothing left to take, then wait for whatever is still running
+    while (true) {
+      {
+        std::lock_guard lock(job.mutex);
+        if (job.remaining == 0) {
+          break;
+        }
+      }
+
+      if (!TryRunTask(firstQueue)) {
+        std::unique_lock lock(job.mutex);
+        job.finished.wait(lock, [&job] { return job.remaining == 0; });
+        break;
+      }
+    }
+
+    if (job.error) {
+      std::rethrow_exception(job.error);
+    }
+  }
+} // namespace Grace::ThreadPool
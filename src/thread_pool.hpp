@@ -0,0 +1,42 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the ThreadPool, a work stealing pool owned by the runtime that the parallel
+ *  natives split their work across.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_THREAD_POOL_HPP
+#define GRACE_THREAD_POOL_HPP
+
+#include <cstddef>
+#include <functional>
+
+#include "grace.hpp"
+
+namespace Grace
+{
+  // Every thread in the pool has its own queue of tasks and takes from the back of it, threads with nothing left
+  // steal from the front of the others', so uneven chunks still keep every thread busy.
+  // Tasks run outside of any VM, so they must not create or destroy objects or touch their reference counts,
+  // since the ObjectTracker and ObjectArena belong to the thread that owns the objects.
+  namespace ThreadPool
+  {
+    // the number of threads that work on each call to ParallelFor(), including the calling thread
+    // 0 picks one per core, and 1 runs everything on the calling thread
+    void SetSize(std::size_t size);
+    GRACE_NODISCARD std::size_t GetSize();
+
+    // splits [0, count) into ranges of at least `grain` and calls body(begin, end) for each of them across the pool,
+    // returning once they have all finished. the calling thread works on them too
+    // if count is no more than `grain`, body is just called once on the calling thread
+    // the first exception thrown by body is rethrown here, once every range has finished
+    void ParallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body);
+  } // namespace ThreadPool
+} // namespace Grace
+
+#endif  // ifndef GRACE_THREAD_POOL_HPP
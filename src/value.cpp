@@ -9,9 +9,11 @@
  *  For licensing information, see grace.hpp
  */
 
+#include <algorithm>
 #include <type_traits>
 
 #include "grace.hpp"
+#include "string_algorithms.hpp"
 #include "value.hpp"
 #include "objects/grace_list.hpp"
 
@@ -37,7 +39,7 @@ namespace Grace::VM
     }
   }
 
-  Value::Value(Value&& other)
+  Value::Value(Value&& other) noexcept
     : m_Type(other.m_Type), m_Data(other.m_Data)
   {
     if (other.m_Type == Type::Object || other.m_Type == Type::String) {
@@ -61,12 +63,21 @@ namespace Grace::VM
     if (m_Type == Type::Object) {
       GRACE_ASSERT(m_Data.m_Object != nullptr, "Object was a nullptr");
       if (m_Data.m_Object->DecreaseRef() == 0) {
-        ObjectTracker::StopTrackingObject(m_Data.m_Object);
-        delete m_Data.m_Object;
+        DestroyObject(m_Data.m_Object);
       }
     }
   }
 
+  void Value::DestroyObject(GraceObject* object)
+  {
+    if (object->ArenaSize() != 0) {
+      ObjectArena::Destroy(object);
+    } else {
+      ObjectTracker::StopTrackingObject(object);
+      delete object;
+    }
+  }
+
   Value Value::operator+(const Value& other) const
   {
     switch (m_Type) {
@@ -230,12 +241,7 @@ namespace Grace::VM
       }
       case Type::String: {
         if (other.m_Type == Type::Int) {
-          std::string res;
-          res.reserve(m_Data.m_Str->size() * other.m_Data.m_Int);
-          for (auto i = 0; i < other.m_Data.m_Int; i++) {
-            res += Get<std::string>();
-          }
-          return Value(res);
+          return Value(StringAlgorithms::Repeat(*m_Data.m_Str, static_cast<std::size_t>(std::max(other.m_Data.m_Int, std::int64_t{0}))));
         }
         break;
       }
@@ -821,56 +827,42 @@ namespace Grace::VM
 
   void Value::PrintLn(bool err) const
   {
-    auto stream = err ? stderr : stdout;
-    switch (m_Type) {
-      case Type::Bool:
-        fmt::print(stream, "{}\n", m_Data.m_Bool);
-        break;
-      case Type::Char:
-        fmt::print(stream, "{}\n", m_Data.m_Char);
-        break;
-      case Type::Double:
-        fmt::print(stream, "{}\n", m_Data.m_Double);
-        break;
-      case Type::Int:
-        fmt::print(stream, "{}\n", m_Data.m_Int);
-        break;
-      case Type::Null:
-        fmt::print(stream, "null\n");
-        break;
-      case Type::Object:
-        m_Data.m_Object->PrintLn(err);
-        break;
-      case Type::String:
-        fmt::print(stream, "{}\n", *m_Data.m_Str);
-        break;
-    }
+    auto& sink = err ? OutputBuffer::Stderr() : OutputBuffer::Stdout();
+    Write(sink);
+    sink.Write('\n');
+    sink.EndPrint();
   }
 
   void Value::Print(bool err) const
   {
-    auto stream = err ? stderr : stdout;
+    auto& sink = err ? OutputBuffer::Stderr() : OutputBuffer::Stdout();
+    Write(sink);
+    sink.EndPrint();
+  }
+
+  void Value::Write(OutputBuffer& sink) const
+  {
     switch (m_Type) {
       case Type::Bool:
-        fmt::print(stream, "{}", m_Data.m_Bool);
+        sink.Write(m_Data.m_Bool ? "true" : "false");
         break;
       case Type::Char:
-        fmt::print(stream, "{}", m_Data.m_Char);
+        sink.Write(m_Data.m_Char);
         break;
       case Type::Double:
-        fmt::print(stream, "{}", m_Data.m_Double);
+        sink.Format("{}", m_Data.m_Double);
         break;
       case Type::Int:
-        fmt::print(stream, "{}", m_Data.m_Int);
+        sink.Format("{}", m_Data.m_Int);
         break;
       case Type::Null:
-        fmt::print(stream, "null");
+        sink.Write("null");
         break;
       case Type::Object:
-        m_Data.m_Object->Print(err);
+        m_Data.m_Object->Write(sink);
         break;
       case Type::String:
-        fmt::print(stream, "{}", *m_Data.m_Str);
+        sink.Write(*m_Data.m_Str);
         break;
       default:
         GRACE_ASSERT(false, "Value::m_Type was not set");
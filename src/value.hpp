@@ -13,6 +13,7 @@
 #define GRACE_VALUE_HPP
 
 #include <functional>
+#include <new>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -24,6 +25,7 @@
 #include "grace.hpp"
 #include "objects/grace_exception.hpp"
 #include "objects/grace_object.hpp"
+#include "objects/object_arena.hpp"
 #include "objects/object_tracker.hpp"
 
 namespace Grace
@@ -81,9 +83,16 @@ namespace Grace
         }
       }
 
+      // takes over the buffer of a String that was built up natively instead of copying it
+      GRACE_INLINE explicit Value(std::string&& value)
+        : m_Type(Type::String)
+      {
+        m_Data.m_Str = new std::string(std::move(value));
+      }
+
       Value();
       Value(const Value& other);
-      Value(Value&& other);
+      Value(Value&& other) noexcept;
 
       // ONLY call with an object that already exists and has refs elsewhere, this is really only for use in the cycle cleaner
       Value(GraceObject* object);
@@ -95,14 +104,42 @@ namespace Grace
       template<DerivedGraceObject T, typename... Args>
       GRACE_NODISCARD static Value CreateObject(Args&&... args)
       {
+        // construct first, if the constructor throws the Value must not be left holding an Object that was never made
+        auto object = new T(std::forward<Args>(args)...);
         Value res;
         res.m_Type = Type::Object;
-        res.m_Data.m_Object = new T(std::forward<Args>(args)...);
+        res.m_Data.m_Object = object;
         res.m_Data.m_Object->IncreaseRef();
         ObjectTracker::TrackObject(res.m_Data.m_Object);        
         return res;
       }
 
+      // Allocates a GraceObject in the ObjectArena without tracking it, only for objects the optimiser has proven
+      // never escape the Function that creates them, so can never be part of a cycle
+      template<DerivedGraceObject T, typename... Args>
+      GRACE_NODISCARD static Value CreateArenaObject(Args&&... args)
+      {
+        auto memory = ObjectArena::Allocate(sizeof(T));
+        GraceObject* object;
+        try {
+          object = new (memory) T(std::forward<Args>(args)...);
+        } catch (...) {
+          ObjectArena::Deallocate(memory, sizeof(T));
+          throw;
+        }
+
+        object->SetArenaSize(static_cast<std::uint32_t>(sizeof(T)));
+
+        Value res;
+        res.m_Type = Type::Object;
+        res.m_Data.m_Object = object;
+        res.m_Data.m_Object->IncreaseRef();
+        return res;
+      }
+
+      // Frees an object whose ref count has reached 0, from wherever it was allocated
+      static void DestroyObject(GraceObject* object);
+
       constexpr Value& operator=(const Value& other)
       {
         if (this != &other) {
@@ -112,8 +149,7 @@ namespace Grace
 
           if (m_Type == Type::Object) {
             if (m_Data.m_Object->DecreaseRef() == 0) {
-              ObjectTracker::StopTrackingObject(m_Data.m_Object);
-              delete m_Data.m_Object;
+              DestroyObject(m_Data.m_Object);
             }
           }
 
@@ -139,8 +175,7 @@ namespace Grace
           
           if (m_Type == Type::Object) {
             if (m_Data.m_Object->DecreaseRef() == 0) {
-              ObjectTracker::StopTrackingObject(m_Data.m_Object);
-              delete m_Data.m_Object;
+              DestroyObject(m_Data.m_Object);
             }
           }
 
@@ -164,8 +199,7 @@ namespace Grace
 
         if (m_Type == Type::Object) {
           if (m_Data.m_Object->DecreaseRef() == 0) {
-            ObjectTracker::StopTrackingObject(m_Data.m_Object);
-            delete m_Data.m_Object;
+            DestroyObject(m_Data.m_Object);
           }
         }
 
@@ -226,6 +260,7 @@ namespace Grace
 
       void PrintLn(bool err) const;
       void Print(bool err) const;
+      void Write(OutputBuffer& sink) const;
       void DebugPrint() const;
 
       GRACE_NODISCARD GRACE_INLINE bool IsNumber() const
@@ -9,10 +9,13 @@
  *  For licensing information, see grace.hpp
  */
 
+#include <charconv>
 #include <chrono>
 #include <cstdlib>
 #include <filesystem>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <stack>
 #include <utility>
 
@@ -22,9 +25,15 @@
 
 #include "grace.hpp"
 
+#include "event_loop.hpp"
+#include "output_buffer.hpp"
 #include "scanner.hpp"
 #include "vm.hpp"
+#include "objects/grace_bytes.hpp"
+#include "objects/grace_csv.hpp"
 #include "objects/grace_exception.hpp"
+#include "objects/grace_file.hpp"
+#include "objects/grace_generator.hpp"
 #include "objects/grace_instance.hpp"
 #include "objects/grace_iterator.hpp"
 #include "objects/grace_dictionary.hpp"
@@ -42,8 +51,9 @@ namespace Grace::VM
   std::unordered_map<std::int64_t, std::unordered_map<std::int64_t, VM::Class>> VM::m_ClassLookup;
   std::vector<VM::OpLine> VM::m_FullOpList;
   std::vector<Value> VM::m_FullConstantList;
-  std::int64_t VM::m_LastFileNameHash{};
-  std::int64_t VM::m_LastFunctionHash{};
+  std::size_t VM::m_WorkerExitOp = 0;
+  std::vector<VM::InlinedRange> VM::m_InlinedRanges;
+  VM::Function* VM::m_LastFunction = nullptr;
   std::hash<std::string> VM::m_Hasher;
 
   static std::pair<Value, Value> PopLastTwo(std::vector<Value>& stack)
@@ -62,6 +72,155 @@ namespace Grace::VM
     return c;
   }
 
+  // for the specialised ops the compiler emits when type annotations say both operands are Ints
+  // annotations aren't enforced unless running with --check-types, so if they were wrong leave the stack alone
+  // and let the caller fall back to the generic op
+  static bool PopLastTwoInts(std::vector<Value>& stack, std::int64_t& c1, std::int64_t& c2)
+  {
+    const auto& v1 = stack[stack.size() - 2];
+    const auto& v2 = stack[stack.size() - 1];
+    if (v1.GetType() != Value::Type::Int || v2.GetType() != Value::Type::Int) {
+      return false;
+    }
+    c1 = v1.Get<std::int64_t>();
+    c2 = v2.Get<std::int64_t>();
+    stack.pop_back();
+    stack.pop_back();
+    return true;
+  }
+
+  template<typename T>
+  static bool Compare(Ops comparison, const T& c1, const T& c2)
+  {
+    switch (comparison) {
+      case Ops::EqualInt:
+        return c1 == c2;
+      case Ops::NotEqualInt:
+        return c1 != c2;
+      case Ops::GreaterInt:
+        return c1 > c2;
+      case Ops::GreaterEqualInt:
+        return c1 >= c2;
+      case Ops::LessInt:
+        return c1 < c2;
+      case Ops::LessEqualInt:
+        return c1 <= c2;
+      default:
+        GRACE_UNREACHABLE();
+        return false;
+    }
+  }
+
+  static Value Subscript(const Value& container, const Value& subscript)
+  {
+    auto valueType = container.GetType();
+    if (valueType == Value::Type::String) {
+      const auto& s = container.Get<std::string>();
+      if (subscript.GetType() != Value::Type::Int) {
+        throw GraceException(GraceException::Type::InvalidType, fmt::format("Expected `Int` for subscript index but got `{}`", subscript.GetTypeName()));
+      }
+      auto index = static_cast<std::size_t>(subscript.Get<std::int64_t>());
+      if (index >= s.length()) {
+        throw GraceException(GraceException::Type::IndexOutOfRange, fmt::format("Given index is {} but the length of the `String` is {}", index, s.length()));
+      }
+      return Value(s[index]);
+    }
+    
+    if (valueType == Value::Type::Object) {
+      auto object = container.GetObject();
+      
+      switch (object->ObjectType()) {
+        case GraceObjectType::List: {
+          if (subscript.GetType() != Value::Type::Int) {
+            throw GraceException(GraceException::Type::InvalidType, fmt::format("Expected `Int` for subscript index but got `{}`", subscript.GetTypeName()));
+          }
+          auto i = static_cast<std::size_t>(subscript.Get<std::int64_t>());
+          return (*object->GetAsList())[i];
+        }
+        case GraceObjectType::Dictionary:
+          return object->GetAsDictionary()->Get(subscript);
+        case GraceObjectType::Bytes:
+          if (subscript.GetType() != Value::Type::Int) {
+            throw GraceException(GraceException::Type::InvalidType, fmt::format("Expected `Int` for subscript index but got `{}`", subscript.GetTypeName()));
+          }
+          return Value(static_cast<std::int64_t>(object->GetAsBytes()->At(subscript.Get<std::int64_t>())));
+        default:
+          GRACE_UNREACHABLE();
+          break;
+      }
+    }
+
+    throw GraceException(GraceException::Type::InvalidType, fmt::format("`{}` cannot be indexed", container.GetTypeName()));
+  }
+
+  // the optimiser works out which objects can go in the ObjectArena, see FindNonEscapingObjects
+  template<DerivedGraceObject T, typename... Args>
+  static Value NewObject(bool noEscape, Args&&... args)
+  {
+    return noEscape ? Value::CreateArenaObject<T>(std::forward<Args>(args)...) : Value::CreateObject<T>(std::forward<Args>(args)...);
+  }
+
+  // type indices are the same as the ones used by `instanceof`
+  static bool HasTypeIndex(const Value& value, std::int64_t typeIdx)
+  {
+    if (typeIdx < 6) {
+      return typeIdx == static_cast<std::int64_t>(value.GetType());
+    }
+    auto object = value.GetObject();
+    return object != nullptr && typeIdx - 6 == static_cast<std::int64_t>(object->ObjectType());
+  }
+
+  // joins the top numParts values on the stack into one String, which is sized first so it's only allocated once
+  static Value Interpolate(std::vector<Value>& stack, std::size_t numParts)
+  {
+    auto first = stack.end() - static_cast<std::ptrdiff_t>(numParts);
+
+    std::size_t length = 0;
+    for (auto it = first; it != stack.end(); ++it) {
+      switch (it->GetType()) {
+        case Value::Type::String:
+          length += it->Get<std::string>().size();
+          break;
+        case Value::Type::Char:
+          length++;
+          break;
+        case Value::Type::Int:
+          // enough for any std::int64_t, the exact length isn't known until it's written
+          length += 20;
+          break;
+        default:
+          *it = Value(it->AsString());
+          length += it->Get<std::string>().size();
+          break;
+      }
+    }
+
+    std::string result;
+    result.reserve(length);
+    for (auto it = first; it != stack.end(); ++it) {
+      switch (it->GetType()) {
+        case Value::Type::String:
+          result.append(it->Get<std::string>());
+          break;
+        case Value::Type::Char:
+          result.push_back(it->Get<char>());
+          break;
+        case Value::Type::Int: {
+          char digits[20];
+          auto [end, error] = std::to_chars(digits, digits + sizeof(digits), it->Get<std::int64_t>());
+          result.append(digits, end);
+          break;
+        }
+        default:
+          GRACE_UNREACHABLE();
+          break;
+      }
+    }
+
+    stack.erase(first, stack.end());
+    return Value(std::move(result));
+  }
+
 #ifdef GRACE_DEBUG
   static void PrintStack(const std::vector<Value>& stack, const std::string& funcName)
   {
@@ -112,8 +271,7 @@ namespace Grace::VM
 
     auto [it, res] = m_FunctionLookup.at(fileNameHash).try_emplace(funcNameHash, func);
     if (res) {
-      m_LastFileNameHash = fileNameHash;
-      m_LastFunctionHash = funcNameHash;
+      m_LastFunction = it->second.get();
       return true;
     }
     return false;
@@ -133,7 +291,6 @@ namespace Grace::VM
 
     auto [it, res] = m_ClassLookup.at(fileNameHash).try_emplace(classNameHash, cls);
     if (res) {
-      m_LastFileNameHash = fileNameHash;
       return true;
     }
 
@@ -145,18 +302,38 @@ namespace Grace::VM
     auto mainHash = static_cast<std::int64_t>(m_Hasher("main"));
     auto mainFileNameHash = static_cast<std::int64_t>(m_Hasher(mainFileName));
 
-    auto it = m_FunctionLookup.at(mainFileNameHash).find(mainHash);
-    if (it == m_FunctionLookup.at(mainFileNameHash).end()) {
+    if (!m_FunctionLookup.at(mainFileNameHash).contains(mainHash)) {
       fmt::print(stderr, fmt::fg(fmt::color::red) | fmt::emphasis::bold, "ERROR: ");
       fmt::print(stderr, "Could not find `main` function in file, execution cannot proceed.\n");
       return false;
     }
 
-    m_FullOpList = it->second->opList;
-    m_FullConstantList = it->second->constantList;
+    CombineFunctions(mainFileNameHash, mainHash);
+
+    m_WorkerExitOp = m_FullOpList.size();
+    m_FullOpList.push_back({ Ops::Exit, 0 });
+
+  #ifdef GRACE_DEBUG
+    if (verbose) { 
+      fmt::print("FULL OP LIST:\n");
+      for (auto [op, line] : m_FullOpList) {
+        fmt::print("{:>5} | {}\n", line, op);
+      }
+    }
+  #endif
+
+    return true;
+  }
+
+  void VM::CombineFunctions(std::int64_t entryFileNameHash, std::int64_t entryNameHash)
+  {
+    const auto& entryFunc = m_FunctionLookup.at(entryFileNameHash).at(entryNameHash);
+    m_FullOpList = entryFunc->opList;
+    m_FullConstantList = entryFunc->constantList;
+    m_InlinedRanges = entryFunc->inlinedRanges;
     for (auto& [fileName, funcList] : m_FunctionLookup) {
       for (auto& [name, func] : funcList) {
-        if (name == mainHash) {
+        if (name == entryNameHash) {
           continue;
         }
 
@@ -169,19 +346,14 @@ namespace Grace::VM
         func->constantIndexStart = m_FullConstantList.size();
         m_FullConstantList.reserve(constantList.size());
         m_FullConstantList.insert(m_FullConstantList.end(), constantList.begin(), constantList.end());
-      }
-    }
 
-  #ifdef GRACE_DEBUG
-    if (verbose) { 
-      fmt::print("FULL OP LIST:\n");
-      for (auto [op, line] : m_FullOpList) {
-        fmt::print("{:>5} | {}\n", line, op);
+        for (auto range : func->inlinedRanges) {
+          range.opStart += func->opIndexStart;
+          range.opEnd += func->opIndexStart;
+          m_InlinedRanges.push_back(range);
+        }
       }
     }
-  #endif
-
-    return true;
   }
 
   InterpretResult VM::Start(const std::string& mainFileName, bool verbose, const std::vector<std::string>& args)
@@ -190,7 +362,7 @@ namespace Grace::VM
 
     auto mainFileNameHash = static_cast<std::int64_t>(m_Hasher(mainFileName));
     auto start = steady_clock::now();
-    auto res = Run(mainFileNameHash, verbose, args);
+    auto res = Run(mainFileNameHash, static_cast<std::int64_t>(m_Hasher("main")), verbose, args);
     auto end = steady_clock::now();
   
     if (verbose) {
@@ -210,46 +382,158 @@ namespace Grace::VM
     return res;
   }
 
-  InterpretResult VM::Run(std::int64_t mainFileNameHash, GRACE_MAYBE_UNUSED bool verbose, const std::vector<std::string>& clArgs)
+  std::optional<Value> VM::EvaluateConstant()
   {
-  #define PRINT_LOCAL_MEMORY()                                                                          \
-    do {                                                                                                \
-      if (verbose) {                                                                                    \
-        PrintStack(valueStack, m_FunctionLookup.at(fileNameStack.top().first).at(funcNameHash)->name);  \
-        PrintLocals(localsList, m_FunctionLookup.at(fileNameStack.top().first).at(funcNameHash)->name); \
-      }                                                                                                 \
-    } while (false)                                                                                     \
+    auto fileNameHash = m_LastFunction->fileNameHash;
+    auto nameHash = m_LastFunction->nameHash;
 
-    auto interpretResult = InterpretResult::RuntimeOk;
+    Value result;
+    CombineFunctions(fileNameHash, nameHash);
+    auto res = Run(fileNameHash, nameHash, false, {}, &result);
 
-    auto funcNameHash = static_cast<std::int64_t>(m_Hasher("main"));
-    std::vector<Value> valueStack, localsList;
-    valueStack.reserve(16);
-    localsList.reserve(16);
+    // the functions are combined again once the whole program is compiled
+    m_FullOpList.clear();
+    m_FullConstantList.clear();
+    m_InlinedRanges.clear();
+    RemoveLastFunction();
 
-    std::vector<Value> argsAsValues;
-    for (const auto& a : clArgs) {
-      argsAsValues.emplace_back(a);
+    if (res != InterpretResult::RuntimeOk) {
+      return {};
     }
-    localsList.push_back(Value::CreateObject<Grace::GraceList>(std::move(argsAsValues)));
 
-    std::size_t opCurrent = 0, constantCurrent = 0;
-  
-    auto& mainFunc = m_FunctionLookup.at(mainFileNameHash).at(funcNameHash);
+    if (result.GetType() == Value::Type::Object) {
+      auto object = result.GetObject();
+      // constants live for the whole program, so they're never destroyed
+      // this also keeps them out of the cycle cleaner and away from the order statics are destroyed in
+      // it has to happen before freezing, since the count of a frozen object doesn't change
+      object->IncreaseRef();
+      if (!object->Freeze()) {
+        fmt::print(stderr, fmt::fg(fmt::color::red) | fmt::emphasis::bold, "ERROR: ");
+        fmt::print(stderr, "A `{}` cannot be the value of a `const`, since it or something it contains can be modified.\n", result.GetTypeName());
+        return {};
+      }
+    }
 
-    std::vector<std::pair<std::size_t, std::size_t>> opConstOffsets;
-    opConstOffsets.reserve(32);
-    opConstOffsets.emplace_back(mainFunc->opIndexStart, mainFunc->constantIndexStart);
+    return result;
+  }
 
-    std::stack<std::size_t> localsOffsets;
-    localsOffsets.push(0);  // [0] is args
+  void VM::RemoveLastFunction()
+  {
+    m_FunctionLookup.at(m_LastFunction->fileNameHash).erase(m_LastFunction->nameHash);
+    m_LastFunction = nullptr;
+  }
 
-    std::vector<CallStackEntry> callStack;
-    callStack.push_back({ static_cast<std::int64_t>(m_Hasher("file")), funcNameHash, 1, mainFunc->fileName, mainFunc->fileName, mainFunc->fileNameHash, mainFunc->fileNameHash });
+  std::pair<std::int64_t, std::int64_t> VM::FindWorkerFunction(std::string_view qualifiedName, std::size_t arity, std::string_view runningOn)
+  {
+    // `a::b::name` matches a function called `name` in a file whose namespace ends with `a`, `b`
+    std::vector<std::string_view> nameSpace;
+    std::size_t partStart = 0;
+    while (true) {
+      auto partEnd = qualifiedName.find("::", partStart);
+      if (partEnd == std::string_view::npos) {
+        break;
+      }
+      nameSpace.push_back(qualifiedName.substr(partStart, partEnd - partStart));
+      partStart = partEnd + 2;
+    }
+    auto name = qualifiedName.substr(partStart);
+    auto nameHash = static_cast<std::int64_t>(m_Hasher(std::string(name)));
+
+    std::vector<const Function*> matches;
+    for (const auto& [fileNameHash, funcList] : m_FunctionLookup) {
+      auto funcIt = funcList.find(nameHash);
+      if (funcIt == funcList.end()) {
+        continue;
+      }
 
-    std::stack<std::pair<std::int64_t, std::string>> fileNameStack;
-    fileNameStack.push({ mainFileNameHash, mainFunc->fileName });
+      // `main` is only ever combined into the op list as the entry of the program
+      const auto& func = funcIt->second;
+      // a generator's frame can't be moved to another thread, so it can't be the entry of one either
+      if (!func->exported || func->extensionMethod || func->generator || func->name == "main" || func->namespaceVec.size() < nameSpace.size()) {
+        continue;
+      }
+
+      if (std::equal(nameSpace.rbegin(), nameSpace.rend(), func->namespaceVec.rbegin())) {
+        matches.push_back(func.get());
+      }
+    }
+
+    if (matches.empty()) {
+      throw GraceException(
+        GraceException::Type::FunctionNotFound,
+        fmt::format("Cannot find an exported function `{}` to run on a {}", qualifiedName, runningOn)
+      );
+    }
+
+    if (matches.size() > 1) {
+      throw GraceException(
+        GraceException::Type::FunctionNotFound,
+        fmt::format("More than one file exports a function `{}`, qualify it with its module, e.g. `{}::{}`",
+          qualifiedName, matches.front()->namespaceVec.back(), name)
+      );
+    }
+
+    const auto func = matches.front();
+    if (func->arity != arity) {
+      throw GraceException(
+        GraceException::Type::IncorrectArgCount,
+        fmt::format("Incorrect number of arguments given to function '{}', expected {} but got {}", func->name, func->arity, arity)
+      );
+    }
+
+    return { func->fileNameHash, func->nameHash };
+  }
+
+  Value VM::RunWorker(std::int64_t fileNameHash, std::int64_t nameHash, std::vector<Value>&& args)
+  {
+    WorkerEntry worker{ std::move(args), {}, {} };
+    if (Run(fileNameHash, nameHash, false, {}, nullptr, &worker) != InterpretResult::RuntimeOk) {
+      throw GraceException(GraceException::Type::ThreadFailed, std::move(worker.error));
+    }
+    return std::move(worker.result);
+  }
+
+  VM::Task::Task(std::int64_t fileNameHash, std::int64_t nameHash, std::vector<Value>&& args)
+    : m_FileNameHash(fileNameHash)
+    , m_NameHash(nameHash)
+    , m_Worker{ std::move(args), {}, {} }
+    , m_Thread(std::this_thread::get_id())
+  {
 
+  }
+
+  VM::Task::~Task() = default;
+
+  std::unique_ptr<VM::Task> VM::StartTask(std::string_view qualifiedName, std::vector<Value>&& args)
+  {
+    auto [fileNameHash, nameHash] = FindWorkerFunction(qualifiedName, args.size(), "Task");
+    return std::unique_ptr<Task>(new Task(fileNameHash, nameHash, std::move(args)));
+  }
+
+  InterpretResult VM::Resume(Task& task, Budget budget)
+  {
+    if (task.m_Thread != std::this_thread::get_id()) {
+      throw GraceException(
+        GraceException::Type::ThreadFailed,
+        "A Task can only be resumed on the thread that started it, since everything it uses belongs to that thread"
+      );
+    }
+
+    if (task.m_Finished) {
+      throw GraceException(GraceException::Type::ThreadFailed, "This Task has already finished");
+    }
+
+    auto unlimited = budget.ops == 0 && budget.time.count() == 0;
+    auto result = unlimited
+      ? Run(task.m_FileNameHash, task.m_NameHash, false, {}, nullptr, &task.m_Worker, &task)
+      : Run<true>(task.m_FileNameHash, task.m_NameHash, false, {}, nullptr, &task.m_Worker, &task, budget);
+    task.m_Finished = result != InterpretResult::Suspended;
+    return result;
+  }
+
+  // Run() keeps these as its own locals, and only swaps them with the ones kept here when a Task is suspended or resumed
+  struct VM::RunState
+  {
     // used to restore the "state" of the VM before entering a try block
     // if an exception is caught
     struct VMState
@@ -259,16 +543,225 @@ namespace Grace::VM
       std::int64_t opIndexToJump{}, constIndexToJump{};
     };
 
+    // a generator whose frame is on the stacks, with the size of the call stack and value stack once it was resumed
+    struct GeneratorFrame
+    {
+      Value generator;
+      std::size_t callStackSize, stackSize;
+    };
+
+    std::int64_t funcNameHash{};
+    std::size_t opCurrent{}, constantCurrent{};
+    std::vector<Value> valueStack, localsList;
+    std::vector<std::pair<std::size_t, std::size_t>> opConstOffsets;
+    std::stack<std::size_t> localsOffsets;
+    std::vector<CallStackEntry> callStack;
+    std::stack<std::pair<std::int64_t, std::string>> fileNameStack;
     std::stack<VMState> vmStateStack;
     std::stack<Value> heldIterators;
-    std::stack<std::vector<std::pair<std::string, std::int64_t>>> namespaceLookupStack; // used to keep track of what namespace we look for a call in
-    namespaceLookupStack.emplace();
+    std::stack<std::vector<std::pair<std::string, std::int64_t>>> namespaceLookupStack;
+    std::vector<GeneratorFrame> generatorFrames;
+    bool inTryBlock{};
+  };
 
+  // how many ops a Task with a time budget runs between looking at the clock
+  static constexpr std::uint64_t s_OpsPerClockCheck = 256;
+
+  template<bool Budgeted>
+  InterpretResult VM::Run(std::int64_t entryFileNameHash, std::int64_t entryNameHash, GRACE_MAYBE_UNUSED bool verbose,
+    const std::vector<std::string>& clArgs, Value* constantResult, WorkerEntry* worker, Task* task, Budget budget)
+  {
+  #define PRINT_LOCAL_MEMORY()                                                                          \
+    do {                                                                                                \
+      if (verbose) {                                                                                    \
+        PrintStack(valueStack, m_FunctionLookup.at(fileNameStack.top().first).at(funcNameHash)->name);  \
+        PrintLocals(localsList, m_FunctionLookup.at(fileNameStack.top().first).at(funcNameHash)->name); \
+      }                                                                                                 \
+    } while (false)                                                                                     \
+
+    using VMState = RunState::VMState;
+    using GeneratorFrame = RunState::GeneratorFrame;
+
+    auto interpretResult = InterpretResult::RuntimeOk;
+
+    auto funcNameHash = entryNameHash;
+    std::size_t opCurrent{}, constantCurrent{};
+    std::vector<Value> valueStack, localsList;
+    std::vector<std::pair<std::size_t, std::size_t>> opConstOffsets;
+    std::stack<std::size_t> localsOffsets;
+    std::vector<CallStackEntry> callStack;
+    std::stack<std::pair<std::int64_t, std::string>> fileNameStack;
+    std::stack<VMState> vmStateStack;
+    std::stack<Value> heldIterators;
+    std::stack<std::vector<std::pair<std::string, std::int64_t>>> namespaceLookupStack; // used to keep track of what namespace we look for a call in
+    // the generators whose frames are on the stacks
+    std::vector<GeneratorFrame> generatorFrames;
     bool inTryBlock = false;
+    // a failed assertion leaves without reaching an Exit
+    bool reachedExit = false;
+
+    auto swapState = [&](RunState& state) {
+      std::swap(funcNameHash, state.funcNameHash);
+      std::swap(opCurrent, state.opCurrent);
+      std::swap(constantCurrent, state.constantCurrent);
+      std::swap(valueStack, state.valueStack);
+      std::swap(localsList, state.localsList);
+      std::swap(opConstOffsets, state.opConstOffsets);
+      std::swap(localsOffsets, state.localsOffsets);
+      std::swap(callStack, state.callStack);
+      std::swap(fileNameStack, state.fileNameStack);
+      std::swap(vmStateStack, state.vmStateStack);
+      std::swap(heldIterators, state.heldIterators);
+      std::swap(namespaceLookupStack, state.namespaceLookupStack);
+      std::swap(generatorFrames, state.generatorFrames);
+      std::swap(inTryBlock, state.inTryBlock);
+    };
+
+    if (task != nullptr && task->m_State != nullptr) {
+      // carry on from the op the task was suspended before
+      swapState(*task->m_State);
+    } else {
+      valueStack.reserve(16);
+      localsList.reserve(16);
+
+      auto& mainFunc = m_FunctionLookup.at(entryFileNameHash).at(funcNameHash);
+      opCurrent = mainFunc->opIndexStart;
+      constantCurrent = mainFunc->constantIndexStart;
+
+      if (worker != nullptr) {
+        // the entry function returns like any other call would, into the Exit waiting at m_WorkerExitOp
+        localsList = std::move(worker->args);
+        valueStack.emplace_back(static_cast<std::int64_t>(m_WorkerExitOp));
+        valueStack.emplace_back(std::int64_t{});
+        valueStack.emplace_back(std::int64_t{});
+      } else {
+        std::vector<Value> argsAsValues;
+        for (const auto& a : clArgs) {
+          argsAsValues.emplace_back(a);
+        }
+        localsList.push_back(Value::CreateObject<Grace::GraceList>(std::move(argsAsValues)));
+      }
+
+      opConstOffsets.reserve(32);
+      opConstOffsets.emplace_back(mainFunc->opIndexStart, mainFunc->constantIndexStart);
+
+      localsOffsets.push(0);  // [0] is args
+
+      callStack.push_back({ static_cast<std::int64_t>(m_Hasher("file")), funcNameHash, 1, mainFunc->fileName, mainFunc->fileName, mainFunc->fileNameHash, mainFunc->fileNameHash });
+
+      fileNameStack.push({ entryFileNameHash, mainFunc->fileName });
+
+      namespaceLookupStack.emplace();
+    }
+
+    // the budget is handed out a few ops at a time, and only looked at between ops, where everything needed to carry on is on the stacks
+    // a Run() that isn't Budgeted never looks at these, so anything besides a Task with a budget doesn't pay for them
+    GRACE_ASSERT(!Budgeted || task != nullptr, "Only a Task can have a budget");
+    auto hasDeadline = budget.time.count() > 0;
+    auto deadline = hasDeadline ? std::chrono::steady_clock::now() + budget.time : std::chrono::steady_clock::time_point{};
+    auto opsPerCheck = hasDeadline ? s_OpsPerClockCheck : std::numeric_limits<std::uint64_t>::max();
+    auto opsLeft = budget.ops == 0 ? std::numeric_limits<std::uint64_t>::max() : budget.ops;
+    auto opsUntilCheck = std::min(opsLeft, opsPerCheck);
+    opsLeft -= opsUntilCheck;
+
+    // calls a Function whose body only passes its arguments on to a native function, without pushing a frame for it
+    // if the native throws, the frame is pushed anyway so the error looks like it came from inside the Function
+    auto callNativeForward = [&](const Function& calleeFunc, std::int64_t calleeNameHash, std::size_t& line, std::vector<Value>& args) {
+      const auto& forward = *calleeFunc.nativeForward;
+      try {
+        if (constantResult != nullptr && !m_NativeFunctions[forward.nativeIndex].IsPure()) {
+          throw GraceException(GraceException::Type::ImpureConstant, fmt::format("Calling `{}` is not allowed in the initialiser of a `const`", calleeFunc.name));
+        }
+        auto result = m_NativeFunctions[forward.nativeIndex](args);
+        if (forward.returnsResult) {
+          valueStack.push_back(std::move(result));
+        } else {
+          valueStack.emplace_back();
+        }
+      } catch (const GraceException&) {
+        callStack.push_back({ funcNameHash, calleeNameHash, line, fileNameStack.top().second, calleeFunc.fileName, fileNameStack.top().first, calleeFunc.fileNameHash });
+        fileNameStack.push({ calleeFunc.fileNameHash, calleeFunc.fileName });
+        line = forward.line;
+        throw;
+      }
+    };
+
+    // calling a generator function only keeps its arguments, the body doesn't start until the generator is iterated over
+    auto createGenerator = [](const Function& function, std::vector<Value>&& args) {
+      GraceGenerator::Frame frame;
+      frame.functionName = function.name;
+      frame.fileName = function.fileName;
+      frame.nameHash = function.nameHash;
+      frame.fileNameHash = function.fileNameHash;
+      frame.opIndexStart = frame.opIndex = function.opIndexStart;
+      frame.constantIndexStart = frame.constantIndex = function.constantIndexStart;
+      frame.locals = std::move(args);
+      return Value::CreateObject<GraceGenerator>(std::move(frame));
+    };
+
+    // moves a generator's frame onto the stacks as if it had been called, returning to the op at returnOp
+    // that is the op which resumed it, so it runs again to take what the generator yielded
+    auto resumeGenerator = [&](Value generatorValue, std::size_t returnOp, std::size_t returnConstant, std::size_t line) {
+      auto generator = generatorValue.GetObject()->GetAsGenerator();
+      generator->Resume();
+      auto& frame = generator->GetFrame();
+
+      callStack.push_back({ funcNameHash, frame.nameHash, line, fileNameStack.top().second, frame.fileName, fileNameStack.top().first, frame.fileNameHash });
+
+      valueStack.emplace_back(static_cast<std::int64_t>(returnOp));
+      valueStack.emplace_back(static_cast<std::int64_t>(returnConstant));
+      valueStack.emplace_back(static_cast<std::int64_t>(heldIterators.size()));
+      generatorFrames.push_back({ std::move(generatorValue), callStack.size(), valueStack.size() });
+
+      valueStack.insert(valueStack.end(), std::make_move_iterator(frame.stack.begin()), std::make_move_iterator(frame.stack.end()));
+      frame.stack.clear();
 
-    ObjectTracker::SetVerbose(verbose);
+      localsOffsets.push(localsList.size());
+      localsList.insert(localsList.end(), std::make_move_iterator(frame.locals.begin()), std::make_move_iterator(frame.locals.end()));
+      frame.locals.clear();
+
+      for (auto& iterator : frame.heldIterators) {
+        heldIterators.push(std::move(iterator));
+      }
+      frame.heldIterators.clear();
+
+      fileNameStack.push({ frame.fileNameHash, frame.fileName });
+
+      opCurrent = frame.opIndex;
+      constantCurrent = frame.constantIndex;
+      opConstOffsets.emplace_back(frame.opIndexStart, frame.constantIndexStart);
+
+      funcNameHash = frame.nameHash;
+    };
+
+    // a `const` is evaluated while compiling, so its initialiser can't do anything besides produce its value
+    auto throwIfEvaluatingConstant = [constantResult](std::string_view what) {
+      if (constantResult != nullptr) {
+        throw GraceException(GraceException::Type::ImpureConstant, fmt::format("{} is not allowed in the initialiser of a `const`", what));
+      }
+    };
+
+    // a worker can be a fiber on a thread that is already running, which may have turned on verbose collection itself
+    if (worker == nullptr) {
+      ObjectTracker::SetVerbose(verbose);
+    }
 
     while (true) {
+      if constexpr (Budgeted) {
+        if (opsUntilCheck == 0) GRACE_UNLIKELY {
+          if (opsLeft == 0 || (hasDeadline && std::chrono::steady_clock::now() >= deadline)) {
+            if (task->m_State == nullptr) {
+              task->m_State = std::make_unique<RunState>();
+            }
+            swapState(*task->m_State);
+            return InterpretResult::Suspended;
+          }
+          opsUntilCheck = std::min(opsLeft, opsPerCheck);
+          opsLeft -= opsUntilCheck;
+        }
+        opsUntilCheck--;
+      }
+
       auto [op, line] = m_FullOpList[opCurrent++];
 
       try {
@@ -276,7 +769,14 @@ namespace Grace::VM
         switch (op) {
           case Ops::Add: {
             auto [c1, c2] = PopLastTwo(valueStack);
-            valueStack.push_back(c1 + c2);
+            // c1 belongs to us, so a String can be appended to in place instead of copied into a new one
+            // with MoveLocal, `s = s + x` then never copies s
+            if (c1.GetType() == Value::Type::String) {
+              c1 += c2;
+              valueStack.push_back(std::move(c1));
+            } else {
+              valueStack.push_back(c1 + c2);
+            }
             break;
           }
           case Ops::Subtract: {
@@ -289,6 +789,36 @@ namespace Grace::VM
             valueStack.push_back(c1 * c2);
             break;
           }
+          case Ops::AddInt: {
+            std::int64_t i1{}, i2{};
+            if (PopLastTwoInts(valueStack, i1, i2)) {
+              valueStack.emplace_back(i1 + i2);
+              break;
+            }
+            auto [c1, c2] = PopLastTwo(valueStack);
+            valueStack.push_back(c1 + c2);
+            break;
+          }
+          case Ops::SubtractInt: {
+            std::int64_t i1{}, i2{};
+            if (PopLastTwoInts(valueStack, i1, i2)) {
+              valueStack.emplace_back(i1 - i2);
+              break;
+            }
+            auto [c1, c2] = PopLastTwo(valueStack);
+            valueStack.push_back(c1 - c2);
+            break;
+          }
+          case Ops::MultiplyInt: {
+            std::int64_t i1{}, i2{};
+            if (PopLastTwoInts(valueStack, i1, i2)) {
+              valueStack.emplace_back(i1 * i2);
+              break;
+            }
+            auto [c1, c2] = PopLastTwo(valueStack);
+            valueStack.push_back(c1 * c2);
+            break;
+          }
           case Ops::Mod: {
             auto [c1, c2] = PopLastTwo(valueStack);
             valueStack.push_back(c1 % c2);
@@ -339,6 +869,21 @@ namespace Grace::VM
             valueStack.emplace_back(c1 <= c2);
             break;
           }
+          case Ops::EqualInt:
+          case Ops::NotEqualInt:
+          case Ops::GreaterInt:
+          case Ops::GreaterEqualInt:
+          case Ops::LessInt:
+          case Ops::LessEqualInt: {
+            std::int64_t i1{}, i2{};
+            if (PopLastTwoInts(valueStack, i1, i2)) {
+              valueStack.emplace_back(Compare(op, i1, i2));
+              break;
+            }
+            auto [c1, c2] = PopLastTwo(valueStack);
+            valueStack.emplace_back(Compare(op, c1, c2));
+            break;
+          }
           case Ops::Pow: {
             auto [c1, c2] = PopLastTwo(valueStack);
             valueStack.push_back(c1.Pow(c2));
@@ -393,6 +938,12 @@ namespace Grace::VM
             valueStack.push_back(value);
             break;
           }
+          // emitted by the optimiser when this is the last time the local's value is read
+          case Ops::MoveLocal: {
+            auto id = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
+            valueStack.push_back(std::move(localsList[id + localsOffsets.top()]));
+            break;
+          }
           case Ops::Pop:
             valueStack.pop_back();
             break;
@@ -405,29 +956,49 @@ namespace Grace::VM
             break;
           }
           case Ops::Print:
+            throwIfEvaluatingConstant("Printing");
             Pop(valueStack).Print(false);
             break;
-          case Ops::PrintEmptyLine:
-            fmt::print("\n");
+          case Ops::PrintEmptyLine: {
+            throwIfEvaluatingConstant("Printing");
+            auto& sink = OutputBuffer::Stdout();
+            sink.Write('\n');
+            sink.EndPrint();
             break;
+          }
           case Ops::PrintLn:
+            throwIfEvaluatingConstant("Printing");
             Pop(valueStack).PrintLn(false);
             break;
-          case Ops::PrintTab:
-            fmt::print("\t");
+          case Ops::PrintTab: {
+            throwIfEvaluatingConstant("Printing");
+            auto& sink = OutputBuffer::Stdout();
+            sink.Write('\t');
+            sink.EndPrint();
             break;
+          }
           case Ops::EPrint:
+            throwIfEvaluatingConstant("Printing");
             Pop(valueStack).Print(true);
             break;
-          case Ops::EPrintEmptyLine:
-            fmt::print(stderr, "\n");
+          case Ops::EPrintEmptyLine: {
+            throwIfEvaluatingConstant("Printing");
+            auto& sink = OutputBuffer::Stderr();
+            sink.Write('\n');
+            sink.EndPrint();
             break;
+          }
           case Ops::EPrintLn:
+            throwIfEvaluatingConstant("Printing");
             Pop(valueStack).PrintLn(true);
             break;
-          case Ops::EPrintTab:
-            fmt::print(stderr, "\t");
+          case Ops::EPrintTab: {
+            throwIfEvaluatingConstant("Printing");
+            auto& sink = OutputBuffer::Stderr();
+            sink.Write('\t');
+            sink.EndPrint();
             break;
+          }
           case Ops::AppendNamespace: {
             auto text = m_FullConstantList[constantCurrent++].Get<std::string>();
             auto hash = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
@@ -527,6 +1098,24 @@ namespace Grace::VM
               );
             }
 
+            if (calleeFunc->generator) {
+              std::vector<Value> args(arity);
+              for (std::size_t i = 0; i < arity; i++) {
+                args[arity - i - 1] = Pop(valueStack);
+              }
+              valueStack.push_back(createGenerator(*calleeFunc, std::move(args)));
+              break;
+            }
+
+            if (calleeFunc->nativeForward) {
+              std::vector<Value> args(arity);
+              for (std::size_t i = 0; i < arity; i++) {
+                args[arity - i - 1] = Pop(valueStack);
+              }
+              callNativeForward(*calleeFunc, calleeNameHash, line, args);
+              break;
+            }
+
             localsOffsets.push(localsList.size());
             localsList.resize(localsList.size() + arity);
             for (std::size_t i = 0; i < arity; i++) {
@@ -561,6 +1150,10 @@ namespace Grace::VM
               );
             }
 
+            if (constantResult != nullptr && !calleeFunc.IsPure()) {
+              throw GraceException(GraceException::Type::ImpureConstant, fmt::format("Calling `{}` is not allowed in the initialiser of a `const`", calleeFunc.GetName()));
+            }
+
             std::vector<Value> args(arity);
             for (std::uint32_t i = 0; i < arity; i++) {
               args[arity - i - 1] = Pop(valueStack);
@@ -588,8 +1181,8 @@ namespace Grace::VM
               throw GraceException(GraceException::Type::FunctionNotFound, fmt::format("Member function `{}` for type `{}` not found, you might be missing an import", calleeFuncName, callerObject.GetTypeName()));
             }
 
-            auto funcIt = std::find_if(funcListIt->second.begin(), funcListIt->second.end(), [&calleeFuncName](const std::shared_ptr<Function>& func) {
-                return func->name == calleeFuncName;
+            auto funcIt = std::find_if(funcListIt->second.begin(), funcListIt->second.end(), [calleeNameHash](const std::shared_ptr<Function>& func) {
+                return func->nameHash == calleeNameHash;
             });
             if (funcIt == funcListIt->second.end()) {
               throw GraceException(GraceException::Type::FunctionNotFound, fmt::format("Member function `{}` for type `{}` not found, you might be missing an import", calleeFuncName, callerObject.GetTypeName()));
@@ -606,6 +1199,18 @@ namespace Grace::VM
               );
             }
 
+            if (calleeFunc->generator) {
+              argsGiven.insert(argsGiven.begin(), std::move(callerObject));
+              valueStack.push_back(createGenerator(*calleeFunc, std::move(argsGiven)));
+              break;
+            }
+
+            if (calleeFunc->nativeForward) {
+              argsGiven.insert(argsGiven.begin(), std::move(callerObject));
+              callNativeForward(*calleeFunc, calleeNameHash, line, argsGiven);
+              break;
+            }
+
             localsOffsets.push(localsList.size());
             localsList.resize(localsList.size() + arity);
             for (std::size_t i = 0; i < arity - 1; i++) {
@@ -741,6 +1346,7 @@ namespace Grace::VM
             break;
           }
           case Ops::AssignIteratorBegin: {
+            auto constantStart = constantCurrent;
             auto value = Pop(valueStack);
             auto object = value.GetObject();
 
@@ -755,7 +1361,7 @@ namespace Grace::VM
             auto iteratorId = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
 
             if (auto list = object->GetAsList()) {
-              auto listIterator = Value::CreateObject<GraceIterator>(list, GraceIterator::IterableType::List);
+              auto listIterator = Value::CreateArenaObject<GraceIterator>(list, GraceIterator::IterableType::List);
               auto listIteratorObject = listIterator.GetObject()->GetAsIterator();
               heldIterators.push(listIterator);
               
@@ -768,7 +1374,7 @@ namespace Grace::VM
                 constantCurrent++;
               }
             } else if (auto dict = object->GetAsDictionary()) {
-              auto dictIterator = Value::CreateObject<GraceIterator>(dict, GraceIterator::IterableType::Dictionary);
+              auto dictIterator = Value::CreateArenaObject<GraceIterator>(dict, GraceIterator::IterableType::Dictionary);
               auto dictIteratorObject = dictIterator.GetObject()->GetAsIterator();
               heldIterators.push(dictIterator);
 
@@ -789,7 +1395,7 @@ namespace Grace::VM
                 constantCurrent++;
               }
             } else if (auto set = object->GetAsSet()) {
-              auto setIterator = Value::CreateObject<GraceIterator>(set, GraceIterator::IterableType::Set);
+              auto setIterator = Value::CreateArenaObject<GraceIterator>(set, GraceIterator::IterableType::Set);
               auto setIteratorObject = setIterator.GetObject()->GetAsIterator();
               heldIterators.push(setIterator);
 
@@ -803,7 +1409,7 @@ namespace Grace::VM
                 );
               }
             } else if (auto range = object->GetAsRange()) {
-              auto rangeIterator = Value::CreateObject<GraceIterator>(range, GraceIterator::IterableType::Range);
+              auto rangeIterator = Value::CreateArenaObject<GraceIterator>(range, GraceIterator::IterableType::Range);
               auto rangeIteratorObject = rangeIterator.GetObject()->GetAsIterator();
               heldIterators.push(rangeIterator);
 
@@ -816,6 +1422,54 @@ namespace Grace::VM
                   "`Range` does not support multiple iterators"
                 );
               }
+            } else if (auto lines = object->GetAsFileLines()) {
+              auto linesIterator = Value::CreateArenaObject<GraceIterator>(lines, GraceIterator::IterableType::FileLines);
+              auto linesIteratorObject = linesIterator.GetObject()->GetAsIterator();
+              heldIterators.push(linesIterator);
+
+              localsList[iteratorId + localsOffsets.top()] = linesIteratorObject->IsAtEnd() ? Value() : linesIteratorObject->Value();
+              constantCurrent++;
+
+              if (twoIterators) {
+                throw GraceException(
+                  GraceException::Type::InvalidCollectionOperation,
+                  "`FileLines` does not support multiple iterators"
+                );
+              }
+            } else if (auto rows = object->GetAsCsvRows()) {
+              auto rowsIterator = Value::CreateArenaObject<GraceIterator>(rows, GraceIterator::IterableType::CsvRows);
+              auto rowsIteratorObject = rowsIterator.GetObject()->GetAsIterator();
+              heldIterators.push(rowsIterator);
+
+              localsList[iteratorId + localsOffsets.top()] = rowsIteratorObject->IsAtEnd() ? Value() : rowsIteratorObject->Value();
+              constantCurrent++;
+
+              if (twoIterators) {
+                throw GraceException(
+                  GraceException::Type::InvalidCollectionOperation,
+                  "`CsvRows` does not support multiple iterators"
+                );
+              }
+            } else if (auto generator = object->GetAsGenerator()) {
+              if (twoIterators) {
+                throw GraceException(
+                  GraceException::Type::InvalidCollectionOperation,
+                  "`Generator` does not support multiple iterators"
+                );
+              }
+
+              // run the generator up to its first `yield`, then come back here with it still on the stack
+              if (!generator->IsReady()) {
+                valueStack.push_back(value);
+                resumeGenerator(std::move(value), opCurrent - 1, constantStart, line);
+                break;
+              }
+
+              auto generatorIterator = Value::CreateArenaObject<GraceIterator>(generator, GraceIterator::IterableType::Generator);
+              heldIterators.push(generatorIterator);
+
+              localsList[iteratorId + localsOffsets.top()] = generator->Take();
+              constantCurrent++;
             } else {
               // unreachable (?) due to IsIterable() check
               GRACE_ASSERT(false, "Object did not dynamic_cast to a valid iterable type");
@@ -823,12 +1477,23 @@ namespace Grace::VM
             break;
           }
           case Ops::IncrementIterator: {
+            auto constantStart = constantCurrent;
             auto twoIterators = m_FullConstantList[constantCurrent++].Get<bool>();
             auto iteratorVarId = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
             auto heldIterator = heldIterators.top().GetObject()->GetAsIterator();
             auto iterableType = heldIterator->GetType();
 
-            if (iterableType == GraceIterator::IterableType::List) {
+            if (iterableType == GraceIterator::IterableType::Generator) {
+              // run the generator up to its next `yield`, then come back here to take the value
+              auto generator = heldIterator->GetIterable()->GetAsGenerator();
+              if (!generator->IsReady()) {
+                resumeGenerator(Value(generator), opCurrent - 1, constantStart, line);
+                break;
+              }
+
+              localsList[iteratorVarId + localsOffsets.top()] = generator->Take();
+              constantCurrent++;
+            } else if (iterableType == GraceIterator::IterableType::List) {
               heldIterator->Increment();
               localsList[iteratorVarId + localsOffsets.top()] = heldIterator->IsAtEnd() ? Value() : heldIterator->Value();
               if (twoIterators) {
@@ -856,7 +1521,8 @@ namespace Grace::VM
                                                                                           : heldIterator->Value();
                 constantCurrent++;
               }
-            } else if (iterableType == GraceIterator::IterableType::Set || iterableType == GraceIterator::IterableType::Range){
+            } else if (iterableType == GraceIterator::IterableType::Set || iterableType == GraceIterator::IterableType::Range
+                       || iterableType == GraceIterator::IterableType::FileLines || iterableType == GraceIterator::IterableType::CsvRows) {
               heldIterator->Increment();
               localsList[iteratorVarId + localsOffsets.top()] = heldIterator->IsAtEnd() ? Value() : heldIterator->Value();
               constantCurrent++;
@@ -893,9 +1559,36 @@ namespace Grace::VM
             }
             break;
           }
+          case Ops::CompareIntJumpIfFalse: {
+            auto comparison = static_cast<Ops>(m_FullConstantList[constantCurrent++].Get<std::int64_t>());
+            auto constIdx = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
+            auto opIdx = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
+            std::int64_t i1{}, i2{};
+            auto result = false;
+            if (PopLastTwoInts(valueStack, i1, i2)) {
+              result = Compare(comparison, i1, i2);
+            } else {
+              auto [c1, c2] = PopLastTwo(valueStack);
+              result = Compare(comparison, c1, c2);
+            }
+            if (!result) {
+              auto [opOffset, constOffset] = opConstOffsets.back();
+              opCurrent = opIdx + opOffset;
+              constantCurrent = constIdx + constOffset;
+            }
+            break;
+          }
           case Ops::Return: {
             auto returnValue = Pop(valueStack);
 
+            // a generator that returns has finished, and goes back to the op that resumed it without giving anything back
+            auto generatorFinished = !generatorFrames.empty() && generatorFrames.back().callStackSize == callStack.size();
+            if (generatorFinished) {
+              generatorFrames.back().generator.GetObject()->GetAsGenerator()->Finish();
+              generatorFrames.pop_back();
+              localsList.resize(localsOffsets.top());
+            }
+
   #ifdef GRACE_DEBUG
             PRINT_LOCAL_MEMORY();
   #endif
@@ -912,7 +1605,9 @@ namespace Grace::VM
             constantCurrent = static_cast<std::size_t>(Pop(valueStack).Get<std::int64_t>());
             opCurrent = static_cast<std::size_t>(Pop(valueStack).Get<std::int64_t>());
 
-            valueStack.emplace_back(std::move(returnValue));
+            if (!generatorFinished) {
+              valueStack.emplace_back(std::move(returnValue));
+            }
             localsOffsets.pop();
             opConstOffsets.pop_back();
 
@@ -1035,10 +1730,12 @@ namespace Grace::VM
             valueStack.push_back(Value::CreateObject<GraceInstance>(std::move(className), std::move(memberList)));
             break;
           }
-          case Ops::CreateDictionary: {
+          case Ops::CreateDictionary:
+          case Ops::CreateDictionaryNoEscape: {
+            auto noEscape = op == Ops::CreateDictionaryNoEscape;
             auto numItems = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
             if (numItems == 0) {
-              valueStack.push_back(Value::CreateObject<GraceDictionary>());
+              valueStack.push_back(NewObject<GraceDictionary>(noEscape));
               break;
             }
             GraceDictionary dict;
@@ -1046,18 +1743,20 @@ namespace Grace::VM
               auto [key, value] = PopLastTwo(valueStack);
               dict.Insert(std::move(key), std::move(value));
             }
-            valueStack.push_back(Value::CreateObject<GraceDictionary>(std::move(dict)));
+            valueStack.push_back(NewObject<GraceDictionary>(noEscape, std::move(dict)));
             break;
           }
-          case Ops::CreateList: {
+          case Ops::CreateList:
+          case Ops::CreateListNoEscape: {
+            auto noEscape = op == Ops::CreateListNoEscape;
             auto numItems = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
             if (numItems == 0) {
-              valueStack.push_back(Value::CreateObject<GraceList>());
+              valueStack.push_back(NewObject<GraceList>(noEscape));
               break;
             }
 
             if (numItems == 1) {
-              valueStack.push_back(Value::CreateObject<GraceList>(Pop(valueStack)));
+              valueStack.push_back(NewObject<GraceList>(noEscape, Pop(valueStack)));
               break;
             }
 
@@ -1066,25 +1765,34 @@ namespace Grace::VM
               result[numItems - i - 1] = Pop(valueStack);
             }
 
-            valueStack.push_back(Value::CreateObject<GraceList>(std::move(result)));
+            valueStack.push_back(NewObject<GraceList>(noEscape, std::move(result)));
+            break;
+          }
+          case Ops::Interpolate: {
+            auto numParts = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
+            valueStack.push_back(Interpolate(valueStack, static_cast<std::size_t>(numParts)));
             break;
           }
-          case Ops::CreateRange: {
+          case Ops::CreateRange:
+          case Ops::CreateRangeNoEscape: {
+            auto noEscape = op == Ops::CreateRangeNoEscape;
             auto increment = Pop(valueStack);
             auto max = Pop(valueStack);
             auto min = Pop(valueStack);
-            valueStack.push_back(Value::CreateObject<GraceRange>(std::move(min), std::move(max), std::move(increment)));
+            valueStack.push_back(NewObject<GraceRange>(noEscape, std::move(min), std::move(max), std::move(increment)));
             break;
           }
-          case Ops::CreateSet: {
+          case Ops::CreateSet:
+          case Ops::CreateSetNoEscape: {
+            auto noEscape = op == Ops::CreateSetNoEscape;
             auto numItems = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
             if (numItems == 0) {
-              valueStack.push_back(Value::CreateObject<GraceSet>());
+              valueStack.push_back(NewObject<GraceSet>(noEscape));
               break;
             }
 
             if (numItems == 1) {
-              valueStack.push_back(Value::CreateObject<GraceSet>(Pop(valueStack)));
+              valueStack.push_back(NewObject<GraceSet>(noEscape, Pop(valueStack)));
               break;
             }
 
@@ -1093,7 +1801,7 @@ namespace Grace::VM
               result[numItems - i - 1] = Pop(valueStack);
             }
 
-            valueStack.push_back(Value::CreateObject<GraceSet>(std::move(result)));
+            valueStack.push_back(NewObject<GraceSet>(noEscape, std::move(result)));
             break;
           }
           case Ops::AssignSubscript: {
@@ -1109,13 +1817,16 @@ namespace Grace::VM
                   if (subscript.GetType() != Value::Type::Int) {
                     throw GraceException(GraceException::Type::InvalidType, fmt::format("Expected `Int` for subscript index but got `{}`", subscript.GetTypeName()));
                   }
-                  auto index = static_cast<std::size_t>(subscript.Get<std::int64_t>());
-                  (*object->GetAsList())[index] = newValue;
+                  auto list = object->GetAsList();
+                  list->ThrowIfFrozen();
+                  (*list)[static_cast<std::size_t>(subscript.Get<std::int64_t>())] = newValue;
                   break;
                 }
                 case GraceObjectType::Dictionary:
                   object->GetAsDictionary()->Insert(std::move(subscript), std::move(newValue));
                   break;
+                case GraceObjectType::Bytes:
+                  throw GraceException(GraceException::Type::InvalidCollectionOperation, "`Bytes` are read only");
                 default:
                   GRACE_UNREACHABLE();
                   break;
@@ -1125,41 +1836,59 @@ namespace Grace::VM
             }
             break;
           }
+          // the next three are for loops over a Range that the optimiser has versioned, see VersionSubscriptLoops
+          // CheckListRange is run once before the loop, and if it passes the subscripts inside can skip their checks
+          case Ops::CheckListRange: {
+            auto container = Pop(valueStack);
+            // CreateRange is always just before this
+            auto range = valueStack.back().GetObject()->GetAsRange();
+            auto object = container.GetObject();
+            auto list = object != nullptr ? object->GetAsList() : nullptr;
+            valueStack.emplace_back(list != nullptr && range->IndexesWithin(list->Length()));
+            break;
+          }
+          case Ops::GetSubscriptUnchecked: {
+            auto index = static_cast<std::size_t>(valueStack.back().Get<std::int64_t>());
+            auto value = valueStack[valueStack.size() - 2].GetObject()->GetAsList()->GetUnchecked(index);
+            valueStack.pop_back();
+            valueStack.back() = std::move(value);
+            break;
+          }
+          case Ops::AssignSubscriptUnchecked: {
+            auto newValue = Pop(valueStack);
+            auto index = static_cast<std::size_t>(valueStack.back().Get<std::int64_t>());
+            auto list = valueStack[valueStack.size() - 2].GetObject()->GetAsList();
+            list->ThrowIfFrozen();
+            list->GetUnchecked(index) = std::move(newValue);
+            valueStack.pop_back();
+            valueStack.pop_back();
+            break;
+          }
           case Ops::GetSubscript: {
             auto [container, subscript] = PopLastTwo(valueStack);
-            
-            auto valueType = container.GetType();
-            if (valueType == Value::Type::String) {
-              const auto& s = container.Get<std::string>();
-              if (subscript.GetType() != Value::Type::Int) {
-                throw GraceException(GraceException::Type::InvalidType, fmt::format("Expected `Int` for subscript index but got `{}`", subscript.GetTypeName()));
-              }
-              auto index = static_cast<std::size_t>(subscript.Get<std::int64_t>());
-              if (index >= s.length()) {
-                throw GraceException(GraceException::Type::IndexOutOfRange, fmt::format("Given index is {} but the length of the `String` is {}", index, s.length()));
-              }
-              valueStack.emplace_back(s[index]);
-            } else if (valueType == Value::Type::Object) {
-              auto object = container.GetObject();
-              
-              switch (object->ObjectType()) {
-                case GraceObjectType::List: {
-                  if (subscript.GetType() != Value::Type::Int) {
-                    throw GraceException(GraceException::Type::InvalidType, fmt::format("Expected `Int` for subscript index but got `{}`", subscript.GetTypeName()));
-                  }
-                  auto i = static_cast<std::size_t>(subscript.Get<std::int64_t>());
-                  valueStack.push_back((*object->GetAsList())[i]);
-                  break;
-                }
-                case GraceObjectType::Dictionary:
-                  valueStack.push_back(object->GetAsDictionary()->Get(subscript));                
-                  break;
-                default:
-                  GRACE_UNREACHABLE();
-                  break;
-              }
+            valueStack.push_back(Subscript(container, subscript));
+            break;
+          }
+          case Ops::GetSubscriptList: {
+            auto [container, subscript] = PopLastTwo(valueStack);
+            auto object = container.GetObject();
+            if (object != nullptr && object->ObjectType() == GraceObjectType::List && subscript.GetType() == Value::Type::Int) {
+              valueStack.push_back((*object->GetAsList())[static_cast<std::size_t>(subscript.Get<std::int64_t>())]);
             } else {
-              throw GraceException(GraceException::Type::InvalidType, fmt::format("`{}` cannot be indexed", container.GetTypeName()));
+              valueStack.push_back(Subscript(container, subscript));
+            }
+            break;
+          }
+          case Ops::AssertType: {
+            auto typeIdx = m_FullConstantList[constantCurrent++].Get<std::int64_t>();
+            const auto& typeName = m_FullConstantList[constantCurrent++].Get<std::string>();
+            const auto& localName = m_FullConstantList[constantCurrent++].Get<std::string>();
+            const auto& value = valueStack.back();
+            if (!HasTypeIndex(value, typeIdx)) {
+              throw GraceException(
+                GraceException::Type::InvalidType,
+                fmt::format("`{}` is annotated as `{}` but was given a value of type `{}`", localName, typeName, value.GetTypeName())
+              );
             }
             break;
           }
@@ -1217,7 +1946,48 @@ namespace Grace::VM
             auto message = Pop(valueStack);
             throw GraceException(GraceException::Type::ThrownException, message.AsString());
           }
+          case Ops::Yield: {
+            auto value = Pop(valueStack);
+
+            // only generator functions have a Yield, and calling one never runs it outside of a generator frame
+            GRACE_ASSERT(!generatorFrames.empty() && generatorFrames.back().callStackSize == callStack.size(), "Yield outside of a generator");
+            auto [generatorValue, callStackSize, stackSize] = std::move(generatorFrames.back());
+            generatorFrames.pop_back();
+
+            // move the frame off the stacks, everything above where it was resumed belongs to it
+            auto generator = generatorValue.GetObject()->GetAsGenerator();
+            auto& frame = generator->GetFrame();
+            frame.opIndex = opCurrent;
+            frame.constantIndex = constantCurrent;
+
+            frame.stack.assign(std::make_move_iterator(valueStack.begin() + static_cast<std::ptrdiff_t>(stackSize)), std::make_move_iterator(valueStack.end()));
+            valueStack.resize(stackSize);
+
+            auto localsOffset = localsOffsets.top();
+            frame.locals.assign(std::make_move_iterator(localsList.begin() + static_cast<std::ptrdiff_t>(localsOffset)), std::make_move_iterator(localsList.end()));
+            localsList.resize(localsOffset);
+            localsOffsets.pop();
+
+            auto heldIteratorsSize = static_cast<std::size_t>(Pop(valueStack).Get<std::int64_t>());
+            frame.heldIterators.resize(heldIterators.size() - heldIteratorsSize);
+            for (auto i = frame.heldIterators.size(); i-- > 0;) {
+              frame.heldIterators[i] = std::move(heldIterators.top());
+              heldIterators.pop();
+            }
+
+            constantCurrent = static_cast<std::size_t>(Pop(valueStack).Get<std::int64_t>());
+            opCurrent = static_cast<std::size_t>(Pop(valueStack).Get<std::int64_t>());
+
+            funcNameHash = callStack.back().callerHash;
+            callStack.pop_back();
+            fileNameStack.pop();
+            opConstOffsets.pop_back();
+
+            generator->Yield(std::move(value));
+            break;
+          }
           case Ops::Exit: {
+            reachedExit = true;
             goto exit;
           }
           default:
@@ -1226,6 +1996,15 @@ namespace Grace::VM
         }      
 
       } catch(const GraceException& ge) {
+        // ops inlined from another function push that function's frame, as if it had been called
+        auto rangeIt = std::upper_bound(m_InlinedRanges.begin(), m_InlinedRanges.end(), opCurrent - 1,
+            [](std::size_t opIndex, const InlinedRange& range) { return opIndex < range.opStart; });
+        if (rangeIt != m_InlinedRanges.begin() && opCurrent - 1 < std::prev(rangeIt)->opEnd) {
+          const auto& [opStart, opEnd, callee, callLine] = *std::prev(rangeIt);
+          callStack.push_back({ funcNameHash, callee->nameHash, callLine, fileNameStack.top().second, callee->fileName, fileNameStack.top().first, callee->fileNameHash });
+          fileNameStack.push({ callee->fileNameHash, callee->fileName });
+        }
+
         if (inTryBlock) {
           // jump to the catch block and put the exception on the stack to be assigned
           const auto& vmState = vmStateStack.top();
@@ -1239,6 +2018,12 @@ namespace Grace::VM
             localsOffsets.pop();
           }
 
+          // a generator that threw is finished, its frame is thrown away with the rest
+          while (!generatorFrames.empty() && generatorFrames.back().callStackSize > vmState.callStackSize) {
+            generatorFrames.back().generator.GetObject()->GetAsGenerator()->Finish();
+            generatorFrames.pop_back();
+          }
+
           valueStack.resize(vmState.stackSize);
           localsList.resize(vmState.numLocals);
           callStack.resize(vmState.callStackSize);
@@ -1264,6 +2049,9 @@ namespace Grace::VM
           // exception unhandled, report the error and quit
           RuntimeError(ge, line, callStack);
           interpretResult = InterpretResult::RuntimeError;
+          if (worker != nullptr) {
+            worker->error = ge.ToString();
+          }
           break;
         }
       }
@@ -1271,6 +2059,27 @@ namespace Grace::VM
 
   exit:
 
+    // fibers only run while something waits on them, so any left over get to finish before the thread does
+    // a fiber's own Run() leaves them to the thread, which is the only one that can wait for all of them
+    if (constantResult == nullptr && interpretResult == InterpretResult::RuntimeOk) {
+      EventLoop::Drain();
+    }
+
+    OutputBuffer::FlushAll();
+
+    if (constantResult != nullptr && interpretResult == InterpretResult::RuntimeOk) {
+      *constantResult = std::move(valueStack.back());
+    }
+
+    if (worker != nullptr) {
+      if (reachedExit) {
+        worker->result = std::move(valueStack.back());
+      } else if (interpretResult == InterpretResult::RuntimeOk) {
+        interpretResult = InterpretResult::RuntimeError;
+        worker->error = "assertion failed";
+      }
+    }
+
     valueStack.clear();
     localsList.clear();
 
@@ -1278,7 +2087,11 @@ namespace Grace::VM
     PRINT_LOCAL_MEMORY();
 #endif
 
-    ObjectTracker::Finalise();
+    // the program hasn't started yet if this was a `const`, so there's nothing to finalise
+    // a worker's Thread finalises its heap once the result has been sent back
+    if (constantResult == nullptr && worker == nullptr) {
+      ObjectTracker::Finalise();
+    }
 
     return interpretResult;
 
@@ -1287,6 +2100,7 @@ namespace Grace::VM
 
   void VM::RuntimeError(const GraceException& exception, std::size_t line, const std::vector<CallStackEntry>& callStack)
   {
+    OutputBuffer::FlushAll();
     fmt::print(stderr, "\nCall stack (most recent call last):\n");
 
     auto callStackSize = callStack.size();
@@ -12,13 +12,19 @@
 #ifndef GRACE_VM_HPP
 #define GRACE_VM_HPP
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <exception>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <fmt/color.h>
@@ -36,14 +42,17 @@ namespace Grace::VM
   {
     Add,
     AddAssign,
+    AddInt,
     And,
     AppendNamespace,
     Assert,
+    AssertType,
     AssertWithMessage,
     AssignIteratorBegin,
     AssignLocal,
     AssignMember,
     AssignSubscript,
+    AssignSubscriptUnchecked,
     BitwiseAnd,
     BitwiseAndAssign,
     BitwiseNot,
@@ -54,12 +63,18 @@ namespace Grace::VM
     Call,
     Cast,
     CheckIteratorEnd,
+    CheckListRange,
     CheckType,
+    CompareIntJumpIfFalse,
     CreateDictionary,
+    CreateDictionaryNoEscape,
     CreateInstance,
     CreateList,
+    CreateListNoEscape,
     CreateRange,
+    CreateRangeNoEscape,
     CreateSet,
+    CreateSetNoEscape,
     DeclareLocal,
     DestroyHeldIterator,
     Divide,
@@ -67,29 +82,40 @@ namespace Grace::VM
     Dup,
     EnterTry,
     Equal,
+    EqualInt,
     Exit,
     ExitTry,
     GetSubscript,
+    GetSubscriptList,
+    GetSubscriptUnchecked,
     Greater,
     GreaterEqual,
+    GreaterEqualInt,
+    GreaterInt,
     IncrementIterator,
+    Interpolate,
     IsObject,
     Jump,
     JumpIfFalse,
     Less,
     LessEqual,
+    LessEqualInt,
+    LessInt,
     LoadConstant,
     LoadLocal,
     LoadMember,
     MemberCall,
     Mod,
     ModAssign,
+    MoveLocal,
     Multiply,
     MultiplyAssign,
+    MultiplyInt,
     NativeCall,
     Negate,
     Not,
     NotEqual,
+    NotEqualInt,
     Or,
     Pop,
     PopLocal,
@@ -112,14 +138,33 @@ namespace Grace::VM
     StartNewNamespace,
     Subtract,
     SubtractAssign,
+    SubtractInt,
     Throw,
-    Typename
+    Typename,
+    Yield
   };
 
   enum class InterpretResult
   {
     RuntimeOk,
     RuntimeError,
+    // a Task used up its budget, and carries on from where it stopped the next time it's resumed
+    Suspended,
+  };
+
+  // how much a Task can run before VM::Resume() gives back Suspended, 0 is no limit
+  // the clock is only read every few hundred ops, so a time budget can be overrun by that many
+  struct Budget
+  {
+    std::uint64_t ops{};
+    std::chrono::microseconds time{};
+  };
+
+  enum class OptimisationLevel
+  {
+    O0,
+    O1,
+    O2,
   };
 
   // TODO: there will be user defined objects that can have extension methods...
@@ -142,7 +187,7 @@ namespace Grace::VM
 
       GRACE_INLINE static void PushOp(Ops op, std::size_t line)
       {
-        m_FunctionLookup.at(m_LastFileNameHash).at(m_LastFunctionHash)->opList.push_back({ op, line });
+        m_LastFunction->opList.push_back({ op, line });
       }
 
       static void PrintOps();
@@ -150,39 +195,50 @@ namespace Grace::VM
       template<BuiltinGraceType T>
       GRACE_INLINE static void PushConstant(const T& value)
       {
-        m_FunctionLookup.at(m_LastFileNameHash).at(m_LastFunctionHash)->constantList.emplace_back(value);
+        m_LastFunction->constantList.emplace_back(value);
       }
 
       GRACE_INLINE static void PushConstant(const Value& value)
       {
-        m_FunctionLookup.at(m_LastFileNameHash).at(m_LastFunctionHash)->constantList.push_back(value);
+        m_LastFunction->constantList.push_back(value);
       }
 
       GRACE_NODISCARD GRACE_INLINE static std::size_t GetNumConstants()
       {
-        return m_FunctionLookup.at(m_LastFileNameHash).at(m_LastFunctionHash)->constantList.size();
+        return m_LastFunction->constantList.size();
       }
 
       GRACE_NODISCARD GRACE_INLINE static std::size_t GetNumOps()
       {
-        return m_FunctionLookup.at(m_LastFileNameHash).at(m_LastFunctionHash)->opList.size();
+        return m_LastFunction->opList.size();
       }
 
       template<BuiltinGraceType T>
       GRACE_INLINE static void SetConstantAtIndex(std::size_t index, const T& value)
       {
-        m_FunctionLookup.at(m_LastFileNameHash).at(m_LastFunctionHash)->constantList[index] = value;
+        m_LastFunction->constantList[index] = value;
       }
 
       GRACE_NODISCARD GRACE_INLINE static std::optional<Ops> GetLastOp()
       {
-        const auto& opList = m_FunctionLookup.at(m_LastFileNameHash).at(m_LastFunctionHash)->opList;
+        const auto& opList = m_LastFunction->opList;
         return opList.empty() ? std::optional<Ops>{} : opList.back().op;
       }
 
       GRACE_NODISCARD GRACE_INLINE static const std::string& GetLastFunctionName()
       {
-        return m_FunctionLookup.at(m_LastFileNameHash).at(m_LastFunctionHash)->name;
+        return m_LastFunction->name;
+      }
+
+      // called when the compiler finds a `yield` in the function being compiled
+      GRACE_INLINE static void MarkLastFunctionAsGenerator()
+      {
+        m_LastFunction->generator = true;
+      }
+
+      GRACE_NODISCARD GRACE_INLINE static bool LastFunctionIsGenerator()
+      {
+        return m_LastFunction->generator;
       }
 
       GRACE_NODISCARD static bool AddFunction(std::string&& name, std::size_t arity, const std::string& fileName, bool exported, bool extension, std::size_t objectNameHash = {});
@@ -203,11 +259,42 @@ namespace Grace::VM
         return m_NativeFunctions[index];
       }
 
+      static void Optimise(OptimisationLevel level, bool verbose);
       GRACE_NODISCARD static bool CombineFunctions(const std::string& mainFileName, GRACE_MAYBE_UNUSED bool verbose);
       GRACE_NODISCARD static InterpretResult Start(const std::string& mainFileName, bool verbose, const std::vector<std::string>& args);
 
+      // runs the function just compiled from the initialiser of a `const` and removes it, giving back the frozen result
+      // returns nothing if the initialiser threw, or made something that can't be frozen
+      GRACE_NODISCARD static std::optional<Value> EvaluateConstant();
+      static void RemoveLastFunction();
+
+      // finds the exported function std::thread::spawn() or std::fiber::spawn() was asked to run, giving back its file and name hashes
+      // the name can be qualified with the end of its namespace, `module::name`, if more than one file exports it
+      // runningOn is "Thread" or "Fiber", for the error message
+      GRACE_NODISCARD static std::pair<std::int64_t, std::int64_t> FindWorkerFunction(std::string_view qualifiedName, std::size_t arity, std::string_view runningOn);
+      // runs the function on the calling thread or fiber, which must only be using Values that belong to its thread
+      // throws if the function didn't return, after its error has been reported
+      GRACE_NODISCARD static Value RunWorker(std::int64_t fileNameHash, std::int64_t nameHash, std::vector<Value>&& args);
+
+      class Task;
+
+      // sets up a call to an exported function that only runs while Resume() is running it, so a host can share
+      // a few threads between many scripts, throws if there's no such function or it takes a different number of arguments
+      GRACE_NODISCARD static std::unique_ptr<Task> StartTask(std::string_view qualifiedName, std::vector<Value>&& args);
+      // runs the task until it returns, fails or uses up its budget, giving back Suspended if it hasn't finished
+      // a task's Values belong to the heap of the thread that started it, so it throws if called from any other thread
+      GRACE_NODISCARD static InterpretResult Resume(Task& task, Budget budget);
+
     private:
 
+      // the entry of a Run() started by RunWorker()
+      struct WorkerEntry
+      {
+        std::vector<Value> args;
+        Value result;
+        std::string error;
+      };
+
       struct CallStackEntry
       {
         std::int64_t callerHash{}, calleeHash{};
@@ -216,7 +303,17 @@ namespace Grace::VM
         std::int64_t fileNameHash{}, calleeFileNameHash{};
       };
       
-      GRACE_NODISCARD static InterpretResult Run(std::int64_t mainFileNameHash, GRACE_MAYBE_UNUSED bool verbose, const std::vector<std::string>& clArgs);
+      // the stacks of a Run() that gave back Suspended, kept by its Task until it's resumed
+      struct RunState;
+
+      static void CombineFunctions(std::int64_t entryFileNameHash, std::int64_t entryNameHash);
+      // if constantResult is given, the entry function is the initialiser of a `const` and anything impure will throw
+      // if worker is given, the entry function takes its args instead of the command line, and returns into m_WorkerExitOp
+      // if task is given, it's the worker's Task, and the Run() carries on from where it last stopped
+      // only a Budgeted Run() counts its ops and stops once budget is used up, so nothing else pays for the check on every op
+      template<bool Budgeted = false>
+      GRACE_NODISCARD static InterpretResult Run(std::int64_t entryFileNameHash, std::int64_t entryNameHash, GRACE_MAYBE_UNUSED bool verbose,
+        const std::vector<std::string>& clArgs, Value* constantResult = nullptr, WorkerEntry* worker = nullptr, Task* task = nullptr, Budget budget = {});
       static void RuntimeError(const GraceException& exception, std::size_t line, const std::vector<CallStackEntry>& callStack);
 
       struct OpLine
@@ -225,6 +322,23 @@ namespace Grace::VM
         std::size_t line;
       };
 
+      struct Function;
+
+      // set by the optimiser on a Function whose body only passes its parameters on to a native function
+      struct NativeForward
+      {
+        std::size_t nativeIndex, line;
+        bool returnsResult;
+      };
+
+      // ops inlined into a Function from the body of callee, so errors can still report callee's frame
+      struct InlinedRange
+      {
+        std::size_t opStart, opEnd;
+        const Function* callee;
+        std::size_t line;
+      };
+
       struct Function 
       {
         std::string name;
@@ -241,19 +355,28 @@ namespace Grace::VM
 
         std::size_t opIndexStart{}, constantIndexStart{};
 
+        std::optional<NativeForward> nativeForward;
+        // relative to opIndexStart until CombineFunctions
+        std::vector<InlinedRange> inlinedRanges;
+
         // TODO: it's possible that the Function won't need to know if it's an extension or not
         bool exported{}, extensionMethod{};
+        // calling a generator gives back a GraceGenerator instead of running the body
+        bool generator{};
 
         Function(std::string&& name_, std::int64_t nameHash_, std::size_t arity_, const std::string& fileName_, bool exported_, bool extension)
           : name(std::move(name_)), nameHash(nameHash_), arity(arity_), fileName(fileName_), exported(exported_), extensionMethod(extension)
         {
           static std::hash<std::string> hasher;
           fileNameHash = static_cast<std::int64_t>(hasher(fileName_));
-          std::stringstream ss(fileName.substr(0, fileName.find_last_of('.')));
-          std::string part;
-          while (std::getline(ss, part, '/')) {
-            namespaceVec.push_back(part);
+          std::string_view path(fileName);
+          path = path.substr(0, path.find_last_of('.'));
+          std::size_t partStart = 0;
+          while (partStart < path.length()) {
+            auto partEnd = std::min(path.find('/', partStart), path.length());
+            auto& part = namespaceVec.emplace_back(path.substr(partStart, partEnd - partStart));
             namespaceHashVec.push_back(static_cast<std::int64_t>(hasher(part)));
+            partStart = partEnd + 1;
           }
         }
 
@@ -263,6 +386,8 @@ namespace Grace::VM
         }
       };
 
+      static void OptimiseFunction(Function& function, OptimisationLevel level);
+
       struct Class
       {       
         std::string name;
@@ -287,11 +412,54 @@ namespace Grace::VM
 
       static std::vector<OpLine> m_FullOpList;
       static std::vector<Value> m_FullConstantList;
+      // an Exit at the end of m_FullOpList, where a worker's entry function returns to
+      static std::size_t m_WorkerExitOp;
+      // sorted by opStart
+      static std::vector<InlinedRange> m_InlinedRanges;
 
-      static std::int64_t m_LastFileNameHash;
-      static std::int64_t m_LastFunctionHash;
+      // the function currently being compiled, owned by m_FunctionLookup
+      static Function* m_LastFunction;
       static std::hash<std::string> m_Hasher;
   };
+
+  // a call to an exported function started by VM::StartTask(), which only runs while VM::Resume() is running it
+  // it must be destroyed on the thread that started it, like everything else it holds
+  class VM::Task
+  {
+    public:
+
+      ~Task();
+
+      GRACE_NODISCARD GRACE_INLINE bool IsFinished() const
+      {
+        return m_Finished;
+      }
+
+      // what the function returned, once Resume() has given back RuntimeOk
+      GRACE_NODISCARD GRACE_INLINE const Value& GetResult() const
+      {
+        return m_Worker.result;
+      }
+
+      // why the function failed, once Resume() has given back RuntimeError
+      GRACE_NODISCARD GRACE_INLINE const std::string& GetError() const
+      {
+        return m_Worker.error;
+      }
+
+    private:
+
+      friend class VM;
+
+      Task(std::int64_t fileNameHash, std::int64_t nameHash, std::vector<Value>&& args);
+
+      std::int64_t m_FileNameHash, m_NameHash;
+      WorkerEntry m_Worker;
+      // nothing until the first time the task is suspended
+      std::unique_ptr<RunState> m_State;
+      std::thread::id m_Thread;
+      bool m_Finished = false;
+  };
 } // namespace Grace::VM
 
 template<>
@@ -333,6 +501,7 @@ struct fmt::formatter<Grace::VM::Ops> : fmt::formatter<std::string_view>
       case Ops::Greater: name = "Ops::Greater"; break;
       case Ops::GreaterEqual: name = "Ops::GreaterEqual"; break;
       case Ops::IncrementIterator: name = "Ops::IncrementIterator"; break;
+      case Ops::Interpolate: name = "Ops::Interpolate"; break;
       case Ops::IsObject: name = "Ops::IsObject"; break;
       case Ops::Jump: name = "Ops::Jump"; break;
       case Ops::JumpIfFalse: name = "Ops::JumpIfFalse"; break;
@@ -367,6 +536,7 @@ struct fmt::formatter<Grace::VM::Ops> : fmt::formatter<std::string_view>
       case Ops::Subtract: name = "Ops::Subtract"; break;
       case Ops::Throw: name = "Ops::Throw"; break;
       case Ops::Typename: name = "Ops::Typename"; break;
+      case Ops::Yield: name = "Ops::Yield"; break;
       case Ops::BitwiseAnd: name = "Ops::BitwiseAnd"; break;
       case Ops::BitwiseNot: name = "Ops::BitwiseNot"; break;
       case Ops::BitwiseOr: name = "Ops::BitwiseOr"; break;
@@ -384,6 +554,26 @@ struct fmt::formatter<Grace::VM::Ops> : fmt::formatter<std::string_view>
       case Ops::ShiftLeftAssign: name = "Ops::ShiftLeftAssign"; break;
       case Ops::ShiftRightAssign: name = "Ops::ShiftRightAssign"; break;
       case Ops::PowAssign: name = "Ops::PowAssign"; break;
+      case Ops::AddInt: name = "Ops::AddInt"; break;
+      case Ops::SubtractInt: name = "Ops::SubtractInt"; break;
+      case Ops::MultiplyInt: name = "Ops::MultiplyInt"; break;
+      case Ops::EqualInt: name = "Ops::EqualInt"; break;
+      case Ops::NotEqualInt: name = "Ops::NotEqualInt"; break;
+      case Ops::GreaterInt: name = "Ops::GreaterInt"; break;
+      case Ops::GreaterEqualInt: name = "Ops::GreaterEqualInt"; break;
+      case Ops::LessInt: name = "Ops::LessInt"; break;
+      case Ops::LessEqualInt: name = "Ops::LessEqualInt"; break;
+      case Ops::CompareIntJumpIfFalse: name = "Ops::CompareIntJumpIfFalse"; break;
+      case Ops::GetSubscriptList: name = "Ops::GetSubscriptList"; break;
+      case Ops::AssertType: name = "Ops::AssertType"; break;
+      case Ops::MoveLocal: name = "Ops::MoveLocal"; break;
+      case Ops::CheckListRange: name = "Ops::CheckListRange"; break;
+      case Ops::GetSubscriptUnchecked: name = "Ops::GetSubscriptUnchecked"; break;
+      case Ops::AssignSubscriptUnchecked: name = "Ops::AssignSubscriptUnchecked"; break;
+      case Ops::CreateDictionaryNoEscape: name = "Ops::CreateDictionaryNoEscape"; break;
+      case Ops::CreateListNoEscape: name = "Ops::CreateListNoEscape"; break;
+      case Ops::CreateRangeNoEscape: name = "Ops::CreateRangeNoEscape"; break;
+      case Ops::CreateSetNoEscape: name = "Ops::CreateSetNoEscape"; break;
     }
     return fmt::formatter<std::string_view>::format(name, context);
   }
@@ -0,0 +1,2382 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains the out of line definitions for the VM class, specifically the bytecode optimiser,
+ *  which rewrites each Function's ops and constants before they are combined and run.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "grace.hpp"
+#include "vm.hpp"
+#include "objects/grace_exception.hpp"
+
+namespace Grace::VM
+{
+  static constexpr std::size_t s_NoTarget = std::numeric_limits<std::size_t>::max();
+
+  // An op together with the constants it consumes and the index of the instruction it jumps to, if any.
+  // Passes work on a list of these so they can remove and rewrite ops without having to keep
+  // the constant indices stored in jumps in sync, those are recalculated when the list is encoded again.
+  struct Instruction
+  {
+    Ops op;
+    std::size_t line;
+    std::vector<Value> constants;
+    std::size_t target = s_NoTarget;
+    // index into the call sites inlined into this Function, if this was inlined from another Function
+    std::size_t inlineSite = s_NoTarget;
+    bool removed = false;
+  };
+
+  using InstructionList = std::vector<Instruction>;
+
+  // What a Function does with each of its local slots, see AnalyseLocals
+  struct LocalUsage
+  {
+    std::vector<std::size_t> declarations, stores;
+    std::size_t reads = 0, otherWrites = 0;
+  };
+
+  // How many constants an op reads from the constant list when it is run, this must match VM::Run
+  static std::optional<std::size_t> NumConstants(Ops op, const std::vector<Value>& constants, std::size_t index)
+  {
+    switch (op) {
+      case Ops::Add:
+      case Ops::AddInt:
+      case Ops::And:
+      case Ops::Assert:
+      case Ops::AssignSubscript:
+      case Ops::AssignSubscriptUnchecked:
+      case Ops::BitwiseAnd:
+      case Ops::BitwiseNot:
+      case Ops::BitwiseOr:
+      case Ops::BitwiseXOr:
+      case Ops::CheckIteratorEnd:
+      case Ops::CheckListRange:
+      case Ops::CreateRange:
+      case Ops::CreateRangeNoEscape:
+      case Ops::DeclareLocal:
+      case Ops::DestroyHeldIterator:
+      case Ops::Divide:
+      case Ops::Equal:
+      case Ops::EqualInt:
+      case Ops::Exit:
+      case Ops::GetSubscript:
+      case Ops::GetSubscriptList:
+      case Ops::GetSubscriptUnchecked:
+      case Ops::Greater:
+      case Ops::GreaterEqual:
+      case Ops::GreaterEqualInt:
+      case Ops::GreaterInt:
+      case Ops::IsObject:
+      case Ops::Less:
+      case Ops::LessEqual:
+      case Ops::LessEqualInt:
+      case Ops::LessInt:
+      case Ops::Mod:
+      case Ops::Multiply:
+      case Ops::MultiplyInt:
+      case Ops::Negate:
+      case Ops::Not:
+      case Ops::NotEqual:
+      case Ops::NotEqualInt:
+      case Ops::Or:
+      case Ops::Pop:
+      case Ops::PopLocal:
+      case Ops::Pow:
+      case Ops::Print:
+      case Ops::PrintEmptyLine:
+      case Ops::PrintLn:
+      case Ops::PrintTab:
+      case Ops::EPrint:
+      case Ops::EPrintEmptyLine:
+      case Ops::EPrintLn:
+      case Ops::EPrintTab:
+      case Ops::Return:
+      case Ops::ShiftLeft:
+      case Ops::ShiftRight:
+      case Ops::StartNewNamespace:
+      case Ops::Subtract:
+      case Ops::SubtractInt:
+      case Ops::Throw:
+      case Ops::Typename:
+      case Ops::Yield:
+        return 0;
+      case Ops::AddAssign:
+      case Ops::AssertWithMessage:
+      case Ops::AssignLocal:
+      case Ops::AssignMember:
+      case Ops::BitwiseAndAssign:
+      case Ops::BitwiseOrAssign:
+      case Ops::BitwiseXOrAssign:
+      case Ops::Cast:
+      case Ops::CreateDictionary:
+      case Ops::CreateDictionaryNoEscape:
+      case Ops::CreateList:
+      case Ops::CreateListNoEscape:
+      case Ops::CreateSet:
+      case Ops::CreateSetNoEscape:
+      case Ops::DivideAssign:
+      case Ops::Dup:
+      case Ops::ExitTry:
+      case Ops::Interpolate:
+      case Ops::LoadConstant:
+      case Ops::LoadLocal:
+      case Ops::LoadMember:
+      case Ops::ModAssign:
+      case Ops::MoveLocal:
+      case Ops::MultiplyAssign:
+      case Ops::PopLocals:
+      case Ops::PowAssign:
+      case Ops::ShiftLeftAssign:
+      case Ops::ShiftRightAssign:
+      case Ops::SubtractAssign:
+        return 1;
+      case Ops::AppendNamespace:
+      case Ops::EnterTry:
+      case Ops::Jump:
+      case Ops::JumpIfFalse:
+      case Ops::NativeCall:
+        return 2;
+      case Ops::AssertType:
+      case Ops::AssignIteratorBegin:
+      case Ops::Call:
+      case Ops::CompareIntJumpIfFalse:
+      case Ops::IncrementIterator:
+      case Ops::MemberCall:
+        return 3;
+      case Ops::CheckType:
+        // user defined types also have the type name
+        if (index >= constants.size() || constants[index].GetType() != Value::Type::Int) {
+          return {};
+        }
+        return constants[index].Get<std::int64_t>() < 11 ? 1 : 2;
+      case Ops::CreateInstance:
+        // number of members, the name of each member, class name hash, file name hash
+        if (index >= constants.size() || constants[index].GetType() != Value::Type::Int) {
+          return {};
+        }
+        return 3 + static_cast<std::size_t>(constants[index].Get<std::int64_t>());
+    }
+    return {};
+  }
+
+  GRACE_NODISCARD static bool IsJump(Ops op)
+  {
+    return op == Ops::Jump || op == Ops::JumpIfFalse || op == Ops::CompareIntJumpIfFalse || op == Ops::EnterTry;
+  }
+
+  GRACE_NODISCARD static bool IsCompoundAssign(Ops op)
+  {
+    switch (op) {
+      case Ops::AddAssign:
+      case Ops::BitwiseAndAssign:
+      case Ops::BitwiseOrAssign:
+      case Ops::BitwiseXOrAssign:
+      case Ops::DivideAssign:
+      case Ops::ModAssign:
+      case Ops::MultiplyAssign:
+      case Ops::PowAssign:
+      case Ops::ShiftLeftAssign:
+      case Ops::ShiftRightAssign:
+      case Ops::SubtractAssign:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  // Jumps store (constant index, op index), EnterTry stores (op index, constant index)
+  // and CompareIntJumpIfFalse has the comparison before (constant index, op index)
+  GRACE_NODISCARD static std::pair<std::size_t, std::size_t> JumpOperandPositions(Ops op)
+  {
+    switch (op) {
+      case Ops::EnterTry:
+        return { 1, 0 };
+      case Ops::CompareIntJumpIfFalse:
+        return { 1, 2 };
+      default:
+        return { 0, 1 };
+    }
+  }
+
+  // Calls the callback with the index of every instruction that can run directly after the one at index
+  template<typename Callback>
+  static void ForEachSuccessor(const InstructionList& instructions, std::size_t index, Callback&& callback)
+  {
+    const auto& instruction = instructions[index];
+    switch (instruction.op) {
+      case Ops::Jump:
+        callback(instruction.target);
+        return;
+      case Ops::Exit:
+      case Ops::Return:
+      case Ops::Throw:
+        return;
+      // EnterTry "jumps" to the catch block when anything in the try block throws
+      case Ops::CompareIntJumpIfFalse:
+      case Ops::EnterTry:
+      case Ops::JumpIfFalse:
+        callback(instruction.target);
+        break;
+      default:
+        break;
+    }
+
+    if (index + 1 < instructions.size()) {
+      callback(index + 1);
+    }
+  }
+
+  GRACE_NODISCARD static std::vector<bool> FindJumpTargets(const InstructionList& instructions)
+  {
+    std::vector<bool> targets(instructions.size());
+    for (const auto& instruction : instructions) {
+      if (!instruction.removed && IsJump(instruction.op)) {
+        targets[instruction.target] = true;
+      }
+    }
+    return targets;
+  }
+
+  // Erases removed instructions, anything that jumped to one now jumps to the next instruction that was kept
+  static void Compact(InstructionList& instructions)
+  {
+    std::vector<std::size_t> newIndices(instructions.size() + 1);
+    std::size_t numKept = 0;
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      newIndices[i] = numKept;
+      if (!instructions[i].removed) {
+        numKept++;
+      }
+    }
+    newIndices[instructions.size()] = numKept;
+
+    InstructionList result;
+    result.reserve(numKept);
+    for (auto& instruction : instructions) {
+      if (instruction.removed) {
+        continue;
+      }
+      if (IsJump(instruction.op)) {
+        instruction.target = newIndices[instruction.target];
+      }
+      result.push_back(std::move(instruction));
+    }
+
+    instructions = std::move(result);
+  }
+
+  // Inserts instructions before the one at index, anything that jumped to that one now jumps to the first of them
+  static void Insert(InstructionList& instructions, std::size_t index, InstructionList&& inserted)
+  {
+    for (auto& instruction : instructions) {
+      if (IsJump(instruction.op) && instruction.target > index) {
+        instruction.target += inserted.size();
+      }
+    }
+
+    instructions.insert(instructions.begin() + static_cast<std::ptrdiff_t>(index),
+        std::make_move_iterator(inserted.begin()), std::make_move_iterator(inserted.end()));
+  }
+
+  GRACE_NODISCARD static std::optional<Value> FoldUnary(Ops op, const Value& value)
+  {
+    // objects only get into the constant list as the value of a `const`, and anything made from them would be shared by every run of the op
+    if (value.GetType() == Value::Type::Object) {
+      return {};
+    }
+
+    try {
+      switch (op) {
+        case Ops::BitwiseNot:
+          return ~value;
+        case Ops::Negate:
+          return -value;
+        case Ops::Not:
+          return !value;
+        default:
+          return {};
+      }
+    } catch (const GraceException&) {
+      // leave it for the VM to throw at runtime with the right call stack
+      return {};
+    }
+  }
+
+  // The op a specialised op does the same thing as, for passes that only need to know what an op computes
+  GRACE_NODISCARD static Ops GenericOp(Ops op)
+  {
+    switch (op) {
+      case Ops::AddInt: return Ops::Add;
+      case Ops::EqualInt: return Ops::Equal;
+      case Ops::GreaterEqualInt: return Ops::GreaterEqual;
+      case Ops::GreaterInt: return Ops::Greater;
+      case Ops::LessEqualInt: return Ops::LessEqual;
+      case Ops::LessInt: return Ops::Less;
+      case Ops::MultiplyInt: return Ops::Multiply;
+      case Ops::NotEqualInt: return Ops::NotEqual;
+      case Ops::SubtractInt: return Ops::Subtract;
+      default: return op;
+    }
+  }
+
+  GRACE_NODISCARD static std::optional<Value> FoldBinary(Ops op, const Value& c1, const Value& c2)
+  {
+    // see FoldUnary
+    if (c1.GetType() == Value::Type::Object || c2.GetType() == Value::Type::Object) {
+      return {};
+    }
+
+    auto rhsIsInt = c2.GetType() == Value::Type::Int;
+    auto rhsInt = rhsIsInt ? c2.Get<std::int64_t>() : std::int64_t{};
+
+    try {
+      switch (GenericOp(op)) {
+        case Ops::Add:
+          return c1 + c2;
+        case Ops::And:
+          return Value(c1.AsBool() && c2.AsBool());
+        case Ops::BitwiseAnd:
+          return c1 & c2;
+        case Ops::BitwiseOr:
+          return c1 | c2;
+        case Ops::BitwiseXOr:
+          return c1 ^ c2;
+        case Ops::Divide:
+        case Ops::Mod:
+          // integer division by 0 or -1 can trap, don't do that in the compiler
+          if (rhsIsInt && (rhsInt == 0 || rhsInt == -1)) {
+            return {};
+          }
+          return op == Ops::Divide ? c1 / c2 : c1 % c2;
+        case Ops::Equal:
+          return Value(c1 == c2);
+        case Ops::Greater:
+          return Value(c1 > c2);
+        case Ops::GreaterEqual:
+          return Value(c1 >= c2);
+        case Ops::Less:
+          return Value(c1 < c2);
+        case Ops::LessEqual:
+          return Value(c1 <= c2);
+        case Ops::Multiply:
+          return c1 * c2;
+        case Ops::NotEqual:
+          return Value(c1 != c2);
+        case Ops::Or:
+          return Value(c1.AsBool() || c2.AsBool());
+        case Ops::Pow:
+          return c1.Pow(c2);
+        case Ops::ShiftLeft:
+        case Ops::ShiftRight:
+          if (rhsIsInt && (rhsInt < 0 || rhsInt >= 64)) {
+            return {};
+          }
+          return op == Ops::ShiftLeft ? c1 << c2 : c1 >> c2;
+        case Ops::Subtract:
+          return c1 - c2;
+        default:
+          return {};
+      }
+    } catch (const GraceException&) {
+      return {};
+    }
+  }
+
+  // LoadConstant, LoadConstant, Op => LoadConstant
+  // LoadConstant, Op => LoadConstant
+  // LoadConstant, JumpIfFalse => Jump or nothing
+  static bool FoldConstants(InstructionList& instructions)
+  {
+    auto targets = FindJumpTargets(instructions);
+    auto changed = false;
+
+    for (std::size_t i = 1; i < instructions.size(); i++) {
+      auto& instruction = instructions[i];
+      auto& previous = instructions[i - 1];
+      // anything jumping into the middle of the sequence would see a different stack
+      if (targets[i] || previous.removed || previous.op != Ops::LoadConstant) {
+        continue;
+      }
+
+      if (instruction.op == Ops::JumpIfFalse) {
+        previous.removed = true;
+        if (previous.constants[0].AsBool()) {
+          instruction.removed = true;
+        } else {
+          instruction.op = Ops::Jump;
+        }
+        changed = true;
+        continue;
+      }
+
+      if (auto result = FoldUnary(instruction.op, previous.constants[0])) {
+        previous.constants[0] = std::move(*result);
+        instruction.removed = true;
+        changed = true;
+        continue;
+      }
+
+      if (i < 2 || targets[i - 1]) {
+        continue;
+      }
+
+      auto& first = instructions[i - 2];
+      if (first.removed || first.op != Ops::LoadConstant) {
+        continue;
+      }
+
+      if (auto result = FoldBinary(instruction.op, first.constants[0], previous.constants[0])) {
+        first.constants[0] = std::move(*result);
+        previous.removed = true;
+        instruction.removed = true;
+        changed = true;
+      }
+    }
+
+    return changed;
+  }
+
+  // Retargets jumps to unconditional jumps at the final destination and removes jumps to the next instruction
+  static bool ThreadJumps(InstructionList& instructions)
+  {
+    auto changed = false;
+
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      auto& instruction = instructions[i];
+      if (instruction.op != Ops::Jump && instruction.op != Ops::JumpIfFalse) {
+        continue;
+      }
+
+      auto target = instruction.target;
+      // bounded in case the jumps form a loop, e.g. `while true: end`
+      for (std::size_t hops = 0; instructions[target].op == Ops::Jump && hops < instructions.size(); hops++) {
+        target = instructions[target].target;
+      }
+
+      if (target != instruction.target) {
+        instruction.target = target;
+        changed = true;
+      }
+
+      if (instruction.target == i + 1) {
+        if (instruction.op == Ops::Jump) {
+          instruction.removed = true;
+        } else {
+          // the condition still needs to come off the stack
+          instruction.op = Ops::Pop;
+          instruction.constants.clear();
+          instruction.target = s_NoTarget;
+        }
+        changed = true;
+      }
+    }
+
+    return changed;
+  }
+
+  static bool RemoveUnreachable(InstructionList& instructions)
+  {
+    std::vector<bool> reachable(instructions.size());
+    std::vector<std::size_t> workList = { 0 };
+    reachable[0] = true;
+
+    while (!workList.empty()) {
+      auto index = workList.back();
+      workList.pop_back();
+      ForEachSuccessor(instructions, index, [&](std::size_t successor) {
+        if (!reachable[successor]) {
+          reachable[successor] = true;
+          workList.push_back(successor);
+        }
+      });
+    }
+
+    auto changed = false;
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      if (!reachable[i]) {
+        instructions[i].removed = true;
+        changed = true;
+      }
+    }
+
+    return changed;
+  }
+
+  // Values that are pushed then immediately popped, e.g. the result of an expression statement like `x;`
+  static bool RemoveDeadPushes(InstructionList& instructions)
+  {
+    auto targets = FindJumpTargets(instructions);
+    auto changed = false;
+
+    for (std::size_t i = 1; i < instructions.size(); i++) {
+      auto& instruction = instructions[i];
+      auto& previous = instructions[i - 1];
+      if (instruction.op != Ops::Pop || targets[i] || previous.removed) {
+        continue;
+      }
+
+      if (previous.op == Ops::LoadConstant || previous.op == Ops::LoadLocal) {
+        previous.removed = true;
+        instruction.removed = true;
+        changed = true;
+      }
+    }
+
+    return changed;
+  }
+
+  GRACE_NODISCARD static std::optional<std::size_t> LocalSlot(const Value& value)
+  {
+    if (value.GetType() != Value::Type::Int || value.Get<std::int64_t>() < 0) {
+      return {};
+    }
+    return static_cast<std::size_t>(value.Get<std::int64_t>());
+  }
+
+  /*
+   *  Works out how many locals exist before each instruction runs, by walking the control flow from the start of the Function.
+   *
+   *  @param instructions     The decoded Function.
+   *  @param numParameters    How many locals exist when the Function is entered.
+   *  @returns                The number of locals before each instruction, empty for unreachable instructions,
+   *                          or nullopt if the number isn't the same along every path.
+   */
+  GRACE_NODISCARD static std::optional<std::vector<std::optional<std::size_t>>> CountLocals(const InstructionList& instructions, std::size_t numParameters)
+  {
+    std::vector<std::optional<std::size_t>> numLocals(instructions.size());
+    if (instructions.empty()) {
+      return numLocals;
+    }
+
+    std::vector<std::size_t> workList = { 0 };
+    numLocals[0] = numParameters;
+
+    while (!workList.empty()) {
+      auto index = workList.back();
+      workList.pop_back();
+
+      const auto& instruction = instructions[index];
+      auto count = *numLocals[index];
+      switch (instruction.op) {
+        case Ops::DeclareLocal:
+          count++;
+          break;
+        case Ops::PopLocal:
+          if (count == 0) {
+            return {};
+          }
+          count--;
+          break;
+        case Ops::ExitTry:
+        case Ops::PopLocals: {
+          auto target = LocalSlot(instruction.constants[0]);
+          if (!target) {
+            return {};
+          }
+          count = *target;
+          break;
+        }
+        default:
+          break;
+      }
+
+      // the compiler should guarantee this
+      auto consistent = true;
+      ForEachSuccessor(instructions, index, [&](std::size_t successor) {
+        // the VM resets the locals to where they were at EnterTry when jumping to the catch block
+        auto successorCount = instruction.op == Ops::EnterTry && successor == instruction.target ? *numLocals[index] : count;
+        if (!numLocals[successor]) {
+          numLocals[successor] = successorCount;
+          workList.push_back(successor);
+        } else if (*numLocals[successor] != successorCount) {
+          consistent = false;
+        }
+      });
+
+      if (!consistent) {
+        return {};
+      }
+    }
+
+    return numLocals;
+  }
+
+  /*
+   *  Works out which instructions declare, assign and read each local slot of a Function.
+   *
+   *  @param instructions     The decoded Function.
+   *  @param numParameters    How many locals exist when the Function is entered.
+   *  @returns                The usage of each slot, or nullopt if locals are accessed in a way that can't be analysed.
+   */
+  GRACE_NODISCARD static std::optional<std::vector<LocalUsage>> AnalyseLocals(const InstructionList& instructions, std::size_t numParameters)
+  {
+    std::vector<LocalUsage> usage(numParameters);
+    auto slotUsage = [&usage](std::size_t slot) -> LocalUsage& {
+      if (slot >= usage.size()) {
+        usage.resize(slot + 1);
+      }
+      return usage[slot];
+    };
+
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      const auto& instruction = instructions[i];
+      const auto& constants = instruction.constants;
+      switch (instruction.op) {
+        // reads the last N locals without naming them
+        case Ops::CreateInstance:
+          return {};
+        case Ops::LoadLocal:
+        case Ops::AssignLocal: {
+          auto slot = LocalSlot(constants[0]);
+          if (!slot) {
+            return {};
+          }
+          if (instruction.op == Ops::LoadLocal) {
+            slotUsage(*slot).reads++;
+          } else {
+            slotUsage(*slot).stores.push_back(i);
+          }
+          break;
+        }
+        case Ops::AssignIteratorBegin:
+        case Ops::IncrementIterator: {
+          auto iteratorSlot = LocalSlot(constants[1]);
+          if (!iteratorSlot || constants[0].GetType() != Value::Type::Bool) {
+            return {};
+          }
+          slotUsage(*iteratorSlot).otherWrites++;
+          if (constants[0].Get<bool>()) {
+            auto secondSlot = LocalSlot(constants[2]);
+            if (!secondSlot) {
+              return {};
+            }
+            // the index of a list iterator is incremented in place
+            auto& second = slotUsage(*secondSlot);
+            second.otherWrites++;
+            second.reads++;
+          }
+          break;
+        }
+        default:
+          if (IsCompoundAssign(instruction.op)) {
+            auto slot = LocalSlot(constants[0]);
+            if (!slot) {
+              return {};
+            }
+            auto& local = slotUsage(*slot);
+            local.reads++;
+            local.otherWrites++;
+          }
+          break;
+      }
+    }
+
+    // the slot a DeclareLocal creates isn't in the bytecode, it's however many locals exist at that point
+    auto numLocals = CountLocals(instructions, numParameters);
+    if (!numLocals) {
+      return {};
+    }
+
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      if (instructions[i].op == Ops::DeclareLocal && (*numLocals)[i]) {
+        slotUsage(*(*numLocals)[i]).declarations.push_back(i);
+      }
+    }
+
+    return usage;
+  }
+
+  /*
+   *  Copy propagation for locals that are only ever assigned a constant or an unmodified parameter,
+   *  e.g. `final size = 10;`, so every LoadLocal of them can load the original value instead.
+   *  This feeds constant folding, and dead store elimination then removes the assignment.
+   */
+  static bool PropagateCopies(InstructionList& instructions, const std::vector<LocalUsage>& usage, std::size_t numParameters)
+  {
+    auto targets = FindJumpTargets(instructions);
+    auto changed = false;
+
+    for (auto slot = numParameters; slot < usage.size(); slot++) {
+      const auto& local = usage[slot];
+      if (local.reads == 0 || local.otherWrites != 0 || local.declarations.size() != 1 || local.stores.size() != 1) {
+        continue;
+      }
+
+      // DeclareLocal, source, AssignLocal with nothing able to jump in between
+      // so the local can't be read before it has been assigned
+      auto declaration = local.declarations[0];
+      if (local.stores[0] != declaration + 2 || targets[declaration + 1] || targets[declaration + 2]) {
+        continue;
+      }
+
+      const auto& source = instructions[declaration + 1];
+      if (source.op == Ops::LoadLocal) {
+        auto sourceSlot = *LocalSlot(source.constants[0]);
+        if (sourceSlot >= numParameters) {
+          continue;
+        }
+        const auto& parameter = usage[sourceSlot];
+        if (!parameter.stores.empty() || parameter.otherWrites != 0 || !parameter.declarations.empty()) {
+          continue;
+        }
+      } else if (source.op != Ops::LoadConstant) {
+        continue;
+      }
+
+      auto sourceOp = source.op;
+      auto sourceConstant = source.constants[0];
+      for (auto& instruction : instructions) {
+        if (instruction.op == Ops::LoadLocal && *LocalSlot(instruction.constants[0]) == slot) {
+          instruction.op = sourceOp;
+          instruction.constants[0] = sourceConstant;
+          changed = true;
+        }
+      }
+    }
+
+    return changed;
+  }
+
+  // Assignments to locals that are never read are replaced with a Pop, the value is still evaluated for its side effects
+  static bool EliminateDeadStores(InstructionList& instructions, const std::vector<LocalUsage>& usage)
+  {
+    auto changed = false;
+
+    for (const auto& local : usage) {
+      if (local.reads != 0) {
+        continue;
+      }
+
+      for (auto store : local.stores) {
+        auto& instruction = instructions[store];
+        instruction.op = Ops::Pop;
+        instruction.constants.clear();
+        changed = true;
+      }
+    }
+
+    return changed;
+  }
+
+  // The ops that always give an Int and can't throw when all of their operands are Ints, and how many operands they take
+  GRACE_NODISCARD static std::optional<std::size_t> PureIntOperands(Ops op)
+  {
+    switch (GenericOp(op)) {
+      case Ops::Add:
+      case Ops::BitwiseAnd:
+      case Ops::BitwiseOr:
+      case Ops::BitwiseXOr:
+      case Ops::Multiply:
+      case Ops::Subtract:
+        return 2;
+      case Ops::Negate:
+        return 1;
+      default:
+        return {};
+    }
+  }
+
+  // An expression built only from Int constants, locals that always hold Ints and the ops in PureIntOperands,
+  // so working it out again with the same locals always gives the same Int
+  struct PureExpression
+  {
+    // the instructions from start to end push its value
+    std::size_t start, end;
+    // the ops and constants it's made of, two expressions with the same key always give the same result
+    std::vector<std::int64_t> key;
+    std::vector<std::size_t> slots;
+  };
+
+  /*
+   *  Finds the pure Int expression whose value is pushed by the instruction at end.
+   *
+   *  @param targets      The jump targets of the Function, nothing can jump into the middle of the expression.
+   *  @param intSlots     The local slots that always hold Ints, see FindIntSlots.
+   *  @returns            The expression, or nullopt if the value isn't made by one.
+   */
+  GRACE_NODISCARD static std::optional<PureExpression> FindPureExpression(const InstructionList& instructions, std::size_t end,
+      const std::vector<bool>& targets, const std::vector<bool>& intSlots)
+  {
+    PureExpression expression{ end, end, {}, {} };
+
+    // how many values are still needed from the instructions before this one
+    std::size_t needed = 1;
+    for (auto i = end;; i--) {
+      const auto& instruction = instructions[i];
+      if (instruction.op == Ops::LoadConstant) {
+        if (instruction.constants[0].GetType() != Value::Type::Int) {
+          return {};
+        }
+        needed--;
+      } else if (instruction.op == Ops::LoadLocal) {
+        auto slot = LocalSlot(instruction.constants[0]);
+        if (!slot || *slot >= intSlots.size() || !intSlots[*slot]) {
+          return {};
+        }
+        expression.slots.push_back(*slot);
+        needed--;
+      } else if (auto operands = PureIntOperands(instruction.op)) {
+        needed += *operands - 1;
+      } else {
+        return {};
+      }
+
+      if (needed == 0) {
+        expression.start = i;
+        break;
+      }
+      if (i == 0 || targets[i]) {
+        return {};
+      }
+    }
+
+    for (auto i = expression.start; i <= end; i++) {
+      const auto& instruction = instructions[i];
+      expression.key.push_back(static_cast<std::int64_t>(GenericOp(instruction.op)));
+      if (instruction.op == Ops::LoadConstant || instruction.op == Ops::LoadLocal) {
+        expression.key.push_back(instruction.constants[0].Get<std::int64_t>());
+      }
+    }
+
+    return expression;
+  }
+
+  /*
+   *  Works out which local slots only ever hold Ints, so expressions made from them can't throw or make objects.
+   *  Every declaration of the slot must straight away be given a pure Int expression, and anything changing it
+   *  afterwards must keep it an Int. Type annotations aren't checked at runtime, so parameters could be anything.
+   *  Starts by assuming every other slot qualifies and takes away the ones that don't, until nothing changes.
+   *
+   *  @param numLocals    The number of locals before each instruction, see CountLocals.
+   *  @returns            Whether each slot always holds an Int.
+   */
+  GRACE_NODISCARD static std::vector<bool> FindIntSlots(const InstructionList& instructions, std::size_t numSlots, const std::vector<bool>& targets,
+      const std::vector<std::optional<std::size_t>>& numLocals, std::size_t numParameters)
+  {
+    std::vector<bool> intSlots(numSlots, true);
+    std::fill_n(intSlots.begin(), std::min(numParameters, numSlots), false);
+
+    // whether the value the instruction at index stores is a pure Int expression
+    auto storesInt = [&](std::size_t index) {
+      return index != 0 && !targets[index] && FindPureExpression(instructions, index - 1, targets, intSlots);
+    };
+
+    auto changed = true;
+    while (changed) {
+      changed = false;
+      auto exclude = [&](std::size_t slot) {
+        if (slot < numSlots && intSlots[slot]) {
+          intSlots[slot] = false;
+          changed = true;
+        }
+      };
+
+      for (std::size_t i = 0; i < instructions.size(); i++) {
+        const auto& instruction = instructions[i];
+        const auto& constants = instruction.constants;
+        switch (instruction.op) {
+          case Ops::AssignLocal:
+          case Ops::AddAssign:
+          case Ops::BitwiseAndAssign:
+          case Ops::BitwiseOrAssign:
+          case Ops::BitwiseXOrAssign:
+          case Ops::MultiplyAssign:
+          case Ops::SubtractAssign: {
+            auto slot = *LocalSlot(constants[0]);
+            if (slot < numSlots && intSlots[slot] && !storesInt(i)) {
+              exclude(slot);
+            }
+            break;
+          }
+          case Ops::AssignIteratorBegin:
+          case Ops::IncrementIterator:
+            exclude(*LocalSlot(constants[1]));
+            if (constants[0].Get<bool>()) {
+              exclude(*LocalSlot(constants[2]));
+            }
+            break;
+          case Ops::DeclareLocal: {
+            if (!numLocals[i]) {
+              break;
+            }
+            // DeclareLocal, expression, AssignLocal, where the expression doesn't read the new local
+            auto slot = *numLocals[i];
+            auto store = i + 1;
+            while (store < instructions.size() && !targets[store]
+                && (instructions[store].op == Ops::LoadConstant || instructions[store].op == Ops::LoadLocal || PureIntOperands(instructions[store].op))) {
+              store++;
+            }
+            auto initialised = store < instructions.size() && instructions[store].op == Ops::AssignLocal
+              && *LocalSlot(instructions[store].constants[0]) == slot && storesInt(store);
+            if (initialised) {
+              auto expression = FindPureExpression(instructions, store - 1, targets, intSlots);
+              initialised = expression->start == i + 1
+                && std::find(expression->slots.begin(), expression->slots.end(), slot) == expression->slots.end();
+            }
+            if (!initialised) {
+              exclude(slot);
+            }
+            break;
+          }
+          default:
+            if (IsCompoundAssign(instruction.op)) {
+              exclude(*LocalSlot(constants[0]));
+            }
+            break;
+        }
+      }
+    }
+
+    return intSlots;
+  }
+
+  /*
+   *  Makes room for new locals straight after the parameters, which are declared and set to 0 at the start of the
+   *  Function so they only ever hold Ints. Every other local moves up to make room.
+   *
+   *  @param count    How many locals to add.
+   *  @returns        The slot of the first new local.
+   */
+  static std::size_t AddIntLocals(InstructionList& instructions, std::size_t numParameters, std::size_t count)
+  {
+    auto move = [numParameters, count](Value& constant) {
+      auto slot = constant.Get<std::int64_t>();
+      if (slot >= static_cast<std::int64_t>(numParameters)) {
+        constant = Value(slot + static_cast<std::int64_t>(count));
+      }
+    };
+
+    InstructionList prologue;
+    auto line = instructions.empty() ? 0 : instructions[0].line;
+    for (std::size_t i = 0; i < count; i++) {
+      prologue.push_back(Instruction{ Ops::DeclareLocal, line, {} });
+      prologue.push_back(Instruction{ Ops::LoadConstant, line, { Value(std::int64_t{}) } });
+      prologue.push_back(Instruction{ Ops::AssignLocal, line, { Value(static_cast<std::int64_t>(numParameters + i)) } });
+    }
+
+    for (auto& instruction : instructions) {
+      auto& constants = instruction.constants;
+      switch (instruction.op) {
+        case Ops::AssignIteratorBegin:
+        case Ops::IncrementIterator:
+          move(constants[1]);
+          if (constants[0].Get<bool>()) {
+            move(constants[2]);
+          }
+          break;
+        // both of these give the number of locals to keep, which now includes the new ones
+        case Ops::ExitTry:
+        case Ops::PopLocals:
+        case Ops::AssignLocal:
+        case Ops::LoadLocal:
+          move(constants[0]);
+          break;
+        default:
+          if (IsCompoundAssign(instruction.op)) {
+            move(constants[0]);
+          }
+          break;
+      }
+
+      // anything jumping back to the start mustn't declare the new locals again
+      if (IsJump(instruction.op)) {
+        instruction.target += prologue.size();
+      }
+    }
+
+    instructions.insert(instructions.begin(), std::make_move_iterator(prologue.begin()), std::make_move_iterator(prologue.end()));
+    return numParameters;
+  }
+
+  /*
+   *  Common subexpression elimination for pure Int expressions within a block, e.g. the second `row * width` in
+   *  `grid[row * width + column] = grid[row * width + column - 1]`. The first one is kept in a local, either the one
+   *  it's assigned to or a new one, and the others load that instead of working it out again.
+   *  Only one expression is done at a time, the biggest saving first, since that can break up smaller ones.
+   *
+   *  @param canAddLocals     Whether the Function's slots can be moved up to make room for a new local, see AddIntLocals.
+   *  @returns                Whether an expression was replaced.
+   */
+  static bool EliminateCommonSubexpressions(InstructionList& instructions, const std::vector<LocalUsage>& usage, std::size_t numParameters, bool canAddLocals)
+  {
+    auto targets = FindJumpTargets(instructions);
+    auto numLocals = CountLocals(instructions, numParameters);
+    if (!numLocals) {
+      return false;
+    }
+    auto intSlots = FindIntSlots(instructions, usage.size(), targets, *numLocals, numParameters);
+
+    struct Available
+    {
+      PureExpression first;
+      // the local the first one was assigned to, if any
+      std::optional<std::size_t> holder;
+      std::vector<PureExpression> repeats;
+    };
+
+    // expressions still available at the current instruction, and ones that stopped being available
+    std::vector<Available> available, done;
+
+    // anything reading a slot that's changed, or kept in it, has to be worked out again after that
+    auto invalidate = [&](auto&& isChanged) {
+      for (auto it = available.begin(); it != available.end();) {
+        const auto& slots = it->first.slots;
+        if (std::any_of(slots.begin(), slots.end(), isChanged) || (it->holder && isChanged(*it->holder))) {
+          done.push_back(std::move(*it));
+          it = available.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    };
+
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      if (targets[i]) {
+        std::move(available.begin(), available.end(), std::back_inserter(done));
+        available.clear();
+      }
+
+      const auto& instruction = instructions[i];
+      const auto& constants = instruction.constants;
+      switch (instruction.op) {
+        case Ops::AssignLocal: {
+          auto slot = *LocalSlot(constants[0]);
+          invalidate([slot](std::size_t changed) { return changed == slot; });
+          if (i != 0 && !targets[i]) {
+            for (auto& entry : available) {
+              if (entry.first.end == i - 1 && entry.repeats.empty()) {
+                entry.holder = slot;
+              }
+            }
+          }
+          break;
+        }
+        case Ops::AssignIteratorBegin:
+        case Ops::IncrementIterator: {
+          auto first = *LocalSlot(constants[1]);
+          auto second = constants[0].Get<bool>() ? *LocalSlot(constants[2]) : first;
+          invalidate([first, second](std::size_t changed) { return changed == first || changed == second; });
+          break;
+        }
+        case Ops::DeclareLocal:
+        case Ops::ExitTry:
+        case Ops::PopLocal:
+        case Ops::PopLocals: {
+          // the slots from here up are made or thrown away, ExitTry's count doesn't include the frame's offset so it could be any of them
+          std::size_t from = 0;
+          if (instruction.op == Ops::PopLocals) {
+            from = *LocalSlot(constants[0]);
+          } else if (instruction.op != Ops::ExitTry && (*numLocals)[i]) {
+            from = *(*numLocals)[i] - (instruction.op == Ops::PopLocal ? 1 : 0);
+          }
+          invalidate([from](std::size_t changed) { return changed >= from; });
+          break;
+        }
+        default:
+          if (IsCompoundAssign(instruction.op)) {
+            auto slot = *LocalSlot(constants[0]);
+            invalidate([slot](std::size_t changed) { return changed == slot; });
+          }
+          break;
+      }
+
+      if (!PureIntOperands(instruction.op)) {
+        continue;
+      }
+      auto expression = FindPureExpression(instructions, i, targets, intSlots);
+      if (!expression) {
+        continue;
+      }
+
+      auto entry = std::find_if(available.begin(), available.end(), [&](const Available& other) {
+        return other.first.key == expression->key;
+      });
+      if (entry == available.end()) {
+        available.push_back({ std::move(*expression), {}, {} });
+      } else {
+        entry->repeats.push_back(std::move(*expression));
+      }
+    }
+    std::move(available.begin(), available.end(), std::back_inserter(done));
+
+    // each repeat saves all but one of its instructions, a new local costs a store and a load after the first one
+    auto saving = [](const Available& entry) -> std::int64_t {
+      auto size = static_cast<std::int64_t>(entry.first.end - entry.first.start);
+      return size * static_cast<std::int64_t>(entry.repeats.size()) - (entry.holder ? 0 : 2);
+    };
+
+    Available* best = nullptr;
+    for (auto& entry : done) {
+      if (entry.repeats.empty() || saving(entry) <= 0 || (!entry.holder && !canAddLocals)) {
+        continue;
+      }
+      if (best == nullptr || saving(entry) > saving(*best)) {
+        best = &entry;
+      }
+    }
+
+    if (best == nullptr) {
+      return false;
+    }
+
+    std::size_t holder, offset = 0;
+    if (best->holder) {
+      holder = *best->holder;
+    } else {
+      holder = AddIntLocals(instructions, numParameters, 1);
+      offset = 3;
+    }
+
+    for (const auto& repeat : best->repeats) {
+      auto& load = instructions[repeat.start + offset];
+      load.op = Ops::LoadLocal;
+      load.constants = { Value(static_cast<std::int64_t>(holder)) };
+      for (auto i = repeat.start + 1; i <= repeat.end; i++) {
+        instructions[i + offset].removed = true;
+      }
+    }
+
+    if (!best->holder) {
+      // the value is still needed where it was first worked out, so it's loaded straight back after being kept
+      auto end = best->first.end + offset;
+      auto line = instructions[end].line;
+      Insert(instructions, end + 1, {
+        Instruction{ Ops::AssignLocal, line, { Value(static_cast<std::int64_t>(holder)) } },
+        Instruction{ Ops::LoadLocal, line, { Value(static_cast<std::int64_t>(holder)) } },
+      });
+    }
+
+    return true;
+  }
+
+  /*
+   *  Loop invariant code motion for pure Int expressions, e.g. `n * n` in `while i < n * n:`. An expression reading
+   *  only locals that nothing in the loop changes is worked out once before the loop, into a new local the loop loads.
+   *  Only one loop is done at a time, innermost first, so what's moved out of it can be moved out of an outer loop next.
+   *
+   *  @returns    Whether anything was moved.
+   */
+  static bool HoistLoopInvariants(InstructionList& instructions, const std::vector<LocalUsage>& usage, std::size_t numParameters)
+  {
+    auto targets = FindJumpTargets(instructions);
+    auto numLocals = CountLocals(instructions, numParameters);
+    if (!numLocals) {
+      return false;
+    }
+    auto intSlots = FindIntSlots(instructions, usage.size(), targets, *numLocals, numParameters);
+
+    // a loop is everything from the target of a jump back up to that jump
+    std::vector<std::pair<std::size_t, std::size_t>> loops;
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      if (instructions[i].op == Ops::Jump && instructions[i].target <= i && (*numLocals)[i]) {
+        loops.emplace_back(instructions[i].target, i);
+      }
+    }
+    std::sort(loops.begin(), loops.end(), [](const auto& a, const auto& b) {
+      return a.second - a.first < b.second - b.first;
+    });
+
+    for (auto [head, back] : loops) {
+      // the loop can only be entered at the top, where the invariants will be worked out first
+      auto enteredElsewhere = false;
+      for (std::size_t i = 0; i < instructions.size(); i++) {
+        const auto& instruction = instructions[i];
+        if ((i < head || i > back) && IsJump(instruction.op) && instruction.target > head && instruction.target <= back) {
+          enteredElsewhere = true;
+          break;
+        }
+      }
+      if (enteredElsewhere || !(*numLocals)[head]) {
+        continue;
+      }
+
+      // the slots the loop changes, makes or throws away, a catch block can also reset the locals
+      std::vector<bool> changed(usage.size());
+      auto firstDropped = *(*numLocals)[head];
+      auto hasTry = false;
+      for (auto i = head; i <= back; i++) {
+        const auto& instruction = instructions[i];
+        const auto& constants = instruction.constants;
+        switch (instruction.op) {
+          case Ops::EnterTry:
+          case Ops::ExitTry:
+            hasTry = true;
+            break;
+          case Ops::AssignLocal:
+            changed[*LocalSlot(constants[0])] = true;
+            break;
+          case Ops::AssignIteratorBegin:
+          case Ops::IncrementIterator:
+            changed[*LocalSlot(constants[1])] = true;
+            if (constants[0].Get<bool>()) {
+              changed[*LocalSlot(constants[2])] = true;
+            }
+            break;
+          case Ops::DeclareLocal:
+          case Ops::PopLocal:
+          case Ops::PopLocals:
+            if ((*numLocals)[i]) {
+              auto from = instruction.op == Ops::PopLocals ? *LocalSlot(constants[0])
+                : instruction.op == Ops::PopLocal ? *(*numLocals)[i] - 1 : *(*numLocals)[i];
+              firstDropped = std::min(firstDropped, from);
+            }
+            break;
+          default:
+            if (IsCompoundAssign(instruction.op)) {
+              changed[*LocalSlot(constants[0])] = true;
+            }
+            break;
+        }
+      }
+      if (hasTry) {
+        continue;
+      }
+
+      // the biggest invariant expressions, an expression found later that contains earlier ones replaces them
+      std::vector<PureExpression> invariants;
+      for (auto i = head; i <= back; i++) {
+        if (!PureIntOperands(instructions[i].op)) {
+          continue;
+        }
+        auto expression = FindPureExpression(instructions, i, targets, intSlots);
+        if (!expression || expression->start < head) {
+          continue;
+        }
+        const auto& slots = expression->slots;
+        auto invariant = std::all_of(slots.begin(), slots.end(), [&](std::size_t slot) {
+          return !changed[slot] && slot < firstDropped;
+        });
+        if (!invariant) {
+          continue;
+        }
+        while (!invariants.empty() && invariants.back().start >= expression->start) {
+          invariants.pop_back();
+        }
+        invariants.push_back(std::move(*expression));
+      }
+      if (invariants.empty()) {
+        continue;
+      }
+
+      // the same expression can appear more than once, they all load the same local
+      std::vector<std::size_t> keyIndices;
+      std::vector<const PureExpression*> keys;
+      for (const auto& expression : invariants) {
+        auto it = std::find_if(keys.begin(), keys.end(), [&](const PureExpression* key) { return key->key == expression.key; });
+        keyIndices.push_back(static_cast<std::size_t>(it - keys.begin()));
+        if (it == keys.end()) {
+          keys.push_back(&expression);
+        }
+      }
+
+      auto firstLocal = AddIntLocals(instructions, numParameters, keys.size());
+      auto offset = keys.size() * 3;
+      head += offset;
+      back += offset;
+
+      InstructionList preheader;
+      for (std::size_t k = 0; k < keys.size(); k++) {
+        for (auto i = keys[k]->start; i <= keys[k]->end; i++) {
+          preheader.push_back(instructions[i + offset]);
+        }
+        preheader.push_back(Instruction{ Ops::AssignLocal, instructions[keys[k]->end + offset].line, { Value(static_cast<std::int64_t>(firstLocal + k)) } });
+      }
+
+      for (std::size_t n = 0; n < invariants.size(); n++) {
+        const auto& expression = invariants[n];
+        auto& load = instructions[expression.start + offset];
+        load.op = Ops::LoadLocal;
+        load.constants = { Value(static_cast<std::int64_t>(firstLocal + keyIndices[n])) };
+        for (auto i = expression.start + 1; i <= expression.end; i++) {
+          instructions[i + offset].removed = true;
+        }
+      }
+
+      // jumps to the top from outside the loop work the invariants out, the loop's own jumps back skip them
+      auto preheaderSize = preheader.size();
+      Insert(instructions, head, std::move(preheader));
+      for (auto i = head + preheaderSize; i <= back + preheaderSize; i++) {
+        auto& instruction = instructions[i];
+        if (IsJump(instruction.op) && instruction.target == head) {
+          instruction.target = head + preheaderSize;
+        }
+      }
+
+      return true;
+    }
+
+    return false;
+  }
+
+  // LessInt, JumpIfFalse => CompareIntJumpIfFalse, so conditions on Ints don't need to push and pop a Bool
+  // this runs after everything else, the other passes only know about JumpIfFalse
+  static bool FuseIntCompareBranches(InstructionList& instructions)
+  {
+    auto targets = FindJumpTargets(instructions);
+    auto changed = false;
+
+    for (std::size_t i = 1; i < instructions.size(); i++) {
+      auto& instruction = instructions[i];
+      auto& previous = instructions[i - 1];
+      if (instruction.op != Ops::JumpIfFalse || targets[i] || previous.removed) {
+        continue;
+      }
+
+      switch (previous.op) {
+        case Ops::EqualInt:
+        case Ops::GreaterEqualInt:
+        case Ops::GreaterInt:
+        case Ops::LessEqualInt:
+        case Ops::LessInt:
+        case Ops::NotEqualInt:
+          break;
+        default:
+          continue;
+      }
+
+      instruction.op = Ops::CompareIntJumpIfFalse;
+      instruction.constants.insert(instruction.constants.begin(), Value(static_cast<std::int64_t>(previous.op)));
+      previous.removed = true;
+      changed = true;
+    }
+
+    return changed;
+  }
+
+  /*
+   *  Liveness analysis for local slots. A LoadLocal after which the slot's value can't be read again, before it is
+   *  next assigned or the Function returns, becomes a MoveLocal, so the value is moved onto the stack instead of copied.
+   *  This saves copying Strings and the ref count traffic of copying objects, e.g. for `s = s + x` or passing a local
+   *  to a function for the last time. This runs after everything else, the other passes only know about LoadLocal.
+   *
+   *  @returns    Whether any loads were changed.
+   */
+  static bool MoveLastUses(InstructionList& instructions)
+  {
+    std::size_t numSlots = 0;
+    for (const auto& instruction : instructions) {
+      switch (instruction.op) {
+        // a throw anywhere in a try block can land in the catch block, which may read any local,
+        // and CreateInstance reads the last N locals without naming them
+        case Ops::CreateInstance:
+        case Ops::EnterTry:
+          return false;
+        case Ops::AssignIteratorBegin:
+        case Ops::IncrementIterator:
+          if (instruction.constants[0].GetType() != Value::Type::Bool) {
+            return false;
+          }
+          for (std::size_t i = 1; i < 3; i++) {
+            auto slot = LocalSlot(instruction.constants[i]);
+            if (!slot) {
+              return false;
+            }
+            numSlots = std::max(numSlots, *slot + 1);
+          }
+          break;
+        default:
+          if (instruction.op == Ops::LoadLocal || instruction.op == Ops::AssignLocal || IsCompoundAssign(instruction.op)) {
+            auto slot = LocalSlot(instruction.constants[0]);
+            if (!slot) {
+              return false;
+            }
+            numSlots = std::max(numSlots, *slot + 1);
+          }
+          break;
+      }
+    }
+
+    if (numSlots == 0) {
+      return false;
+    }
+
+    // the slots that may be read again after each instruction, worked backwards until nothing changes
+    std::vector<std::vector<bool>> liveOut(instructions.size(), std::vector<bool>(numSlots));
+    std::vector<std::vector<bool>> liveIn(instructions.size(), std::vector<bool>(numSlots));
+
+    auto changed = true;
+    while (changed) {
+      changed = false;
+
+      for (auto i = instructions.size(); i-- > 0;) {
+        const auto& instruction = instructions[i];
+
+        auto out = std::vector<bool>(numSlots);
+        ForEachSuccessor(instructions, i, [&](std::size_t successor) {
+          const auto& successorIn = liveIn[successor];
+          for (std::size_t slot = 0; slot < numSlots; slot++) {
+            out[slot] = out[slot] || successorIn[slot];
+          }
+        });
+
+        auto in = out;
+        const auto& constants = instruction.constants;
+        switch (instruction.op) {
+          case Ops::AssignLocal:
+            in[*LocalSlot(constants[0])] = false;
+            break;
+          case Ops::LoadLocal:
+            in[*LocalSlot(constants[0])] = true;
+            break;
+          case Ops::AssignIteratorBegin:
+            in[*LocalSlot(constants[1])] = false;
+            if (constants[0].Get<bool>()) {
+              in[*LocalSlot(constants[2])] = false;
+            }
+            break;
+          case Ops::IncrementIterator:
+            // the index of a list iterator is incremented in place
+            in[*LocalSlot(constants[1])] = false;
+            if (constants[0].Get<bool>()) {
+              in[*LocalSlot(constants[2])] = true;
+            }
+            break;
+          default:
+            if (IsCompoundAssign(instruction.op)) {
+              in[*LocalSlot(constants[0])] = true;
+            }
+            break;
+        }
+
+        if (out != liveOut[i] || in != liveIn[i]) {
+          liveOut[i] = std::move(out);
+          liveIn[i] = std::move(in);
+          changed = true;
+        }
+      }
+    }
+
+    auto moved = false;
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      auto& instruction = instructions[i];
+      if (instruction.op == Ops::LoadLocal && !liveOut[i][*LocalSlot(instruction.constants[0])]) {
+        instruction.op = Ops::MoveLocal;
+        moved = true;
+      }
+    }
+
+    return moved;
+  }
+
+  // The op that allocates the same object in the ObjectArena, if the op allocates an object that could go there
+  GRACE_NODISCARD static std::optional<Ops> NoEscapeOp(Ops op)
+  {
+    switch (op) {
+      case Ops::CreateDictionary:
+        return Ops::CreateDictionaryNoEscape;
+      case Ops::CreateList:
+        return Ops::CreateListNoEscape;
+      case Ops::CreateRange:
+        return Ops::CreateRangeNoEscape;
+      case Ops::CreateSet:
+        return Ops::CreateSetNoEscape;
+      default:
+        return {};
+    }
+  }
+
+  // Whether an op pops the value on top of the stack and is then done with it, without keeping it anywhere
+  GRACE_NODISCARD static bool ConsumesWithoutEscaping(Ops op)
+  {
+    switch (op) {
+      // the iterator keeps a ref, but it is destroyed at the end of the loop
+      case Ops::AssignIteratorBegin:
+      case Ops::CheckListRange:
+      case Ops::CheckType:
+      case Ops::IsObject:
+      case Ops::Pop:
+      case Ops::Print:
+      case Ops::PrintLn:
+      case Ops::EPrint:
+      case Ops::EPrintLn:
+      case Ops::Typename:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /*
+   *  Escape analysis for lists, dictionaries, sets and ranges. An object escapes if it could be referenced by anything
+   *  other than the Function's own stack and locals, e.g. by being returned, passed to a function, stored in another object
+   *  or given to a member call. Allocations whose object can't escape become NoEscape ops, which put the object in
+   *  the ObjectArena without tracking it, since an object nothing else can reference can never be part of a cycle.
+   *
+   *  This is deliberately conservative: an object is only known not to escape if every use of it matches one of a few
+   *  shapes the compiler emits, e.g. `for i in [0..n]`, or a local that is only ever subscripted, iterated or printed.
+   *
+   *  @param instructions     The decoded Function.
+   *  @param numParameters    How many locals exist when the Function is entered, these come from the caller.
+   *  @returns                Whether any allocations were changed.
+   */
+  static bool FindNonEscapingObjects(InstructionList& instructions, std::size_t numParameters)
+  {
+    auto targets = FindJumpTargets(instructions);
+    auto size = instructions.size();
+
+    auto plainPush = [&](std::size_t index) {
+      return index < size && !targets[index] && (instructions[index].op == Ops::LoadLocal || instructions[index].op == Ops::LoadConstant);
+    };
+
+    auto opAt = [&](std::size_t index, auto&&... ops) {
+      return index < size && !targets[index] && ((instructions[index].op == ops) || ...);
+    };
+
+    // whether the object pushed by the instruction at index is used without escaping, only looking at what comes right after it
+    auto usedSafely = [&](std::size_t index) {
+      if (index + 1 < size && !targets[index + 1] && ConsumesWithoutEscaping(instructions[index + 1].op)) {
+        return true;
+      }
+
+      // the container in `x[i]` or `x[i] = v`
+      if (plainPush(index + 1) && opAt(index + 2, Ops::GetSubscript, Ops::GetSubscriptList, Ops::GetSubscriptUnchecked)) {
+        return true;
+      }
+      return plainPush(index + 1) && plainPush(index + 2) && opAt(index + 3, Ops::AssignSubscript, Ops::AssignSubscriptUnchecked);
+    };
+
+    // which slots only ever hold objects that don't escape
+    std::vector<bool> safeSlots;
+    auto markUnsafe = [&](const Value& slotValue) {
+      auto slot = LocalSlot(slotValue);
+      if (slot && *slot < safeSlots.size()) {
+        safeSlots[*slot] = false;
+      }
+    };
+
+    for (const auto& instruction : instructions) {
+      switch (instruction.op) {
+        // reads the last N locals without naming them
+        case Ops::CreateInstance:
+          return false;
+        case Ops::AssignLocal:
+        case Ops::LoadLocal:
+          if (auto slot = LocalSlot(instruction.constants[0]); slot && *slot >= safeSlots.size()) {
+            safeSlots.resize(*slot + 1, true);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+
+    for (std::size_t i = 0; i < std::min(numParameters, safeSlots.size()); i++) {
+      safeSlots[i] = false;
+    }
+
+    for (std::size_t i = 0; i < size; i++) {
+      const auto& instruction = instructions[i];
+      switch (instruction.op) {
+        case Ops::AssignLocal:
+          if (i == 0 || targets[i] || !NoEscapeOp(instructions[i - 1].op)) {
+            markUnsafe(instruction.constants[0]);
+          }
+          break;
+        case Ops::LoadLocal:
+          if (!usedSafely(i)) {
+            markUnsafe(instruction.constants[0]);
+          }
+          break;
+        case Ops::AssignIteratorBegin:
+        case Ops::IncrementIterator:
+          markUnsafe(instruction.constants[1]);
+          markUnsafe(instruction.constants[2]);
+          break;
+        default:
+          if (IsCompoundAssign(instruction.op)) {
+            markUnsafe(instruction.constants[0]);
+          }
+          break;
+      }
+    }
+
+    auto changed = false;
+    for (std::size_t i = 0; i < size; i++) {
+      auto& instruction = instructions[i];
+      auto noEscapeOp = NoEscapeOp(instruction.op);
+      if (!noEscapeOp) {
+        continue;
+      }
+
+      auto safe = usedSafely(i);
+      if (!safe && opAt(i + 1, Ops::AssignLocal)) {
+        auto slot = LocalSlot(instructions[i + 1].constants[0]);
+        safe = slot && *slot < safeSlots.size() && safeSlots[*slot];
+      }
+
+      if (safe) {
+        instruction.op = *noEscapeOp;
+        changed = true;
+      }
+    }
+
+    return changed;
+  }
+
+  // canAddLocals is whether the Function's slots can be moved up to make room for new locals, see AddIntLocals
+  static void RunPasses(InstructionList& instructions, OptimisationLevel level, std::size_t numParameters, bool canAddLocals)
+  {
+    // each pass can expose more work for the others, e.g. a propagated constant can be folded into a branch
+    // which makes a block unreachable, so run them until nothing changes
+    auto changed = true;
+    while (changed && !instructions.empty()) {
+      changed = false;
+
+      auto run = [&](auto&& pass) {
+        if (pass(instructions)) {
+          Compact(instructions);
+          changed = true;
+        }
+      };
+
+      run(RemoveUnreachable);
+      run(ThreadJumps);
+      run(FoldConstants);
+      run(RemoveDeadPushes);
+
+      if (level >= OptimisationLevel::O2) {
+        if (auto usage = AnalyseLocals(instructions, numParameters)) {
+          run([&](InstructionList& list) { return PropagateCopies(list, *usage, numParameters); });
+        }
+        if (auto usage = AnalyseLocals(instructions, numParameters)) {
+          run([&](InstructionList& list) { return EliminateDeadStores(list, *usage); });
+        }
+        if (auto usage = AnalyseLocals(instructions, numParameters); usage && canAddLocals) {
+          run([&](InstructionList& list) { return HoistLoopInvariants(list, *usage, numParameters); });
+        }
+        if (auto usage = AnalyseLocals(instructions, numParameters)) {
+          run([&](InstructionList& list) { return EliminateCommonSubexpressions(list, *usage, numParameters, canAddLocals); });
+        }
+      }
+    }
+  }
+
+  // MoveLocal and the NoEscape ops are only valid for the Function they were worked out for, e.g. not once it has been
+  // inlined somewhere else, so passes only ever see the plain ops and MoveLastUses and FindNonEscapingObjects work them out again
+  GRACE_NODISCARD static Ops AnalysisFreeOp(Ops op)
+  {
+    switch (op) {
+      case Ops::MoveLocal:
+        return Ops::LoadLocal;
+      case Ops::CreateDictionaryNoEscape:
+        return Ops::CreateDictionary;
+      case Ops::CreateListNoEscape:
+        return Ops::CreateList;
+      case Ops::CreateRangeNoEscape:
+        return Ops::CreateRange;
+      case Ops::CreateSetNoEscape:
+        return Ops::CreateSet;
+      default:
+        return op;
+    }
+  }
+
+  /*
+   *  Decodes a Function's ops and constants into an InstructionList.
+   *
+   *  @returns    The instructions, or nullopt if the constants or jump targets don't line up with the ops,
+   *              in which case the Function should be left as it is.
+   */
+  template<typename OpList>
+  GRACE_NODISCARD static std::optional<InstructionList> Decode(const OpList& opList, const std::vector<Value>& constantList)
+  {
+    InstructionList instructions;
+    instructions.reserve(opList.size());
+
+    // where each op starts reading constants from, to check the constant indices stored in jumps
+    std::vector<std::size_t> constantStarts;
+    constantStarts.reserve(opList.size());
+
+    std::size_t constantIndex = 0;
+    for (auto [op, line] : opList) {
+      auto numConstants = NumConstants(op, constantList, constantIndex);
+      if (!numConstants || constantIndex + *numConstants > constantList.size()) {
+        return {};
+      }
+
+      constantStarts.push_back(constantIndex);
+      auto& instruction = instructions.emplace_back(Instruction{ AnalysisFreeOp(op), line, {} });
+      instruction.constants.assign(constantList.begin() + constantIndex, constantList.begin() + constantIndex + *numConstants);
+      constantIndex += *numConstants;
+    }
+
+    if (constantIndex != constantList.size()) {
+      return {};
+    }
+
+    for (auto& instruction : instructions) {
+      if (!IsJump(instruction.op)) {
+        continue;
+      }
+
+      auto [constantPosition, opPosition] = JumpOperandPositions(instruction.op);
+      const auto& constantOperand = instruction.constants[constantPosition];
+      const auto& opOperand = instruction.constants[opPosition];
+      if (constantOperand.GetType() != Value::Type::Int || opOperand.GetType() != Value::Type::Int) {
+        return {};
+      }
+
+      auto opIndex = opOperand.Get<std::int64_t>();
+      if (opIndex < 0 || static_cast<std::size_t>(opIndex) >= instructions.size()
+          || constantStarts[static_cast<std::size_t>(opIndex)] != static_cast<std::size_t>(constantOperand.Get<std::int64_t>())) {
+        return {};
+      }
+
+      instruction.target = static_cast<std::size_t>(opIndex);
+    }
+
+    return instructions;
+  }
+
+  // Writes the instructions back out as ops and constants, filling in the indices jumps need
+  template<typename OpList>
+  static void Encode(InstructionList& instructions, OpList& opList, std::vector<Value>& constantList)
+  {
+    std::vector<std::pair<std::size_t, std::size_t>> starts;
+    starts.reserve(instructions.size());
+    std::size_t numConstants = 0;
+    for (const auto& instruction : instructions) {
+      starts.emplace_back(starts.size(), numConstants);
+      numConstants += instruction.constants.size();
+    }
+
+    opList.clear();
+    opList.reserve(instructions.size());
+    constantList.clear();
+    constantList.reserve(numConstants);
+
+    for (auto& instruction : instructions) {
+      if (IsJump(instruction.op)) {
+        auto [constantPosition, opPosition] = JumpOperandPositions(instruction.op);
+        auto [opIndex, constIndex] = starts[instruction.target];
+        instruction.constants[constantPosition] = Value(static_cast<std::int64_t>(constIndex));
+        instruction.constants[opPosition] = Value(static_cast<std::int64_t>(opIndex));
+      }
+
+      opList.push_back({ instruction.op, instruction.line });
+      constantList.insert(constantList.end(), instruction.constants.begin(), instruction.constants.end());
+    }
+  }
+
+  // Bigger functions aren't worth the extra code
+  static constexpr std::size_t s_MaxInlineInstructions = 32;
+
+  // The body of a function that can be inlined, found by the resolver given to InlineCalls
+  struct InlineCandidate
+  {
+    InstructionList body;
+    std::size_t arity, site;
+  };
+
+  GRACE_NODISCARD static bool CanInline(const InstructionList& body, std::size_t arity)
+  {
+    if (body.empty() || body.size() > s_MaxInlineInstructions) {
+      return false;
+    }
+
+    for (const auto& instruction : body) {
+      switch (instruction.op) {
+        // calls, iterators, try blocks, namespace lookups and yields all depend on the callee having its own frame
+        case Ops::AppendNamespace:
+        case Ops::AssignIteratorBegin:
+        case Ops::Call:
+        case Ops::CheckIteratorEnd:
+        case Ops::CreateInstance:
+        case Ops::DestroyHeldIterator:
+        case Ops::EnterTry:
+        case Ops::ExitTry:
+        case Ops::IncrementIterator:
+        case Ops::MemberCall:
+        case Ops::StartNewNamespace:
+        case Ops::Yield:
+          return false;
+        default:
+          break;
+      }
+    }
+
+    // execution must not be able to run off the end of the body
+    switch (body.back().op) {
+      case Ops::Exit:
+      case Ops::Jump:
+      case Ops::Return:
+      case Ops::Throw:
+        break;
+      default:
+        return false;
+    }
+
+    // every Return must have popped all of the callee's locals, so the caller's locals are as they were
+    auto numLocals = CountLocals(body, arity);
+    if (!numLocals) {
+      return false;
+    }
+
+    for (std::size_t i = 0; i < body.size(); i++) {
+      if (body[i].op == Ops::Return && (*numLocals)[i] && *(*numLocals)[i] != 0) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Replaces the instruction at index with replacement, whose jump targets are relative to its first instruction
+  // and can be replacement.size() to continue after it
+  static void Splice(InstructionList& instructions, std::size_t index, InstructionList&& replacement)
+  {
+    auto shift = replacement.size() - 1;
+    for (auto& instruction : instructions) {
+      if (IsJump(instruction.op) && instruction.target > index) {
+        instruction.target += shift;
+      }
+    }
+
+    for (auto& instruction : replacement) {
+      if (IsJump(instruction.op)) {
+        instruction.target += index;
+      }
+    }
+
+    instructions[index] = std::move(replacement[0]);
+    instructions.insert(instructions.begin() + static_cast<std::ptrdiff_t>(index) + 1,
+        std::make_move_iterator(replacement.begin() + 1), std::make_move_iterator(replacement.end()));
+  }
+
+  /*
+   *  Builds the instructions that replace a call to candidate, with the callee's locals moved up to start at base.
+   *  The arguments are already on the stack so are popped into new locals, and a Return becomes a jump past the end
+   *  which leaves the return value on the stack, just like returning from the call would.
+   */
+  GRACE_NODISCARD static InstructionList InlineBody(InlineCandidate&& candidate, std::size_t base, std::size_t line)
+  {
+    InstructionList result;
+    result.reserve(candidate.arity * 2 + candidate.body.size());
+
+    for (std::size_t i = 0; i < candidate.arity; i++) {
+      result.push_back(Instruction{ Ops::DeclareLocal, line, {} });
+    }
+    for (auto i = candidate.arity; i-- > 0;) {
+      result.push_back(Instruction{ Ops::AssignLocal, line, { Value(static_cast<std::int64_t>(base + i)) } });
+    }
+
+    auto prologueSize = result.size();
+    auto end = prologueSize + candidate.body.size();
+
+    for (auto& instruction : candidate.body) {
+      instruction.inlineSite = candidate.site;
+
+      if (instruction.op == Ops::LoadLocal || instruction.op == Ops::AssignLocal || instruction.op == Ops::PopLocals
+          || IsCompoundAssign(instruction.op)) {
+        auto slot = instruction.constants[0].Get<std::int64_t>();
+        instruction.constants[0] = Value(slot + static_cast<std::int64_t>(base));
+      } else if (instruction.op == Ops::Return) {
+        instruction.op = Ops::Jump;
+        instruction.constants = { Value(std::int64_t{}), Value(std::int64_t{}) };
+        instruction.target = end;
+      }
+
+      if (IsJump(instruction.op) && instruction.target != end) {
+        instruction.target += prologueSize;
+      }
+
+      result.push_back(std::move(instruction));
+    }
+
+    return result;
+  }
+
+  /*
+   *  Replaces calls whose callee can be worked out at compile time with the callee's body.
+   *  The namespace a Call looks in is set up by the StartNewNamespace and AppendNamespace ops before it,
+   *  so those are followed here the same way the VM does, and removed along with the Call.
+   *
+   *  @param instructions     The decoded Function.
+   *  @param numParameters    How many locals exist when the Function is entered.
+   *  @param resolve          Called with the namespace path (empty for the same file), name hash, number of args and line
+   *                          of each Call, returns an InlineCandidate if the callee can be inlined.
+   *  @returns                Whether any calls were inlined.
+   */
+  template<typename Resolve>
+  static bool InlineCalls(InstructionList& instructions, std::size_t numParameters, Resolve&& resolve)
+  {
+    auto numLocals = CountLocals(instructions, numParameters);
+    if (!numLocals) {
+      return false;
+    }
+
+    struct NamespaceFrame
+    {
+      std::vector<std::string> parts;
+      std::vector<std::size_t> instructions;
+    };
+
+    struct InlinedCall
+    {
+      std::size_t index;
+      InlineCandidate candidate;
+      std::vector<std::size_t> namespaceInstructions;
+    };
+
+    auto targets = FindJumpTargets(instructions);
+    std::vector<NamespaceFrame> namespaces(1);
+    std::vector<InlinedCall> calls;
+
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      const auto& instruction = instructions[i];
+
+      // namespaces are only ever built up inside an expression, so there shouldn't be any when control flow splits or joins
+      if (targets[i] || IsJump(instruction.op)) {
+        if (namespaces.size() != 1 || !namespaces[0].parts.empty()) {
+          return false;
+        }
+      }
+
+      switch (instruction.op) {
+        case Ops::StartNewNamespace:
+          namespaces.push_back({ {}, { i } });
+          break;
+        case Ops::AppendNamespace:
+          if (instruction.constants[0].GetType() != Value::Type::String) {
+            return false;
+          }
+          namespaces.back().parts.push_back(instruction.constants[0].Get<std::string>());
+          namespaces.back().instructions.push_back(i);
+          break;
+        case Ops::Call: {
+          auto& frame = namespaces.back();
+          std::string path;
+          for (std::size_t part = 0; part < frame.parts.size(); part++) {
+            path.append(frame.parts[part]);
+            path.append(part < frame.parts.size() - 1 ? "/" : ".gr");
+          }
+
+          const auto& nameHash = instruction.constants[0];
+          const auto& numArgs = instruction.constants[1];
+          if (nameHash.GetType() == Value::Type::Int && numArgs.GetType() == Value::Type::Int && (*numLocals)[i]
+              && (namespaces.size() > 1 || path.empty())) {
+            if (auto candidate = resolve(path, nameHash.Get<std::int64_t>(), static_cast<std::size_t>(numArgs.Get<std::int64_t>()), instruction.line)) {
+              calls.push_back({ i, std::move(*candidate), namespaces.size() > 1 ? frame.instructions : std::vector<std::size_t>{} });
+            }
+          }
+
+          // the VM pops the namespace once a call has used it
+          if (namespaces.size() > 1) {
+            namespaces.pop_back();
+          }
+          break;
+        }
+        default:
+          break;
+      }
+    }
+
+    // work backwards so splicing doesn't move anything still to be inlined
+    for (auto it = calls.rbegin(); it != calls.rend(); it++) {
+      for (auto index : it->namespaceInstructions) {
+        instructions[index].removed = true;
+      }
+      auto line = instructions[it->index].line;
+      Splice(instructions, it->index, InlineBody(std::move(it->candidate), *(*numLocals)[it->index], line));
+    }
+
+    if (!calls.empty()) {
+      Compact(instructions);
+    }
+
+    return !calls.empty();
+  }
+
+  /*
+   *  Checks for a body that only passes its parameters on to a native function and returns the result or null, e.g.
+   *  LoadLocal 0, LoadLocal 1, NativeCall, PopLocals, Return
+   *
+   *  @returns    The index of the NativeCall and whether its result is returned, or nullopt.
+   */
+  GRACE_NODISCARD static std::optional<std::pair<std::size_t, bool>> FindNativeForward(const InstructionList& instructions, std::size_t arity)
+  {
+    if (instructions.size() < arity + 2) {
+      return {};
+    }
+
+    for (std::size_t i = 0; i < arity; i++) {
+      const auto& instruction = instructions[i];
+      if (instruction.op != Ops::LoadLocal || LocalSlot(instruction.constants[0]) != i) {
+        return {};
+      }
+    }
+
+    const auto& nativeCall = instructions[arity];
+    if (nativeCall.op != Ops::NativeCall || LocalSlot(nativeCall.constants[1]) != arity) {
+      return {};
+    }
+
+    std::vector<Ops> rest;
+    for (auto i = arity + 1; i < instructions.size(); i++) {
+      const auto& instruction = instructions[i];
+      if (instruction.op == Ops::PopLocals && LocalSlot(instruction.constants[0]) == 0) {
+        continue;
+      }
+      if (instruction.op == Ops::LoadConstant && instruction.constants[0].GetType() != Value::Type::Null) {
+        return {};
+      }
+      rest.push_back(instruction.op);
+    }
+
+    if (rest == std::vector<Ops>{ Ops::Return }) {
+      return std::make_pair(arity, true);
+    }
+    if (rest == std::vector<Ops>{ Ops::Pop, Ops::LoadConstant, Ops::Return }) {
+      return std::make_pair(arity, false);
+    }
+    return {};
+  }
+
+  // Loops are copied whole, so only version small ones
+  static constexpr std::size_t s_MaxVersionedLoopInstructions = 128;
+
+  // A `for` loop over a Range whose body subscripts lists with the loop's iterator, see VersionSubscriptLoops
+  struct SubscriptLoop
+  {
+    // from the AssignIteratorBegin up to the instruction the loop exits to
+    std::size_t begin, end;
+    // the instructions that can skip their checks, and the slots of the lists they subscript
+    std::vector<std::size_t> subscripts, lists;
+  };
+
+  GRACE_NODISCARD static std::optional<SubscriptLoop> FindSubscriptLoop(const InstructionList& instructions, const std::vector<bool>& targets,
+      const std::vector<std::optional<std::size_t>>& numLocals, std::size_t begin)
+  {
+    // CreateRange, AssignIteratorBegin, CheckIteratorEnd, JumpIfFalse end, ..., Jump back to the CheckIteratorEnd
+    const auto& assign = instructions[begin];
+    if (assign.op != Ops::AssignIteratorBegin || begin == 0 || instructions[begin - 1].op != Ops::CreateRange || targets[begin]
+        || !numLocals[begin] || assign.constants[0].GetType() != Value::Type::Bool || assign.constants[0].Get<bool>()) {
+      return {};
+    }
+
+    const auto& exitJump = instructions[begin + 2];
+    if (instructions[begin + 1].op != Ops::CheckIteratorEnd || exitJump.op != Ops::JumpIfFalse || exitJump.target <= begin + 2
+        || exitJump.target - begin > s_MaxVersionedLoopInstructions) {
+      return {};
+    }
+
+    auto iterator = LocalSlot(assign.constants[1]);
+    auto end = exitJump.target;
+
+    // the only way into the loop must be through the top
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      const auto& instruction = instructions[i];
+      if ((i < begin || i >= end) && IsJump(instruction.op) && instruction.target > begin && instruction.target < end) {
+        return {};
+      }
+    }
+
+    SubscriptLoop loop{ begin, end, {}, {} };
+    std::vector<std::size_t> writtenSlots;
+
+    for (auto i = begin + 1; i < end; i++) {
+      const auto& instruction = instructions[i];
+      if (IsJump(instruction.op) && (instruction.target < begin || instruction.target > end)) {
+        return {};
+      }
+
+      const auto& constants = instruction.constants;
+      switch (instruction.op) {
+        // anything that gets called could change the length of a list, and so could anything run while a generator is suspended
+        case Ops::Call:
+        case Ops::MemberCall:
+        case Ops::NativeCall:
+        case Ops::Yield:
+        // only the innermost loops are versioned, so copies don't nest
+        case Ops::AssignIteratorBegin:
+        case Ops::EnterTry:
+        case Ops::ExitTry:
+          return {};
+        case Ops::AssignLocal:
+          writtenSlots.push_back(*LocalSlot(constants[0]));
+          break;
+        case Ops::IncrementIterator:
+          if (LocalSlot(constants[1]) != iterator) {
+            return {};
+          }
+          break;
+        // LoadLocal list, LoadLocal iterator, GetSubscript
+        case Ops::GetSubscript:
+        case Ops::GetSubscriptList:
+          if (instructions[i - 2].op == Ops::LoadLocal && instructions[i - 1].op == Ops::LoadLocal
+              && LocalSlot(instructions[i - 1].constants[0]) == iterator && !targets[i - 1] && !targets[i]) {
+            loop.subscripts.push_back(i);
+          }
+          break;
+        // LoadLocal list, LoadLocal iterator, value, AssignSubscript
+        case Ops::AssignSubscript:
+          if (instructions[i - 3].op == Ops::LoadLocal && instructions[i - 2].op == Ops::LoadLocal
+              && LocalSlot(instructions[i - 2].constants[0]) == iterator
+              && (instructions[i - 1].op == Ops::LoadConstant || instructions[i - 1].op == Ops::LoadLocal)
+              && !targets[i - 2] && !targets[i - 1] && !targets[i]) {
+            loop.subscripts.push_back(i);
+          }
+          break;
+        default:
+          if (IsCompoundAssign(instruction.op)) {
+            writtenSlots.push_back(*LocalSlot(constants[0]));
+          }
+          break;
+      }
+    }
+
+    if (std::find(writtenSlots.begin(), writtenSlots.end(), *iterator) != writtenSlots.end()) {
+      return {};
+    }
+
+    // the list has to exist before the loop and stay the same list all the way through it
+    std::erase_if(loop.subscripts, [&](std::size_t index) {
+      auto listIndex = instructions[index].op == Ops::AssignSubscript ? index - 3 : index - 2;
+      auto list = *LocalSlot(instructions[listIndex].constants[0]);
+      return list == *iterator || list >= *numLocals[begin] || std::find(writtenSlots.begin(), writtenSlots.end(), list) != writtenSlots.end();
+    });
+
+    if (loop.subscripts.empty()) {
+      return {};
+    }
+
+    for (auto index : loop.subscripts) {
+      auto listIndex = instructions[index].op == Ops::AssignSubscript ? index - 3 : index - 2;
+      auto list = *LocalSlot(instructions[listIndex].constants[0]);
+      if (std::find(loop.lists.begin(), loop.lists.end(), list) == loop.lists.end()) {
+        loop.lists.push_back(list);
+      }
+    }
+
+    return loop;
+  }
+
+  /*
+   *  Bounds check elimination for `for` loops over a Range that subscript lists with the iterator, e.g.
+   *  `for i in [0..n]: total += bits[i]; end`. The loop is copied, and before it runs CheckListRange checks once
+   *  that every value of the Range is a valid index into each list. If so the copy is run, where the subscripts
+   *  skip the type and bounds checks, otherwise the original loop is run and behaves exactly as it did before.
+   *  The lists can't change length during the loop because it can't contain any calls, and can't be reassigned.
+   *
+   *  @param instructions     The decoded Function.
+   *  @param numParameters    How many locals exist when the Function is entered.
+   *  @returns                Whether any loops were versioned.
+   */
+  static bool VersionSubscriptLoops(InstructionList& instructions, std::size_t numParameters)
+  {
+    auto numLocals = CountLocals(instructions, numParameters);
+    if (!numLocals) {
+      return false;
+    }
+
+    auto targets = FindJumpTargets(instructions);
+
+    std::vector<SubscriptLoop> loops;
+    for (std::size_t i = 0; i + 2 < instructions.size(); i++) {
+      if (auto loop = FindSubscriptLoop(instructions, targets, *numLocals, i)) {
+        i = loop->end - 1;
+        loops.push_back(std::move(*loop));
+      }
+    }
+
+    if (loops.empty()) {
+      return false;
+    }
+
+    InstructionList result;
+    result.reserve(instructions.size() * 2);
+
+    // where each of the original instructions ends up, and the jumps that need to be pointed at them
+    std::vector<std::size_t> newIndices(instructions.size());
+    std::vector<std::pair<std::size_t, std::size_t>> pendingTargets;
+
+    auto nextLoop = loops.begin();
+    for (std::size_t i = 0; i < instructions.size(); i++) {
+      if (nextLoop != loops.end() && nextLoop->begin == i) {
+        const auto& loop = *nextLoop++;
+        auto line = instructions[i].line;
+
+        // LoadLocal list, CheckListRange, JumpIfFalse to the original loop, for each list
+        for (auto list : loop.lists) {
+          result.push_back(Instruction{ Ops::LoadLocal, line, { Value(static_cast<std::int64_t>(list)) } });
+          result.push_back(Instruction{ Ops::CheckListRange, line, {} });
+          result.push_back(Instruction{ Ops::JumpIfFalse, line, { Value(std::int64_t{}), Value(std::int64_t{}) } });
+          pendingTargets.emplace_back(result.size() - 1, loop.begin);
+        }
+
+        auto copyStart = result.size();
+        for (auto j = loop.begin; j < loop.end; j++) {
+          auto& instruction = result.emplace_back(instructions[j]);
+          if (IsJump(instruction.op)) {
+            if (instruction.target == loop.end) {
+              pendingTargets.emplace_back(result.size() - 1, loop.end);
+            } else {
+              instruction.target = copyStart + instruction.target - loop.begin;
+            }
+          }
+        }
+
+        for (auto index : loop.subscripts) {
+          auto& instruction = result[copyStart + index - loop.begin];
+          instruction.op = instruction.op == Ops::AssignSubscript ? Ops::AssignSubscriptUnchecked : Ops::GetSubscriptUnchecked;
+        }
+
+        // the copy can fall off the end of the loop on a `break`, so skip over the original
+        result.push_back(Instruction{ Ops::Jump, line, { Value(std::int64_t{}), Value(std::int64_t{}) } });
+        pendingTargets.emplace_back(result.size() - 1, loop.end);
+      }
+
+      newIndices[i] = result.size();
+      auto& instruction = result.emplace_back(std::move(instructions[i]));
+      if (IsJump(instruction.op)) {
+        pendingTargets.emplace_back(result.size() - 1, instruction.target);
+      }
+    }
+
+    for (auto [index, target] : pendingTargets) {
+      result[index].target = newIndices[target];
+    }
+
+    instructions = std::move(result);
+    return true;
+  }
+
+  void VM::Optimise(OptimisationLevel level, bool verbose)
+  {
+    using namespace std::chrono;
+
+    if (level == OptimisationLevel::O0) {
+      return;
+    }
+
+    auto start = steady_clock::now();
+
+    std::size_t numOpsBefore = 0, numOpsAfter = 0;
+    for (auto& [fileName, funcList] : m_FunctionLookup) {
+      for (auto& [name, func] : funcList) {
+        numOpsBefore += func->opList.size();
+        OptimiseFunction(*func, level);
+        numOpsAfter += func->opList.size();
+      }
+    }
+
+    if (verbose) {
+      auto seconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+      fmt::print("Optimisation at -O{} took {} ops to {} in {:.3f} ms.\n", static_cast<int>(level), numOpsBefore, numOpsAfter, seconds * 1000.0);
+    }
+  }
+
+  void VM::OptimiseFunction(Function& function, OptimisationLevel level)
+  {
+    auto instructions = Decode(function.opList, function.constantList);
+    if (!instructions) {
+      // leave anything we don't understand as it is
+      return;
+    }
+
+    // ExitTry resizes the locals without the frame's offset, so outside of main the slot numbers can't be trusted after one
+    auto hasExitTry = std::any_of(instructions->begin(), instructions->end(), [](const Instruction& instruction) {
+      return instruction.op == Ops::ExitTry;
+    });
+    auto slotsCanMove = !hasExitTry || function.name == "main";
+
+    // main always has the command line args in slot 0, even if it doesn't take them
+    auto numParameters = function.name == "main" && function.arity == 0 ? 1 : function.arity;
+    RunPasses(*instructions, level, numParameters, slotsCanMove);
+
+    // the Function each inlined instruction came from, and the line it was called on
+    std::vector<std::pair<const Function*, std::size_t>> inlineSites;
+
+    auto resolve = [&](const std::string& path, std::int64_t nameHash, std::size_t numArgs, std::size_t line) -> std::optional<InlineCandidate> {
+      auto funcListIt = m_FunctionLookup.find(path.empty() ? function.fileNameHash : static_cast<std::int64_t>(m_Hasher(path)));
+      if (funcListIt == m_FunctionLookup.end()) {
+        return {};
+      }
+
+      auto funcIt = funcListIt->second.find(nameHash);
+      if (funcIt == funcListIt->second.end() || (!path.empty() && !funcIt->second->exported)) {
+        return {};
+      }
+
+      // a callee that already has inlined code would need nested frames for errors, and calling a generator doesn't run its body
+      const auto& callee = *funcIt->second;
+      if (&callee == &function || callee.arity != numArgs || !callee.inlinedRanges.empty() || callee.generator) {
+        return {};
+      }
+
+      auto body = Decode(callee.opList, callee.constantList);
+      if (!body || !CanInline(*body, callee.arity)) {
+        return {};
+      }
+
+      inlineSites.emplace_back(&callee, line);
+      return InlineCandidate{ std::move(*body), callee.arity, inlineSites.size() - 1 };
+    };
+
+    if (level >= OptimisationLevel::O2 && slotsCanMove && InlineCalls(*instructions, numParameters, resolve)) {
+      RunPasses(*instructions, level, numParameters, slotsCanMove);
+    }
+
+    if (level >= OptimisationLevel::O2) {
+      VersionSubscriptLoops(*instructions, numParameters);
+    }
+
+    if (FuseIntCompareBranches(*instructions)) {
+      Compact(*instructions);
+    }
+
+    function.nativeForward.reset();
+    if (level >= OptimisationLevel::O1 && function.name != "main" && !function.generator) {
+      if (auto forward = FindNativeForward(*instructions, function.arity)) {
+        auto [index, returnsResult] = *forward;
+        const auto& nativeCall = (*instructions)[index];
+        auto nativeIndex = static_cast<std::size_t>(nativeCall.constants[0].Get<std::int64_t>());
+        if (nativeIndex < m_NativeFunctions.size() && m_NativeFunctions[nativeIndex].GetArity() == function.arity) {
+          function.nativeForward = NativeForward{ nativeIndex, nativeCall.line, returnsResult };
+        }
+      }
+    }
+
+    if (level >= OptimisationLevel::O1) {
+      FindNonEscapingObjects(*instructions, numParameters);
+    }
+
+    MoveLastUses(*instructions);
+
+    Encode(*instructions, function.opList, function.constantList);
+
+    function.inlinedRanges.clear();
+    for (std::size_t i = 0; i < instructions->size(); i++) {
+      auto site = (*instructions)[i].inlineSite;
+      if (site == s_NoTarget) {
+        continue;
+      }
+
+      auto [callee, line] = inlineSites[site];
+      auto& ranges = function.inlinedRanges;
+      if (!ranges.empty() && ranges.back().opEnd == i && ranges.back().callee == callee && ranges.back().line == line) {
+        ranges.back().opEnd = i + 1;
+      } else {
+        ranges.push_back({ i, i + 1, callee, line });
+      }
+    }
+  }
+} // namespace Grace::VM
@@ -9,23 +9,42 @@
  *  For licensing information, see grace.hpp
  */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <thread>
 
 #include <dyncall.h>
 #include <dynload.h>
 
 #include "grace.hpp"
+#include "csv_reader.hpp"
+#include "event_loop.hpp"
+#include "input_buffer.hpp"
+#include "json.hpp"
+#include "output_buffer.hpp"
+#include "serialize.hpp"
+#include "source_file.hpp"
+#include "string_algorithms.hpp"
+#include "thread_pool.hpp"
 #include "vm.hpp"
+#include "objects/grace_bytes.hpp"
+#include "objects/grace_csv.hpp"
 #include "objects/grace_dictionary.hpp"
+#include "objects/grace_fiber.hpp"
 #include "objects/grace_set.hpp"
 #include "objects/grace_exception.hpp"
+#include "objects/grace_file.hpp"
 #include "objects/grace_instance.hpp"
+#include "objects/grace_keyvaluepair.hpp"
 #include "objects/grace_list.hpp"
+#include "objects/grace_string_builder.hpp"
+#include "objects/grace_thread.hpp"
 #include "objects/object_tracker.hpp"
 
 using namespace Grace::VM;
@@ -34,6 +53,8 @@ using Args = std::vector<Value>&;
 
 static Value SqrtFloat(Args args);
 static Value SqrtInt(Args args);
+static Value MathMin(Args args);
+static Value MathMax(Args args);
 
 static Value TimeHours(GRACE_MAYBE_UNUSED Args args);
 static Value TimeMinutes(GRACE_MAYBE_UNUSED Args args);
@@ -56,11 +77,31 @@ static Value ListSorted(Args args);
 static Value ListSortedDescending(Args args);
 static Value ListFirst(Args args);
 static Value ListLast(Args args);
+static Value ListContains(Args args);
+static Value ListIndexOf(Args args);
+static Value ListSum(Args args);
+static Value ListMin(Args args);
+static Value ListMax(Args args);
+static Value ListReverse(Args args);
+static Value ListExtend(Args args);
+static Value ListFill(Args args);
+static Value ListSlice(Args args);
+static Value ListZip(Args args);
+static Value ListParSort(Args args);
+static Value ListParSum(Args args);
+static Value ListParMin(Args args);
+static Value ListParMax(Args args);
+static Value ListParCount(Args args);
+static Value ListParAdd(Args args);
+static Value ListParSubtract(Args args);
+static Value ListParMultiply(Args args);
+static Value ListParDivide(Args args);
 
 static Value DictionaryInsert(Args args);
 static Value DictionaryGet(Args args);
 static Value DictionaryContainsKey(Args args);
 static Value DictionaryRemove(Args args);
+static Value DictionaryToList(Args args);
 
 static Value KeyValuePairKey(Args args);
 static Value KeyValuePairValue(Args args);
@@ -72,9 +113,41 @@ static Value SetSize(Args args);
 static Value FileWrite(Args args);
 static Value FileReadAllText(Args args);
 static Value FileReadAllLines(Args args);
+static Value FileOpen(Args args);
+static Value FileReadLine(Args args);
+static Value FileReadChunk(Args args);
+static Value FileWriteHandle(Args args);
+static Value FileAppendHandle(Args args);
+static Value FileClose(Args args);
+static Value FileLines(Args args);
+static Value FileMap(Args args);
+
+static Value BytesFromString(Args args);
+static Value BytesToString(Args args);
+static Value BytesLength(Args args);
+static Value BytesAt(Args args);
+static Value BytesSlice(Args args);
+static Value BytesFind(Args args);
+
+static Value JsonParse(Args args);
+static Value JsonStringify(Args args);
+
+static Value CsvRows(Args args);
+static Value CsvColumns(Args args);
+
+static Value SerializeDump(Args args);
+static Value SerializeLoad(Args args);
+static Value SerializeToBytes(Args args);
+static Value SerializeFromBytes(Args args);
 
 static Value FlushStdout(GRACE_MAYBE_UNUSED Args args);
 static Value FlushStderr(GRACE_MAYBE_UNUSED Args args);
+static Value SetStdoutBuffering(Args args);
+static Value SetStderrBuffering(Args args);
+static Value ReadLineStdin(GRACE_MAYBE_UNUSED Args args);
+static Value ReadAllStdin(GRACE_MAYBE_UNUSED Args args);
+static Value ReadIntsStdin(GRACE_MAYBE_UNUSED Args args);
+static Value LinesStdin(GRACE_MAYBE_UNUSED Args args);
 
 static Value SystemExit(Args args);
 static Value SystemRun(Args args);
@@ -89,6 +162,52 @@ static Value InteropDoCall(Args args);
 static Value StringLength(Args args);
 static Value StringSplit(Args args);
 static Value StringSubstring(Args args);
+static Value StringFind(Args args);
+static Value StringRFind(Args args);
+static Value StringContains(Args args);
+static Value StringStartsWith(Args args);
+static Value StringEndsWith(Args args);
+static Value StringCount(Args args);
+static Value StringReplaceAll(Args args);
+static Value StringTrim(Args args);
+static Value StringToUpper(Args args);
+static Value StringToLower(Args args);
+static Value StringJoin(Args args);
+static Value StringRepeat(Args args);
+
+static Value StringBuilderCreate(GRACE_MAYBE_UNUSED Args args);
+static Value StringBuilderAppend(Args args);
+static Value StringBuilderAppendLine(Args args);
+static Value StringBuilderBuild(Args args);
+static Value StringBuilderLength(Args args);
+static Value StringBuilderClear(Args args);
+
+static Value ThreadSpawn(Args args);
+static Value ThreadJoin(Args args);
+static Value ThreadCores(GRACE_MAYBE_UNUSED Args args);
+static Value ChannelCreate(GRACE_MAYBE_UNUSED Args args);
+static Value ChannelSend(Args args);
+static Value ChannelReceive(Args args);
+static Value ChannelTryReceive(Args args);
+static Value ChannelClose(Args args);
+static Value ThreadSetPoolSize(Args args);
+static Value ThreadGetPoolSize(GRACE_MAYBE_UNUSED Args args);
+
+static Value FiberSpawn(Args args);
+static Value FiberJoin(Args args);
+static Value FiberSleep(Args args);
+static Value FiberOpen(Args args);
+static Value FiberPipe(GRACE_MAYBE_UNUSED Args args);
+static Value FiberRun(Args args);
+static Value FiberStart(Args args);
+static Value ProcessInput(Args args);
+static Value ProcessOutput(Args args);
+static Value ProcessWait(Args args);
+static Value StreamReadLine(Args args);
+static Value StreamReadChunk(Args args);
+static Value StreamReadAll(Args args);
+static Value StreamWrite(Args args);
+static Value StreamClose(Args args);
 
 static Value CharIsLower(Args args);
 static Value CharIsUpper(Args args);
@@ -111,11 +230,14 @@ static Value PathGetDirectory(Args args);
 static Value PathCombine(Args args);
 static Value PathExists(Args args);
 
+// natives registered as pure have no side effects outside of their arguments, so can be called while evaluating a `const`
 void VM::RegisterNatives()
 {
   // Math functions
-  m_NativeFunctions.emplace_back("__NATIVE_SQRT_FLOAT", 1, &SqrtFloat);
-  m_NativeFunctions.emplace_back("__NATIVE_SQRT_INT", 1, &SqrtInt);
+  m_NativeFunctions.emplace_back("__NATIVE_SQRT_FLOAT", 1, &SqrtFloat, true);
+  m_NativeFunctions.emplace_back("__NATIVE_SQRT_INT", 1, &SqrtInt, true);
+  m_NativeFunctions.emplace_back("__NATIVE_MATH_MIN", 2, &MathMin, true);
+  m_NativeFunctions.emplace_back("__NATIVE_MATH_MAX", 2, &MathMax, true);
 
   // Time functions
   m_NativeFunctions.emplace_back("__NATIVE_TIME_H", 0, &TimeHours);
@@ -127,40 +249,96 @@ void VM::RegisterNatives()
   m_NativeFunctions.emplace_back("__NATIVE_TIME_SLEEP", 1, &Sleep);
 
   // List functions
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_APPEND", 2, &ListAppend);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_INSERT", 3, &ListInsert);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_REMOVE", 2, &ListRemove);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_POP", 1, &ListPop);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_SET_AT_INDEX", 3, &ListSetAtIndex);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_GET_AT_INDEX", 2, &ListGetAtIndex);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_LENGTH", 1, &ListLength);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_SORT", 1, &ListSort);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_SORT_DESCENDING", 1, &ListSortDescending);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_SORTED", 1, &ListSorted);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_SORTED_DESCENDING", 1, &ListSortedDescending);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_FIRST", 1, &ListFirst);
-  m_NativeFunctions.emplace_back("__NATIVE_LIST_LAST", 1, &ListLast);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_APPEND", 2, &ListAppend, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_INSERT", 3, &ListInsert, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_REMOVE", 2, &ListRemove, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_POP", 1, &ListPop, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_SET_AT_INDEX", 3, &ListSetAtIndex, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_GET_AT_INDEX", 2, &ListGetAtIndex, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_LENGTH", 1, &ListLength, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_SORT", 1, &ListSort, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_SORT_DESCENDING", 1, &ListSortDescending, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_SORTED", 1, &ListSorted, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_SORTED_DESCENDING", 1, &ListSortedDescending, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_FIRST", 1, &ListFirst, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_LAST", 1, &ListLast, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_CONTAINS", 2, &ListContains, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_INDEX_OF", 2, &ListIndexOf, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_SUM", 1, &ListSum, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_MIN", 1, &ListMin, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_MAX", 1, &ListMax, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_REVERSE", 1, &ListReverse, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_EXTEND", 2, &ListExtend, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_FILL", 2, &ListFill, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_SLICE", 3, &ListSlice, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_ZIP", 2, &ListZip, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_PAR_SORT", 1, &ListParSort, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_PAR_SUM", 1, &ListParSum, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_PAR_MIN", 1, &ListParMin, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_PAR_MAX", 1, &ListParMax, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_PAR_COUNT", 2, &ListParCount, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_PAR_ADD", 2, &ListParAdd, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_PAR_SUBTRACT", 2, &ListParSubtract, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_PAR_MULTIPLY", 2, &ListParMultiply, true);
+  m_NativeFunctions.emplace_back("__NATIVE_LIST_PAR_DIVIDE", 2, &ListParDivide, true);
 
   // Dictionary functions
-  m_NativeFunctions.emplace_back("__NATIVE_DICTIONARY_INSERT", 3, &DictionaryInsert);
-  m_NativeFunctions.emplace_back("__NATIVE_DICTIONARY_GET", 2, &DictionaryGet);
-  m_NativeFunctions.emplace_back("__NATIVE_DICTIONARY_CONTAINS_KEY", 2, &DictionaryContainsKey);
-  m_NativeFunctions.emplace_back("__NATIVE_DICTIONARY_REMOVE", 2, &DictionaryRemove);
-
-  m_NativeFunctions.emplace_back("__NATIVE_KEYVALUEPAIR_KEY", 1, &KeyValuePairKey);
-  m_NativeFunctions.emplace_back("__NATIVE_KEYVALUEPAIR_VALUE", 1, &KeyValuePairValue);
-
-  m_NativeFunctions.emplace_back("__NATIVE_SET_ADD", 2, &SetAdd);
-  m_NativeFunctions.emplace_back("__NATIVE_SET_CONTAINS", 2, &SetContains);
-  m_NativeFunctions.emplace_back("__NATIVE_SET_SIZE", 1, &SetSize);
+  m_NativeFunctions.emplace_back("__NATIVE_DICTIONARY_INSERT", 3, &DictionaryInsert, true);
+  m_NativeFunctions.emplace_back("__NATIVE_DICTIONARY_GET", 2, &DictionaryGet, true);
+  m_NativeFunctions.emplace_back("__NATIVE_DICTIONARY_CONTAINS_KEY", 2, &DictionaryContainsKey, true);
+  m_NativeFunctions.emplace_back("__NATIVE_DICTIONARY_REMOVE", 2, &DictionaryRemove, true);
+  m_NativeFunctions.emplace_back("__NATIVE_DICTIONARY_TO_LIST", 1, &DictionaryToList, true);
+
+  m_NativeFunctions.emplace_back("__NATIVE_KEYVALUEPAIR_KEY", 1, &KeyValuePairKey, true);
+  m_NativeFunctions.emplace_back("__NATIVE_KEYVALUEPAIR_VALUE", 1, &KeyValuePairValue, true);
+
+  m_NativeFunctions.emplace_back("__NATIVE_SET_ADD", 2, &SetAdd, true);
+  m_NativeFunctions.emplace_back("__NATIVE_SET_CONTAINS", 2, &SetContains, true);
+  m_NativeFunctions.emplace_back("__NATIVE_SET_SIZE", 1, &SetSize, true);
   // File functions
   m_NativeFunctions.emplace_back("__NATIVE_FILE_WRITE", 2, &FileWrite);
   m_NativeFunctions.emplace_back("__NATIVE_FILE_READ_ALL_TEXT", 1, &FileReadAllText);
   m_NativeFunctions.emplace_back("__NATIVE_FILE_READ_ALL_LINES", 1, &FileReadAllLines);
+  m_NativeFunctions.emplace_back("__NATIVE_FILE_OPEN", 2, &FileOpen);
+  m_NativeFunctions.emplace_back("__NATIVE_FILE_READ_LINE", 1, &FileReadLine);
+  m_NativeFunctions.emplace_back("__NATIVE_FILE_READ_CHUNK", 2, &FileReadChunk);
+  m_NativeFunctions.emplace_back("__NATIVE_FILE_WRITE_HANDLE", 2, &FileWriteHandle);
+  m_NativeFunctions.emplace_back("__NATIVE_FILE_APPEND_HANDLE", 2, &FileAppendHandle);
+  m_NativeFunctions.emplace_back("__NATIVE_FILE_CLOSE", 1, &FileClose);
+  m_NativeFunctions.emplace_back("__NATIVE_FILE_LINES", 1, &FileLines);
+  m_NativeFunctions.emplace_back("__NATIVE_FILE_MAP", 1, &FileMap);
+
+  // Bytes functions
+  m_NativeFunctions.emplace_back("__NATIVE_BYTES_FROM_STRING", 1, &BytesFromString, true);
+  m_NativeFunctions.emplace_back("__NATIVE_BYTES_TO_STRING", 1, &BytesToString, true);
+  m_NativeFunctions.emplace_back("__NATIVE_BYTES_LENGTH", 1, &BytesLength, true);
+  m_NativeFunctions.emplace_back("__NATIVE_BYTES_AT", 2, &BytesAt, true);
+  m_NativeFunctions.emplace_back("__NATIVE_BYTES_SLICE", 3, &BytesSlice, true);
+  m_NativeFunctions.emplace_back("__NATIVE_BYTES_FIND", 3, &BytesFind, true);
+
+  // JSON functions
+  m_NativeFunctions.emplace_back("__NATIVE_JSON_PARSE", 1, &JsonParse, true);
+  m_NativeFunctions.emplace_back("__NATIVE_JSON_STRINGIFY", 2, &JsonStringify, true);
+
+  // CSV functions
+  m_NativeFunctions.emplace_back("__NATIVE_CSV_ROWS", 3, &CsvRows);
+  m_NativeFunctions.emplace_back("__NATIVE_CSV_COLUMNS", 3, &CsvColumns);
+
+  // Serialize functions
+  m_NativeFunctions.emplace_back("__NATIVE_SERIALIZE_DUMP", 2, &SerializeDump);
+  m_NativeFunctions.emplace_back("__NATIVE_SERIALIZE_LOAD", 1, &SerializeLoad);
+  m_NativeFunctions.emplace_back("__NATIVE_SERIALIZE_TO_BYTES", 1, &SerializeToBytes, true);
+  m_NativeFunctions.emplace_back("__NATIVE_SERIALIZE_FROM_BYTES", 1, &SerializeFromBytes, true);
 
   // Console IO functions
   m_NativeFunctions.emplace_back("__NATIVE_FLUSH_STDOUT", 0, &FlushStdout);
   m_NativeFunctions.emplace_back("__NATIVE_FLUSH_STDERR", 0, &FlushStderr);
+  m_NativeFunctions.emplace_back("__NATIVE_SET_STDOUT_BUFFERING", 2, &SetStdoutBuffering);
+  m_NativeFunctions.emplace_back("__NATIVE_SET_STDERR_BUFFERING", 2, &SetStderrBuffering);
+  m_NativeFunctions.emplace_back("__NATIVE_READ_LINE_STDIN", 0, &ReadLineStdin);
+  m_NativeFunctions.emplace_back("__NATIVE_READ_ALL_STDIN", 0, &ReadAllStdin);
+  m_NativeFunctions.emplace_back("__NATIVE_READ_INTS_STDIN", 0, &ReadIntsStdin);
+  m_NativeFunctions.emplace_back("__NATIVE_LINES_STDIN", 0, &LinesStdin);
 
   // System functions
   m_NativeFunctions.emplace_back("__NATIVE_SYSTEM_EXIT", 1, &SystemExit);
@@ -176,15 +354,63 @@ void VM::RegisterNatives()
   m_NativeFunctions.emplace_back("__NATIVE_INTEROP_DO_CALL", 4, &InteropDoCall);
 
   // String functions
-  m_NativeFunctions.emplace_back("__NATIVE_STRING_LENGTH", 1, &StringLength);
-  m_NativeFunctions.emplace_back("__NATIVE_STRING_SPLIT", 2, &StringSplit);
-  m_NativeFunctions.emplace_back("__NATIVE_STRING_SUBSTRING", 3, &StringSubstring);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_LENGTH", 1, &StringLength, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_SPLIT", 2, &StringSplit, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_SUBSTRING", 3, &StringSubstring, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_FIND", 2, &StringFind, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_RFIND", 2, &StringRFind, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_CONTAINS", 2, &StringContains, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_STARTS_WITH", 2, &StringStartsWith, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_ENDS_WITH", 2, &StringEndsWith, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_COUNT", 2, &StringCount, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_REPLACE_ALL", 3, &StringReplaceAll, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_TRIM", 1, &StringTrim, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_TO_UPPER", 1, &StringToUpper, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_TO_LOWER", 1, &StringToLower, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_JOIN", 2, &StringJoin, true);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_REPEAT", 2, &StringRepeat, true);
+
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_BUILDER_CREATE", 0, &StringBuilderCreate);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_BUILDER_APPEND", 2, &StringBuilderAppend);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_BUILDER_APPEND_LINE", 2, &StringBuilderAppendLine);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_BUILDER_BUILD", 1, &StringBuilderBuild);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_BUILDER_LENGTH", 1, &StringBuilderLength);
+  m_NativeFunctions.emplace_back("__NATIVE_STRING_BUILDER_CLEAR", 1, &StringBuilderClear);
+
+  // Thread functions
+  m_NativeFunctions.emplace_back("__NATIVE_THREAD_SPAWN", 2, &ThreadSpawn);
+  m_NativeFunctions.emplace_back("__NATIVE_THREAD_JOIN", 1, &ThreadJoin);
+  m_NativeFunctions.emplace_back("__NATIVE_THREAD_CORES", 0, &ThreadCores);
+  m_NativeFunctions.emplace_back("__NATIVE_CHANNEL_CREATE", 0, &ChannelCreate);
+  m_NativeFunctions.emplace_back("__NATIVE_CHANNEL_SEND", 2, &ChannelSend);
+  m_NativeFunctions.emplace_back("__NATIVE_CHANNEL_RECEIVE", 1, &ChannelReceive);
+  m_NativeFunctions.emplace_back("__NATIVE_CHANNEL_TRY_RECEIVE", 1, &ChannelTryReceive);
+  m_NativeFunctions.emplace_back("__NATIVE_CHANNEL_CLOSE", 1, &ChannelClose);
+  m_NativeFunctions.emplace_back("__NATIVE_THREAD_SET_POOL_SIZE", 1, &ThreadSetPoolSize);
+  m_NativeFunctions.emplace_back("__NATIVE_THREAD_GET_POOL_SIZE", 0, &ThreadGetPoolSize);
+
+  // Fiber functions
+  m_NativeFunctions.emplace_back("__NATIVE_FIBER_SPAWN", 2, &FiberSpawn);
+  m_NativeFunctions.emplace_back("__NATIVE_FIBER_JOIN", 1, &FiberJoin);
+  m_NativeFunctions.emplace_back("__NATIVE_FIBER_SLEEP", 1, &FiberSleep);
+  m_NativeFunctions.emplace_back("__NATIVE_FIBER_OPEN", 2, &FiberOpen);
+  m_NativeFunctions.emplace_back("__NATIVE_FIBER_PIPE", 0, &FiberPipe);
+  m_NativeFunctions.emplace_back("__NATIVE_FIBER_RUN", 1, &FiberRun);
+  m_NativeFunctions.emplace_back("__NATIVE_FIBER_START", 1, &FiberStart);
+  m_NativeFunctions.emplace_back("__NATIVE_PROCESS_INPUT", 1, &ProcessInput);
+  m_NativeFunctions.emplace_back("__NATIVE_PROCESS_OUTPUT", 1, &ProcessOutput);
+  m_NativeFunctions.emplace_back("__NATIVE_PROCESS_WAIT", 1, &ProcessWait);
+  m_NativeFunctions.emplace_back("__NATIVE_STREAM_READ_LINE", 1, &StreamReadLine);
+  m_NativeFunctions.emplace_back("__NATIVE_STREAM_READ_CHUNK", 2, &StreamReadChunk);
+  m_NativeFunctions.emplace_back("__NATIVE_STREAM_READ_ALL", 1, &StreamReadAll);
+  m_NativeFunctions.emplace_back("__NATIVE_STREAM_WRITE", 2, &StreamWrite);
+  m_NativeFunctions.emplace_back("__NATIVE_STREAM_CLOSE", 1, &StreamClose);
 
   // Char functions
-  m_NativeFunctions.emplace_back("__NATIVE_CHAR_IS_LOWER", 1, &CharIsLower);
-  m_NativeFunctions.emplace_back("__NATIVE_CHAR_IS_UPPER", 1, &CharIsUpper);
-  m_NativeFunctions.emplace_back("__NATIVE_CHAR_TO_LOWER", 1, &CharToLower);
-  m_NativeFunctions.emplace_back("__NATIVE_CHAR_TO_UPPER", 1, &CharToUpper);
+  m_NativeFunctions.emplace_back("__NATIVE_CHAR_IS_LOWER", 1, &CharIsLower, true);
+  m_NativeFunctions.emplace_back("__NATIVE_CHAR_IS_UPPER", 1, &CharIsUpper, true);
+  m_NativeFunctions.emplace_back("__NATIVE_CHAR_TO_LOWER", 1, &CharToLower, true);
+  m_NativeFunctions.emplace_back("__NATIVE_CHAR_TO_UPPER", 1, &CharToUpper, true);
 
   // GC functions
   m_NativeFunctions.emplace_back("__NATIVE_GC_SET_ENABLED", 1, &GcSetEnabled);
@@ -198,10 +424,10 @@ void VM::RegisterNatives()
   m_NativeFunctions.emplace_back("__NATIVE_GC_GET_GROW_FACTOR", 0, &GcGetGrowFactor);
 
   // Path functions
-  m_NativeFunctions.emplace_back("__NATIVE_PATH_GET_FILE_NAME", 1, &PathGetFileName);
-  m_NativeFunctions.emplace_back("__NATIVE_PATH_GET_FILE_NAME_WITHOUT_EXTENSION", 1, &PathGetFileNameWithoutExtension);
-  m_NativeFunctions.emplace_back("__NATIVE_PATH_GET_DIRECTORY", 1, &PathGetDirectory);
-  m_NativeFunctions.emplace_back("__NATIVE_PATH_COMBINE", 2, &PathCombine);
+  m_NativeFunctions.emplace_back("__NATIVE_PATH_GET_FILE_NAME", 1, &PathGetFileName, true);
+  m_NativeFunctions.emplace_back("__NATIVE_PATH_GET_FILE_NAME_WITHOUT_EXTENSION", 1, &PathGetFileNameWithoutExtension, true);
+  m_NativeFunctions.emplace_back("__NATIVE_PATH_GET_DIRECTORY", 1, &PathGetDirectory, true);
+  m_NativeFunctions.emplace_back("__NATIVE_PATH_COMBINE", 2, &PathCombine, true);
   m_NativeFunctions.emplace_back("__NATIVE_PATH_EXISTS", 1, &PathExists);
 }
 
@@ -229,6 +455,40 @@ static Value SqrtInt(Args args)
   return Value(std::sqrt(args[0].Get<std::int64_t>()));
 }
 
+static void CheckNumberOrThrow(const Value& value, std::string_view argName, std::string_view funcSignature)
+{
+  if (value.GetType() != Value::Type::Int && value.GetType() != Value::Type::Double) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected number for `{}` in `std::math::{}` but got `{}`", argName, funcSignature, value.GetTypeName())
+    );
+  }
+}
+
+static Value MathMin(Args args)
+{
+  CheckNumberOrThrow(args[0], "first", "min(first, second)");
+  CheckNumberOrThrow(args[1], "second", "min(first, second)");
+
+  if (args[0].GetType() == Value::Type::Int && args[1].GetType() == Value::Type::Int) {
+    return Value(std::min(args[0].Get<std::int64_t>(), args[1].Get<std::int64_t>()));
+  }
+
+  return args[0] <= args[1] ? args[0] : args[1];
+}
+
+static Value MathMax(Args args)
+{
+  CheckNumberOrThrow(args[0], "first", "max(first, second)");
+  CheckNumberOrThrow(args[1], "second", "max(first, second)");
+
+  if (args[0].GetType() == Value::Type::Int && args[1].GetType() == Value::Type::Int) {
+    return Value(std::max(args[0].Get<std::int64_t>(), args[1].Get<std::int64_t>()));
+  }
+
+  return args[0] >= args[1] ? args[0] : args[1];
+}
+
 static Value TimeHours(GRACE_MAYBE_UNUSED Args args)
 {
   return Value(static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::hours>(std::chrono::steady_clock::now().time_since_epoch()).count()));
@@ -346,6 +606,7 @@ static Value ListSetAtIndex(Args args)
       );
     }
 
+    list->ThrowIfFrozen();
     (*list)[args[1].Get<std::int64_t>()] = std::move(args[2]);
     return {};
   }
@@ -465,6 +726,360 @@ static Value ListLast(Args args)
   );
 }
 
+static Grace::GraceList* GetListOrThrow(Value& value, std::string_view funcSignature)
+{
+  auto object = value.GetObject();
+  if (object != nullptr) {
+    if (auto list = object->GetAsList()) {
+      return list;
+    }
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `List` for `std::list::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
+}
+
+static std::size_t GetListIndexOrThrow(const Value& value, std::string_view argName, std::string_view funcSignature)
+{
+  if (value.GetType() != Value::Type::Int) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `Int` for `{}` in `std::list::{}` but got `{}`", argName, funcSignature, value.GetTypeName())
+    );
+  }
+
+  if (value.Get<std::int64_t>() < 0) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::IndexOutOfRange,
+      fmt::format("`{}` cannot be negative in `std::list::{}`, got {}", argName, funcSignature, value.Get<std::int64_t>())
+    );
+  }
+
+  return static_cast<std::size_t>(value.Get<std::int64_t>());
+}
+
+static Value ListContains(Args args)
+{
+  return Value(GetListOrThrow(args[0], "contains(list, value)")->IndexOf(args[1]) != -1);
+}
+
+static Value ListIndexOf(Args args)
+{
+  return Value(GetListOrThrow(args[0], "index_of(list, value)")->IndexOf(args[1]));
+}
+
+// Ints are added up directly rather than through Value::operator+, and the sum only becomes a Float once a Float turns up
+static Value ListSum(Args args)
+{
+  auto list = GetListOrThrow(args[0], "sum(list)");
+
+  std::int64_t intSum = 0;
+  double floatSum = 0.0;
+  auto isFloat = false;
+  for (std::size_t i = 0; i < list->Length(); i++) {
+    const auto& value = list->GetUnchecked(i);
+    switch (value.GetType()) {
+      case Value::Type::Int:
+        if (isFloat) {
+          floatSum += static_cast<double>(value.Get<std::int64_t>());
+        } else {
+          // wraps around on overflow like Int addition does
+          intSum = static_cast<std::int64_t>(static_cast<std::uint64_t>(intSum) + static_cast<std::uint64_t>(value.Get<std::int64_t>()));
+        }
+        break;
+      case Value::Type::Double:
+        if (!isFloat) {
+          isFloat = true;
+          floatSum = static_cast<double>(intSum);
+        }
+        floatSum += value.Get<double>();
+        break;
+      default:
+        throw Grace::GraceException(
+          Grace::GraceException::Type::InvalidType,
+          fmt::format("Expected a List of numbers for `std::list::sum(list)` but found `{}`", value.GetTypeName())
+        );
+    }
+  }
+
+  return isFloat ? Value(floatSum) : Value(intSum);
+}
+
+static bool IsBetter(const Value& value, const Value& best, bool findMax)
+{
+  if (value.GetType() == Value::Type::Int && best.GetType() == Value::Type::Int) {
+    auto lhs = value.Get<std::int64_t>(), rhs = best.Get<std::int64_t>();
+    return findMax ? lhs > rhs : lhs < rhs;
+  }
+  return findMax ? value > best : value < best;
+}
+
+static Value ListMinMax(Grace::GraceList* list, bool findMax)
+{
+  // throws if the List is empty
+  const auto* best = &list->First();
+  for (std::size_t i = 1; i < list->Length(); i++) {
+    const auto& value = list->GetUnchecked(i);
+    if (IsBetter(value, *best, findMax)) {
+      best = &value;
+    }
+  }
+
+  return *best;
+}
+
+static Value ListMin(Args args)
+{
+  return ListMinMax(GetListOrThrow(args[0], "min(list)"), false);
+}
+
+static Value ListMax(Args args)
+{
+  return ListMinMax(GetListOrThrow(args[0], "max(list)"), true);
+}
+
+static Value ListReverse(Args args)
+{
+  GetListOrThrow(args[0], "reverse(list)")->Reverse();
+  return {};
+}
+
+static Value ListExtend(Args args)
+{
+  auto list = GetListOrThrow(args[0], "extend(list, other)");
+  list->Extend(*GetListOrThrow(args[1], "extend(list, other)"));
+  return {};
+}
+
+static Value ListFill(Args args)
+{
+  GetListOrThrow(args[0], "fill(list, value)")->Fill(args[1]);
+  return {};
+}
+
+static Value ListSlice(Args args)
+{
+  auto list = GetListOrThrow(args[0], "slice(list, start, length)");
+  auto start = GetListIndexOrThrow(args[1], "start", "slice(list, start, length)");
+  auto length = GetListIndexOrThrow(args[2], "length", "slice(list, start, length)");
+  return Value::CreateObject<Grace::GraceList>(list->Slice(start, length));
+}
+
+static Value ListZip(Args args)
+{
+  auto list = GetListOrThrow(args[0], "zip(list, other)");
+  auto other = GetListOrThrow(args[1], "zip(list, other)");
+
+  auto length = std::min(list->Length(), other->Length());
+  std::vector<Value> pairs;
+  pairs.reserve(length);
+  for (std::size_t i = 0; i < length; i++) {
+    pairs.push_back(Value::CreateObject<Grace::GraceKeyValuePair>(Value(list->GetUnchecked(i)), Value(other->GetUnchecked(i))));
+  }
+
+  return Value::CreateObject<Grace::GraceList>(std::move(pairs));
+}
+
+// Lists no longer than this are done on the calling thread, the same as the serial versions
+// the work done on the ThreadPool only reads Values and writes numbers, it never creates or releases an object
+static constexpr std::size_t s_ParallelGrain = 16384;
+
+static Value ListParSort(Args args)
+{
+  GetListOrThrow(args[0], "par_sort(list)")->ParallelSort();
+  return {};
+}
+
+static Value ListParSum(Args args)
+{
+  auto list = GetListOrThrow(args[0], "par_sum(list)");
+
+  std::mutex mutex;
+  std::int64_t intSum = 0;
+  double floatSum = 0.0;
+  auto isFloat = false;
+  Grace::ThreadPool::ParallelFor(list->Length(), s_ParallelGrain, [&](std::size_t begin, std::size_t end) {
+    std::int64_t chunkIntSum = 0;
+    double chunkFloatSum = 0.0;
+    auto chunkIsFloat = false;
+    for (auto i = begin; i < end; i++) {
+      const auto& value = list->GetUnchecked(i);
+      switch (value.GetType()) {
+        case Value::Type::Int:
+          chunkIntSum = static_cast<std::int64_t>(static_cast<std::uint64_t>(chunkIntSum) + static_cast<std::uint64_t>(value.Get<std::int64_t>()));
+          break;
+        case Value::Type::Double:
+          chunkIsFloat = true;
+          chunkFloatSum += value.Get<double>();
+          break;
+        default:
+          throw Grace::GraceException(
+            Grace::GraceException::Type::InvalidType,
+            fmt::format("Expected a List of numbers for `std::list::par_sum(list)` but found `{}`", value.GetTypeName())
+          );
+      }
+    }
+
+    std::lock_guard lock(mutex);
+    intSum = static_cast<std::int64_t>(static_cast<std::uint64_t>(intSum) + static_cast<std::uint64_t>(chunkIntSum));
+    floatSum += chunkFloatSum;
+    isFloat = isFloat || chunkIsFloat;
+  });
+
+  // Ints and Floats are added up separately, so a Float result can differ from `sum` in the last few bits
+  return isFloat ? Value(static_cast<double>(intSum) + floatSum) : Value(intSum);
+}
+
+static Value ListParMinMax(Grace::GraceList* list, bool findMax)
+{
+  if (list->Length() <= s_ParallelGrain) {
+    return ListMinMax(list, findMax);
+  }
+
+  std::mutex mutex;
+  std::vector<std::pair<std::size_t, const Value*>> chunkBests;
+  Grace::ThreadPool::ParallelFor(list->Length(), s_ParallelGrain, [&](std::size_t begin, std::size_t end) {
+    const auto* best = &list->GetUnchecked(begin);
+    for (auto i = begin + 1; i < end; i++) {
+      const auto& value = list->GetUnchecked(i);
+      if (IsBetter(value, *best, findMax)) {
+        best = &value;
+      }
+    }
+
+    std::lock_guard lock(mutex);
+    chunkBests.emplace_back(begin, best);
+  });
+
+  // in List order, so ties go to the first one the same way they do in `min` and `max`
+  std::sort(chunkBests.begin(), chunkBests.end());
+  const auto* best = chunkBests.front().second;
+  for (const auto& [begin, chunkBest] : chunkBests) {
+    if (IsBetter(*chunkBest, *best, findMax)) {
+      best = chunkBest;
+    }
+  }
+
+  return *best;
+}
+
+static Value ListParMin(Args args)
+{
+  return ListParMinMax(GetListOrThrow(args[0], "par_min(list)"), false);
+}
+
+static Value ListParMax(Args args)
+{
+  return ListParMinMax(GetListOrThrow(args[0], "par_max(list)"), true);
+}
+
+static Value ListParCount(Args args)
+{
+  auto list = GetListOrThrow(args[0], "par_count(list, value)");
+  const auto& value = args[1];
+
+  std::atomic<std::size_t> count = 0;
+  Grace::ThreadPool::ParallelFor(list->Length(), s_ParallelGrain, [&](std::size_t begin, std::size_t end) {
+    std::size_t chunkCount = 0;
+    for (auto i = begin; i < end; i++) {
+      if (list->GetUnchecked(i) == value) {
+        chunkCount++;
+      }
+    }
+    count += chunkCount;
+  });
+
+  return Value(static_cast<std::int64_t>(count.load()));
+}
+
+// `other` is either a number used for every element, or a List of numbers the same length as `list`
+static Value ListParElementWise(Args args, char op, std::string_view funcSignature)
+{
+  auto list = GetListOrThrow(args[0], funcSignature);
+
+  auto isNumber = [](const Value& value) {
+    return value.GetType() == Value::Type::Int || value.GetType() == Value::Type::Double;
+  };
+
+  auto otherObject = args[1].GetObject();
+  auto otherList = otherObject == nullptr ? nullptr : otherObject->GetAsList();
+  if (otherList == nullptr && !isNumber(args[1])) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected a number or `List` for `other` in `std::list::{}` but got `{}`", funcSignature, args[1].GetTypeName())
+    );
+  }
+
+  if (otherList != nullptr && otherList->Length() != list->Length()) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("Cannot combine a List of length {} with a List of length {} in `std::list::{}`", list->Length(), otherList->Length(), funcSignature)
+    );
+  }
+
+  std::vector<Value> result(list->Length());
+  Grace::ThreadPool::ParallelFor(list->Length(), s_ParallelGrain, [&](std::size_t begin, std::size_t end) {
+    for (auto i = begin; i < end; i++) {
+      const auto& lhs = list->GetUnchecked(i);
+      const auto& rhs = otherList == nullptr ? args[1] : otherList->GetUnchecked(i);
+      if (!isNumber(lhs) || !isNumber(rhs)) {
+        throw Grace::GraceException(
+          Grace::GraceException::Type::InvalidType,
+          fmt::format("Expected a List of numbers for `std::list::{}` but found `{}`", funcSignature, (isNumber(lhs) ? rhs : lhs).GetTypeName())
+        );
+      }
+
+      switch (op) {
+        case '+':
+          result[i] = lhs + rhs;
+          break;
+        case '-':
+          result[i] = lhs - rhs;
+          break;
+        case '*':
+          result[i] = lhs * rhs;
+          break;
+        case '/':
+          if (lhs.GetType() == Value::Type::Int && rhs.GetType() == Value::Type::Int && rhs.Get<std::int64_t>() == 0) {
+            throw Grace::GraceException(
+              Grace::GraceException::Type::InvalidOperand,
+              fmt::format("Cannot divide an Int by 0 in `std::list::{}`", funcSignature)
+            );
+          }
+          result[i] = lhs / rhs;
+          break;
+        default:
+          GRACE_UNREACHABLE();
+          break;
+      }
+    }
+  });
+
+  return Value::CreateObject<Grace::GraceList>(std::move(result));
+}
+
+static Value ListParAdd(Args args)
+{
+  return ListParElementWise(args, '+', "par_add(list, other)");
+}
+
+static Value ListParSubtract(Args args)
+{
+  return ListParElementWise(args, '-', "par_subtract(list, other)");
+}
+
+static Value ListParMultiply(Args args)
+{
+  return ListParElementWise(args, '*', "par_multiply(list, other)");
+}
+
+static Value ListParDivide(Args args)
+{
+  return ListParElementWise(args, '/', "par_divide(list, other)");
+}
+
 static Value DictionaryInsert(Args args)
 {
   if (args[0].GetObject()->GetAsDictionary() == nullptr) {
@@ -518,6 +1133,18 @@ static Value DictionaryRemove(Args args)
   return Value(dict->Remove(args[1]));
 }
 
+static Value DictionaryToList(Args args)
+{
+  if (args[0].GetObject() == nullptr || args[0].GetObject()->GetAsDictionary() == nullptr) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `Dict` for `std::dict::to_list(dict)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  return Value::CreateObject<Grace::GraceList>(args[0].GetObject()->GetAsDictionary()->ToVector());
+}
+
 static Value KeyValuePairKey(Args args)
 {
   if (args[0].GetObject()->GetAsKeyValuePair() == nullptr) {
@@ -662,377 +1289,1421 @@ static Value FileReadAllLines(Args args)
   return res;
 }
 
-static Value FlushStdout(GRACE_MAYBE_UNUSED Args args)
+static Grace::GraceFile* GetFileOrThrow(Value& value, std::string_view funcSignature)
 {
-  std::fflush(stdout);
-  return {};
-}
+  auto object = value.GetObject();
+  if (object != nullptr) {
+    if (auto file = object->GetAsFile()) {
+      return file;
+    }
+  }
 
-static Value FlushStderr(GRACE_MAYBE_UNUSED Args args)
-{
-  std::fflush(stderr);
-  return {};
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `File` for `std::file::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
 }
 
-static Value SystemExit(Args args)
+static Value FileOpen(Args args)
 {
-  if (args[0].GetType() != Value::Type::Int) {
+  if (args[0].GetType() != Value::Type::String || args[1].GetType() != Value::Type::String) {
     throw Grace::GraceException(
       Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `Int` for `std::system::exit(exit_code)` but got `{}`", args[0].GetTypeName())
+      fmt::format("Expected `String` for both arguments of `std::file::open(path, mode)` but got `{}` and `{}`", args[0].GetTypeName(), args[1].GetTypeName())
     );
   }
 
-  std::exit(static_cast<int>(args[0].Get<std::int64_t>()));
+  return Value::CreateObject<Grace::GraceFile>(args[0].Get<std::string>(), args[1].Get<std::string>());
 }
 
-static Value SystemRun(Args args)
+static Value FileReadLine(Args args)
 {
-  if (args[0].GetType() == Value::Type::String) {
+  auto file = GetFileOrThrow(args[0], "read_line(file)");
+  if (auto line = file->ReadLine()) {
+    return Value(*line);
+  }
+  return {};
+}
+
+static Value FileReadChunk(Args args)
+{
+  auto file = GetFileOrThrow(args[0], "read_chunk(file, count)");
+  if (args[1].GetType() != Value::Type::Int) {
     throw Grace::GraceException(
       Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `String` for `std::system::run(command)` but got `{}`", args[0].GetTypeName())
+      fmt::format("Expected `Int` for `count` in `std::file::read_chunk(file, count)` but got `{}`", args[1].GetTypeName())
     );
   }
 
-  auto res = std::system(args[0].Get<std::string>().c_str());
-  return Value(std::int64_t(res));
+  auto count = args[1].Get<std::int64_t>();
+  if (count <= 0) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("`count` must be greater than 0 for `std::file::read_chunk(file, count)` but got {}", count)
+    );
+  }
+
+  auto chunk = file->ReadChunk(static_cast<std::size_t>(count));
+  if (chunk.empty()) {
+    return {};
+  }
+  return Value(chunk);
 }
 
-static Value SystemPlatform(GRACE_MAYBE_UNUSED Args args)
+// Strings and Bytes are written as they are, anything else is written as it would be printed
+static void WriteToFile(Grace::GraceFile* file, const Value& contents, bool append)
 {
-#ifdef _WIN32
-  return Value(std::string("Win32"));
-#elif _WIN64
-  return Value(std::string("Win64"));
-#elif __APPLE__ || __MACH__
-  return Value(std::string("macOS"));
-#elif __linux__
-  return Value(std::string("Linux"));
-#elif __FreeBSD__
-  return Value(std::string("FreeBSD"));
-#elif __unix || __unix__
-  return Value(std::string("Unix"));
-#else
-  return Value(std::string("Other"));
-#endif
+  auto object = contents.GetObject();
+  if (contents.GetType() == Value::Type::String) {
+    append ? file->AppendText(contents.Get<std::string>()) : file->WriteText(contents.Get<std::string>());
+  } else if (auto bytes = object != nullptr ? object->GetAsBytes() : nullptr) {
+    append ? file->AppendText(bytes->View()) : file->WriteText(bytes->View());
+  } else {
+    auto text = contents.AsString();
+    append ? file->AppendText(text) : file->WriteText(text);
+  }
 }
 
-static Value DirectoryExists(Args args)
+static Value FileWriteHandle(Args args)
 {
-  if (args[0].GetType() != Value::Type::String) {
-    throw Grace::GraceException(
-      Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `String` for `std::directory::exists(path)` but got `{}`", args[0].GetTypeName())
-    );
-  }
+  WriteToFile(GetFileOrThrow(args[0], "write(file, contents)"), args[1], false);
+  return {};
+}
 
-  const auto& path = args[0].Get<std::string>();
-  auto exists = std::filesystem::is_directory(path);
-  return Value(exists);
+static Value FileAppendHandle(Args args)
+{
+  WriteToFile(GetFileOrThrow(args[0], "append(file, contents)"), args[1], true);
+  return {};
 }
 
-static Value DirectoryCreate(Args args)
+static Value FileClose(Args args)
+{
+  GetFileOrThrow(args[0], "close(file)")->Close();
+  return {};
+}
+
+static Value FileLines(Args args)
+{
+  GetFileOrThrow(args[0], "lines(file)");
+  return Value::CreateObject<Grace::GraceFileLines>(args[0]);
+}
+
+static Value FileMap(Args args)
 {
   if (args[0].GetType() != Value::Type::String) {
     throw Grace::GraceException(
       Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `String` for `std::directory::create(path)` but got `{}`", args[0].GetTypeName())
+      fmt::format("Expected `String` for `std::file::map(path)` but got `{}`", args[0].GetTypeName())
     );
   }
 
   const auto& path = args[0].Get<std::string>();
-  auto result = std::filesystem::create_directories(path);
-  return Value(result);
-}
-
-static Value InteropLoadLibrary(Args args)
-{
-  if (args[0].GetType() != Value::Type::String) {
+  auto file = Grace::Scanner::SourceFile::Open(path);
+  if (file == nullptr) {
     throw Grace::GraceException(
-      Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `String` for `std::interop::load_library(library_path)` but got `{}`", args[0].GetTypeName())
+      Grace::GraceException::Type::FileReadFailed,
+      fmt::format("Failed to map file '{}'", path)
     );
   }
 
-  const auto& libName = args[0].Get<std::string>();
+  return Value::CreateObject<Grace::GraceBytes>(std::move(file));
+}
 
-  auto handle = dlLoadLibrary(libName.c_str());
-  if (handle == nullptr) {
-    throw Grace::GraceException(Grace::GraceException::Type::LibraryLoadFailure, fmt::format("Failed to load dynamic library {}", libName));
+static Grace::GraceBytes* GetBytesOrThrow(Value& value, std::string_view funcSignature)
+{
+  auto object = value.GetObject();
+  if (object != nullptr) {
+    if (auto bytes = object->GetAsBytes()) {
+      return bytes;
+    }
   }
 
-  auto ptrAsInt = (std::int64_t)handle;
-  return Value(ptrAsInt);
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `Bytes` for `std::bytes::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
 }
 
-static Value InteropDoCall(Args args)
+static Value BytesFromString(Args args)
 {
-#define CDECL_ARG_BOOL 0
-#define CDECL_ARG_CHAR 1
-#define CDECL_ARG_SHORT 2
-#define CDECL_ARG_INT 3
-#define CDECL_ARG_LONG 4
-#define CDECL_ARG_LONG_LONG 5
-#define CDECL_ARG_FLOAT 6
-#define CDECL_ARG_DOUBLE 7
-#define CDECL_ARG_POINTER 8
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::bytes::from_string(string)` but got `{}`", args[0].GetTypeName())
+    );
+  }
 
-#define CDECL_CALL_BOOL 0
-#define CDECL_CALL_CHAR 1
-#define CDECL_CALL_SHORT 2
-#define CDECL_CALL_INT 3
-#define CDECL_CALL_LONG 4
-#define CDECL_CALL_LONG_LONG 5
-#define CDECL_CALL_FLOAT 6
-#define CDECL_CALL_DOUBLE 7
-#define CDECL_CALL_POINTER 8
-#define CDECL_CALL_VOID 9
+  return Value::CreateObject<Grace::GraceBytes>(std::string(args[0].Get<std::string>()));
+}
 
-  auto handleInstance = args[0].GetObject()->GetAsInstance();
+static Value BytesToString(Args args)
+{
+  auto bytes = GetBytesOrThrow(args[0], "to_string(bytes)");
+  return Value(std::string(bytes->View()));
+}
 
-  if (handleInstance == nullptr || handleInstance->ObjectName() != "LibraryHandle") {
+static Value BytesLength(Args args)
+{
+  auto bytes = GetBytesOrThrow(args[0], "length(bytes)");
+  return Value(static_cast<std::int64_t>(bytes->Length()));
+}
+
+static Value BytesAt(Args args)
+{
+  auto bytes = GetBytesOrThrow(args[0], "at(bytes, index)");
+  if (args[1].GetType() != Value::Type::Int) {
     throw Grace::GraceException(
       Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `std::interop::LibraryHandle` for `handle` in `std::interop::do_call(handle, func_name, args, call_type)` but got `{}`", args[0].GetTypeName())
+      fmt::format("Expected `Int` for `index` in `std::bytes::at(bytes, index)` but got `{}`", args[1].GetTypeName())
     );
   }
 
-  if (args[1].GetType() != Value::Type::String) {
+  return Value(static_cast<std::int64_t>(bytes->At(args[1].Get<std::int64_t>())));
+}
+
+static Value BytesSlice(Args args)
+{
+  auto bytes = GetBytesOrThrow(args[0], "slice(bytes, start, length)");
+  if (args[1].GetType() != Value::Type::Int || args[2].GetType() != Value::Type::Int) {
     throw Grace::GraceException(
       Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `String` for `func_name` in `std::interop::do_call(handle, func_name, args, call_type)` but got `{}`", args[1].GetTypeName())
+      fmt::format("Expected `Int` for `start` and `length` in `std::bytes::slice(bytes, start, length)` but got `{}` and `{}`", args[1].GetTypeName(), args[2].GetTypeName())
     );
   }
 
-  const auto& funcName = args[1].Get<std::string>();
-
-  auto argsObject = args[2].GetObject();
-  if (argsObject == nullptr || argsObject->GetAsList() == nullptr) {
+  auto start = args[1].Get<std::int64_t>();
+  auto length = args[2].Get<std::int64_t>();
+  auto size = static_cast<std::int64_t>(bytes->Length());
+  if (start < 0 || length < 0 || start > size || length > size - start) {
     throw Grace::GraceException(
-      Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `List` for `args` in `std::interop::do_call(handle, func_name, args, call_type)` but got `{}`", args[2].GetTypeName())
+      Grace::GraceException::Type::IndexOutOfRange,
+      fmt::format("Cannot take {} bytes from index {} when the length of the `Bytes` is {}", length, start, size)
     );
   }
-  auto argList = argsObject->GetAsList();
 
-  if (args[3].GetType() != Value::Type::Int) {
+  return Value::CreateObject<Grace::GraceBytes>(*bytes, static_cast<std::size_t>(start), static_cast<std::size_t>(length));
+}
+
+static Value BytesFind(Args args)
+{
+  auto bytes = GetBytesOrThrow(args[0], "find(bytes, needle, start)");
+  if (args[2].GetType() != Value::Type::Int) {
     throw Grace::GraceException(
       Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `Int` for `call_type` in `std::interop::do_call(handle, func_name, args, call_type)` but got `{}`", args[3].GetTypeName())
+      fmt::format("Expected `Int` for `start` in `std::bytes::find(bytes, needle, start)` but got `{}`", args[2].GetTypeName())
     );
   }
-  auto callType = args[3].Get<std::int64_t>();
 
-  auto addressAsInt = (DLLib*)(handleInstance->LoadMember("lib_address").Get<std::int64_t>());
-  void* funcPtr = dlFindSymbol(addressAsInt, funcName.c_str());
-  if (funcPtr == nullptr) {
+  auto start = args[2].Get<std::int64_t>();
+  if (start < 0) {
     throw Grace::GraceException(
-      Grace::GraceException::Type::FunctionNotFound,
-      fmt::format("Failed to load function `{}` from dynamic library `{}`", funcName, handleInstance->LoadMember("library_name").Get<std::string>())
+      Grace::GraceException::Type::IndexOutOfRange,
+      fmt::format("`start` cannot be negative in `std::bytes::find(bytes, needle, start)` but got {}", start)
     );
   }
 
-  auto stackSize = static_cast<std::size_t>(handleInstance->LoadMember("stack_size").Get<std::int64_t>());
-  DCCallVM* vm = dcNewCallVM(stackSize);
-  dcMode(vm, DC_CALL_C_DEFAULT);
-  dcReset(vm);
-
-  std::vector<char*> argsToDelete;
-
-  for (auto it = argList->Begin(); it != argList->End(); it++) {
-    auto pair = it->GetObject()->GetAsKeyValuePair();
-    if (pair == nullptr) {
-      throw Grace::GraceException(Grace::GraceException::Type::InvalidType, fmt::format("Expected all args in arg list to be `KeyValuePair`s but got `{}`", it->GetTypeName()));
+  std::optional<std::size_t> index;
+  const auto& needle = args[1];
+  auto needleObject = needle.GetObject();
+  switch (needle.GetType()) {
+    case Value::Type::String:
+      index = bytes->Find(needle.Get<std::string>(), static_cast<std::size_t>(start));
+      break;
+    case Value::Type::Char: {
+      auto c = needle.Get<char>();
+      index = bytes->Find(std::string_view(&c, 1), static_cast<std::size_t>(start));
+      break;
     }
-
-    auto& argType = pair->Key();
-    switch (argType.Get<std::int64_t>()) {
-      case CDECL_ARG_BOOL:
-        dcArgBool(vm, pair->Value().Get<bool>());
-        break;
-      case CDECL_ARG_CHAR:
-        dcArgChar(vm, pair->Value().Get<char>());
-        break;
-      case CDECL_ARG_SHORT:
-        dcArgShort(vm, static_cast<short>(pair->Value().Get<std::int64_t>()));
-        break;
-      case CDECL_ARG_INT:
-        dcArgInt(vm, static_cast<int>(pair->Value().Get<std::int64_t>()));
-        break;
-      case CDECL_ARG_LONG:
-        dcArgLong(vm, static_cast<long>(pair->Value().Get<std::int64_t>()));
-        break;
-      case CDECL_ARG_LONG_LONG:
-        dcArgLongLong(vm, static_cast<long long>(pair->Value().Get<std::int64_t>()));
-        break;
-      case CDECL_ARG_FLOAT:
-        dcArgFloat(vm, static_cast<float>(pair->Value().Get<double>()));
-        break;
-      case CDECL_ARG_DOUBLE:
-        dcArgDouble(vm, pair->Value().Get<double>());
-        break;
-      case CDECL_ARG_POINTER: {
-        auto& str = pair->Value().Get<std::string>();
-        auto charArray = new char[str.size() + 1];  // + 1 for null terminated char
-        std::memcpy(charArray, str.data(), str.size());
-        charArray[str.size()] = '\0';
-        argsToDelete.push_back(charArray);
-        dcArgPointer(vm, charArray);
+    default:
+      if (auto needleBytes = needleObject != nullptr ? needleObject->GetAsBytes() : nullptr) {
+        index = bytes->Find(needleBytes->View(), static_cast<std::size_t>(start));
         break;
       }
-      default:
-        throw Grace::GraceException(Grace::GraceException::Type::InvalidArgument, "Invalid type given for cdecl argument type");
-    }
+      throw Grace::GraceException(
+        Grace::GraceException::Type::InvalidType,
+        fmt::format("Expected `Bytes`, `String` or `Char` for `needle` in `std::bytes::find(bytes, needle, start)` but got `{}`", needle.GetTypeName())
+      );
   }
 
-  Value returnValue;
+  return Value(index ? static_cast<std::int64_t>(*index) : std::int64_t(-1));
+}
 
-  switch (callType) {
-    case CDECL_CALL_BOOL:
-      returnValue = static_cast<bool>(dcCallBool(vm, funcPtr));
-      break;
-    case CDECL_CALL_CHAR:
-      returnValue = static_cast<char>(dcCallChar(vm, funcPtr));
-      break;
-    case CDECL_CALL_SHORT:
-      returnValue = static_cast<std::int64_t>(dcCallShort(vm, funcPtr));
-      break;
-    case CDECL_CALL_INT:
-      returnValue = static_cast<std::int64_t>(dcCallInt(vm, funcPtr));
-      break;
-    case CDECL_CALL_LONG:
-      returnValue = static_cast<std::int64_t>(dcCallLong(vm, funcPtr));
-      break;
-    case CDECL_CALL_LONG_LONG:
-      returnValue = static_cast<std::int64_t>(dcCallLongLong(vm, funcPtr));
-      break;
-    case CDECL_CALL_FLOAT:
-      returnValue = static_cast<double>(dcCallFloat(vm, funcPtr));
-      break;
-    case CDECL_CALL_DOUBLE:
-      returnValue = static_cast<double>(dcCallDouble(vm, funcPtr));
-      break;
-    case CDECL_CALL_POINTER:
-      GRACE_NOT_IMPLEMENTED();
-      break;
-    case CDECL_CALL_VOID:
-      dcCallVoid(vm, funcPtr);
-      break;
-    default:
-      throw Grace::GraceException(Grace::GraceException::Type::InvalidArgument, "Invalid return type given for cdecl library call");
+static Value JsonParse(Args args)
+{
+  if (args[0].GetType() == Value::Type::String) {
+    return Grace::Json::Parse(args[0].Get<std::string>());
   }
 
-  for (auto p : argsToDelete) {
-    delete[] p;
+  // a mapped file can be parsed without copying it into a String first
+  auto object = args[0].GetObject();
+  if (object != nullptr) {
+    if (auto bytes = object->GetAsBytes()) {
+      return Grace::Json::Parse(bytes->View());
+    }
   }
 
-  return returnValue;
-
-#undef CDECL_ARG_BOOL
-#undef CDECL_ARG_CHAR
-#undef CDECL_ARG_SHORT
-#undef CDECL_ARG_INT
-#undef CDECL_ARG_LONG
-#undef CDECL_ARG_LONG_LONG
-#undef CDECL_ARG_FLOAT
-#undef CDECL_ARG_DOUBLE
-#undef CDECL_ARG_POINTER
-
-#undef CDECL_CALL_BOOL
-#undef CDECL_CALL_CHAR
-#undef CDECL_CALL_SHORT
-#undef CDECL_CALL_INT
-#undef CDECL_CALL_LONG
-#undef CDECL_CALL_LONG_LONG
-#undef CDECL_CALL_FLOAT
-#undef CDECL_CALL_DOUBLE
-#undef CDECL_CALL_POINTER
-#undef CDECL_CALL_VOID
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `String` or `Bytes` for `std::json::parse(text)` but got `{}`", args[0].GetTypeName())
+  );
 }
 
-static Value StringLength(Args args)
+static Value JsonStringify(Args args)
 {
-  auto& s = args[0];
-  if (s.GetType() != Value::Type::String) {
+  if (args[1].GetType() != Value::Type::Int) {
     throw Grace::GraceException(
       Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `String` for `std::string::length(s)` but got `{}`", args[0].GetTypeName())
+      fmt::format("Expected `Int` for `indent` in `std::json::stringify_pretty(value, indent)` but got `{}`", args[1].GetTypeName())
     );
   }
 
-  return Value(static_cast<std::int64_t>(s.Get<std::string>().length()));
+  auto indent = args[1].Get<std::int64_t>();
+  if (indent < 0) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("`indent` cannot be negative in `std::json::stringify_pretty(value, indent)` but got {}", indent)
+    );
+  }
+
+  Grace::OutputBuffer sink;
+  Grace::Json::Write(sink, args[0], static_cast<std::size_t>(indent));
+  return Value(sink.TakeString());
 }
 
-static Value StringSplit(Args args)
+// opens the file for a CsvReader after checking the path, delimiter and quote
+static Value OpenCsvOrThrow(Args args, std::string_view funcSignature)
 {
   if (args[0].GetType() != Value::Type::String) {
     throw Grace::GraceException(
       Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `String` for `std::string::split(s, separator)` but got `{}`", args[0].GetTypeName())
+      fmt::format("Expected `String` for `path` in `std::csv::{}` but got `{}`", funcSignature, args[0].GetTypeName())
     );
   }
 
-  if (args[1].GetType() != Value::Type::String && args[1].GetType() != Value::Type::Char) {
+  if (args[1].GetType() != Value::Type::Char || args[2].GetType() != Value::Type::Char) {
     throw Grace::GraceException(
       Grace::GraceException::Type::InvalidType,
-      fmt::format("Expected `String` or `Char` for `std::string::split(s, separator)` but got `{}`", args[1].GetTypeName())
+      fmt::format("Expected `Char` for `delimiter` and `quote` in `std::csv::{}` but got `{}` and `{}`", funcSignature, args[1].GetTypeName(), args[2].GetTypeName())
     );
   }
 
-  const auto& s = args[0].Get<std::string>();
-  auto separator = args[1].AsString();
-
-  if (separator.length() == 0) {
-    throw Grace::GraceException(Grace::GraceException::Type::InvalidArgument, "Separator has 0 length");
+  auto delimiter = args[1].Get<char>();
+  auto quote = args[2].Get<char>();
+  if (delimiter == quote || delimiter == '\n' || delimiter == '\r' || quote == '\n' || quote == '\r') {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("`delimiter` and `quote` must be different and can't be line endings in `std::csv::{}`", funcSignature)
+    );
   }
 
-  auto res = Value::CreateObject<Grace::GraceList>();
-  auto list = res.GetObject()->GetAsList();
-  if (s.find(separator) == std::string::npos) {
-    list->Append(s);
-    return res;
+  return Value::CreateObject<Grace::GraceFile>(args[0].Get<std::string>(), std::string("r"));
+}
+
+static Value CsvRows(Args args)
+{
+  auto file = OpenCsvOrThrow(args, "rows(path, delimiter, quote)");
+  return Value::CreateObject<Grace::GraceCsvRows>(file, args[1].Get<char>(), args[2].Get<char>());
+}
+
+static Value CsvColumns(Args args)
+{
+  auto file = OpenCsvOrThrow(args, "columns(path, delimiter, quote)");
+  Grace::CsvReader reader(file, args[1].Get<char>(), args[2].Get<char>());
+  return reader.ReadColumns();
+}
+
+static Value SerializeDump(Args args)
+{
+  if (args[1].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `path` in `std::serialize::dump(value, path)` but got `{}`", args[1].GetTypeName())
+    );
   }
-  
-  std::size_t lastSplit = 0;
-  for (std::size_t i = 0; i < s.length();) {
-    if (s.substr(i, separator.length()) == separator) {
-      list->Append(s.substr(lastSplit, i - lastSplit));
-      lastSplit = i + separator.length();
-      i = lastSplit;
-    } else {
-      i++;
-    }
+
+  auto data = Grace::Serialize::Encode(args[0]);
+
+  const auto& path = args[1].Get<std::string>();
+  std::ofstream outStream(path, std::ios::binary);
+  outStream.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+  if (outStream.fail()) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::FileWriteFailed,
+      fmt::format("Failed to write to '{}'", path)
+    );
   }
 
-  list->Append(s.substr(lastSplit));
-  return res;
+  return {};
 }
 
-static Value StringSubstring(Args args)
+static Value SerializeLoad(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::serialize::load(path)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  const auto& path = args[0].Get<std::string>();
+  auto file = Grace::Scanner::SourceFile::Open(path);
+  if (file == nullptr) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::FileReadFailed,
+      fmt::format("Failed to open file '{}'", path)
+    );
+  }
+
+  return Grace::Serialize::Decode(file->GetText());
+}
+
+static Value SerializeToBytes(Args args)
+{
+  return Value::CreateObject<Grace::GraceBytes>(Grace::Serialize::Encode(args[0]));
+}
+
+static Value SerializeFromBytes(Args args)
+{
+  auto object = args[0].GetObject();
+  if (object != nullptr) {
+    if (auto bytes = object->GetAsBytes()) {
+      return Grace::Serialize::Decode(bytes->View());
+    }
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `Bytes` for `std::serialize::from_bytes(bytes)` but got `{}`", args[0].GetTypeName())
+  );
+}
+
+static Value FlushStdout(GRACE_MAYBE_UNUSED Args args)
+{
+  Grace::OutputBuffer::Stdout().Flush();
+  return {};
+}
+
+static Value FlushStderr(GRACE_MAYBE_UNUSED Args args)
+{
+  Grace::OutputBuffer::Stderr().Flush();
+  return {};
+}
+
+static void SetBuffering(Grace::OutputBuffer& buffer, Args args, std::string_view funcName)
+{
+  if (args[0].GetType() != Value::Type::Int || args[1].GetType() != Value::Type::Int) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `Int` for both arguments of `std::console::{}(mode, size)` but got `{}` and `{}`", funcName, args[0].GetTypeName(), args[1].GetTypeName())
+    );
+  }
+
+  auto mode = args[0].Get<std::int64_t>();
+  auto size = args[1].Get<std::int64_t>();
+  if (mode < 0 || mode > static_cast<std::int64_t>(Grace::OutputBuffer::Mode::Full)) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("`mode` must be one of `BUFFER_NONE`, `BUFFER_LINE` or `BUFFER_FULL` for `std::console::{}(mode, size)`", funcName)
+    );
+  }
+  if (size <= 0) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("`size` must be greater than 0 for `std::console::{}(mode, size)` but got {}", funcName, size)
+    );
+  }
+
+  buffer.SetMode(static_cast<Grace::OutputBuffer::Mode>(mode), static_cast<std::size_t>(size));
+}
+
+static Value SetStdoutBuffering(Args args)
+{
+  SetBuffering(Grace::OutputBuffer::Stdout(), args, "set_buffering");
+  return {};
+}
+
+static Value SetStderrBuffering(Args args)
+{
+  SetBuffering(Grace::OutputBuffer::Stderr(), args, "set_ebuffering");
+  return {};
+}
+
+static Value ReadLineStdin(GRACE_MAYBE_UNUSED Args args)
+{
+  if (auto line = Grace::InputBuffer::Stdin().ReadLine()) {
+    return Value(*line);
+  }
+  return {};
+}
+
+static Value ReadAllStdin(GRACE_MAYBE_UNUSED Args args)
+{
+  return Value(Grace::InputBuffer::Stdin().ReadAll());
+}
+
+static Value ReadIntsStdin(GRACE_MAYBE_UNUSED Args args)
+{
+  auto res = Value::CreateObject<Grace::GraceList>();
+  auto list = res.GetObject()->GetAsList();
+  auto& reader = Grace::InputBuffer::Stdin();
+  while (auto value = reader.ReadInt()) {
+    list->Append(*value);
+  }
+  return res;
+}
+
+static Value LinesStdin(GRACE_MAYBE_UNUSED Args args)
+{
+  return Value::CreateObject<Grace::GraceFileLines>();
+}
+
+static Value SystemExit(Args args)
+{
+  if (args[0].GetType() != Value::Type::Int) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `Int` for `std::system::exit(exit_code)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  Grace::OutputBuffer::FlushAll();
+  std::exit(static_cast<int>(args[0].Get<std::int64_t>()));
+}
+
+static Value SystemRun(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::system::run(command)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  Grace::OutputBuffer::FlushAll();
+  auto res = std::system(args[0].Get<std::string>().c_str());
+  return Value(std::int64_t(res));
+}
+
+static Value SystemPlatform(GRACE_MAYBE_UNUSED Args args)
+{
+#ifdef _WIN32
+  return Value(std::string("Win32"));
+#elif _WIN64
+  return Value(std::string("Win64"));
+#elif __APPLE__ || __MACH__
+  return Value(std::string("macOS"));
+#elif __linux__
+  return Value(std::string("Linux"));
+#elif __FreeBSD__
+  return Value(std::string("FreeBSD"));
+#elif __unix || __unix__
+  return Value(std::string("Unix"));
+#else
+  return Value(std::string("Other"));
+#endif
+}
+
+static Value DirectoryExists(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::directory::exists(path)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  const auto& path = args[0].Get<std::string>();
+  auto exists = std::filesystem::is_directory(path);
+  return Value(exists);
+}
+
+static Value DirectoryCreate(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::directory::create(path)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  const auto& path = args[0].Get<std::string>();
+  auto result = std::filesystem::create_directories(path);
+  return Value(result);
+}
+
+static Value InteropLoadLibrary(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::interop::load_library(library_path)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  const auto& libName = args[0].Get<std::string>();
+
+  auto handle = dlLoadLibrary(libName.c_str());
+  if (handle == nullptr) {
+    throw Grace::GraceException(Grace::GraceException::Type::LibraryLoadFailure, fmt::format("Failed to load dynamic library {}", libName));
+  }
+
+  auto ptrAsInt = (std::int64_t)handle;
+  return Value(ptrAsInt);
+}
+
+static Value InteropDoCall(Args args)
+{
+#define CDECL_ARG_BOOL 0
+#define CDECL_ARG_CHAR 1
+#define CDECL_ARG_SHORT 2
+#define CDECL_ARG_INT 3
+#define CDECL_ARG_LONG 4
+#define CDECL_ARG_LONG_LONG 5
+#define CDECL_ARG_FLOAT 6
+#define CDECL_ARG_DOUBLE 7
+#define CDECL_ARG_POINTER 8
+
+#define CDECL_CALL_BOOL 0
+#define CDECL_CALL_CHAR 1
+#define CDECL_CALL_SHORT 2
+#define CDECL_CALL_INT 3
+#define CDECL_CALL_LONG 4
+#define CDECL_CALL_LONG_LONG 5
+#define CDECL_CALL_FLOAT 6
+#define CDECL_CALL_DOUBLE 7
+#define CDECL_CALL_POINTER 8
+#define CDECL_CALL_VOID 9
+
+  auto handleInstance = args[0].GetObject()->GetAsInstance();
+
+  if (handleInstance == nullptr || handleInstance->ObjectName() != "LibraryHandle") {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `std::interop::LibraryHandle` for `handle` in `std::interop::do_call(handle, func_name, args, call_type)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  if (args[1].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `func_name` in `std::interop::do_call(handle, func_name, args, call_type)` but got `{}`", args[1].GetTypeName())
+    );
+  }
+
+  const auto& funcName = args[1].Get<std::string>();
+
+  auto argsObject = args[2].GetObject();
+  if (argsObject == nullptr || argsObject->GetAsList() == nullptr) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `List` for `args` in `std::interop::do_call(handle, func_name, args, call_type)` but got `{}`", args[2].GetTypeName())
+    );
+  }
+  auto argList = argsObject->GetAsList();
+
+  if (args[3].GetType() != Value::Type::Int) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `Int` for `call_type` in `std::interop::do_call(handle, func_name, args, call_type)` but got `{}`", args[3].GetTypeName())
+    );
+  }
+  auto callType = args[3].Get<std::int64_t>();
+
+  auto addressAsInt = (DLLib*)(handleInstance->LoadMember("lib_address").Get<std::int64_t>());
+  void* funcPtr = dlFindSymbol(addressAsInt, funcName.c_str());
+  if (funcPtr == nullptr) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::FunctionNotFound,
+      fmt::format("Failed to load function `{}` from dynamic library `{}`", funcName, handleInstance->LoadMember("library_name").Get<std::string>())
+    );
+  }
+
+  auto stackSize = static_cast<std::size_t>(handleInstance->LoadMember("stack_size").Get<std::int64_t>());
+  DCCallVM* vm = dcNewCallVM(stackSize);
+  dcMode(vm, DC_CALL_C_DEFAULT);
+  dcReset(vm);
+
+  std::vector<char*> argsToDelete;
+
+  for (auto it = argList->Begin(); it != argList->End(); it++) {
+    auto pair = it->GetObject()->GetAsKeyValuePair();
+    if (pair == nullptr) {
+      throw Grace::GraceException(Grace::GraceException::Type::InvalidType, fmt::format("Expected all args in arg list to be `KeyValuePair`s but got `{}`", it->GetTypeName()));
+    }
+
+    auto& argType = pair->Key();
+    switch (argType.Get<std::int64_t>()) {
+      case CDECL_ARG_BOOL:
+        dcArgBool(vm, pair->Value().Get<bool>());
+        break;
+      case CDECL_ARG_CHAR:
+        dcArgChar(vm, pair->Value().Get<char>());
+        break;
+      case CDECL_ARG_SHORT:
+        dcArgShort(vm, static_cast<short>(pair->Value().Get<std::int64_t>()));
+        break;
+      case CDECL_ARG_INT:
+        dcArgInt(vm, static_cast<int>(pair->Value().Get<std::int64_t>()));
+        break;
+      case CDECL_ARG_LONG:
+        dcArgLong(vm, static_cast<long>(pair->Value().Get<std::int64_t>()));
+        break;
+      case CDECL_ARG_LONG_LONG:
+        dcArgLongLong(vm, static_cast<long long>(pair->Value().Get<std::int64_t>()));
+        break;
+      case CDECL_ARG_FLOAT:
+        dcArgFloat(vm, static_cast<float>(pair->Value().Get<double>()));
+        break;
+      case CDECL_ARG_DOUBLE:
+        dcArgDouble(vm, pair->Value().Get<double>());
+        break;
+      case CDECL_ARG_POINTER: {
+        auto& str = pair->Value().Get<std::string>();
+        auto charArray = new char[str.size() + 1];  // + 1 for null terminated char
+        std::memcpy(charArray, str.data(), str.size());
+        charArray[str.size()] = '\0';
+        argsToDelete.push_back(charArray);
+        dcArgPointer(vm, charArray);
+        break;
+      }
+      default:
+        throw Grace::GraceException(Grace::GraceException::Type::InvalidArgument, "Invalid type given for cdecl argument type");
+    }
+  }
+
+  // the library might print too
+  Grace::OutputBuffer::FlushAll();
+
+  Value returnValue;
+
+  switch (callType) {
+    case CDECL_CALL_BOOL:
+      returnValue = static_cast<bool>(dcCallBool(vm, funcPtr));
+      break;
+    case CDECL_CALL_CHAR:
+      returnValue = static_cast<char>(dcCallChar(vm, funcPtr));
+      break;
+    case CDECL_CALL_SHORT:
+      returnValue = static_cast<std::int64_t>(dcCallShort(vm, funcPtr));
+      break;
+    case CDECL_CALL_INT:
+      returnValue = static_cast<std::int64_t>(dcCallInt(vm, funcPtr));
+      break;
+    case CDECL_CALL_LONG:
+      returnValue = static_cast<std::int64_t>(dcCallLong(vm, funcPtr));
+      break;
+    case CDECL_CALL_LONG_LONG:
+      returnValue = static_cast<std::int64_t>(dcCallLongLong(vm, funcPtr));
+      break;
+    case CDECL_CALL_FLOAT:
+      returnValue = static_cast<double>(dcCallFloat(vm, funcPtr));
+      break;
+    case CDECL_CALL_DOUBLE:
+      returnValue = static_cast<double>(dcCallDouble(vm, funcPtr));
+      break;
+    case CDECL_CALL_POINTER:
+      GRACE_NOT_IMPLEMENTED();
+      break;
+    case CDECL_CALL_VOID:
+      dcCallVoid(vm, funcPtr);
+      break;
+    default:
+      throw Grace::GraceException(Grace::GraceException::Type::InvalidArgument, "Invalid return type given for cdecl library call");
+  }
+
+  for (auto p : argsToDelete) {
+    delete[] p;
+  }
+
+  return returnValue;
+
+#undef CDECL_ARG_BOOL
+#undef CDECL_ARG_CHAR
+#undef CDECL_ARG_SHORT
+#undef CDECL_ARG_INT
+#undef CDECL_ARG_LONG
+#undef CDECL_ARG_LONG_LONG
+#undef CDECL_ARG_FLOAT
+#undef CDECL_ARG_DOUBLE
+#undef CDECL_ARG_POINTER
+
+#undef CDECL_CALL_BOOL
+#undef CDECL_CALL_CHAR
+#undef CDECL_CALL_SHORT
+#undef CDECL_CALL_INT
+#undef CDECL_CALL_LONG
+#undef CDECL_CALL_LONG_LONG
+#undef CDECL_CALL_FLOAT
+#undef CDECL_CALL_DOUBLE
+#undef CDECL_CALL_POINTER
+#undef CDECL_CALL_VOID
+}
+
+static Value StringLength(Args args)
+{
+  auto& s = args[0];
+  if (s.GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::string::length(s)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  return Value(static_cast<std::int64_t>(s.Get<std::string>().length()));
+}
+
+static Value StringSplit(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::string::split(s, separator)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  if (args[1].GetType() != Value::Type::String && args[1].GetType() != Value::Type::Char) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` or `Char` for `std::string::split(s, separator)` but got `{}`", args[1].GetTypeName())
+    );
+  }
+
+  const auto& s = args[0].Get<std::string>();
+  auto separator = args[1].AsString();
+
+  if (separator.length() == 0) {
+    throw Grace::GraceException(Grace::GraceException::Type::InvalidArgument, "Separator has 0 length");
+  }
+
+  auto res = Value::CreateObject<Grace::GraceList>();
+  auto list = res.GetObject()->GetAsList();
+  if (s.find(separator) == std::string::npos) {
+    list->Append(s);
+    return res;
+  }
+  
+  std::size_t lastSplit = 0;
+  for (std::size_t i = 0; i < s.length();) {
+    if (s.substr(i, separator.length()) == separator) {
+      list->Append(s.substr(lastSplit, i - lastSplit));
+      lastSplit = i + separator.length();
+      i = lastSplit;
+    } else {
+      i++;
+    }
+  }
+
+  list->Append(s.substr(lastSplit));
+  return res;
+}
+
+static Value StringSubstring(Args args)
 {
   if (args[0].GetType() == Value::Type::String) {
     if (args[1].GetType() != Value::Type::Int) {
       throw Grace::GraceException(
         Grace::GraceException::Type::InvalidType,
-        fmt::format("Expected `Int` for `start` in `std::string::substring(string, start, length)` but got `{}`", args[1].GetType())
+        fmt::format("Expected `Int` for `start` in `std::string::substring(string, start, length)` but got `{}`", args[1].GetType())
+      );
+    }
+
+    if (args[2].GetType() != Value::Type::Int) {
+      throw Grace::GraceException(
+        Grace::GraceException::Type::InvalidType,
+        fmt::format("Expected `Int` for `length` in `std::string::substring(string, start, length)` but got `{}`", args[2].GetType())
+      );
+    }
+
+    return Value(args[0].Get<std::string>().substr(static_cast<std::size_t>(args[1].Get<std::int64_t>()), static_cast<std::size_t>(args[2].Get<std::int64_t>())));
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `String` for `std::string::substring(string, start, length)` but got `{}`", args[0].GetType())
+  );  
+}
+
+static const std::string& GetStringOrThrow(const Value& value, std::string_view funcSignature)
+{
+  if (value.GetType() == Value::Type::String) {
+    return value.Get<std::string>();
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `String` for `std::string::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
+}
+
+// a Char can be searched for anywhere a String can, it's viewed where it is rather than being copied into a String
+static std::string_view GetTextOrThrow(const Value& value, std::string_view funcSignature)
+{
+  if (value.GetType() == Value::Type::String) {
+    return value.Get<std::string>();
+  }
+
+  if (value.GetType() == Value::Type::Char) {
+    return std::string_view(&value.Get<char>(), 1);
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `String` or `Char` for `std::string::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
+}
+
+static Value IndexOrMinusOne(std::size_t index)
+{
+  return Value(index == std::string_view::npos ? std::int64_t{-1} : static_cast<std::int64_t>(index));
+}
+
+static Value StringFind(Args args)
+{
+  const auto& s = GetStringOrThrow(args[0], "find(s, needle)");
+  return IndexOrMinusOne(Grace::StringAlgorithms::Find(s, GetTextOrThrow(args[1], "find(s, needle)")));
+}
+
+static Value StringRFind(Args args)
+{
+  const auto& s = GetStringOrThrow(args[0], "rfind(s, needle)");
+  return IndexOrMinusOne(Grace::StringAlgorithms::FindLast(s, GetTextOrThrow(args[1], "rfind(s, needle)")));
+}
+
+static Value StringContains(Args args)
+{
+  const auto& s = GetStringOrThrow(args[0], "contains(s, needle)");
+  return Value(Grace::StringAlgorithms::Find(s, GetTextOrThrow(args[1], "contains(s, needle)")) != std::string_view::npos);
+}
+
+static Value StringStartsWith(Args args)
+{
+  std::string_view s = GetStringOrThrow(args[0], "starts_with(s, prefix)");
+  return Value(s.starts_with(GetTextOrThrow(args[1], "starts_with(s, prefix)")));
+}
+
+static Value StringEndsWith(Args args)
+{
+  std::string_view s = GetStringOrThrow(args[0], "ends_with(s, suffix)");
+  return Value(s.ends_with(GetTextOrThrow(args[1], "ends_with(s, suffix)")));
+}
+
+static Value StringCount(Args args)
+{
+  const auto& s = GetStringOrThrow(args[0], "count(s, needle)");
+  auto needle = GetTextOrThrow(args[1], "count(s, needle)");
+  if (needle.empty()) {
+    throw Grace::GraceException(Grace::GraceException::Type::InvalidArgument, "Cannot count occurrences of an empty String");
+  }
+
+  return Value(static_cast<std::int64_t>(Grace::StringAlgorithms::Count(s, needle)));
+}
+
+static Value StringReplaceAll(Args args)
+{
+  const auto& s = GetStringOrThrow(args[0], "replace_all(s, from, to)");
+  auto from = GetTextOrThrow(args[1], "replace_all(s, from, to)");
+  auto to = GetTextOrThrow(args[2], "replace_all(s, from, to)");
+  if (from.empty()) {
+    throw Grace::GraceException(Grace::GraceException::Type::InvalidArgument, "Cannot replace an empty String");
+  }
+
+  return Value(Grace::StringAlgorithms::ReplaceAll(s, from, to));
+}
+
+static Value StringTrim(Args args)
+{
+  const auto& s = GetStringOrThrow(args[0], "trim(s)");
+  return Value(std::string(Grace::StringAlgorithms::Trim(s)));
+}
+
+static Value StringToUpper(Args args)
+{
+  return Value(Grace::StringAlgorithms::ToUpper(GetStringOrThrow(args[0], "to_upper(s)")));
+}
+
+static Value StringToLower(Args args)
+{
+  return Value(Grace::StringAlgorithms::ToLower(GetStringOrThrow(args[0], "to_lower(s)")));
+}
+
+static Value StringJoin(Args args)
+{
+  auto object = args[0].GetObject();
+  auto list = object == nullptr ? nullptr : object->GetAsList();
+  if (list == nullptr) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `List` for `std::string::join(strings, separator)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  auto separator = GetTextOrThrow(args[1], "join(strings, separator)");
+
+  // check every element and add up the lengths first, so the result is only allocated once
+  std::size_t length = list->Length() == 0 ? 0 : separator.size() * (list->Length() - 1);
+  for (std::size_t i = 0; i < list->Length(); i++) {
+    const auto& element = list->GetUnchecked(i);
+    if (element.GetType() == Value::Type::String) {
+      length += element.Get<std::string>().size();
+    } else if (element.GetType() == Value::Type::Char) {
+      length++;
+    } else {
+      throw Grace::GraceException(
+        Grace::GraceException::Type::InvalidType,
+        fmt::format("Expected every element to be a `String` or `Char` in `std::string::join(strings, separator)` but element {} is `{}`", i, element.GetTypeName())
       );
     }
+  }
 
-    if (args[2].GetType() != Value::Type::Int) {
-      throw Grace::GraceException(
-        Grace::GraceException::Type::InvalidType,
-        fmt::format("Expected `Int` for `length` in `std::string::substring(string, start, length)` but got `{}`", args[2].GetType())
-      );
+  std::string result;
+  result.reserve(length);
+  for (std::size_t i = 0; i < list->Length(); i++) {
+    if (i != 0) {
+      result.append(separator);
     }
 
-    return Value(args[0].Get<std::string>().substr(static_cast<std::size_t>(args[1].Get<std::int64_t>()), static_cast<std::size_t>(args[2].Get<std::int64_t>())));
+    const auto& element = list->GetUnchecked(i);
+    if (element.GetType() == Value::Type::String) {
+      result.append(element.Get<std::string>());
+    } else {
+      result.push_back(element.Get<char>());
+    }
+  }
+
+  return Value(std::move(result));
+}
+
+static Value StringRepeat(Args args)
+{
+  const auto& s = GetStringOrThrow(args[0], "repeat(s, count)");
+  if (args[1].GetType() != Value::Type::Int) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `Int` for `count` in `std::string::repeat(s, count)` but got `{}`", args[1].GetTypeName())
+    );
+  }
+
+  auto count = args[1].Get<std::int64_t>();
+  if (count < 0) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("`count` must not be negative in `std::string::repeat(s, count)` but got {}", count)
+    );
+  }
+
+  if (!s.empty() && static_cast<std::uint64_t>(count) > std::string().max_size() / s.size()) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("Repeating a String of length {} {} times is too long", s.size(), count)
+    );
+  }
+
+  return Value(Grace::StringAlgorithms::Repeat(s, static_cast<std::size_t>(count)));
+}
+
+static Grace::GraceStringBuilder* GetStringBuilderOrThrow(Value& value, std::string_view funcSignature)
+{
+  auto object = value.GetObject();
+  if (object != nullptr) {
+    if (auto builder = object->GetAsStringBuilder()) {
+      return builder;
+    }
   }
 
   throw Grace::GraceException(
     Grace::GraceException::Type::InvalidType,
-    fmt::format("Expected `String` for `std::string::substring(string, start, length)` but got `{}`", args[0].GetType())
-  );  
+    fmt::format("Expected `StringBuilder` for `std::string_builder::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
+}
+
+static Value StringBuilderCreate(GRACE_MAYBE_UNUSED Args args)
+{
+  return Value::CreateObject<Grace::GraceStringBuilder>();
+}
+
+static Value StringBuilderAppend(Args args)
+{
+  GetStringBuilderOrThrow(args[0], "append(builder, value)")->Append(args[1]);
+  return Value();
+}
+
+static Value StringBuilderAppendLine(Args args)
+{
+  auto builder = GetStringBuilderOrThrow(args[0], "append_line(builder, value)");
+  builder->Append(args[1]);
+  builder->Append(Value('\n'));
+  return Value();
+}
+
+static Value StringBuilderBuild(Args args)
+{
+  return Value(GetStringBuilderOrThrow(args[0], "build(builder)")->Buffer());
+}
+
+static Value StringBuilderLength(Args args)
+{
+  return Value(static_cast<std::int64_t>(GetStringBuilderOrThrow(args[0], "length(builder)")->Buffer().size()));
+}
+
+static Value StringBuilderClear(Args args)
+{
+  GetStringBuilderOrThrow(args[0], "clear(builder)")->Clear();
+  return Value();
+}
+
+static Value ThreadSpawn(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `name` in `std::thread::spawn(name, args)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  auto object = args[1].GetObject();
+  auto list = object == nullptr ? nullptr : object->GetAsList();
+  if (list == nullptr) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `List` for `args` in `std::thread::spawn(name, args)` but got `{}`", args[1].GetTypeName())
+    );
+  }
+
+  const auto& name = args[0].Get<std::string>();
+  auto [fileNameHash, nameHash] = VM::FindWorkerFunction(name, list->Length(), "Thread");
+
+  // encoded now, so the thread gets the arguments as they were when it was spawned
+  auto message = Grace::ThreadMessage::Encode(args[1]);
+  return Value::CreateObject<Grace::GraceThread>(name, [fileNameHash, nameHash, message = std::move(message)]() {
+    auto decoded = message.Decode();
+    auto decodedList = decoded.GetObject()->GetAsList();
+
+    std::vector<Value> workerArgs;
+    workerArgs.reserve(decodedList->Length());
+    for (std::size_t i = 0; i < decodedList->Length(); i++) {
+      workerArgs.push_back(decodedList->GetUnchecked(i));
+    }
+
+    auto result = VM::RunWorker(fileNameHash, nameHash, std::move(workerArgs));
+    return Grace::ThreadMessage::Encode(result);
+  });
+}
+
+static Grace::GraceThread* GetThreadOrThrow(Value& value, std::string_view funcSignature)
+{
+  auto object = value.GetObject();
+  if (object != nullptr) {
+    if (auto thread = object->GetAsThread()) {
+      return thread;
+    }
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `Thread` for `std::thread::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
+}
+
+static Value ThreadJoin(Args args)
+{
+  Grace::OutputBuffer::FlushAll();
+  return GetThreadOrThrow(args[0], "join(thread)")->Join();
+}
+
+static Value ThreadCores(GRACE_MAYBE_UNUSED Args args)
+{
+  // 0 if it can't be worked out, but there's always at least the thread asking
+  return Value(static_cast<std::int64_t>(std::max(std::thread::hardware_concurrency(), 1u)));
+}
+
+static Value ChannelCreate(GRACE_MAYBE_UNUSED Args args)
+{
+  return Value::CreateObject<Grace::GraceChannel>();
+}
+
+static Grace::GraceChannel* GetChannelOrThrow(Value& value, std::string_view funcSignature)
+{
+  auto object = value.GetObject();
+  if (object != nullptr) {
+    if (auto channel = object->GetAsChannel()) {
+      return channel;
+    }
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `Channel` for `std::thread::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
+}
+
+static Value ChannelSend(Args args)
+{
+  GetChannelOrThrow(args[0], "send(channel, value)")->Send(args[1]);
+  return Value();
+}
+
+static Value ChannelReceive(Args args)
+{
+  // anything printed so far should be seen before this thread goes to sleep
+  Grace::OutputBuffer::FlushAll();
+  return GetChannelOrThrow(args[0], "receive(channel)")->Receive().value_or(Value());
+}
+
+static Value ChannelTryReceive(Args args)
+{
+  return GetChannelOrThrow(args[0], "try_receive(channel)")->TryReceive().value_or(Value());
+}
+
+static Value ChannelClose(Args args)
+{
+  GetChannelOrThrow(args[0], "close(channel)")->Close();
+  return Value();
+}
+
+static Value ThreadSetPoolSize(Args args)
+{
+  if (args[0].GetType() != Value::Type::Int || args[0].Get<std::int64_t>() < 0) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("Expected a positive `Int` or 0 for `std::thread::set_pool_size(size)` but got `{}`", args[0])
+    );
+  }
+
+  Grace::ThreadPool::SetSize(static_cast<std::size_t>(args[0].Get<std::int64_t>()));
+  return Value();
+}
+
+static Value ThreadGetPoolSize(GRACE_MAYBE_UNUSED Args args)
+{
+  return Value(static_cast<std::int64_t>(Grace::ThreadPool::GetSize()));
+}
+
+static Value FiberSpawn(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `name` in `std::fiber::spawn(name, args)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  auto object = args[1].GetObject();
+  auto list = object == nullptr ? nullptr : object->GetAsList();
+  if (list == nullptr) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `List` for `args` in `std::fiber::spawn(name, args)` but got `{}`", args[1].GetTypeName())
+    );
+  }
+
+  const auto& name = args[0].Get<std::string>();
+  auto [fileNameHash, nameHash] = VM::FindWorkerFunction(name, list->Length(), "Fiber");
+
+  // the fiber shares this thread's heap, so the arguments are passed as they are rather than copied
+  std::vector<Value> fiberArgs;
+  fiberArgs.reserve(list->Length());
+  for (std::size_t i = 0; i < list->Length(); i++) {
+    fiberArgs.push_back(list->GetUnchecked(i));
+  }
+
+  return Value::CreateObject<Grace::GraceFiber>(name, [fileNameHash, nameHash, fiberArgs = std::move(fiberArgs)]() mutable {
+    return VM::RunWorker(fileNameHash, nameHash, std::move(fiberArgs));
+  });
+}
+
+static Grace::GraceFiber* GetFiberOrThrow(Value& value, std::string_view funcSignature)
+{
+  auto object = value.GetObject();
+  if (object != nullptr) {
+    if (auto fiber = object->GetAsFiber()) {
+      return fiber;
+    }
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `Fiber` for `std::fiber::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
+}
+
+static Value FiberJoin(Args args)
+{
+  return GetFiberOrThrow(args[0], "join(fiber)")->Join();
+}
+
+static Value FiberSleep(Args args)
+{
+  if (args[0].GetType() != Value::Type::Int || args[0].Get<std::int64_t>() < 0) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("Expected a positive `Int` or 0 for `std::fiber::sleep(milliseconds)` but got `{}`", args[0])
+    );
+  }
+
+  // anything printed so far should be seen before the thread goes to sleep in epoll
+  Grace::OutputBuffer::FlushAll();
+  Grace::EventLoop::Sleep(std::chrono::milliseconds(args[0].Get<std::int64_t>()));
+  return Value();
+}
+
+static Value FiberOpen(Args args)
+{
+  if (args[0].GetType() != Value::Type::String || args[1].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for both arguments of `std::fiber::open(path, mode)` but got `{}` and `{}`", args[0].GetTypeName(), args[1].GetTypeName())
+    );
+  }
+
+  const auto& path = args[0].Get<std::string>();
+  const auto& mode = args[1].Get<std::string>();
+  auto fd = Grace::EventLoop::Open(path, mode);
+  return Value::CreateObject<Grace::GraceStream>(fd, fmt::format("'{}'", path), mode == "r", mode != "r");
+}
+
+static Value FiberPipe(GRACE_MAYBE_UNUSED Args args)
+{
+  auto [readEnd, writeEnd] = Grace::EventLoop::Pipe();
+  return Value::CreateObject<Grace::GraceList>(std::vector<Value>{
+    Value::CreateObject<Grace::GraceStream>(readEnd, "from a pipe", true, false),
+    Value::CreateObject<Grace::GraceStream>(writeEnd, "into a pipe", false, true),
+  });
+}
+
+static Value FiberRun(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::fiber::run(command)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  // the child writes straight to the same stdout, after anything that was printed before it started
+  Grace::OutputBuffer::FlushAll();
+  auto child = Grace::EventLoop::StartProcess(args[0].Get<std::string>(), false, false);
+  return Value(static_cast<std::int64_t>(Grace::EventLoop::WaitForProcess(child.pid)));
+}
+
+static Value FiberStart(Args args)
+{
+  if (args[0].GetType() != Value::Type::String) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `String` for `std::fiber::start(command)` but got `{}`", args[0].GetTypeName())
+    );
+  }
+
+  const auto& command = args[0].Get<std::string>();
+  auto child = Grace::EventLoop::StartProcess(command, true, true);
+  auto input = Value::CreateObject<Grace::GraceStream>(child.input, fmt::format("into `{}`", command), false, true);
+  auto output = Value::CreateObject<Grace::GraceStream>(child.output, fmt::format("from `{}`", command), true, false);
+  return Value::CreateObject<Grace::GraceProcess>(command, child.pid, std::move(input), std::move(output));
+}
+
+static Grace::GraceProcess* GetProcessOrThrow(Value& value, std::string_view funcSignature)
+{
+  auto object = value.GetObject();
+  if (object != nullptr) {
+    if (auto process = object->GetAsProcess()) {
+      return process;
+    }
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `Process` for `std::fiber::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
+}
+
+static Value ProcessInput(Args args)
+{
+  return GetProcessOrThrow(args[0], "input(process)")->Input();
+}
+
+static Value ProcessOutput(Args args)
+{
+  return GetProcessOrThrow(args[0], "output(process)")->Output();
+}
+
+static Value ProcessWait(Args args)
+{
+  return Value(static_cast<std::int64_t>(GetProcessOrThrow(args[0], "wait(process)")->Wait()));
+}
+
+static Grace::GraceStream* GetStreamOrThrow(Value& value, std::string_view funcSignature)
+{
+  auto object = value.GetObject();
+  if (object != nullptr) {
+    if (auto stream = object->GetAsStream()) {
+      return stream;
+    }
+  }
+
+  throw Grace::GraceException(
+    Grace::GraceException::Type::InvalidType,
+    fmt::format("Expected `Stream` for `std::fiber::{}` but got `{}`", funcSignature, value.GetTypeName())
+  );
+}
+
+static Value StreamReadLine(Args args)
+{
+  if (auto line = GetStreamOrThrow(args[0], "read_line(stream)")->ReadLine()) {
+    return Value(std::move(*line));
+  }
+  return {};
+}
+
+static Value StreamReadChunk(Args args)
+{
+  auto stream = GetStreamOrThrow(args[0], "read_chunk(stream, count)");
+  if (args[1].GetType() != Value::Type::Int) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidType,
+      fmt::format("Expected `Int` for `count` in `std::fiber::read_chunk(stream, count)` but got `{}`", args[1].GetTypeName())
+    );
+  }
+
+  auto count = args[1].Get<std::int64_t>();
+  if (count <= 0) {
+    throw Grace::GraceException(
+      Grace::GraceException::Type::InvalidArgument,
+      fmt::format("`count` must be greater than 0 for `std::fiber::read_chunk(stream, count)` but got {}", count)
+    );
+  }
+
+  auto chunk = stream->ReadChunk(static_cast<std::size_t>(count));
+  if (chunk.empty()) {
+    return {};
+  }
+  return Value(std::move(chunk));
+}
+
+static Value StreamReadAll(Args args)
+{
+  return Value(GetStreamOrThrow(args[0], "read_all(stream)")->ReadAll());
+}
+
+// Strings and Bytes are written as they are, anything else is written as it would be printed
+static Value StreamWrite(Args args)
+{
+  auto stream = GetStreamOrThrow(args[0], "write(stream, contents)");
+  auto object = args[1].GetObject();
+  if (args[1].GetType() == Value::Type::String) {
+    stream->WriteText(args[1].Get<std::string>());
+  } else if (auto bytes = object != nullptr ? object->GetAsBytes() : nullptr) {
+    stream->WriteText(bytes->View());
+  } else {
+    stream->WriteText(args[1].AsString());
+  }
+  return {};
+}
+
+static Value StreamClose(Args args)
+{
+  GetStreamOrThrow(args[0], "close(stream)")->Close();
+  return {};
 }
 
 static Value CharIsLower(Args args)
@@ -0,0 +1,71 @@
+/*
+ *  The Grace Programming Language.
+ *
+ *  This file contains helpers for matching bytes 8 at a time in a std::uint64_t, used by the Scanner and the JSON parser.
+ *  The matchers return a word with the high bit of each byte set where that byte matches,
+ *  only ASCII bytes can match so multi-byte UTF-8 sequences are never included in a run.
+ *
+ *  Copyright (c) 2022 - Present, Ryan Jeffares.
+ *  All rights reserved.
+ *
+ *  For licensing information, see grace.hpp
+ */
+
+#ifndef GRACE_WORD_AT_A_TIME_HPP
+#define GRACE_WORD_AT_A_TIME_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Grace::WordAtATime
+{
+  constexpr std::uint64_t Broadcast(std::uint8_t byte)
+  {
+    return 0x0101010101010101ull * byte;
+  }
+
+  constexpr std::uint64_t BytesInRange(std::uint64_t word, std::uint8_t low, std::uint8_t high)
+  {
+    auto low7 = word & Broadcast(0x7F);
+    return (low7 + Broadcast(0x80 - low)) & ~(low7 + Broadcast(0x7F - high)) & ~word & Broadcast(0x80);
+  }
+
+  // number of bytes at the start of the word, in memory order, that matched
+  inline std::size_t LeadingMatches(std::uint64_t matches)
+  {
+    auto misses = ~matches & Broadcast(0x80);
+    if (misses == 0) {
+      return 8;
+    }
+
+    if constexpr (std::endian::native == std::endian::little) {
+      return static_cast<std::size_t>(std::countr_zero(misses)) / 8;
+    } else {
+      return static_cast<std::size_t>(std::countl_zero(misses)) / 8;
+    }
+  }
+
+  template<typename WordMatcher, typename CharMatcher>
+  const char* SkipRun(const char* current, const char* end, WordMatcher wordMatcher, CharMatcher charMatcher)
+  {
+    while (end - current >= 8) {
+      std::uint64_t word;
+      std::memcpy(&word, current, sizeof(word));
+      auto matched = LeadingMatches(wordMatcher(word));
+      current += matched;
+      if (matched != 8) {
+        return current;
+      }
+    }
+
+    while (current != end && charMatcher(*current)) {
+      current++;
+    }
+
+    return current;
+  }
+} // namespace Grace::WordAtATime
+
+#endif  // ifndef GRACE_WORD_AT_A_TIME_HPP
@@ -0,0 +1,83 @@
+import argparse
+import os
+import subprocess
+import sys
+
+
+parser = argparse.ArgumentParser(
+    description='Check that every example produces the same output with and without bytecode optimisation'
+)
+parser.add_argument(
+    '--levels', nargs='+', default=['-O1', '-O2'], help='Optimisation levels to compare against -O0'
+)
+parser.add_argument(
+    '--timeout', type=int, default=60, help='Seconds to allow each run before skipping the example'
+)
+
+# these print timings or process ids, so only the exit code is compared
+NONDETERMINISTIC = ['better_fib.gr', 'fib_2.gr', 'import.gr']
+
+# these print until they are killed, so their output would fill up memory before timing out
+ENDLESS = ['range.gr']
+
+
+def run(grace, level, path, timeout):
+    result = subprocess.run(
+        [grace, level, path], stdin=subprocess.DEVNULL, capture_output=True, timeout=timeout
+    )
+    return result.returncode, result.stdout, result.stderr
+
+
+def main():
+    args = parser.parse_args()
+
+    if os.name == 'nt':
+        grace = './build/grace/Release/Release/grace.exe'
+    else:
+        grace = './build/grace/Release/grace'
+
+    failures = []
+    for root, dirs, files in os.walk('./examples', topdown=True):
+        for file in sorted(files):
+            if not file.endswith('.gr'):
+                continue
+
+            if file in ENDLESS:
+                print('Skipped', os.path.join(root, file), '(never finishes)')
+                continue
+
+            example_path = os.path.join(root, file)
+            try:
+                expected = run(grace, '-O0', example_path, args.timeout)
+            except subprocess.TimeoutExpired:
+                print('Skipped', example_path, '(timed out)')
+                continue
+
+            for level in args.levels:
+                try:
+                    actual = run(grace, level, example_path, args.timeout)
+                except subprocess.TimeoutExpired:
+                    failures.append(f'{example_path} {level}: timed out')
+                    continue
+
+                if file in NONDETERMINISTIC:
+                    matches = actual[0] == expected[0]
+                else:
+                    matches = actual == expected
+
+                if not matches:
+                    failures.append(f'{example_path} {level}: output differs from -O0')
+
+            print('Checked', example_path)
+
+    print()
+    if failures:
+        for failure in failures:
+            print('FAILED', failure)
+        sys.exit(1)
+
+    print('All examples match')
+
+
+if __name__ == '__main__':
+    main()